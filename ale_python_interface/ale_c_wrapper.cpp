@@ -2,6 +2,7 @@
 
 #include <cstring>
 #include <string>
+#include <vector>
 #include <stdexcept>
 
 void encodeState(ALEState *state, char *buf, int buf_len) {
@@ -22,4 +23,84 @@ ALEState *decodeState(const char *serialized, int len) {
 	std::string str(serialized, len);
 
 	return new ALEState(str);
-}
\ No newline at end of file
+}
+bool preloadROMs(ALEInterface *ale, const char **rom_files, int n) {
+	try {
+		ale->preloadROMs(std::vector<std::string>(rom_files, rom_files + n));
+		return true;
+	} catch (std::exception &e) {
+		ale::Logger::Error << e.what() << std::endl;
+		return false;
+	}
+}
+
+bool selectROM(ALEInterface *ale, int index, bool restart) {
+	try {
+		ale->selectROM(index, restart);
+		return true;
+	} catch (std::exception &e) {
+		ale::Logger::Error << e.what() << std::endl;
+		return false;
+	}
+}
+
+StateArchiveWriter *openStateArchiveWriter(const char *filename, const char *reference,
+                                           int len, int level) {
+	try {
+		StateCodec codec(std::string(reference, len), level);
+		StateArchiveWriter *writer = new StateArchiveWriter(filename, codec);
+		if (writer->isOpen())
+			return writer;
+		delete writer;
+		ale::Logger::Error << "Couldn't create state archive " << filename << std::endl;
+	} catch (std::exception &e) {
+		ale::Logger::Error << e.what() << std::endl;
+	}
+	return NULL;
+}
+
+int stateArchiveWriterAdd(StateArchiveWriter *writer, const char *serialized, int len) {
+	try {
+		return writer->add(ALEState(std::string(serialized, len)));
+	} catch (std::exception &e) {
+		ale::Logger::Error << e.what() << std::endl;
+		return -1;
+	}
+}
+
+bool closeStateArchiveWriter(StateArchiveWriter *writer) {
+	bool written = writer->close();
+	if (!written)
+		ale::Logger::Error << "Error writing state archive" << std::endl;
+	delete writer;
+	return written;
+}
+
+StateArchive *openStateArchive(const char *filename) {
+	try {
+		return new StateArchive(filename);
+	} catch (std::exception &e) {
+		ale::Logger::Error << e.what() << std::endl;
+		return NULL;
+	}
+}
+
+ALEState *stateArchiveGet(StateArchive *archive, int i) {
+	try {
+		return new ALEState(archive->get(i));
+	} catch (std::exception &e) {
+		ale::Logger::Error << e.what() << std::endl;
+		return NULL;
+	}
+}
+
+ReplayBufferHandle *newReplayBuffer(int capacity, int height, int width, int stack,
+                                    bool deduplicate, unsigned int seed) {
+	try {
+		return new ReplayBufferHandle(new ReplayBuffer(capacity, height, width, stack,
+		                                               deduplicate, seed));
+	} catch (std::exception &e) {
+		ale::Logger::Error << e.what() << std::endl;
+		return NULL;
+	}
+}
@@ -2,6 +2,7 @@
 #define __ALE_C_WRAPPER_H__
 
 #include <ale_interface.hpp>
+#include "environment/state_archive.hpp"
 
 extern "C" {
   // Declares int rgb_palette[256]
@@ -16,12 +17,17 @@ extern "C" {
   void setBool(ALEInterface *ale,const char *key,bool value){ale->setBool(key,value);}
   void setFloat(ALEInterface *ale,const char *key,float value){ale->setFloat(key,value);}
   void loadROM(ALEInterface *ale,const char *rom_file){ale->loadROM(rom_file);}
+  // Both return false, logging why, if the ROMs can't be preloaded or there is no such game
+  bool preloadROMs(ALEInterface *ale, const char **rom_files, int n);
+  bool selectROM(ALEInterface *ale, int index, bool restart);
+  int getNumPreloadedROMs(ALEInterface *ale){return ale->getNumPreloadedROMs();}
+  int getSelectedROM(ALEInterface *ale){return ale->getSelectedROM();}
   int act(ALEInterface *ale,int action){return ale->act((Action)action);}
   bool game_over(ALEInterface *ale){return ale->game_over();}
   void reset_game(ALEInterface *ale){ale->reset_game();}
   void getAvailableModes(ALEInterface *ale,int *availableModes) {
     ModeVect modes_vect = ale->getAvailableModes();
-    for(unsigned int i = 0; i < ale->getAvailableModes().size(); i++){
+    for(unsigned int i = 0; i < modes_vect.size(); i++){
       availableModes[i] = modes_vect[i];
     }
   }
@@ -29,7 +35,7 @@ extern "C" {
   void setMode(ALEInterface *ale, int mode) {ale->setMode(mode);}
   void getAvailableDifficulties(ALEInterface *ale,int *availableDifficulties) {
     DifficultyVect difficulties_vect = ale->getAvailableDifficulties();
-    for(unsigned int i = 0; i < ale->getAvailableDifficulties().size(); i++){
+    for(unsigned int i = 0; i < difficulties_vect.size(); i++){
       availableDifficulties[i] = difficulties_vect[i];
     }
   }
@@ -37,14 +43,14 @@ extern "C" {
   void setDifficulty(ALEInterface *ale, int difficulty) {ale->setDifficulty(difficulty);}
   void getLegalActionSet(ALEInterface *ale,int *actions) {
     ActionVect action_vect = ale->getLegalActionSet();
-    for(unsigned int i = 0; i < ale->getLegalActionSet().size(); i++){
+    for(unsigned int i = 0; i < action_vect.size(); i++){
       actions[i] = action_vect[i];
     }
   }
   int getLegalActionSize(ALEInterface *ale){return ale->getLegalActionSet().size();}
   void getMinimalActionSet(ALEInterface *ale,int *actions){
     ActionVect action_vect = ale->getMinimalActionSet();
-    for(unsigned int i = 0;i < ale->getMinimalActionSet().size();i++){
+    for(unsigned int i = 0;i < action_vect.size();i++){
       actions[i] = action_vect[i];
     }
   }
@@ -85,6 +91,12 @@ extern "C" {
     ale->theOSystem->colourPalette().applyPaletteGrayscale(output_buffer, ale_screen_data, screen_size);
   }
 
+  void getAudio(ALEInterface *ale, unsigned char *output_buffer){
+    const SoundHeadless *audio = ale->environment->getAudio();
+    if (audio != NULL) audio->getSamples(output_buffer);
+  }
+  int getAudioSize(ALEInterface *ale){return ale->getAudioSize();}
+
   void saveState(ALEInterface *ale){ale->saveState();}
   void loadState(ALEInterface *ale){ale->loadState();}
   ALEState* cloneState(ALEInterface *ale){return new ALEState(ale->cloneState());}
@@ -92,8 +104,82 @@ extern "C" {
   ALEState* cloneSystemState(ALEInterface *ale){return new ALEState(ale->cloneSystemState());}
   void restoreSystemState(ALEInterface *ale, ALEState* state){ale->restoreSystemState(*state);}
   void deleteState(ALEState* state){delete state;}
+  // Checkpoints are handed out packed in 64 bits, depth first
+  unsigned long long checkpoint(ALEInterface *ale){
+    Journal::Checkpoint checkpoint = ale->checkpoint();
+    return ((unsigned long long)checkpoint.depth << 32) | checkpoint.id;
+  }
+  bool rollback(ALEInterface *ale, unsigned long long checkpoint){
+    Journal::Checkpoint unpacked = { (uInt32)(checkpoint >> 32), (uInt32)checkpoint };
+    return ale->rollback(unpacked);
+  }
   void saveScreenPNG(ALEInterface *ale,const char *filename){ale->saveScreenPNG(filename);}
 
+  // Plays the n actions from state without processing screens, stopping early at a terminal
+  // state. Fills rewards and lives (n entries each) and returns the number of steps taken.
+  int rollout(ALEInterface *ale, ALEState *state, const int *actions, int n, int *rewards,
+              int *lives){
+    ActionVect action_vect(n);
+    for(int i = 0; i < n; i++) action_vect[i] = (Action)actions[i];
+    RolloutResult result;
+    ale->rollout(*state, action_vect.empty() ? NULL : &action_vect[0], n, &result);
+    for(size_t i = 0; i < result.rewards.size(); i++){
+      rewards[i] = result.rewards[i];
+      lives[i] = result.lives[i];
+    }
+    return result.rewards.size();
+  }
+  // Acts once from state with each of the n actions, in parallel. Fills the child states,
+  // to be freed with deleteState, their rewards and whether they are terminal.
+  void expand(ALEInterface *ale, ALEState *state, const int *actions, int n,
+              ALEState **children, int *rewards, bool *terminal){
+    ActionVect action_vect(n);
+    for(int i = 0; i < n; i++) action_vect[i] = (Action)actions[i];
+    std::vector<ChildNode> nodes;
+    ale->expand(*state, action_vect, nodes);
+    for(int i = 0; i < n; i++){
+      children[i] = new ALEState(*nodes[i].state);
+      rewards[i] = nodes[i].reward;
+      terminal[i] = nodes[i].terminal;
+    }
+  }
+  // Plays num_sequences sequences of length actions each (row by row) from state, in
+  // parallel, and fills their total rewards and numbers of steps taken.
+  void rolloutBatch(ALEInterface *ale, ALEState *state, const int *actions, int num_sequences,
+                    int length, int *total_rewards, int *steps){
+    std::vector<ActionVect> sequences(num_sequences);
+    for(int i = 0; i < num_sequences; i++){
+      for(int j = 0; j < length; j++)
+        sequences[i].push_back((Action)actions[i * length + j]);
+    }
+    std::vector<RolloutResult> results;
+    ale->rolloutBatch(*state, sequences, results);
+    for(int i = 0; i < num_sequences; i++){
+      total_rewards[i] = results[i].total_reward;
+      steps[i] = results[i].rewards.size();
+    }
+  }
+
+  // 64-bit fingerprints; the batch versions fill fingerprints[i] for each of the n
+  // interfaces or states
+  unsigned long long getScreenFingerprint(ALEInterface *ale){return ale->getScreenFingerprint();}
+  unsigned long long getRAMFingerprint(ALEInterface *ale){return ale->getRAMFingerprint();}
+  unsigned long long getStateFingerprint(ALEState *state){return state->fingerprint();}
+  void getScreenFingerprints(ALEInterface **ales, int n, unsigned long long *fingerprints){
+    for(int i = 0; i < n; i++) fingerprints[i] = ales[i]->getScreenFingerprint();
+  }
+  void getScreenCellFingerprints(ALEInterface **ales, int n, int rows, int columns, int levels,
+                                 unsigned long long *fingerprints){
+    for(int i = 0; i < n; i++)
+      fingerprints[i] = ales[i]->getScreen().cellFingerprint(rows, columns, levels);
+  }
+  void getRAMFingerprints(ALEInterface **ales, int n, unsigned long long *fingerprints){
+    for(int i = 0; i < n; i++) fingerprints[i] = ales[i]->getRAMFingerprint();
+  }
+  void getStateFingerprints(ALEState **states, int n, unsigned long long *fingerprints){
+    for(int i = 0; i < n; i++) fingerprints[i] = states[i]->fingerprint();
+  }
+
   // Encodes the state as a raw bytestream. This may have multiple '\0' characters
   // and thus should not be treated as a C string. Use encodeStateLen to find the length
   // of the buffer to pass in, or it will be overrun as this simply memcpys bytes into the buffer.
@@ -101,6 +187,45 @@ extern "C" {
   int encodeStateLen(ALEState *state);
   ALEState *decodeState(const char *serialized, int len);
 
+  // State archives hold states encoded as above. Opening returns NULL on failure, adding a
+  // state returns its index or -1, and stateArchiveGet returns a new state or NULL.
+  StateArchiveWriter *openStateArchiveWriter(const char *filename, const char *reference,
+                                             int len, int level);
+  int stateArchiveWriterAdd(StateArchiveWriter *writer, const char *serialized, int len);
+  bool closeStateArchiveWriter(StateArchiveWriter *writer);
+  StateArchive *openStateArchive(const char *filename);
+  int stateArchiveSize(StateArchive *archive){return archive->size();}
+  ALEState *stateArchiveGet(StateArchive *archive, int i);
+  void closeStateArchive(StateArchive *archive){delete archive;}
+
+  // Replay buffers are shared with the environments feeding them; the handle holds one
+  // reference. newReplayBuffer returns NULL on invalid sizes, and replayBufferSample false
+  // if there is no transition to draw. Any output pointer but observations and actions may
+  // be NULL.
+  typedef std::shared_ptr<ReplayBuffer> ReplayBufferHandle;
+  ReplayBufferHandle *newReplayBuffer(int capacity, int height, int width, int stack,
+                                      bool deduplicate, unsigned int seed);
+  void deleteReplayBuffer(ReplayBufferHandle *buffer){delete buffer;}
+  void setReplayBuffer(ALEInterface *ale, ReplayBufferHandle *buffer){
+    ale->setReplayBuffer(buffer != NULL ? *buffer : ReplayBufferHandle());
+  }
+  int replayBufferSize(ReplayBufferHandle *buffer){return (*buffer)->size();}
+  int replayBufferTransitions(ReplayBufferHandle *buffer){return (*buffer)->transitions();}
+  int replayBufferNumFrames(ReplayBufferHandle *buffer){return (*buffer)->numFrames();}
+  size_t replayBufferFrameBytes(ReplayBufferHandle *buffer){return (*buffer)->frameBytes();}
+  bool replayBufferSample(ReplayBufferHandle *buffer, int n, unsigned char *observations,
+                          int *actions, int *rewards, unsigned char *next_observations,
+                          unsigned char *terminals, size_t *indices, double *probabilities,
+                          int threads){
+    ReplayBuffer::Batch batch = { observations, actions, rewards, next_observations,
+                                  terminals, indices, probabilities };
+    return (*buffer)->sample(n, batch, threads);
+  }
+  void replayBufferUpdatePriorities(ReplayBufferHandle *buffer, const size_t *indices,
+                                    const double *priorities, int n){
+    (*buffer)->updatePriorities(indices, priorities, n);
+  }
+
   // 0: Info, 1: Warning, 2: Error
   void setLoggerMode(int mode) { ale::Logger::setMode(ale::Logger::mode(mode)); }
 }
@@ -0,0 +1,1254 @@
+// ale_native.cpp
+//
+// A compiled CPython module implementing the same ALEInterface class as the ctypes
+// interface in ale_python_interface.py, which uses it when it is built. Calls cost a
+// regular method call rather than ctypes marshalling, act() releases the GIL while
+// emulating, and getScreenView()/getRAMView() return zero-copy numpy views of the
+// observations that stay current as the game is played.
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
+#include <numpy/arrayobject.h>
+
+#include <ale_interface.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+typedef struct {
+  PyObject_HEAD
+  ALEInterface *ale;
+  int views; // Live arrays sharing the environment's screen or RAM
+} NativeALE;
+
+typedef struct {
+  PyObject_HEAD
+  ALEState *state; // NULL once deleteState() was called
+} NativeState;
+
+typedef struct {
+  PyObject_HEAD
+  std::shared_ptr<ReplayBuffer> *buffer; // Shared with the environments feeding it
+} NativeReplayBuffer;
+
+static PyTypeObject NativeALEType;
+static PyTypeObject NativeStateType;
+static PyTypeObject NativeReplayBufferType;
+
+// Settings throw on unknown keys; C++ exceptions must not cross into Python
+#define CATCH_STD_EXCEPTIONS \
+  catch (const std::exception &e) { \
+    PyErr_SetString(PyExc_RuntimeError, e.what()); \
+    return NULL; \
+  }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Helpers
+
+// Accepts both bytes, as the ctypes interface does, and str
+static bool toString(PyObject *obj, std::string &str) {
+  if (PyBytes_Check(obj)) {
+    str.assign(PyBytes_AS_STRING(obj), PyBytes_GET_SIZE(obj));
+    return true;
+  }
+  if (PyUnicode_Check(obj)) {
+    PyObject *bytes = PyUnicode_AsUTF8String(obj);
+    if (bytes == NULL)
+      return false;
+    str.assign(PyBytes_AS_STRING(bytes), PyBytes_GET_SIZE(bytes));
+    Py_DECREF(bytes);
+    return true;
+  }
+  PyErr_SetString(PyExc_TypeError, "expected bytes or str");
+  return false;
+}
+
+// Returns out, or if it is None a new array of the given shape and type, and exposes its
+// memory in view. Fails unless it holds at least size bytes.
+static PyObject *outputArray(PyObject *out, int nd, npy_intp *dims, int type, size_t size,
+                             Py_buffer &view) {
+  if (out == NULL || out == Py_None)
+    out = PyArray_SimpleNew(nd, dims, type);
+  else
+    Py_INCREF(out);
+  if (out == NULL)
+    return NULL;
+
+  if (PyObject_GetBuffer(out, &view, PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS) < 0) {
+    Py_DECREF(out);
+    return NULL;
+  }
+  if ((size_t)view.len < size) {
+    PyBuffer_Release(&view);
+    Py_DECREF(out);
+    PyErr_Format(PyExc_ValueError, "output buffer must hold at least %zu bytes", size);
+    return NULL;
+  }
+  return out;
+}
+
+static PyObject *intArray(const std::vector<int> &values) {
+  npy_intp dims[1] = { (npy_intp)values.size() };
+  PyObject *array = PyArray_SimpleNew(1, dims, NPY_INT);
+  if (array != NULL && !values.empty())
+    memcpy(PyArray_DATA((PyArrayObject *)array), &values[0], values.size() * sizeof(int));
+  return array;
+}
+
+// Collects the interfaces of a sequence of ALEInterface objects
+static bool interfaceList(PyObject *seq, std::vector<NativeALE *> &ales) {
+  PyObject *fast = PySequence_Fast(seq, "expected a sequence of ALEInterface");
+  if (fast == NULL)
+    return false;
+  Py_ssize_t n = PySequence_Fast_GET_SIZE(fast);
+  ales.resize(n);
+  for (Py_ssize_t i = 0; i < n; i++) {
+    PyObject *item = PySequence_Fast_GET_ITEM(fast, i);
+    if (!PyObject_TypeCheck(item, &NativeALEType) || ((NativeALE *)item)->ale == NULL) {
+      Py_DECREF(fast);
+      PyErr_SetString(PyExc_TypeError, "expected a sequence of ALEInterface");
+      return false;
+    }
+    ales[i] = (NativeALE *)item;
+  }
+  Py_DECREF(fast);
+  return true;
+}
+
+static ALEState *stateOf(PyObject *obj) {
+  if (!PyObject_TypeCheck(obj, &NativeStateType)) {
+    PyErr_SetString(PyExc_TypeError, "expected an ALEState");
+    return NULL;
+  }
+  ALEState *state = ((NativeState *)obj)->state;
+  if (state == NULL)
+    PyErr_SetString(PyExc_ValueError, "the ALEState was deleted");
+  return state;
+}
+
+static PyObject *wrapState(const ALEState &state) {
+  NativeState *obj = PyObject_New(NativeState, &NativeStateType);
+  if (obj != NULL)
+    obj->state = new ALEState(state);
+  return (PyObject *)obj;
+}
+
+// Compact environments copy the screen lazily; views must see it after every step
+static void refreshViews(NativeALE *self) {
+  if (self->views > 0)
+    self->ale->getScreen();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Views
+
+static const char *ViewCapsule = "ale_native.view";
+
+static void releaseView(PyObject *capsule) {
+  NativeALE *owner = (NativeALE *)PyCapsule_GetPointer(capsule, ViewCapsule);
+  owner->views--;
+  Py_DECREF(owner);
+}
+
+// A read-only array over the environment's memory which keeps self alive
+static PyObject *viewArray(NativeALE *self, int nd, npy_intp *dims, const void *data) {
+  PyObject *array = PyArray_New(&PyArray_Type, nd, dims, NPY_UINT8, NULL, (void *)data, 0,
+                                NPY_ARRAY_C_CONTIGUOUS | NPY_ARRAY_ALIGNED, NULL);
+  if (array == NULL)
+    return NULL;
+
+  PyObject *capsule = PyCapsule_New(self, ViewCapsule, releaseView);
+  if (capsule == NULL) {
+    Py_DECREF(array);
+    return NULL;
+  }
+  Py_INCREF(self);
+  self->views++;
+  if (PyArray_SetBaseObject((PyArrayObject *)array, capsule) < 0) {
+    Py_DECREF(array);
+    return NULL;
+  }
+  return array;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// ALEState
+
+static void NativeState_dealloc(NativeState *self) {
+  delete self->state;
+  Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// ALEInterface
+
+static PyObject *NativeALE_new(PyTypeObject *type, PyObject *args, PyObject *kwds) {
+  NativeALE *self = (NativeALE *)type->tp_alloc(type, 0);
+  if (self == NULL)
+    return NULL;
+  self->ale = new ALEInterface();
+  self->views = 0;
+  return (PyObject *)self;
+}
+
+static void NativeALE_dealloc(NativeALE *self) {
+  delete self->ale;
+  Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *NativeALE_getString(NativeALE *self, PyObject *arg) {
+  std::string key;
+  if (!toString(arg, key))
+    return NULL;
+  try {
+    return PyBytes_FromString(self->ale->getString(key).c_str());
+  }
+  CATCH_STD_EXCEPTIONS
+}
+
+static PyObject *NativeALE_getInt(NativeALE *self, PyObject *arg) {
+  std::string key;
+  if (!toString(arg, key))
+    return NULL;
+  try {
+    return PyLong_FromLong(self->ale->getInt(key));
+  }
+  CATCH_STD_EXCEPTIONS
+}
+
+static PyObject *NativeALE_getBool(NativeALE *self, PyObject *arg) {
+  std::string key;
+  if (!toString(arg, key))
+    return NULL;
+  try {
+    return PyBool_FromLong(self->ale->getBool(key));
+  }
+  CATCH_STD_EXCEPTIONS
+}
+
+static PyObject *NativeALE_getFloat(NativeALE *self, PyObject *arg) {
+  std::string key;
+  if (!toString(arg, key))
+    return NULL;
+  try {
+    return PyFloat_FromDouble(self->ale->getFloat(key));
+  }
+  CATCH_STD_EXCEPTIONS
+}
+
+static PyObject *NativeALE_setString(NativeALE *self, PyObject *args) {
+  PyObject *keyObj, *valueObj;
+  std::string key, value;
+  if (!PyArg_ParseTuple(args, "OO", &keyObj, &valueObj) || !toString(keyObj, key) ||
+      !toString(valueObj, value))
+    return NULL;
+  try {
+    self->ale->setString(key, value);
+  }
+  CATCH_STD_EXCEPTIONS
+  Py_RETURN_NONE;
+}
+
+static PyObject *NativeALE_setInt(NativeALE *self, PyObject *args) {
+  PyObject *keyObj;
+  int value;
+  std::string key;
+  if (!PyArg_ParseTuple(args, "Oi", &keyObj, &value) || !toString(keyObj, key))
+    return NULL;
+  try {
+    self->ale->setInt(key, value);
+  }
+  CATCH_STD_EXCEPTIONS
+  Py_RETURN_NONE;
+}
+
+static PyObject *NativeALE_setBool(NativeALE *self, PyObject *args) {
+  PyObject *keyObj, *valueObj;
+  std::string key;
+  if (!PyArg_ParseTuple(args, "OO", &keyObj, &valueObj) || !toString(keyObj, key))
+    return NULL;
+  int value = PyObject_IsTrue(valueObj);
+  if (value < 0)
+    return NULL;
+  try {
+    self->ale->setBool(key, value != 0);
+  }
+  CATCH_STD_EXCEPTIONS
+  Py_RETURN_NONE;
+}
+
+static PyObject *NativeALE_setFloat(NativeALE *self, PyObject *args) {
+  PyObject *keyObj;
+  float value;
+  std::string key;
+  if (!PyArg_ParseTuple(args, "Of", &keyObj, &value) || !toString(keyObj, key))
+    return NULL;
+  try {
+    self->ale->setFloat(key, value);
+  }
+  CATCH_STD_EXCEPTIONS
+  Py_RETURN_NONE;
+}
+
+// The views point into the environment, which call replaces; raises if any is alive
+static bool checkNoViews(NativeALE *self, const char *call) {
+  if (self->views > 0) {
+    PyErr_Format(PyExc_RuntimeError,
+                 "screen or RAM views are still alive; delete them before %s", call);
+    return false;
+  }
+  return true;
+}
+
+static PyObject *NativeALE_loadROM(NativeALE *self, PyObject *arg) {
+  std::string rom;
+  if (!toString(arg, rom) || !checkNoViews(self, "loadROM()"))
+    return NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  self->ale->loadROM(rom);
+  Py_END_ALLOW_THREADS
+  Py_RETURN_NONE;
+}
+
+static PyObject *NativeALE_preloadROMs(NativeALE *self, PyObject *arg) {
+  PyObject *seq = PySequence_Fast(arg, "preloadROMs() expects a sequence of file names");
+  if (seq == NULL)
+    return NULL;
+  std::vector<std::string> roms(PySequence_Fast_GET_SIZE(seq));
+  for (size_t i = 0; i < roms.size(); i++) {
+    if (!toString(PySequence_Fast_GET_ITEM(seq, i), roms[i])) {
+      Py_DECREF(seq);
+      return NULL;
+    }
+  }
+  Py_DECREF(seq);
+  if (!checkNoViews(self, "preloadROMs()"))
+    return NULL;
+
+  std::string error;
+  Py_BEGIN_ALLOW_THREADS
+  try {
+    self->ale->preloadROMs(roms);
+  } catch (const std::exception &e) {
+    error = e.what();
+  }
+  Py_END_ALLOW_THREADS
+  if (!error.empty()) {
+    PyErr_SetString(PyExc_RuntimeError, error.c_str());
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
+static PyObject *NativeALE_selectROM(NativeALE *self, PyObject *args) {
+  int index, restart = 0;
+  if (!PyArg_ParseTuple(args, "i|p", &index, &restart) || !checkNoViews(self, "selectROM()"))
+    return NULL;
+  if (index < 0 || index >= self->ale->getNumPreloadedROMs()) {
+    PyErr_Format(PyExc_IndexError, "No preloaded ROM at index %d", index);
+    return NULL;
+  }
+  self->ale->selectROM(index, restart != 0);
+  Py_RETURN_NONE;
+}
+
+static PyObject *NativeALE_getNumPreloadedROMs(NativeALE *self, PyObject *) {
+  return PyLong_FromLong(self->ale->getNumPreloadedROMs());
+}
+
+static PyObject *NativeALE_getSelectedROM(NativeALE *self, PyObject *) {
+  return PyLong_FromLong(self->ale->getSelectedROM());
+}
+
+static PyObject *NativeALE_act(NativeALE *self, PyObject *arg) {
+  long action = PyLong_AsLong(arg);
+  if (action == -1 && PyErr_Occurred())
+    return NULL;
+
+  reward_t reward;
+  Py_BEGIN_ALLOW_THREADS
+  reward = self->ale->act((Action)action);
+  refreshViews(self);
+  Py_END_ALLOW_THREADS
+  return PyLong_FromLong(reward);
+}
+
+static PyObject *NativeALE_game_over(NativeALE *self, PyObject *) {
+  return PyBool_FromLong(self->ale->game_over());
+}
+
+static PyObject *NativeALE_reset_game(NativeALE *self, PyObject *) {
+  Py_BEGIN_ALLOW_THREADS
+  self->ale->reset_game();
+  refreshViews(self);
+  Py_END_ALLOW_THREADS
+  Py_RETURN_NONE;
+}
+
+static PyObject *NativeALE_getLegalActionSet(NativeALE *self, PyObject *) {
+  ActionVect actions = self->ale->getLegalActionSet();
+  return intArray(std::vector<int>(actions.begin(), actions.end()));
+}
+
+static PyObject *NativeALE_getMinimalActionSet(NativeALE *self, PyObject *) {
+  ActionVect actions = self->ale->getMinimalActionSet();
+  return intArray(std::vector<int>(actions.begin(), actions.end()));
+}
+
+static PyObject *NativeALE_getAvailableModes(NativeALE *self, PyObject *) {
+  ModeVect modes = self->ale->getAvailableModes();
+  return intArray(std::vector<int>(modes.begin(), modes.end()));
+}
+
+static PyObject *NativeALE_setMode(NativeALE *self, PyObject *arg) {
+  long mode = PyLong_AsLong(arg);
+  if (mode == -1 && PyErr_Occurred())
+    return NULL;
+  self->ale->setMode((game_mode_t)mode);
+  Py_RETURN_NONE;
+}
+
+static PyObject *NativeALE_getAvailableDifficulties(NativeALE *self, PyObject *) {
+  DifficultyVect difficulties = self->ale->getAvailableDifficulties();
+  return intArray(std::vector<int>(difficulties.begin(), difficulties.end()));
+}
+
+static PyObject *NativeALE_setDifficulty(NativeALE *self, PyObject *arg) {
+  long difficulty = PyLong_AsLong(arg);
+  if (difficulty == -1 && PyErr_Occurred())
+    return NULL;
+  self->ale->setDifficulty((difficulty_t)difficulty);
+  Py_RETURN_NONE;
+}
+
+static PyObject *NativeALE_getFrameNumber(NativeALE *self, PyObject *) {
+  return PyLong_FromLong(self->ale->getFrameNumber());
+}
+
+static PyObject *NativeALE_lives(NativeALE *self, PyObject *) {
+  return PyLong_FromLong(self->ale->lives());
+}
+
+static PyObject *NativeALE_getEpisodeFrameNumber(NativeALE *self, PyObject *) {
+  return PyLong_FromLong(self->ale->getEpisodeFrameNumber());
+}
+
+static PyObject *NativeALE_getScreenDims(NativeALE *self, PyObject *) {
+  const ALEScreen &screen = self->ale->getScreen();
+  return Py_BuildValue("(ii)", screen.width(), screen.height());
+}
+
+static PyObject *NativeALE_getScreen(NativeALE *self, PyObject *args) {
+  PyObject *out = NULL;
+  if (!PyArg_ParseTuple(args, "|O", &out))
+    return NULL;
+  const ALEScreen &screen = self->ale->getScreen();
+  npy_intp dims[1] = { (npy_intp)screen.arraySize() };
+  Py_buffer view;
+  if ((out = outputArray(out, 1, dims, NPY_UINT8, screen.arraySize(), view)) == NULL)
+    return NULL;
+  memcpy(view.buf, screen.getArray(), screen.arraySize());
+  PyBuffer_Release(&view);
+  return out;
+}
+
+static PyObject *NativeALE_getScreenRGB(NativeALE *self, PyObject *args) {
+  PyObject *out = NULL;
+  if (!PyArg_ParseTuple(args, "|O", &out))
+    return NULL;
+  const ALEScreen &screen = self->ale->getScreen();
+  npy_intp dims[3] = { (npy_intp)screen.height(), (npy_intp)screen.width(), 3 };
+  Py_buffer view;
+  if ((out = outputArray(out, 3, dims, NPY_UINT8, screen.arraySize() * 3, view)) == NULL)
+    return NULL;
+  self->ale->theOSystem->colourPalette().applyPaletteRGB((uInt8 *)view.buf,
+      screen.getArray(), screen.arraySize());
+  PyBuffer_Release(&view);
+  return out;
+}
+
+static PyObject *NativeALE_getScreenGrayscale(NativeALE *self, PyObject *args) {
+  PyObject *out = NULL;
+  if (!PyArg_ParseTuple(args, "|O", &out))
+    return NULL;
+  const ALEScreen &screen = self->ale->getScreen();
+  npy_intp dims[3] = { (npy_intp)screen.height(), (npy_intp)screen.width(), 1 };
+  Py_buffer view;
+  if ((out = outputArray(out, 3, dims, NPY_UINT8, screen.arraySize(), view)) == NULL)
+    return NULL;
+  self->ale->theOSystem->colourPalette().applyPaletteGrayscale((uInt8 *)view.buf,
+      screen.getArray(), screen.arraySize());
+  PyBuffer_Release(&view);
+  return out;
+}
+
+static PyObject *NativeALE_getScreenView(NativeALE *self, PyObject *) {
+  const ALEScreen &screen = self->ale->getScreen();
+  npy_intp dims[2] = { (npy_intp)screen.height(), (npy_intp)screen.width() };
+  return viewArray(self, 2, dims, screen.getArray());
+}
+
+static PyObject *NativeALE_getRAMSize(NativeALE *self, PyObject *) {
+  return PyLong_FromLong(self->ale->getRAM().size());
+}
+
+static PyObject *NativeALE_getRAM(NativeALE *self, PyObject *args) {
+  PyObject *out = NULL;
+  if (!PyArg_ParseTuple(args, "|O", &out))
+    return NULL;
+  const ALERAM &ram = self->ale->getRAM();
+  npy_intp dims[1] = { (npy_intp)ram.size() };
+  Py_buffer view;
+  if ((out = outputArray(out, 1, dims, NPY_UINT8, ram.size(), view)) == NULL)
+    return NULL;
+  memcpy(view.buf, ram.array(), ram.size());
+  PyBuffer_Release(&view);
+  return out;
+}
+
+static PyObject *NativeALE_getRAMView(NativeALE *self, PyObject *) {
+  const ALERAM &ram = self->ale->getRAM();
+  npy_intp dims[1] = { (npy_intp)ram.size() };
+  return viewArray(self, 1, dims, ram.array());
+}
+
+static PyObject *NativeALE_getAudioSize(NativeALE *self, PyObject *) {
+  return PyLong_FromSize_t(self->ale->getAudioSize());
+}
+
+static PyObject *NativeALE_getAudio(NativeALE *self, PyObject *args) {
+  PyObject *out = NULL;
+  if (!PyArg_ParseTuple(args, "|O", &out))
+    return NULL;
+  size_t size = self->ale->getAudioSize();
+  npy_intp dims[1] = { (npy_intp)size };
+  Py_buffer view;
+  if ((out = outputArray(out, 1, dims, NPY_UINT8, size, view)) == NULL)
+    return NULL;
+  const SoundHeadless *audio = self->ale->environment->getAudio();
+  if (audio != NULL)
+    audio->getSamples((uInt8 *)view.buf);
+  PyBuffer_Release(&view);
+  return out;
+}
+
+static PyObject *NativeALE_getScreenFingerprint(NativeALE *self, PyObject *) {
+  return PyLong_FromUnsignedLongLong(self->ale->getScreenFingerprint());
+}
+
+static PyObject *NativeALE_getRAMFingerprint(NativeALE *self, PyObject *) {
+  return PyLong_FromUnsignedLongLong(self->ale->getRAMFingerprint());
+}
+
+static PyObject *NativeALE_getStateFingerprint(NativeALE *, PyObject *arg) {
+  ALEState *state = stateOf(arg);
+  if (state == NULL)
+    return NULL;
+  return PyLong_FromUnsignedLongLong(state->fingerprint());
+}
+
+// Fills a uint64 array, or a new one, with the fingerprint of each item
+template <typename Item, typename Fingerprint>
+static PyObject *fingerprints(const std::vector<Item> &items, PyObject *out,
+                              Fingerprint fingerprint) {
+  npy_intp dims[1] = { (npy_intp)items.size() };
+  Py_buffer view;
+  if ((out = outputArray(out, 1, dims, NPY_UINT64, items.size() * sizeof(fingerprint_t),
+                         view)) == NULL)
+    return NULL;
+  fingerprint_t *values = (fingerprint_t *)view.buf;
+  for (size_t i = 0; i < items.size(); i++)
+    values[i] = fingerprint(items[i]);
+  PyBuffer_Release(&view);
+  return out;
+}
+
+static PyObject *NativeALE_getScreenFingerprints(PyObject *, PyObject *args) {
+  PyObject *seq, *out = NULL;
+  std::vector<NativeALE *> ales;
+  if (!PyArg_ParseTuple(args, "O|O", &seq, &out) || !interfaceList(seq, ales))
+    return NULL;
+  return fingerprints(ales, out, [](NativeALE *a) { return a->ale->getScreenFingerprint(); });
+}
+
+static PyObject *NativeALE_getScreenCellFingerprints(PyObject *, PyObject *args) {
+  PyObject *seq, *out = NULL;
+  int rows, columns, levels;
+  std::vector<NativeALE *> ales;
+  if (!PyArg_ParseTuple(args, "Oiii|O", &seq, &rows, &columns, &levels, &out) ||
+      !interfaceList(seq, ales))
+    return NULL;
+  return fingerprints(ales, out, [=](NativeALE *a) {
+    return a->ale->getScreen().cellFingerprint(rows, columns, levels);
+  });
+}
+
+static PyObject *NativeALE_getRAMFingerprints(PyObject *, PyObject *args) {
+  PyObject *seq, *out = NULL;
+  std::vector<NativeALE *> ales;
+  if (!PyArg_ParseTuple(args, "O|O", &seq, &out) || !interfaceList(seq, ales))
+    return NULL;
+  return fingerprints(ales, out, [](NativeALE *a) { return a->ale->getRAMFingerprint(); });
+}
+
+static PyObject *NativeALE_getStateFingerprints(PyObject *, PyObject *args) {
+  PyObject *seq, *out = NULL;
+  if (!PyArg_ParseTuple(args, "O|O", &seq, &out))
+    return NULL;
+  PyObject *fast = PySequence_Fast(seq, "expected a sequence of ALEState");
+  if (fast == NULL)
+    return NULL;
+  std::vector<ALEState *> states(PySequence_Fast_GET_SIZE(fast));
+  for (size_t i = 0; i < states.size(); i++) {
+    if ((states[i] = stateOf(PySequence_Fast_GET_ITEM(fast, i))) == NULL) {
+      Py_DECREF(fast);
+      return NULL;
+    }
+  }
+  Py_DECREF(fast);
+  return fingerprints(states, out, [](ALEState *s) { return s->fingerprint(); });
+}
+
+static PyObject *NativeALE_actBatch(PyObject *, PyObject *args) {
+  PyObject *seq, *actionSeq, *out = NULL;
+  std::vector<NativeALE *> ales;
+  if (!PyArg_ParseTuple(args, "OO|O", &seq, &actionSeq, &out) || !interfaceList(seq, ales))
+    return NULL;
+
+  PyObject *fast = PySequence_Fast(actionSeq, "expected a sequence of actions");
+  if (fast == NULL)
+    return NULL;
+  if ((size_t)PySequence_Fast_GET_SIZE(fast) != ales.size()) {
+    Py_DECREF(fast);
+    PyErr_SetString(PyExc_ValueError, "expected one action per interface");
+    return NULL;
+  }
+  std::vector<Action> actions(ales.size());
+  for (size_t i = 0; i < ales.size(); i++) {
+    long action = PyLong_AsLong(PySequence_Fast_GET_ITEM(fast, i));
+    if (action == -1 && PyErr_Occurred()) {
+      Py_DECREF(fast);
+      return NULL;
+    }
+    actions[i] = (Action)action;
+  }
+  Py_DECREF(fast);
+
+  npy_intp dims[1] = { (npy_intp)ales.size() };
+  Py_buffer view;
+  if ((out = outputArray(out, 1, dims, NPY_INT, ales.size() * sizeof(int), view)) == NULL)
+    return NULL;
+  int *rewards = (int *)view.buf;
+
+  Py_BEGIN_ALLOW_THREADS
+  for (size_t i = 0; i < ales.size(); i++) {
+    rewards[i] = ales[i]->ale->act(actions[i]);
+    refreshViews(ales[i]);
+  }
+  Py_END_ALLOW_THREADS
+
+  PyBuffer_Release(&view);
+  return out;
+}
+
+// Reads a C-contiguous array of actions, converting it to ints if needed
+static PyArrayObject *actionArray(PyObject *obj, int nd) {
+  return (PyArrayObject *)PyArray_FROMANY(obj, NPY_INT, nd, nd,
+                                          NPY_ARRAY_IN_ARRAY | NPY_ARRAY_FORCECAST);
+}
+
+static PyObject *NativeALE_rollout(NativeALE *self, PyObject *args) {
+  PyObject *stateObj, *actionsObj;
+  if (!PyArg_ParseTuple(args, "OO", &stateObj, &actionsObj))
+    return NULL;
+  ALEState *state = stateOf(stateObj);
+  if (state == NULL)
+    return NULL;
+  PyArrayObject *actions = actionArray(actionsObj, 1);
+  if (actions == NULL)
+    return NULL;
+
+  size_t n = PyArray_DIM(actions, 0);
+  const int *data = (const int *)PyArray_DATA(actions);
+  ActionVect actionVect(n);
+  for (size_t i = 0; i < n; i++)
+    actionVect[i] = (Action)data[i];
+  Py_DECREF(actions);
+
+  RolloutResult result;
+  Py_BEGIN_ALLOW_THREADS
+  self->ale->rollout(*state, actionVect.empty() ? NULL : &actionVect[0], n, &result);
+  refreshViews(self);
+  Py_END_ALLOW_THREADS
+
+  PyObject *rewards = intArray(std::vector<int>(result.rewards.begin(), result.rewards.end()));
+  PyObject *lives = intArray(result.lives);
+  if (rewards == NULL || lives == NULL) {
+    Py_XDECREF(rewards);
+    Py_XDECREF(lives);
+    return NULL;
+  }
+  return Py_BuildValue("(NN)", rewards, lives);
+}
+
+static PyObject *NativeALE_expand(NativeALE *self, PyObject *args) {
+  PyObject *stateObj, *actionsObj;
+  if (!PyArg_ParseTuple(args, "OO", &stateObj, &actionsObj))
+    return NULL;
+  ALEState *state = stateOf(stateObj);
+  if (state == NULL)
+    return NULL;
+  PyArrayObject *actions = actionArray(actionsObj, 1);
+  if (actions == NULL)
+    return NULL;
+
+  size_t n = PyArray_DIM(actions, 0);
+  const int *data = (const int *)PyArray_DATA(actions);
+  ActionVect actionVect(n);
+  for (size_t i = 0; i < n; i++)
+    actionVect[i] = (Action)data[i];
+  Py_DECREF(actions);
+
+  std::vector<ChildNode> nodes;
+  Py_BEGIN_ALLOW_THREADS
+  self->ale->expand(*state, actionVect, nodes);
+  Py_END_ALLOW_THREADS
+
+  npy_intp dims[1] = { (npy_intp)n };
+  PyObject *children = PyList_New(n);
+  PyObject *rewards = PyArray_SimpleNew(1, dims, NPY_INT);
+  PyObject *terminal = PyArray_SimpleNew(1, dims, NPY_BOOL);
+  if (children == NULL || rewards == NULL || terminal == NULL) {
+    Py_XDECREF(children);
+    Py_XDECREF(rewards);
+    Py_XDECREF(terminal);
+    return NULL;
+  }
+  for (size_t i = 0; i < n; i++) {
+    PyObject *child = wrapState(*nodes[i].state);
+    if (child == NULL) {
+      Py_DECREF(children);
+      Py_DECREF(rewards);
+      Py_DECREF(terminal);
+      return NULL;
+    }
+    PyList_SET_ITEM(children, i, child);
+    ((int *)PyArray_DATA((PyArrayObject *)rewards))[i] = nodes[i].reward;
+    ((npy_bool *)PyArray_DATA((PyArrayObject *)terminal))[i] = nodes[i].terminal;
+  }
+  return Py_BuildValue("(NNN)", children, rewards, terminal);
+}
+
+static PyObject *NativeALE_rolloutBatch(NativeALE *self, PyObject *args) {
+  PyObject *stateObj, *actionsObj;
+  if (!PyArg_ParseTuple(args, "OO", &stateObj, &actionsObj))
+    return NULL;
+  ALEState *state = stateOf(stateObj);
+  if (state == NULL)
+    return NULL;
+  PyArrayObject *actions = actionArray(actionsObj, 2);
+  if (actions == NULL)
+    return NULL;
+
+  size_t rows = PyArray_DIM(actions, 0), length = PyArray_DIM(actions, 1);
+  const int *data = (const int *)PyArray_DATA(actions);
+  std::vector<ActionVect> sequences(rows);
+  for (size_t i = 0; i < rows; i++) {
+    for (size_t j = 0; j < length; j++)
+      sequences[i].push_back((Action)data[i * length + j]);
+  }
+  Py_DECREF(actions);
+
+  std::vector<RolloutResult> results;
+  Py_BEGIN_ALLOW_THREADS
+  self->ale->rolloutBatch(*state, sequences, results);
+  Py_END_ALLOW_THREADS
+
+  std::vector<int> totals(rows), steps(rows);
+  for (size_t i = 0; i < rows; i++) {
+    totals[i] = results[i].total_reward;
+    steps[i] = results[i].rewards.size();
+  }
+  PyObject *totalsArray = intArray(totals), *stepsArray = intArray(steps);
+  if (totalsArray == NULL || stepsArray == NULL) {
+    Py_XDECREF(totalsArray);
+    Py_XDECREF(stepsArray);
+    return NULL;
+  }
+  return Py_BuildValue("(NN)", totalsArray, stepsArray);
+}
+
+static PyObject *NativeALE_saveScreenPNG(NativeALE *self, PyObject *arg) {
+  std::string filename;
+  if (!toString(arg, filename))
+    return NULL;
+  self->ale->saveScreenPNG(filename);
+  Py_RETURN_NONE;
+}
+
+static PyObject *NativeALE_saveState(NativeALE *self, PyObject *) {
+  self->ale->saveState();
+  Py_RETURN_NONE;
+}
+
+static PyObject *NativeALE_loadState(NativeALE *self, PyObject *) {
+  self->ale->loadState();
+  Py_RETURN_NONE;
+}
+
+static PyObject *NativeALE_cloneState(NativeALE *self, PyObject *) {
+  return wrapState(self->ale->cloneState());
+}
+
+static PyObject *NativeALE_restoreState(NativeALE *self, PyObject *arg) {
+  ALEState *state = stateOf(arg);
+  if (state == NULL)
+    return NULL;
+  self->ale->restoreState(*state);
+  Py_RETURN_NONE;
+}
+
+// Checkpoints are handed to Python packed in 64 bits, depth first
+static PyObject *NativeALE_checkpoint(NativeALE *self, PyObject *) {
+  Journal::Checkpoint checkpoint = self->ale->checkpoint();
+  return PyLong_FromUnsignedLongLong(((unsigned long long)checkpoint.depth << 32) |
+                                     checkpoint.id);
+}
+
+static PyObject *NativeALE_rollback(NativeALE *self, PyObject *arg) {
+  unsigned long long packed = PyLong_AsUnsignedLongLong(arg);
+  if (PyErr_Occurred())
+    return NULL;
+  Journal::Checkpoint checkpoint = { (uInt32)(packed >> 32), (uInt32)packed };
+  return PyBool_FromLong(self->ale->rollback(checkpoint));
+}
+
+static PyObject *NativeALE_cloneSystemState(NativeALE *self, PyObject *) {
+  return wrapState(self->ale->cloneSystemState());
+}
+
+static PyObject *NativeALE_restoreSystemState(NativeALE *self, PyObject *arg) {
+  ALEState *state = stateOf(arg);
+  if (state == NULL)
+    return NULL;
+  self->ale->restoreSystemState(*state);
+  Py_RETURN_NONE;
+}
+
+static PyObject *NativeALE_deleteState(NativeALE *, PyObject *arg) {
+  if (stateOf(arg) == NULL)
+    return NULL;
+  // States are also freed when garbage collected; this merely does it sooner
+  NativeState *state = (NativeState *)arg;
+  delete state->state;
+  state->state = NULL;
+  Py_RETURN_NONE;
+}
+
+static PyObject *NativeALE_encodeStateLen(NativeALE *, PyObject *arg) {
+  ALEState *state = stateOf(arg);
+  if (state == NULL)
+    return NULL;
+  return PyLong_FromSize_t(state->serialize().size());
+}
+
+static PyObject *NativeALE_encodeState(NativeALE *, PyObject *args) {
+  PyObject *stateObj, *out = NULL;
+  if (!PyArg_ParseTuple(args, "O|O", &stateObj, &out))
+    return NULL;
+  ALEState *state = stateOf(stateObj);
+  if (state == NULL)
+    return NULL;
+  std::string serialized = state->serialize();
+  npy_intp dims[1] = { (npy_intp)serialized.size() };
+  Py_buffer view;
+  if ((out = outputArray(out, 1, dims, NPY_UINT8, serialized.size(), view)) == NULL)
+    return NULL;
+  memcpy(view.buf, serialized.data(), serialized.size());
+  PyBuffer_Release(&view);
+  return out;
+}
+
+static PyObject *NativeALE_decodeState(NativeALE *, PyObject *arg) {
+  Py_buffer view;
+  if (PyObject_GetBuffer(arg, &view, PyBUF_C_CONTIGUOUS) < 0)
+    return NULL;
+  ALEState state(std::string((const char *)view.buf, view.len));
+  PyBuffer_Release(&view);
+  return wrapState(state);
+}
+
+static PyObject *NativeALE_setReplayBuffer(NativeALE *self, PyObject *arg) {
+  if (arg != Py_None && !PyObject_TypeCheck(arg, &NativeReplayBufferType)) {
+    PyErr_SetString(PyExc_TypeError, "expected a ReplayBuffer or None");
+    return NULL;
+  }
+  try {
+    self->ale->setReplayBuffer(arg == Py_None ? std::shared_ptr<ReplayBuffer>() :
+                               *((NativeReplayBuffer *)arg)->buffer);
+  }
+  CATCH_STD_EXCEPTIONS
+  Py_RETURN_NONE;
+}
+
+static PyObject *NativeALE_setLoggerMode(PyObject *, PyObject *arg) {
+  long mode;
+  if (PyBytes_Check(arg) || PyUnicode_Check(arg)) {
+    std::string name;
+    if (!toString(arg, name))
+      return NULL;
+    mode = name == "info" ? 0 : name == "warning" ? 1 : name == "error" ? 2 : -1;
+  }
+  else if ((mode = PyLong_AsLong(arg)) == -1 && PyErr_Occurred())
+    return NULL;
+
+  if (mode < 0 || mode > 2) {
+    PyErr_SetString(PyExc_ValueError,
+                    "Invalid Mode! Mode must be one of 0: info, 1: warning, 2: error");
+    return NULL;
+  }
+  ale::Logger::setMode(ale::Logger::mode(mode));
+  Py_RETURN_NONE;
+}
+
+static PyMethodDef NativeALE_methods[] = {
+  {"getString", (PyCFunction)NativeALE_getString, METH_O, NULL},
+  {"getInt", (PyCFunction)NativeALE_getInt, METH_O, NULL},
+  {"getBool", (PyCFunction)NativeALE_getBool, METH_O, NULL},
+  {"getFloat", (PyCFunction)NativeALE_getFloat, METH_O, NULL},
+  {"setString", (PyCFunction)NativeALE_setString, METH_VARARGS, NULL},
+  {"setInt", (PyCFunction)NativeALE_setInt, METH_VARARGS, NULL},
+  {"setBool", (PyCFunction)NativeALE_setBool, METH_VARARGS, NULL},
+  {"setFloat", (PyCFunction)NativeALE_setFloat, METH_VARARGS, NULL},
+  {"loadROM", (PyCFunction)NativeALE_loadROM, METH_O, NULL},
+  {"preloadROMs", (PyCFunction)NativeALE_preloadROMs, METH_O,
+    "preloadROMs(rom_files): loads each ROM into a game of its own, configured with the "
+    "current settings, and makes the first one active. The next loadROM discards them."},
+  {"selectROM", (PyCFunction)NativeALE_selectROM, METH_VARARGS,
+    "selectROM(index, restart=False): makes a preloaded game active, as it was left, or as "
+    "it was loaded if restart is true."},
+  {"getNumPreloadedROMs", (PyCFunction)NativeALE_getNumPreloadedROMs, METH_NOARGS, NULL},
+  {"getSelectedROM", (PyCFunction)NativeALE_getSelectedROM, METH_NOARGS, NULL},
+  {"act", (PyCFunction)NativeALE_act, METH_O,
+    "Applies an action and returns the reward. The GIL is released while emulating."},
+  {"game_over", (PyCFunction)NativeALE_game_over, METH_NOARGS, NULL},
+  {"reset_game", (PyCFunction)NativeALE_reset_game, METH_NOARGS, NULL},
+  {"getLegalActionSet", (PyCFunction)NativeALE_getLegalActionSet, METH_NOARGS, NULL},
+  {"getMinimalActionSet", (PyCFunction)NativeALE_getMinimalActionSet, METH_NOARGS, NULL},
+  {"getAvailableModes", (PyCFunction)NativeALE_getAvailableModes, METH_NOARGS, NULL},
+  {"setMode", (PyCFunction)NativeALE_setMode, METH_O, NULL},
+  {"getAvailableDifficulties", (PyCFunction)NativeALE_getAvailableDifficulties, METH_NOARGS,
+    NULL},
+  {"setDifficulty", (PyCFunction)NativeALE_setDifficulty, METH_O, NULL},
+  {"getFrameNumber", (PyCFunction)NativeALE_getFrameNumber, METH_NOARGS, NULL},
+  {"lives", (PyCFunction)NativeALE_lives, METH_NOARGS, NULL},
+  {"getEpisodeFrameNumber", (PyCFunction)NativeALE_getEpisodeFrameNumber, METH_NOARGS, NULL},
+  {"getScreenDims", (PyCFunction)NativeALE_getScreenDims, METH_NOARGS,
+    "Returns a tuple that contains (screen_width, screen_height)."},
+  {"getScreen", (PyCFunction)NativeALE_getScreen, METH_VARARGS,
+    "Fills screen_data, or a new array, with the palette index of each pixel."},
+  {"getScreenRGB", (PyCFunction)NativeALE_getScreenRGB, METH_VARARGS, NULL},
+  {"getScreenGrayscale", (PyCFunction)NativeALE_getScreenGrayscale, METH_VARARGS, NULL},
+  {"getScreenView", (PyCFunction)NativeALE_getScreenView, METH_NOARGS,
+    "Returns a read-only (height, width) array of palette indices sharing the emulator's "
+    "screen, which changes as the game is played. Copy it to keep a frame."},
+  {"getRAMSize", (PyCFunction)NativeALE_getRAMSize, METH_NOARGS, NULL},
+  {"getRAM", (PyCFunction)NativeALE_getRAM, METH_VARARGS, NULL},
+  {"getRAMView", (PyCFunction)NativeALE_getRAMView, METH_NOARGS,
+    "Returns a read-only array sharing the emulator's RAM; see getScreenView."},
+  {"getAudioSize", (PyCFunction)NativeALE_getAudioSize, METH_NOARGS, NULL},
+  {"getAudio", (PyCFunction)NativeALE_getAudio, METH_VARARGS, NULL},
+  {"getScreenFingerprint", (PyCFunction)NativeALE_getScreenFingerprint, METH_NOARGS, NULL},
+  {"getRAMFingerprint", (PyCFunction)NativeALE_getRAMFingerprint, METH_NOARGS, NULL},
+  {"getStateFingerprint", (PyCFunction)NativeALE_getStateFingerprint, METH_O, NULL},
+  {"getScreenFingerprints", (PyCFunction)NativeALE_getScreenFingerprints,
+    METH_VARARGS | METH_STATIC, NULL},
+  {"getScreenCellFingerprints", (PyCFunction)NativeALE_getScreenCellFingerprints,
+    METH_VARARGS | METH_STATIC, NULL},
+  {"getRAMFingerprints", (PyCFunction)NativeALE_getRAMFingerprints,
+    METH_VARARGS | METH_STATIC, NULL},
+  {"getStateFingerprints", (PyCFunction)NativeALE_getStateFingerprints,
+    METH_VARARGS | METH_STATIC, NULL},
+  {"actBatch", (PyCFunction)NativeALE_actBatch, METH_VARARGS | METH_STATIC,
+    "actBatch(ales, actions, rewards=None): applies actions[i] to ales[i] and returns the "
+    "rewards as an array of ints. The GIL is released for the whole batch."},
+  {"rollout", (PyCFunction)NativeALE_rollout, METH_VARARGS,
+    "rollout(state, actions): plays the actions from state without processing screens, "
+    "stopping early at a terminal state. Returns the rewards and lives after each step."},
+  {"rolloutBatch", (PyCFunction)NativeALE_rolloutBatch, METH_VARARGS,
+    "rolloutBatch(state, actions): plays each row of actions from state, in parallel on "
+    "copies of this environment. Returns the total reward and steps taken of each row."},
+  {"expand", (PyCFunction)NativeALE_expand, METH_VARARGS,
+    "expand(state, actions): acts once from state with each action, in parallel on copies "
+    "of this environment. Returns the child states, their rewards and terminal flags."},
+  {"saveScreenPNG", (PyCFunction)NativeALE_saveScreenPNG, METH_O, NULL},
+  {"saveState", (PyCFunction)NativeALE_saveState, METH_NOARGS, NULL},
+  {"loadState", (PyCFunction)NativeALE_loadState, METH_NOARGS, NULL},
+  {"cloneState", (PyCFunction)NativeALE_cloneState, METH_NOARGS, NULL},
+  {"restoreState", (PyCFunction)NativeALE_restoreState, METH_O, NULL},
+  {"checkpoint", (PyCFunction)NativeALE_checkpoint, METH_NOARGS,
+    "checkpoint(): takes a checkpoint for depth-first search and returns its handle."},
+  {"rollback", (PyCFunction)NativeALE_rollback, METH_O,
+    "rollback(checkpoint): returns to the checkpoint's state, discarding later checkpoints. "
+    "Returns False if the checkpoint was discarded."},
+  {"cloneSystemState", (PyCFunction)NativeALE_cloneSystemState, METH_NOARGS, NULL},
+  {"restoreSystemState", (PyCFunction)NativeALE_restoreSystemState, METH_O, NULL},
+  {"deleteState", (PyCFunction)NativeALE_deleteState, METH_O, NULL},
+  {"encodeStateLen", (PyCFunction)NativeALE_encodeStateLen, METH_O, NULL},
+  {"encodeState", (PyCFunction)NativeALE_encodeState, METH_VARARGS, NULL},
+  {"decodeState", (PyCFunction)NativeALE_decodeState, METH_O, NULL},
+  {"setReplayBuffer", (PyCFunction)NativeALE_setReplayBuffer, METH_O,
+    "setReplayBuffer(buffer): adds every step taken by act() to the ReplayBuffer, until the "
+    "next loadROM; None stops. Episodes restart after reset_game and restoreState, and "
+    "rollouts are left out."},
+  {"setLoggerMode", (PyCFunction)NativeALE_setLoggerMode, METH_O | METH_STATIC, NULL},
+  {NULL, NULL, 0, NULL}
+};
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// ReplayBuffer
+
+static PyObject *NativeReplayBuffer_new(PyTypeObject *type, PyObject *args, PyObject *kwds) {
+  static const char *keywords[] = { "capacity", "height", "width", "stack", "deduplicate",
+                                    "seed", NULL };
+  Py_ssize_t capacity, height, width;
+  int stack = 4, deduplicate = 0;
+  unsigned int seed = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "nnn|ipI", (char **)keywords, &capacity,
+                                   &height, &width, &stack, &deduplicate, &seed))
+    return NULL;
+  if (capacity < 0 || height <= 0 || width <= 0) {
+    PyErr_SetString(PyExc_ValueError, "invalid replay buffer size");
+    return NULL;
+  }
+
+  NativeReplayBuffer *self = (NativeReplayBuffer *)type->tp_alloc(type, 0);
+  if (self == NULL)
+    return NULL;
+  try {
+    self->buffer = new std::shared_ptr<ReplayBuffer>(
+        new ReplayBuffer(capacity, height, width, stack, deduplicate, seed));
+  }
+  catch (const std::exception &e) {
+    Py_TYPE(self)->tp_free((PyObject *)self);
+    PyErr_SetString(PyExc_ValueError, e.what());
+    return NULL;
+  }
+  return (PyObject *)self;
+}
+
+static void NativeReplayBuffer_dealloc(NativeReplayBuffer *self) {
+  delete self->buffer;
+  Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static Py_ssize_t NativeReplayBuffer_len(NativeReplayBuffer *self) {
+  return (*self->buffer)->size();
+}
+
+static PyObject *NativeReplayBuffer_transitions(NativeReplayBuffer *self, PyObject *) {
+  return PyLong_FromSize_t((*self->buffer)->transitions());
+}
+
+static PyObject *NativeReplayBuffer_numFrames(NativeReplayBuffer *self, PyObject *) {
+  return PyLong_FromSize_t((*self->buffer)->numFrames());
+}
+
+static PyObject *NativeReplayBuffer_frameBytes(NativeReplayBuffer *self, PyObject *) {
+  return PyLong_FromSize_t((*self->buffer)->frameBytes());
+}
+
+static PyObject *NativeReplayBuffer_sample(NativeReplayBuffer *self, PyObject *args,
+                                           PyObject *kwds) {
+  static const char *keywords[] = { "batch_size", "observations", "next_observations",
+                                    "threads", NULL };
+  Py_ssize_t n;
+  PyObject *obsOut = NULL, *nextOut = NULL;
+  int threads = 1;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "n|OOi", (char **)keywords, &n, &obsOut,
+                                   &nextOut, &threads))
+    return NULL;
+  if (n <= 0) {
+    PyErr_SetString(PyExc_ValueError, "batch_size must be positive");
+    return NULL;
+  }
+
+  ReplayBuffer &buffer = **self->buffer;
+  npy_intp obsDims[4] = { (npy_intp)n, buffer.stack(), (npy_intp)buffer.height(),
+                          (npy_intp)buffer.width() };
+  size_t obsSize = n * buffer.stack() * buffer.height() * buffer.width();
+  Py_buffer obsView, nextView;
+  PyObject *observations = outputArray(obsOut, 4, obsDims, NPY_UINT8, obsSize, obsView);
+  if (observations == NULL)
+    return NULL;
+  PyObject *next = outputArray(nextOut, 4, obsDims, NPY_UINT8, obsSize, nextView);
+  if (next == NULL) {
+    PyBuffer_Release(&obsView);
+    Py_DECREF(observations);
+    return NULL;
+  }
+
+  npy_intp dims[1] = { (npy_intp)n };
+  PyObject *actions = PyArray_SimpleNew(1, dims, NPY_INT);
+  PyObject *rewards = PyArray_SimpleNew(1, dims, NPY_INT);
+  PyObject *terminals = PyArray_SimpleNew(1, dims, NPY_BOOL);
+  PyObject *indices = PyArray_SimpleNew(1, dims, NPY_UINTP);
+  PyObject *probabilities = PyArray_SimpleNew(1, dims, NPY_DOUBLE);
+  bool sampled = false;
+  if (actions != NULL && rewards != NULL && terminals != NULL && indices != NULL &&
+      probabilities != NULL) {
+    ReplayBuffer::Batch batch = {
+      (pixel_t *)obsView.buf,
+      (int *)PyArray_DATA((PyArrayObject *)actions),
+      (reward_t *)PyArray_DATA((PyArrayObject *)rewards),
+      (pixel_t *)nextView.buf,
+      (uInt8 *)PyArray_DATA((PyArrayObject *)terminals),
+      (size_t *)PyArray_DATA((PyArrayObject *)indices),
+      (double *)PyArray_DATA((PyArrayObject *)probabilities)
+    };
+    Py_BEGIN_ALLOW_THREADS
+    sampled = buffer.sample(n, batch, threads);
+    Py_END_ALLOW_THREADS
+    if (!sampled)
+      PyErr_SetString(PyExc_ValueError, "The replay buffer holds no transition");
+  }
+  PyBuffer_Release(&obsView);
+  PyBuffer_Release(&nextView);
+
+  if (!sampled) {
+    Py_DECREF(observations);
+    Py_DECREF(next);
+    Py_XDECREF(actions);
+    Py_XDECREF(rewards);
+    Py_XDECREF(terminals);
+    Py_XDECREF(indices);
+    Py_XDECREF(probabilities);
+    return NULL;
+  }
+  return Py_BuildValue("(NNNNNNN)", observations, actions, rewards, next, terminals, indices,
+                       probabilities);
+}
+
+static PyObject *NativeReplayBuffer_updatePriorities(NativeReplayBuffer *self,
+                                                     PyObject *args) {
+  PyObject *indicesObj, *prioritiesObj;
+  if (!PyArg_ParseTuple(args, "OO", &indicesObj, &prioritiesObj))
+    return NULL;
+  PyArrayObject *indices = (PyArrayObject *)PyArray_FROMANY(
+      indicesObj, NPY_UINTP, 1, 1, NPY_ARRAY_IN_ARRAY | NPY_ARRAY_FORCECAST);
+  if (indices == NULL)
+    return NULL;
+  PyArrayObject *priorities = (PyArrayObject *)PyArray_FROMANY(
+      prioritiesObj, NPY_DOUBLE, 1, 1, NPY_ARRAY_IN_ARRAY | NPY_ARRAY_FORCECAST);
+  if (priorities == NULL) {
+    Py_DECREF(indices);
+    return NULL;
+  }
+
+  size_t n = std::min(PyArray_DIM(indices, 0), PyArray_DIM(priorities, 0));
+  const size_t *indexData = (const size_t *)PyArray_DATA(indices);
+  const double *priorityData = (const double *)PyArray_DATA(priorities);
+  Py_BEGIN_ALLOW_THREADS
+  (*self->buffer)->updatePriorities(indexData, priorityData, n);
+  Py_END_ALLOW_THREADS
+  Py_DECREF(indices);
+  Py_DECREF(priorities);
+  Py_RETURN_NONE;
+}
+
+static PyMethodDef NativeReplayBuffer_methods[] = {
+  {"transitions", (PyCFunction)NativeReplayBuffer_transitions, METH_NOARGS,
+    "Number of transitions which can be sampled."},
+  {"numFrames", (PyCFunction)NativeReplayBuffer_numFrames, METH_NOARGS, NULL},
+  {"frameBytes", (PyCFunction)NativeReplayBuffer_frameBytes, METH_NOARGS, NULL},
+  {"sample", (PyCFunction)NativeReplayBuffer_sample, METH_VARARGS | METH_KEYWORDS,
+    "sample(batch_size, observations=None, next_observations=None, threads=1): draws "
+    "transitions and returns observations, actions, rewards, next_observations, terminals, "
+    "indices and probabilities. Observations, (batch_size, stack, height, width) arrays of "
+    "palette indices, are written to the given arrays if any. The GIL is released while "
+    "sampling."},
+  {"updatePriorities", (PyCFunction)NativeReplayBuffer_updatePriorities, METH_VARARGS,
+    "updatePriorities(indices, priorities): sets the priorities, already raised to the "
+    "prioritization exponent, of the transitions sampled at indices."},
+  {NULL, NULL, 0, NULL}
+};
+
+static PySequenceMethods NativeReplayBuffer_sequence;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Module
+
+#if PY_MAJOR_VERSION >= 3
+static struct PyModuleDef NativeModule = {
+  PyModuleDef_HEAD_INIT, "ale_native", "Compiled ALE interface.", -1, NULL,
+  NULL, NULL, NULL, NULL
+};
+#endif
+
+static PyObject *initModule() {
+  NativeALEType.tp_name = "ale_python_interface.ale_native.ALEInterface";
+  NativeALEType.tp_basicsize = sizeof(NativeALE);
+  NativeALEType.tp_flags = Py_TPFLAGS_DEFAULT;
+  NativeALEType.tp_doc = "The Arcade Learning Environment";
+  NativeALEType.tp_new = NativeALE_new;
+  NativeALEType.tp_dealloc = (destructor)NativeALE_dealloc;
+  NativeALEType.tp_methods = NativeALE_methods;
+
+  NativeStateType.tp_name = "ale_python_interface.ale_native.ALEState";
+  NativeStateType.tp_basicsize = sizeof(NativeState);
+  NativeStateType.tp_flags = Py_TPFLAGS_DEFAULT;
+  NativeStateType.tp_doc = "A copy of the environment state";
+  NativeStateType.tp_dealloc = (destructor)NativeState_dealloc;
+
+  NativeReplayBuffer_sequence.sq_length = (lenfunc)NativeReplayBuffer_len;
+  NativeReplayBufferType.tp_name = "ale_python_interface.ale_native.ReplayBuffer";
+  NativeReplayBufferType.tp_basicsize = sizeof(NativeReplayBuffer);
+  NativeReplayBufferType.tp_flags = Py_TPFLAGS_DEFAULT;
+  NativeReplayBufferType.tp_doc =
+    "ReplayBuffer(capacity, height, width, stack=4, deduplicate=False, seed=0): the last "
+    "capacity steps taken by the environments given to ALEInterface.setReplayBuffer, each "
+    "frame stored once as palette indices, sampled in stacks of frames with probability "
+    "proportional to priorities.";
+  NativeReplayBufferType.tp_new = NativeReplayBuffer_new;
+  NativeReplayBufferType.tp_dealloc = (destructor)NativeReplayBuffer_dealloc;
+  NativeReplayBufferType.tp_methods = NativeReplayBuffer_methods;
+  NativeReplayBufferType.tp_as_sequence = &NativeReplayBuffer_sequence;
+
+  if (PyType_Ready(&NativeALEType) < 0 || PyType_Ready(&NativeStateType) < 0 ||
+      PyType_Ready(&NativeReplayBufferType) < 0)
+    return NULL;
+
+#if PY_MAJOR_VERSION >= 3
+  PyObject *module = PyModule_Create(&NativeModule);
+#else
+  PyObject *module = Py_InitModule3("ale_native", NULL, "Compiled ALE interface.");
+#endif
+  if (module == NULL)
+    return NULL;
+
+  Py_INCREF(&NativeALEType);
+  PyModule_AddObject(module, "ALEInterface", (PyObject *)&NativeALEType);
+  Py_INCREF(&NativeStateType);
+  PyModule_AddObject(module, "ALEState", (PyObject *)&NativeStateType);
+  Py_INCREF(&NativeReplayBufferType);
+  PyModule_AddObject(module, "ReplayBuffer", (PyObject *)&NativeReplayBufferType);
+  return module;
+}
+
+#if PY_MAJOR_VERSION >= 3
+PyMODINIT_FUNC PyInit_ale_native() {
+  import_array();
+  return initModule();
+}
+#else
+PyMODINIT_FUNC initale_native() {
+  import_array();
+  initModule();
+}
+#endif
@@ -2,12 +2,16 @@
 # Author: Ben Goodrich
 # This directly implements a python version of the arcade learning
 # environment interface.
-__all__ = ['ALEInterface']
+__all__ = ['ALEInterface', 'StateArchive', 'StateArchiveWriter', 'DatasetShard',
+           'readDatasetManifest', 'ReplayBuffer']
 
 from ctypes import *
 import numpy as np
 from numpy.ctypeslib import as_ctypes
+import mmap
 import os
+import struct
+import zlib
 
 ale_lib = cdll.LoadLibrary(os.path.join(os.path.dirname(__file__),
                                         'libale_c.so'))
@@ -34,6 +38,14 @@ ale_lib.setFloat.argtypes = [c_void_p, c_char_p, c_float]
 ale_lib.setFloat.restype = None
 ale_lib.loadROM.argtypes = [c_void_p, c_char_p]
 ale_lib.loadROM.restype = None
+ale_lib.preloadROMs.argtypes = [c_void_p, c_void_p, c_int]
+ale_lib.preloadROMs.restype = c_bool
+ale_lib.selectROM.argtypes = [c_void_p, c_int, c_bool]
+ale_lib.selectROM.restype = c_bool
+ale_lib.getNumPreloadedROMs.argtypes = [c_void_p]
+ale_lib.getNumPreloadedROMs.restype = c_int
+ale_lib.getSelectedROM.argtypes = [c_void_p]
+ale_lib.getSelectedROM.restype = c_int
 ale_lib.act.argtypes = [c_void_p, c_int]
 ale_lib.act.restype = c_int
 ale_lib.game_over.argtypes = [c_void_p]
@@ -80,6 +92,10 @@ ale_lib.getScreenRGB.argtypes = [c_void_p, c_void_p]
 ale_lib.getScreenRGB.restype = None
 ale_lib.getScreenGrayscale.argtypes = [c_void_p, c_void_p]
 ale_lib.getScreenGrayscale.restype = None
+ale_lib.getAudio.argtypes = [c_void_p, c_void_p]
+ale_lib.getAudio.restype = None
+ale_lib.getAudioSize.argtypes = [c_void_p]
+ale_lib.getAudioSize.restype = c_int
 ale_lib.saveState.argtypes = [c_void_p]
 ale_lib.saveState.restype = None
 ale_lib.loadState.argtypes = [c_void_p]
@@ -92,16 +108,73 @@ ale_lib.cloneSystemState.argtypes = [c_void_p]
 ale_lib.cloneSystemState.restype = c_void_p
 ale_lib.restoreSystemState.argtypes = [c_void_p, c_void_p]
 ale_lib.restoreSystemState.restype = None
+ale_lib.checkpoint.argtypes = [c_void_p]
+ale_lib.checkpoint.restype = c_uint64
+ale_lib.rollback.argtypes = [c_void_p, c_uint64]
+ale_lib.rollback.restype = c_bool
 ale_lib.deleteState.argtypes = [c_void_p]
 ale_lib.deleteState.restype = None
 ale_lib.saveScreenPNG.argtypes = [c_void_p, c_char_p]
 ale_lib.saveScreenPNG.restype = None
+ale_lib.getScreenFingerprint.argtypes = [c_void_p]
+ale_lib.getScreenFingerprint.restype = c_uint64
+ale_lib.getRAMFingerprint.argtypes = [c_void_p]
+ale_lib.getRAMFingerprint.restype = c_uint64
+ale_lib.getStateFingerprint.argtypes = [c_void_p]
+ale_lib.getStateFingerprint.restype = c_uint64
+ale_lib.getScreenFingerprints.argtypes = [c_void_p, c_int, c_void_p]
+ale_lib.getScreenFingerprints.restype = None
+ale_lib.getScreenCellFingerprints.argtypes = [c_void_p, c_int, c_int, c_int, c_int, c_void_p]
+ale_lib.getScreenCellFingerprints.restype = None
+ale_lib.getRAMFingerprints.argtypes = [c_void_p, c_int, c_void_p]
+ale_lib.getRAMFingerprints.restype = None
+ale_lib.getStateFingerprints.argtypes = [c_void_p, c_int, c_void_p]
+ale_lib.getStateFingerprints.restype = None
+ale_lib.rollout.argtypes = [c_void_p, c_void_p, c_void_p, c_int, c_void_p, c_void_p]
+ale_lib.rollout.restype = c_int
+ale_lib.rolloutBatch.argtypes = [c_void_p, c_void_p, c_void_p, c_int, c_int, c_void_p, c_void_p]
+ale_lib.rolloutBatch.restype = None
+ale_lib.expand.argtypes = [c_void_p, c_void_p, c_void_p, c_int, c_void_p, c_void_p, c_void_p]
+ale_lib.expand.restype = None
 ale_lib.encodeState.argtypes = [c_void_p, c_void_p, c_int]
 ale_lib.encodeState.restype = None
 ale_lib.encodeStateLen.argtypes = [c_void_p]
 ale_lib.encodeStateLen.restype = c_int
 ale_lib.decodeState.argtypes = [c_void_p, c_int]
 ale_lib.decodeState.restype = c_void_p
+ale_lib.openStateArchiveWriter.argtypes = [c_char_p, c_void_p, c_int, c_int]
+ale_lib.openStateArchiveWriter.restype = c_void_p
+ale_lib.stateArchiveWriterAdd.argtypes = [c_void_p, c_void_p, c_int]
+ale_lib.stateArchiveWriterAdd.restype = c_int
+ale_lib.closeStateArchiveWriter.argtypes = [c_void_p]
+ale_lib.closeStateArchiveWriter.restype = c_bool
+ale_lib.openStateArchive.argtypes = [c_char_p]
+ale_lib.openStateArchive.restype = c_void_p
+ale_lib.stateArchiveSize.argtypes = [c_void_p]
+ale_lib.stateArchiveSize.restype = c_int
+ale_lib.stateArchiveGet.argtypes = [c_void_p, c_int]
+ale_lib.stateArchiveGet.restype = c_void_p
+ale_lib.closeStateArchive.argtypes = [c_void_p]
+ale_lib.closeStateArchive.restype = None
+ale_lib.newReplayBuffer.argtypes = [c_int, c_int, c_int, c_int, c_bool, c_uint]
+ale_lib.newReplayBuffer.restype = c_void_p
+ale_lib.deleteReplayBuffer.argtypes = [c_void_p]
+ale_lib.deleteReplayBuffer.restype = None
+ale_lib.setReplayBuffer.argtypes = [c_void_p, c_void_p]
+ale_lib.setReplayBuffer.restype = None
+ale_lib.replayBufferSize.argtypes = [c_void_p]
+ale_lib.replayBufferSize.restype = c_int
+ale_lib.replayBufferTransitions.argtypes = [c_void_p]
+ale_lib.replayBufferTransitions.restype = c_int
+ale_lib.replayBufferNumFrames.argtypes = [c_void_p]
+ale_lib.replayBufferNumFrames.restype = c_int
+ale_lib.replayBufferFrameBytes.argtypes = [c_void_p]
+ale_lib.replayBufferFrameBytes.restype = c_size_t
+ale_lib.replayBufferSample.argtypes = [c_void_p, c_int, c_void_p, c_void_p, c_void_p, c_void_p,
+                                       c_void_p, c_void_p, c_void_p, c_int]
+ale_lib.replayBufferSample.restype = c_bool
+ale_lib.replayBufferUpdatePriorities.argtypes = [c_void_p, c_void_p, c_void_p, c_int]
+ale_lib.replayBufferUpdatePriorities.restype = None
 ale_lib.setLoggerMode.argtypes = [c_int]
 ale_lib.setLoggerMode.restype = None
 
@@ -137,6 +210,28 @@ class ALEInterface(object):
     def loadROM(self, rom_file):
         ale_lib.loadROM(self.obj, rom_file)
 
+    def preloadROMs(self, rom_files):
+        """Loads each ROM into a game of its own, configured with the current settings,
+        and makes the first one active; selectROM switches between them without
+        reloading. The next loadROM discards them.
+        """
+        names = (c_char_p * len(rom_files))(*rom_files)
+        if not ale_lib.preloadROMs(self.obj, names, len(rom_files)):
+            raise RuntimeError("Couldn't preload the ROMs")
+
+    def selectROM(self, index, restart=False):
+        """Makes the index-th preloaded game active, as it was left, or as it was loaded
+        if restart is true.
+        """
+        if not ale_lib.selectROM(self.obj, index, restart):
+            raise IndexError("No preloaded ROM at index %d" % index)
+
+    def getNumPreloadedROMs(self):
+        return ale_lib.getNumPreloadedROMs(self.obj)
+
+    def getSelectedROM(self):
+        return ale_lib.getSelectedROM(self.obj)
+
     def act(self, action):
         return ale_lib.act(self.obj, int(action))
 
@@ -261,10 +356,130 @@ class ALEInterface(object):
         ale_lib.getRAM(self.obj, as_ctypes(ram))
         return ram
 
+    def getAudioSize(self):
+        return ale_lib.getAudioSize(self.obj)
+
+    def getAudio(self, audio_data=None):
+        """This function grabs the sound of the frames emulated by the last act, as
+        8-bit mono samples. It requires sound_obs to be set before loadROM.
+        audio_data MUST be a numpy array of uint8. This can be initialized like so:
+        audio_data = np.empty(audio_size, dtype=np.uint8)
+        where audio_size can be retrieved via the getAudioSize function.
+        If it is None,  then this function will initialize it.
+        """
+        if(audio_data is None):
+            audio_size = ale_lib.getAudioSize(self.obj)
+            audio_data = np.zeros(audio_size, dtype=np.uint8)
+        ale_lib.getAudio(self.obj, as_ctypes(audio_data))
+        return audio_data
+
     def saveScreenPNG(self, filename):
         """Save the current screen as a png file"""
         return ale_lib.saveScreenPNG(self.obj, filename)
 
+    def getScreenFingerprint(self):
+        """Returns a 64-bit hash of the current screen. Equal screens have equal
+        fingerprints; only the rows which changed since the last call are rehashed.
+        """
+        return ale_lib.getScreenFingerprint(self.obj)
+
+    def getRAMFingerprint(self):
+        """Returns a 64-bit hash of the current RAM content."""
+        return ale_lib.getRAMFingerprint(self.obj)
+
+    def getStateFingerprint(self, state):
+        """Returns a 64-bit hash of a state returned by cloneState or
+        cloneSystemState. Equal states have equal fingerprints.
+        """
+        return ale_lib.getStateFingerprint(state)
+
+    @staticmethod
+    def getScreenFingerprints(ales, fingerprints=None):
+        """Fills fingerprints, a numpy array of uint64, with the screen fingerprint of
+        each interface in ales. If it is None,  then this function will initialize it.
+        """
+        if(fingerprints is None):
+            fingerprints = np.zeros(len(ales), dtype=np.uint64)
+        objs = (c_void_p * len(ales))(*[ale.obj for ale in ales])
+        ale_lib.getScreenFingerprints(objs, len(ales), as_ctypes(fingerprints))
+        return fingerprints
+
+    @staticmethod
+    def getScreenCellFingerprints(ales, rows, columns, levels, fingerprints=None):
+        """Like getScreenFingerprints, but hashes a coarse view of each screen: rows x
+        columns blocks of average luminance, quantized to levels values. Screens
+        which differ only in small details share a cell fingerprint.
+        """
+        if(fingerprints is None):
+            fingerprints = np.zeros(len(ales), dtype=np.uint64)
+        objs = (c_void_p * len(ales))(*[ale.obj for ale in ales])
+        ale_lib.getScreenCellFingerprints(objs, len(ales), rows, columns, levels,
+                                          as_ctypes(fingerprints))
+        return fingerprints
+
+    @staticmethod
+    def getRAMFingerprints(ales, fingerprints=None):
+        """Like getScreenFingerprints, for the RAM of each interface in ales."""
+        if(fingerprints is None):
+            fingerprints = np.zeros(len(ales), dtype=np.uint64)
+        objs = (c_void_p * len(ales))(*[ale.obj for ale in ales])
+        ale_lib.getRAMFingerprints(objs, len(ales), as_ctypes(fingerprints))
+        return fingerprints
+
+    @staticmethod
+    def getStateFingerprints(states, fingerprints=None):
+        """Like getScreenFingerprints, for each state in states."""
+        if(fingerprints is None):
+            fingerprints = np.zeros(len(states), dtype=np.uint64)
+        objs = (c_void_p * len(states))(*states)
+        ale_lib.getStateFingerprints(objs, len(states), as_ctypes(fingerprints))
+        return fingerprints
+
+    def rollout(self, state, actions):
+        """Restores state, then plays the actions without processing screens, stopping
+        early at a terminal state. Returns the rewards and lives after each step taken,
+        as two numpy arrays. The environment is left in the state reached.
+        """
+        actions = np.ascontiguousarray(actions, dtype=np.intc)
+        rewards = np.zeros(len(actions), dtype=np.intc)
+        lives = np.zeros(len(actions), dtype=np.intc)
+        steps = ale_lib.rollout(self.obj, state, as_ctypes(actions), len(actions),
+                                as_ctypes(rewards), as_ctypes(lives))
+        return rewards[:steps], lives[:steps]
+
+    def rolloutBatch(self, state, actions):
+        """Plays each row of the 2-D array actions from state like rollout, in parallel
+        on copies of this environment, which is left untouched. Returns the total reward
+        and number of steps taken of each row, as two numpy arrays.
+        """
+        actions = np.ascontiguousarray(actions, dtype=np.intc)
+        total_rewards = np.zeros(actions.shape[0], dtype=np.intc)
+        steps = np.zeros(actions.shape[0], dtype=np.intc)
+        ale_lib.rolloutBatch(self.obj, state, as_ctypes(actions), actions.shape[0],
+                             actions.shape[1], as_ctypes(total_rewards), as_ctypes(steps))
+        return total_rewards, steps
+
+    def expand(self, state, actions):
+        """Acts once from state with each of the actions, in parallel on copies of this
+        environment, which is left untouched. Returns the child states, which must be
+        freed with deleteState, and numpy arrays of their rewards and terminal flags.
+        """
+        actions = np.ascontiguousarray(actions, dtype=np.intc)
+        children = (c_void_p * len(actions))()
+        rewards = np.zeros(len(actions), dtype=np.intc)
+        terminal = np.zeros(len(actions), dtype=np.bool_)
+        ale_lib.expand(self.obj, state, as_ctypes(actions), len(actions), children,
+                       as_ctypes(rewards), terminal.ctypes.data_as(c_void_p))
+        return list(children), rewards, terminal
+
+    def setReplayBuffer(self, buffer):
+        """Adds every step taken by act() to the ReplayBuffer, until the next loadROM;
+        None stops. Episodes restart after reset_game and restoreState, and rollouts
+        are left out.
+        """
+        self._replay_buffer = buffer
+        ale_lib.setReplayBuffer(self.obj, buffer.obj if buffer is not None else None)
+
     def saveState(self):
         """Saves the state of the system"""
         return ale_lib.saveState(self.obj)
@@ -299,6 +514,20 @@ class ALEInterface(object):
         """Reverse operation of cloneSystemState."""
         ale_lib.restoreSystemState(self.obj, state)
 
+    def checkpoint(self):
+        """Takes a checkpoint for depth-first search and returns its handle.
+        From then on, the emulator journals the RAM it writes, so that
+        backtracking a few steps with rollback() is cheaper than restoreState().
+        """
+        return ale_lib.checkpoint(self.obj)
+
+    def rollback(self, checkpoint):
+        """Returns to the state of the checkpoint, discarding the checkpoints
+        taken after it. Returns False, changing nothing, if the checkpoint was
+        discarded by an earlier rollback, reset_game, restoreState or rollout.
+        """
+        return ale_lib.rollback(self.obj, checkpoint)
+
     def deleteState(self, state):
         """ Deallocates the ALEState """
         ale_lib.deleteState(state)
@@ -325,3 +554,192 @@ class ALEInterface(object):
         mode = dic.get(mode, mode)
         assert mode in [0, 1, 2], "Invalid Mode! Mode must be one of 0: info, 1: warning, 2: error"
         ale_lib.setLoggerMode(mode)
+
+def _encodedState(state):
+    """ The bytes encoding a state pointer, freeing the state """
+    buf = np.zeros(ale_lib.encodeStateLen(state), dtype=np.uint8)
+    ale_lib.encodeState(state, as_ctypes(buf), c_int(len(buf)))
+    ale_lib.deleteState(state)
+    return buf
+
+class StateArchiveWriter(object):
+    """ Writes states of one ROM, as encoded by ALEInterface.encodeState, to a compressed
+        archive. The reference, e.g. the encoded start state, should resemble the states. """
+
+    def __init__(self, filename, reference, level=-1):
+        reference = np.ascontiguousarray(reference, dtype=np.uint8)
+        self.obj = ale_lib.openStateArchiveWriter(filename, as_ctypes(reference),
+                                                  len(reference), level)
+        if not self.obj:
+            raise IOError("Couldn't create state archive %s" % filename)
+
+    def add(self, serialized):
+        """ Appends an encoded state and returns its index """
+        serialized = np.ascontiguousarray(serialized, dtype=np.uint8)
+        index = ale_lib.stateArchiveWriterAdd(self.obj, as_ctypes(serialized), len(serialized))
+        if index < 0:
+            raise ValueError("State doesn't match the archive, or writing it failed")
+        return index
+
+    def close(self):
+        """ Writes the index; no state may be added afterwards. Raises IOError if the
+            archive couldn't be written """
+        if self.obj:
+            written = ale_lib.closeStateArchiveWriter(self.obj)
+            self.obj = None
+            if not written:
+                raise IOError("Error writing state archive")
+
+    def __del__(self):
+        self.close()
+
+class StateArchive(object):
+    """ Reads an archive written by StateArchiveWriter. archive[i] decompresses the i-th
+        state, which ALEInterface.decodeState turns back into a state. """
+
+    def __init__(self, filename):
+        self.obj = ale_lib.openStateArchive(filename)
+        if not self.obj:
+            raise IOError("Couldn't open state archive %s" % filename)
+
+    def __len__(self):
+        return ale_lib.stateArchiveSize(self.obj)
+
+    def __getitem__(self, i):
+        if i < 0:
+            i += len(self)
+        if not 0 <= i < len(self):
+            raise IndexError("No such state in the archive")
+        state = ale_lib.stateArchiveGet(self.obj, i)
+        if not state:
+            raise ValueError("Corrupt state archive")
+        return _encodedState(state)
+
+    def close(self):
+        if self.obj:
+            ale_lib.closeStateArchive(self.obj)
+            self.obj = None
+
+    def __del__(self):
+        self.close()
+
+class ReplayBuffer(object):
+    """ The last capacity steps taken by the environments given to
+        ALEInterface.setReplayBuffer, each frame stored once as palette indices, sampled in
+        stacks of frames with probability proportional to priorities. """
+
+    def __init__(self, capacity, height, width, stack=4, deduplicate=False, seed=0):
+        self.obj = ale_lib.newReplayBuffer(capacity, height, width, stack, deduplicate, seed)
+        if not self.obj:
+            raise ValueError("A replay buffer must hold more steps than a stack of frames")
+        self.shape = (stack, height, width)
+
+    def __len__(self):
+        return ale_lib.replayBufferSize(self.obj)
+
+    def transitions(self):
+        """ Number of transitions which can be sampled """
+        return ale_lib.replayBufferTransitions(self.obj)
+
+    def numFrames(self):
+        return ale_lib.replayBufferNumFrames(self.obj)
+
+    def frameBytes(self):
+        return ale_lib.replayBufferFrameBytes(self.obj)
+
+    def sample(self, batch_size, observations=None, next_observations=None, threads=1):
+        """ Draws batch_size transitions and returns observations, actions, rewards,
+            next_observations, terminals, indices and probabilities, as numpy arrays.
+            Observations, (batch_size, stack, height, width) arrays of palette indices,
+            are written to the given arrays if any. """
+        shape = (batch_size,) + self.shape
+        if observations is None:
+            observations = np.empty(shape, dtype=np.uint8)
+        if next_observations is None:
+            next_observations = np.empty(shape, dtype=np.uint8)
+        for array in (observations, next_observations):
+            if array.nbytes < np.prod(shape) or not array.flags.c_contiguous:
+                raise ValueError("Observations need contiguous arrays of %d bytes" %
+                                 np.prod(shape))
+        actions = np.empty(batch_size, dtype=np.intc)
+        rewards = np.empty(batch_size, dtype=np.intc)
+        terminals = np.empty(batch_size, dtype=np.bool_)
+        indices = np.empty(batch_size, dtype=np.uintp)
+        probabilities = np.empty(batch_size, dtype=np.double)
+        if not ale_lib.replayBufferSample(self.obj, batch_size,
+                                          observations.ctypes.data_as(c_void_p),
+                                          actions.ctypes.data_as(c_void_p),
+                                          rewards.ctypes.data_as(c_void_p),
+                                          next_observations.ctypes.data_as(c_void_p),
+                                          terminals.ctypes.data_as(c_void_p),
+                                          indices.ctypes.data_as(c_void_p),
+                                          probabilities.ctypes.data_as(c_void_p), threads):
+            raise ValueError("The replay buffer holds no transition")
+        return (observations, actions, rewards, next_observations, terminals, indices,
+                probabilities)
+
+    def updatePriorities(self, indices, priorities):
+        """ Sets the priorities, already raised to the prioritization exponent, of the
+            transitions sampled at indices """
+        indices = np.ascontiguousarray(indices, dtype=np.uintp)
+        priorities = np.ascontiguousarray(priorities, dtype=np.double)
+        ale_lib.replayBufferUpdatePriorities(self.obj, indices.ctypes.data_as(c_void_p),
+                                             priorities.ctypes.data_as(c_void_p),
+                                             min(len(indices), len(priorities)))
+
+    def __del__(self):
+        if self.obj:
+            ale_lib.deleteReplayBuffer(self.obj)
+            self.obj = None
+
+class DatasetShard(object):
+    """ Reads a shard of a dataset recorded with the record_dataset_dir setting, in the
+        format described in src/common/Dataset.hpp. shard.readChunk(i) decompresses the
+        i-th chunk into a dict of arrays: observations (palette indices, one screen per
+        step), actions, rewards, terminals, truncated (where the environment jumped to
+        another state after the step) and lives. """
+
+    def __init__(self, filename):
+        with open(filename, 'rb') as f:
+            self.data = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        table, chunks, self.steps, trailer = struct.unpack_from('<QII8s', self.data,
+                                                                len(self.data) - 24)
+        if self.data[:8] != b'ALESHD01' or trailer != b'ALESHEND' or \
+                table + 12 * chunks != len(self.data) - 24:
+            raise IOError("Not a finished dataset shard: %s" % filename)
+        self.height, self.width = struct.unpack_from('<HH', self.data, 8)
+        self.romMD5 = self.data[12:44].decode()
+        self.chunks = [struct.unpack_from('<QI', self.data, table + 12 * i)
+                       for i in range(chunks)]
+
+    def __len__(self):
+        return self.steps
+
+    def numChunks(self):
+        return len(self.chunks)
+
+    def readChunk(self, i):
+        offset, steps = self.chunks[i]
+        columns = []
+        for dtype in (np.uint8, np.uint8, '<i4', np.uint8, '<i4'):
+            size, = struct.unpack_from('<I', self.data, offset)
+            raw = zlib.decompress(self.data[offset + 4:offset + 4 + size])
+            columns.append(np.frombuffer(raw, dtype=dtype))
+            offset += 4 + size
+        observations, actions, rewards, terminals, lives = columns
+        return {'observations': observations.reshape(steps, self.height, self.width),
+                'actions': actions, 'rewards': rewards,
+                'terminals': terminals == 1, 'truncated': terminals == 2, 'lives': lives}
+
+def readDatasetManifest(directory):
+    """ The paths and numbers of steps of the finished shards of a dataset """
+    with open(os.path.join(directory, 'manifest.txt')) as f:
+        return [(os.path.join(directory, name), int(steps))
+                for name, steps in (line.split() for line in f if line.strip())]
+
+# The compiled module, when it was built (see setup.py), implements the same interface
+# without the cost of ctypes; it also provides getScreenView, getRAMView and actBatch
+try:
+    from .ale_native import ALEInterface, ReplayBuffer
+except ImportError:
+    pass
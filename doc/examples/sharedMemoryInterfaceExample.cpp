@@ -0,0 +1,131 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare,
+ *  Matthew Hausknecht, and the Reinforcement Learning and Artificial Intelligence
+ *  Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  sharedMemoryInterfaceExample.cpp
+ *
+ *  Sample code for running an agent over shared memory. Like the FIFO
+ *  interface, this is meant for agents living in another process; only
+ *  shared_memory_layout.h is needed, not the ALE library.
+ **************************************************************************** */
+
+#include <iostream>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "controllers/shared_memory_layout.h"
+
+// Maps the region created by ALE, waiting for it to appear
+ale_shm_header_t* attach(const char* name) {
+
+    for (int attempt = 0; attempt < 500; attempt++) {
+        int fd = shm_open(name, O_RDWR, 0);
+        if (fd >= 0) {
+            struct stat info;
+            void* region = MAP_FAILED;
+            // The region exists but may not have been sized yet
+            if (fstat(fd, &info) == 0 && info.st_size >= (off_t)sizeof(ale_shm_header_t))
+                region = mmap(NULL, info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+
+            if (region != MAP_FAILED) {
+                ale_shm_header_t* header = (ale_shm_header_t*)region;
+                if (header->magic == ALE_SHM_MAGIC && header->version == ALE_SHM_VERSION)
+                    return header;
+                munmap(region, info.st_size);
+            }
+        }
+        usleep(10000);
+    }
+
+    return NULL;
+}
+
+
+void agentMain(ale_shm_header_t* header) {
+
+    std::cout << "Screen is " << header->width << "x" << header->height << ", "
+              << header->num_slots << " slots" << std::endl;
+
+    // Let ALE know who to watch for
+    header->agent_pid = getpid();
+
+    uint32_t seen = 0;
+    int frameNumber = 0;
+
+    while (true) {
+
+        // Wait for the next observation
+        uint32_t seq = seen;
+        while (seq == seen)
+            seq = ale_shm_wait(&header->obs_seq, seen, 100 * 1000 * 1000);
+        if (ale_shm_load(&header->state) == ALE_SHM_CLOSED) break;
+        seen = seq;
+
+        // The observation is read in place; it stays valid for num_slots - 1 steps
+        ale_shm_slot_t* slot = ale_shm_slot(header, seq);
+        if (slot->reward != 0)
+            std::cout << "Reward: " << slot->reward << std::endl;
+
+        frameNumber++;
+        if (slot->terminal) break;
+
+        // Write back a random action, then hand the turn back to ALE
+        header->action_a = rand() % 18;
+        header->action_b = 18;
+        ale_shm_store(&header->action_seq, seq);
+        ale_shm_wake(&header->action_seq);
+    }
+
+    std::cout << "Episode lasted " << frameNumber << " frames" << std::endl;
+}
+
+
+int main(int argc, char** argv) {
+
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " rom_file" << std::endl;
+        std::cerr << "Note: This example must be run from the same directory as the ALE "
+            "executable ('ale')." << std::endl;
+        return 1;
+    }
+
+    const char* name = "/ale_shm_example";
+
+    // We actually fork two processes, ALE itself and an agent
+    pid_t ale = fork();
+    if (ale == 0) {
+        execl("./ale", "./ale", "-game_controller", "shm", "-shm_name", name, argv[1],
+              (char*)NULL);
+        perror("Could not run ./ale");
+        _exit(1);
+    }
+
+    ale_shm_header_t* header = attach(name);
+    if (header == NULL) {
+        std::cerr << "ALE did not create " << name << std::endl;
+        kill(ale, SIGTERM);
+        return 1;
+    }
+
+    agentMain(header);
+
+    // Detach, so that ALE shuts down and removes the region
+    header->agent_pid = -1;
+    ale_shm_wake(&header->action_seq);
+    waitpid(ale, NULL, 0);
+}
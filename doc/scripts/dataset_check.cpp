@@ -0,0 +1,125 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare,
+ *  Matthew Hausknecht, and the Reinforcement Learning and Artificial Intelligence
+ *  Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  dataset_check.cpp
+ *
+ *  Records an offline RL dataset over several shards and chunks, and checks
+ *  that DatasetShard reads back the observations, actions, rewards, terminal
+ *  flags and lives of every step. Run by test_ale.sh.
+ **************************************************************************** */
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <stdlib.h>
+#include <unistd.h>
+#include <ale_interface.hpp>
+#include <common/Dataset.hpp>
+
+static const int NumSteps = 250;
+static const int ResetStep = 120;
+
+static int failures = 0;
+
+static void check(bool condition, const char *what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " rom_file" << std::endl;
+        return 1;
+    }
+    ale::Logger::setMode(ale::Logger::Error);
+
+    char directory[] = "dataset_check.XXXXXX";
+    if (mkdtemp(directory) == NULL) {
+        std::cerr << "Can't create a directory for the dataset" << std::endl;
+        return 1;
+    }
+
+    // What the dataset should hold
+    std::vector<ALEScreen> observations;
+    DatasetChunk expected;
+    {
+        ALEInterface ale;
+        ale.setFloat("repeat_action_probability", 0);
+        ale.setString("record_dataset_dir", directory);
+        ale.setInt("dataset_chunk_size", 16);
+        ale.setInt("dataset_shard_size", 100);
+        ale.loadROM(argv[1]);
+        ActionVect actions = ale.getMinimalActionSet();
+
+        for (int i = 0; i < NumSteps; i++) {
+            if (i == ResetStep) {
+                ale.reset_game();
+                // The episode was cut short, unless it had ended
+                if (expected.terminals.back() == 0)
+                    expected.terminals.back() = DatasetChunk::Truncated;
+            }
+            Action action = actions[(i * 5) % actions.size()];
+            observations.push_back(ale.getScreen());
+            expected.actions.push_back(action);
+            expected.rewards.push_back(ale.act(action));
+            expected.terminals.push_back(ale.game_over() ? DatasetChunk::Terminal : 0);
+            expected.lives.push_back(ale.lives());
+        }
+    }
+
+    std::vector<DatasetManifestEntry> shards;
+    check(readDatasetManifest(directory, shards), "manifest written");
+    check(shards.size() == (size_t)(NumSteps + 99) / 100, "number of shards");
+
+    size_t step = 0;
+    DatasetChunk chunk;
+    for (size_t s = 0; s < shards.size(); s++) {
+        try {
+            DatasetShard shard(shards[s].filename);
+            check(shard.size() == shards[s].steps, "shard size as listed");
+            for (size_t c = 0; c < shard.numChunks(); c++) {
+                shard.readChunk(c, chunk);
+                check(chunk.steps <= 16, "chunk size");
+                size_t frame = shard.height() * shard.width();
+                for (size_t i = 0; i < chunk.steps && step < (size_t)NumSteps; i++, step++) {
+                    check(memcmp(&chunk.observations[i * frame],
+                                 observations[step].getArray(), frame) == 0, "observation");
+                    check(chunk.actions[i] == expected.actions[step], "action");
+                    check(chunk.rewards[i] == expected.rewards[step], "reward");
+                    check(chunk.terminals[i] == expected.terminals[step], "terminal flag");
+                    check(chunk.lives[i] == expected.lives[step], "lives");
+                }
+            }
+            bool outOfRange = false;
+            try {
+                shard.readChunk(shard.numChunks(), chunk);
+            } catch (std::out_of_range &) {
+                outOfRange = true;
+            }
+            check(outOfRange, "chunk past the end");
+        } catch (std::runtime_error &e) {
+            std::cerr << "FAILED: reading " << shards[s].filename << ": " << e.what() << std::endl;
+            failures++;
+        }
+        remove(shards[s].filename.c_str());
+    }
+    check(step == (size_t)NumSteps, "every step read back");
+
+    remove((std::string(directory) + "/manifest.txt").c_str());
+    rmdir(directory);
+
+    if (failures == 0)
+        std::cout << "Datasets: OK" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare,
+ *  Matthew Hausknecht, and the Reinforcement Learning and Artificial Intelligence
+ *  Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  environment_memory_check.cpp
+ *
+ *  Checks the memory taken by each environment against the budget given in
+ *  the manual (Compact Environments): loads 1000 environments of the given
+ *  ROM and fails if the resident memory grew by more than the budget per
+ *  environment. Linux only. Run by test_ale.sh.
+ **************************************************************************** */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <unistd.h>
+#include <ale_interface.hpp>
+
+// Kilobytes per environment, default and compact
+static const double DefaultBudget = 170;
+static const double CompactBudget = 90;
+
+static const int NumEnvironments = 1000;
+
+static long residentKB() {
+    long size = 0, resident = 0;
+    FILE *statm = fopen("/proc/self/statm", "r");
+    if (statm == NULL)
+        return -1;
+    if (fscanf(statm, "%ld %ld", &size, &resident) != 2)
+        resident = -1;
+    fclose(statm);
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+static void addEnvironment(std::vector<std::unique_ptr<ALEInterface> > &environments,
+                           const char *rom, bool compact) {
+    environments.emplace_back(new ALEInterface());
+    environments.back()->setBool("compact_environment", compact);
+    environments.back()->loadROM(rom);
+    environments.back()->act(PLAYER_A_NOOP);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || (argc > 2 && strcmp(argv[2], "compact") != 0)) {
+        std::cerr << "Usage: " << argv[0] << " rom_file [compact]" << std::endl;
+        return 1;
+    }
+    bool compact = argc > 2;
+    double budget = compact ? CompactBudget : DefaultBudget;
+    ale::Logger::setMode(ale::Logger::Error);
+
+    // The first environments also allocate what all of them share
+    std::vector<std::unique_ptr<ALEInterface> > environments;
+    for (int i = 0; i < 10; i++)
+        addEnvironment(environments, argv[1], compact);
+
+    long before = residentKB();
+    for (int i = 0; i < NumEnvironments; i++)
+        addEnvironment(environments, argv[1], compact);
+    long after = residentKB();
+    if (before < 0 || after < 0) {
+        std::cerr << "Can't read /proc/self/statm" << std::endl;
+        return 1;
+    }
+
+    double perEnvironment = (double)(after - before) / NumEnvironments;
+    std::cout << (compact ? "Compact" : "Default") << " environment: " << perEnvironment
+              << " KB (budget " << budget << " KB)" << std::endl;
+    return perEnvironment <= budget ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare,
+ *  Matthew Hausknecht, and the Reinforcement Learning and Artificial Intelligence
+ *  Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  fingerprint_check.cpp
+ *
+ *  Checks the fingerprints of screens, RAM and states: equal contents hash
+ *  equally, different contents differently, and the incremental screen
+ *  fingerprint agrees with the full one. Run by test_ale.sh.
+ **************************************************************************** */
+
+#include <iostream>
+#include <ale_interface.hpp>
+
+static int failures = 0;
+
+static void check(bool condition, const char *what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " rom_file" << std::endl;
+        return 1;
+    }
+    ale::Logger::setMode(ale::Logger::Error);
+
+    // XXH64 of the empty input
+    check(fingerprintBytes("", 0) == 0xEF46DB3751D8E999ULL, "fingerprint of no bytes");
+
+    ALEInterface ale;
+    ale.setFloat("repeat_action_probability", 0);
+    ale.loadROM(argv[1]);
+    ActionVect actions = ale.getMinimalActionSet();
+
+    ALEState start = ale.cloneState();
+    ALEScreen startScreen = ale.getScreen();
+    fingerprint_t startRAM = ale.getRAMFingerprint();
+
+    // Screens
+    ALEScreen copy = startScreen;
+    check(copy.fingerprint() == startScreen.fingerprint(), "copied screen");
+    check(copy.cellFingerprint(11, 8, 8) == startScreen.cellFingerprint(11, 8, 8),
+          "cells of copied screen");
+    *copy.pixel(copy.height() / 2, copy.width() / 2) ^= 2;
+    check(copy.fingerprint() != startScreen.fingerprint(), "screen with one pixel changed");
+
+    // The incremental fingerprint follows the screens, changed or not
+    bool screenChanged = false;
+    for (int i = 0; i < 200; i++) {
+        ale.act(actions[i % actions.size()]);
+        check(ale.getScreenFingerprint() == ale.getScreen().fingerprint(),
+              "incremental screen fingerprint");
+        screenChanged |= !ale.getScreen().equals(startScreen);
+    }
+    check(screenChanged, "game shows a different screen");
+    check(ale.getScreen().equals(startScreen) ==
+          (ale.getScreen().fingerprint() == startScreen.fingerprint()), "screen after playing");
+    check(ale.getRAMFingerprint() == ale.getRAM().fingerprint(), "RAM fingerprint");
+    check(ale.getRAMFingerprint() != startRAM, "RAM after playing");
+
+    // States
+    ALEState later = ale.cloneState();
+    check(ale.cloneState().fingerprint() == later.fingerprint(), "cloned state");
+    check(later.fingerprint() != start.fingerprint(), "state after playing");
+    ale.restoreState(start);
+    check(ale.cloneState().fingerprint() == start.fingerprint(), "restored state");
+    check(ALEState(start.serialize()).fingerprint() == start.fingerprint(),
+          "deserialized state");
+
+    if (failures == 0)
+        std::cout << "Fingerprints: OK" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,165 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare,
+ *  Matthew Hausknecht, and the Reinforcement Learning and Artificial Intelligence
+ *  Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  replay_buffer_check.cpp
+ *
+ *  Fills a small ReplayBuffer with several episodes of a game, past its
+ *  capacity, and checks every sampled transition against the steps added:
+ *  its stacks of frames, zero-padded at the start of episodes, and that
+ *  neither the starts of episodes nor stacks reaching past the evicted steps
+ *  are drawn. Run by test_ale.sh.
+ **************************************************************************** */
+
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include <ale_interface.hpp>
+#include <environment/replay_buffer.hpp>
+
+static const size_t Capacity = 100;
+static const int Stack = 4;
+static const int NumSteps = 300;
+static const size_t BatchSize = 256;
+
+static int failures = 0;
+
+static void check(bool condition, const char *what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+// A slot of the buffer, as pushed
+struct Pushed {
+    size_t screen;
+    bool first;
+    int action;
+    reward_t reward;
+    bool terminal;
+};
+
+// The stack of frames ending with the given push, as the buffer should return it
+static std::vector<pixel_t> expectedStack(const std::vector<Pushed> &pushed,
+                                          const std::vector<ALEScreen> &screens, size_t g) {
+    size_t frameSize = screens[0].height() * screens[0].width();
+    std::vector<pixel_t> stack(Stack * frameSize, 0);
+    for (int k = Stack - 1; k >= 0; k--) {
+        memcpy(&stack[k * frameSize], screens[pushed[g].screen].getArray(), frameSize);
+        if (pushed[g].first)
+            break;
+        g--;
+    }
+    return stack;
+}
+
+static void checkBuffer(ALEInterface &ale, bool deduplicate) {
+    ActionVect actions = ale.getMinimalActionSet();
+    ale.reset_game();
+
+    ALEScreen start = ale.getScreen();
+    ReplayBuffer buffer(Capacity, start.height(), start.width(), Stack, deduplicate, 1);
+
+    size_t frameSize = start.height() * start.width();
+    std::vector<pixel_t> observations(BatchSize * Stack * frameSize);
+    std::vector<pixel_t> nextObservations(BatchSize * Stack * frameSize);
+    std::vector<int> batchActions(BatchSize);
+    std::vector<reward_t> rewards(BatchSize);
+    std::vector<uInt8> terminals(BatchSize);
+    std::vector<size_t> indices(BatchSize);
+    ReplayBuffer::Batch batch = { &observations[0], &batchActions[0], &rewards[0],
+                                  &nextObservations[0], &terminals[0], &indices[0], NULL };
+
+    std::vector<ALEScreen> screens;
+    std::vector<Pushed> pushed;
+
+    // An episode started twice keeps the second screen
+    ale.act(actions[0]);
+    buffer.startEpisode(ale.getScreen());
+    screens.push_back(start);
+    buffer.startEpisode(start);
+    Pushed first = { 0, true, 0, 0, false };
+    pushed.push_back(first);
+    check(!buffer.sample(BatchSize, batch), "sampling without transitions");
+
+    for (int i = 0; i < NumSteps; i++) {
+        Action action = actions[(i * 3) % actions.size()];
+        reward_t reward = ale.act(action);
+        bool terminal = ale.game_over();
+        screens.push_back(ale.getScreen());
+        buffer.addStep(action, reward, terminal, screens.back());
+        Pushed step = { screens.size() - 1, false, action, reward, terminal };
+        pushed.push_back(step);
+
+        if (terminal || i % 37 == 36) {
+            ale.reset_game();
+            screens.push_back(ale.getScreen());
+            buffer.startEpisode(screens.back());
+            Pushed episode = { screens.size() - 1, true, 0, 0, false };
+            pushed.push_back(episode);
+        }
+    }
+
+    // Transitions whose stacks stay within the steps kept
+    size_t total = pushed.size(), oldest = total - Capacity, transitions = 0;
+    for (size_t g = oldest; g < total; g++)
+        transitions += !pushed[g].first && g >= oldest + Stack;
+    check(buffer.size() == Capacity, "buffer full");
+    check(buffer.transitions() == transitions, "transitions kept");
+    if (deduplicate)
+        check(buffer.numFrames() < Capacity, "identical screens stored once");
+    else
+        check(buffer.numFrames() == Capacity, "screens stored");
+
+    check(buffer.sample(BatchSize, batch, 2), "sampling");
+    for (size_t i = 0; i < BatchSize; i++) {
+        // The push the slot holds now
+        size_t g = oldest + (indices[i] + Capacity - oldest % Capacity) % Capacity;
+        if (pushed[g].first || g < oldest + Stack) {
+            check(false, "transition drawn which can't be sampled");
+            continue;
+        }
+        check(batchActions[i] == pushed[g].action, "action");
+        check(rewards[i] == pushed[g].reward, "reward");
+        check(terminals[i] == pushed[g].terminal, "terminal");
+        check(memcmp(&observations[i * Stack * frameSize], &expectedStack(pushed, screens, g - 1)[0],
+                     Stack * frameSize) == 0, "observation stack");
+        check(memcmp(&nextObservations[i * Stack * frameSize], &expectedStack(pushed, screens, g)[0],
+                     Stack * frameSize) == 0, "next observation stack");
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " rom_file" << std::endl;
+        return 1;
+    }
+    ale::Logger::setMode(ale::Logger::Error);
+
+    bool rejected = false;
+    try {
+        ReplayBuffer buffer(Stack, 210, 160, Stack);
+    } catch (std::invalid_argument &) {
+        rejected = true;
+    }
+    check(rejected, "buffer no larger than a stack");
+
+    ALEInterface ale;
+    ale.setFloat("repeat_action_probability", 0);
+    ale.loadROM(argv[1]);
+    checkBuffer(ale, false);
+    checkBuffer(ale, true);
+
+    if (failures == 0)
+        std::cout << "Replay buffer: OK" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
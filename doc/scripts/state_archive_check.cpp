@@ -0,0 +1,137 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare,
+ *  Matthew Hausknecht, and the Reinforcement Learning and Artificial Intelligence
+ *  Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  state_archive_check.cpp
+ *
+ *  Checks that states survive StateCodec and StateArchive round trips, and
+ *  that mismatched, corrupt or unfinished data is rejected. Run by
+ *  test_ale.sh.
+ **************************************************************************** */
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <ale_interface.hpp>
+#include <environment/state_archive.hpp>
+
+static const char *ArchiveFile = "state_archive_check.arc";
+static const int NumStates = 50;
+
+static int failures = 0;
+
+static void check(bool condition, const char *what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+// Whether decoding the data with the codec throws std::runtime_error
+static bool rejects(const StateCodec &codec, const std::string &data) {
+    try {
+        codec.decode(data);
+    } catch (std::runtime_error &) {
+        return true;
+    }
+    return false;
+}
+
+static bool rejectsArchive(const std::string &filename) {
+    try {
+        StateArchive archive(filename);
+    } catch (std::runtime_error &) {
+        return true;
+    }
+    return false;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " rom_file" << std::endl;
+        return 1;
+    }
+    ale::Logger::setMode(ale::Logger::Error);
+
+    ALEInterface ale;
+    ale.setFloat("repeat_action_probability", 0);
+    ale.loadROM(argv[1]);
+    ActionVect actions = ale.getMinimalActionSet();
+
+    StateCodec codec(ale.cloneState());
+    std::vector<std::string> states;
+    for (int i = 0; i < NumStates; i++) {
+        for (int j = 0; j < 10; j++)
+            ale.act(actions[(i + j) % actions.size()]);
+        states.push_back(ale.cloneState().serialize());
+    }
+
+    // Standalone encoding
+    std::string encoded = codec.encode(ALEState(states.back()));
+    check(codec.decode(encoded).serialize() == states.back(), "codec round trip");
+    check(encoded.size() < states.back().size(), "encoded state is compressed");
+    check(StateCodec(states.back()).decode(StateCodec(states.back()).encode(
+          ALEState(states[0]))).serialize() == states[0], "round trip with another reference");
+    check(rejects(StateCodec(states[0]), encoded), "state encoded against another reference");
+    std::string corrupt = encoded;
+    corrupt[0] ^= 1;
+    check(rejects(codec, corrupt), "corrupt header");
+    check(rejects(codec, encoded.substr(0, StateCodec::HeaderSize + 6)), "truncated body");
+
+    // Archive
+    {
+        StateArchiveWriter writer(ArchiveFile, codec);
+        check(writer.isOpen(), "archive opened");
+        for (int i = 0; i < NumStates; i++)
+            check(writer.add(ALEState(states[i])) == (size_t)i, "archive index");
+        check(writer.close(), "archive closed");
+    }
+    try {
+        StateArchive archive(ArchiveFile);
+        check(archive.size() == (size_t)NumStates, "archive size");
+        // Out of order, as only the states asked for are decoded
+        for (int i = NumStates - 1; i >= 0; i -= 3)
+            check(archive.get(i).serialize() == states[i], "archive round trip");
+        bool outOfRange = false;
+        try {
+            archive.get(NumStates);
+        } catch (std::out_of_range &) {
+            outOfRange = true;
+        }
+        check(outOfRange, "state past the end");
+
+        // A decoded state plays on like the original
+        ale.restoreState(archive.get(0));
+        ale.act(actions[0]);
+        ALEState replayed = ale.cloneState();
+        ale.restoreState(ALEState(states[0]));
+        ale.act(actions[0]);
+        check(ale.cloneState().serialize() == replayed.serialize(), "decoded state plays on");
+    } catch (std::exception &e) {
+        std::cerr << "FAILED: reading the archive: " << e.what() << std::endl;
+        failures++;
+    }
+
+    // Without its trailer, as left by a writer which did not finish
+    {
+        std::ifstream in(ArchiveFile, std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::ofstream out(ArchiveFile, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), data.size() - 8);
+    }
+    check(rejectsArchive(ArchiveFile), "unfinished archive");
+    remove(ArchiveFile);
+
+    if (failures == 0)
+        std::cout << "State codec and archive: OK" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
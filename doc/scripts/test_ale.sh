@@ -127,6 +127,48 @@ function TEST_PYTHON_EXAMPLE {
     fi
 }
 
+# TEST_ENVIRONMENT_MEMORY: checks the memory per environment against the manual's budget
+function TEST_ENVIRONMENT_MEMORY {
+    LOG "=========== [ ENVIRONMENT MEMORY TESTS ] ==========="
+    if [[ "$unamestr" != 'Linux' ]]; then
+        LOG "==> Memory is only measured on Linux. Skipping this test..."
+        SKIPPED_TESTS=$((SKIPPED_TESTS+1))
+        return
+    fi
+    TEST "g++ -O2 -std=c++11 -Isrc doc/scripts/environment_memory_check.cpp -L. -Wl,-rpath=. -lale -lz -lpthread -o environment_memory_check"
+    if [ -f "environment_memory_check" ]; then
+        TEST "./environment_memory_check $ROM"
+        TEST "./environment_memory_check $ROM compact"
+        rm environment_memory_check
+    else
+        LOG "Skipping TEST: ./environment_memory_check"
+        SKIPPED_TESTS=$((SKIPPED_TESTS+1))
+    fi
+}
+
+# TEST_LIBRARY_CHECK (String name): builds doc/scripts/name.cpp against the library and
+# runs it on the ROM
+function TEST_LIBRARY_CHECK {
+    TEST "g++ -O2 -std=c++11 -Isrc doc/scripts/$1.cpp -L. -Wl,-rpath=. -lale -lz -lpthread -o $1"
+    if [ -f "$1" ]; then
+        TEST "./$1 $ROM"
+        rm $1
+    else
+        LOG "Skipping TEST: ./$1"
+        SKIPPED_TESTS=$((SKIPPED_TESTS+1))
+    fi
+}
+
+# TEST_LIBRARY_CHECKS: checks of library features which need no display or agent
+function TEST_LIBRARY_CHECKS {
+    LOG "=========== [ LIBRARY CHECKS ] ==========="
+    TEST_LIBRARY_CHECK fingerprint_check
+    TEST_LIBRARY_CHECK state_archive_check
+    TEST_LIBRARY_CHECK trajectory_check
+    TEST_LIBRARY_CHECK dataset_check
+    TEST_LIBRARY_CHECK replay_buffer_check
+}
+
 unamestr=`uname -s`
 echo `uname -a` >> $LOG
 if [[ "$unamestr" == 'Linux' ]]; then
@@ -143,6 +185,8 @@ USE_SDL=0
 USE_RLGLUE=0
 TEST_MAKEFILE_BUILD $USE_SDL $USE_RLGLUE
 TEST_SHARED_LIBRARY_EXAMPLE $USE_SDL
+TEST_ENVIRONMENT_MEMORY
+TEST_LIBRARY_CHECKS
 
 # Makefile Test with SDL and RL_Glue
 USE_SDL=1
@@ -0,0 +1,112 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare,
+ *  Matthew Hausknecht, and the Reinforcement Learning and Artificial Intelligence
+ *  Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  trajectory_check.cpp
+ *
+ *  Records a trajectory with sticky actions, resets, restoreState() jumps and
+ *  a rollout, and checks that verifyTrajectories() replays it exactly, and
+ *  that it notices a step which was tampered with. Run by test_ale.sh.
+ **************************************************************************** */
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <ale_interface.hpp>
+#include <environment/trajectory.hpp>
+
+static const char *TrajectoryFile = "trajectory_check.trj";
+
+static int failures = 0;
+
+static void check(bool condition, const char *what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+// Replays the trajectory file, failing if it can't be replayed at all
+static TrajectoryCheck verify(const std::string &rom_file) {
+    std::vector<std::string> filenames(1, TrajectoryFile);
+    std::vector<TrajectoryCheck> results;
+    verifyTrajectories(filenames, results, 1, rom_file);
+    if (!results[0].error.empty()) {
+        std::cerr << "FAILED: replaying: " << results[0].error << std::endl;
+        failures++;
+    }
+    return results[0];
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " rom_file" << std::endl;
+        return 1;
+    }
+    ale::Logger::setMode(ale::Logger::Error);
+
+    size_t steps = 0;
+    {
+        ALEInterface ale;
+        ale.setInt("random_seed", 7);
+        ale.setFloat("repeat_action_probability", 0.25);
+        ale.setString("record_trajectory_file", TrajectoryFile);
+        ale.setInt("trajectory_snapshot_interval", 32);
+        ale.loadROM(argv[1]);
+        ActionVect actions = ale.getMinimalActionSet();
+
+        ALEState saved;
+        for (int i = 0; i < 300; i++, steps++) {
+            ale.act(actions[(i * 7) % actions.size()]);
+            if (i == 50) saved = ale.cloneState();
+            if (i == 120) ale.reset_game();
+            if (i == 200) ale.restoreState(saved);
+        }
+
+        ActionVect plan(20, actions[1 % actions.size()]);
+        RolloutResult result;
+        ale.rollout(saved, &plan[0], plan.size(), &result);
+        steps += plan.size();
+        for (int i = 0; i < 17; i++, steps++)
+            ale.act(actions[i % actions.size()]);
+    }
+
+    try {
+        Trajectory trajectory(TrajectoryFile);
+        check(trajectory.size() == steps, "steps recorded");
+        check(trajectory.events().back().type == Trajectory::Event::STEP, "last record is a step");
+    } catch (std::runtime_error &e) {
+        std::cerr << "FAILED: reading the trajectory: " << e.what() << std::endl;
+        failures++;
+    }
+
+    TrajectoryCheck result = verify(argv[1]);
+    check(result.deterministic, "replay matches the recording");
+    check(result.steps == steps, "steps replayed");
+
+    // Change the RAM hash of the last step, the last byte of the file
+    {
+        std::ifstream in(TrajectoryFile, std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        data[data.size() - 1] ^= 1;
+        std::ofstream out(TrajectoryFile, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), data.size());
+    }
+    result = verify(argv[1]);
+    check(!result.deterministic, "replay of a tampered trajectory diverges");
+    check(result.divergence == steps - 1, "divergence at the tampered step");
+    remove(TrajectoryFile);
+
+    if (failures == 0)
+        std::cout << "Trajectories: OK" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -13,13 +13,28 @@ module1 = Extension('ale_python_interface.ale_c_wrapper',
                     library_dirs = ['ale_python_interface'],
                     extra_compile_args=['-D__STDC_CONSTANT_MACROS', '-std=c++11'],
                     sources=['ale_python_interface/ale_c_wrapper.cpp'])
+
+# The compiled interface needs numpy's headers; without them the ctypes interface is used
+ext_modules = [module1]
+try:
+  import numpy
+  ext_modules.append(Extension('ale_python_interface.ale_native',
+                               libraries = ['ale_c'],
+                               include_dirs = ['src', numpy.get_include()],
+                               library_dirs = ['ale_python_interface'],
+                               runtime_library_dirs = ['$ORIGIN'] if sys.platform.startswith('linux') else [],
+                               extra_compile_args=['-D__STDC_CONSTANT_MACROS', '-std=c++11'],
+                               sources=['ale_python_interface/ale_native.cpp']))
+except ImportError:
+  print('WARNING: numpy is not installed; only the ctypes interface will be available.')
+
 setup(name = 'ale_python_interface',
       version='0.6',
       description = 'Arcade Learning Environment Python Interface',
       url='https://github.com/bbitmaster/ale_python_interface',
       author='Ben Goodrich',
       license='GPL',
-      ext_modules = [module1],
+      ext_modules = ext_modules,
       packages=['ale_python_interface'],
       package_dir={'ale_python_interface': 'ale_python_interface'},
       package_data={'ale_python_interface': ['libale_c.so']})
@@ -34,6 +34,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cctype>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <iostream>
@@ -51,6 +52,16 @@
 
 using namespace ale;
 
+typedef std::chrono::steady_clock StartupClock;
+
+// Returns the milliseconds elapsed since 'since' and restarts the measurement
+static double lapMilliseconds(StartupClock::time_point& since) {
+  StartupClock::time_point now = StartupClock::now();
+  double elapsed = std::chrono::duration<double, std::milli>(now - since).count();
+  since = now;
+  return elapsed;
+}
+
 // Display ALE welcome message
 std::string ALEInterface::welcomeMessage() {
   std::ostringstream oss;
@@ -84,16 +95,7 @@ void ALEInterface::createOSystem(std::unique_ptr<OSystem> &theOSystem,
 void ALEInterface::checkForUnsupportedRom(std::unique_ptr<OSystem>& theOSystem) {
   const Properties properties = theOSystem->console().properties();
   const std::string md5 = properties.get(Cartridge_MD5);
-  bool found = false;
-  std::ifstream ss("md5.txt");
-  std::string item;
-  while (!found && std::getline(ss, item)) {
-    if (!item.compare(0, md5.size(), md5)) {
-      const std::string rom_candidate = item.substr(md5.size() + 1);
-      found = true;
-    }
-  }
-  if (!found) {
+  if (!isSupportedRomMD5(md5)) {
     // If the md5 doesn't match our master list, warn the user. 
     Logger::Warning << std::endl;
     Logger::Warning << "WARNING: Possibly unsupported ROM: mismatched MD5." << std::endl;
@@ -105,7 +107,14 @@ void ALEInterface::checkForUnsupportedRom(std::unique_ptr<OSystem>& theOSystem)
 }
 
 void ALEInterface::loadSettings(const std::string& romfile,
-                                std::unique_ptr<OSystem> &theOSystem) {
+                                std::unique_ptr<OSystem> &theOSystem,
+                                StartupTimings *timings) {
+  StartupClock::time_point lap = StartupClock::now();
+  StartupTimings unused_timings;
+  if (timings == NULL) {
+    timings = &unused_timings;
+  }
+
   // Load the configuration from a config file (passed on the command
   //  line), if provided
   std::string configFile = theOSystem->settings().getString("config", false);
@@ -116,6 +125,7 @@ void ALEInterface::loadSettings(const std::string& romfile,
 
   theOSystem->settings().validate();
   theOSystem->create();
+  timings->settings = lapMilliseconds(lap);
 
   // Attempt to load the ROM
   if (romfile == "") {
@@ -125,7 +135,9 @@ void ALEInterface::loadSettings(const std::string& romfile,
     Logger::Error << "ROM file " << romfile << " not found." << std::endl;
     exit(1);
   } else if (theOSystem->createConsole(romfile))  {
+    timings->console = lapMilliseconds(lap);
     checkForUnsupportedRom(theOSystem);
+    timings->rom_check = lapMilliseconds(lap);
     Logger::Info << "Running ROM file..." << std::endl;
     theOSystem->settings().setString("rom_file", romfile);
   } else {
@@ -141,19 +153,26 @@ void ALEInterface::loadSettings(const std::string& romfile,
 
   std::string currentDisplayFormat = theOSystem->console().getFormat();
   theOSystem->colourPalette().setPalette("standard", currentDisplayFormat);
+  timings->palette = lapMilliseconds(lap);
 }
 
-ALEInterface::ALEInterface() {
+ALEInterface::ALEInterface():
+  m_selected_game(-1) {
+  StartupClock::time_point lap = StartupClock::now();
   disableBufferedIO();
   Logger::Info << welcomeMessage() << std::endl;
   createOSystem(theOSystem, theSettings);
+  m_startup_timings.config = lapMilliseconds(lap);
 }
 
-ALEInterface::ALEInterface(bool display_screen) {
+ALEInterface::ALEInterface(bool display_screen):
+  m_selected_game(-1) {
+  StartupClock::time_point lap = StartupClock::now();
   disableBufferedIO();
   Logger::Info << welcomeMessage() << std::endl;
   createOSystem(theOSystem, theSettings);
   this->setBool("display_screen", display_screen);
+  m_startup_timings.config = lapMilliseconds(lap);
 }
 
 ALEInterface::~ALEInterface() {
@@ -168,11 +187,37 @@ void ALEInterface::loadROM(std::string rom_file = "") {
   if (rom_file.empty()) {
     rom_file = theOSystem->romFile();
   }
-  loadSettings(rom_file, theOSystem);
-  romSettings.reset(buildRomRLWrapper(rom_file));
+
+  m_games.clear();
+  m_selected_game = -1;
+  m_replicas.reset();
+
+  StartupClock::time_point start = StartupClock::now();
+  loadSettings(rom_file, theOSystem, &m_startup_timings);
+  StartupClock::time_point lap = StartupClock::now();
+  romSettings.reset(buildRomRLWrapper(rom_file,
+      theOSystem->console().properties().get(Cartridge_MD5)));
+  if (!romSettings.get()) {
+    Logger::Error << "Unsupported ROM file " << rom_file << std::endl;
+    exit(1);
+  }
+  m_startup_timings.rom_settings = lapMilliseconds(lap);
   environment.reset(new StellaEnvironment(theOSystem.get(), romSettings.get()));
   max_num_frames = theOSystem->settings().getInt("max_num_frames_per_episode");
+  m_startup_timings.environment = lapMilliseconds(lap);
   environment->reset();
+  m_startup_timings.reset = lapMilliseconds(lap);
+  m_startup_timings.total = lapMilliseconds(start);
+
+  int budget = theOSystem->settings().getInt("startup_budget_ms");
+  if (budget > 0 && m_startup_timings.total > budget) {
+    const StartupTimings& t = m_startup_timings;
+    Logger::Warning << "Warning: loadROM took " << t.total << " ms, over the "
+        << budget << " ms startup budget (settings " << t.settings
+        << ", console " << t.console << ", rom check " << t.rom_check
+        << ", palette " << t.palette << ", rom settings " << t.rom_settings
+        << ", environment " << t.environment << ", reset " << t.reset << ")." << std::endl;
+  }
 #ifndef __USE_SDL
   if (theOSystem->p_display_screen != NULL) {
     Logger::Error
@@ -187,6 +232,84 @@ void ALEInterface::loadROM(std::string rom_file = "") {
 #endif
 }
 
+void ALEInterface::preloadROMs(const std::vector<std::string>& rom_files) {
+  assert(theOSystem.get());
+  if (rom_files.empty())
+    throw std::invalid_argument("No ROM to preload");
+  for (size_t i = 0; i < rom_files.size(); i++) {
+    if (!FilesystemNode::fileExists(rom_files[i]))
+      throw std::runtime_error("ROM file " + rom_files[i] + " not found");
+  }
+
+  // The current game goes first, so that its recorders are finished before the first
+  //  preloaded game opens the same files; only its console and settings are kept, to copy
+  m_games.clear();
+  m_selected_game = -1;
+  m_replicas.reset();
+  environment.reset();
+  romSettings.reset();
+
+  // Each game is configured like loadROM() would, from a copy of the current settings
+  std::vector<std::unique_ptr<Game> > games;
+  for (size_t i = 0; i < rom_files.size(); i++) {
+    std::unique_ptr<Game> game(new Game());
+    createOSystem(game->osystem, game->settings);
+    theOSystem->settings().copyTo(*game->settings);
+    if (i > 0) {
+      // Only the first game may display or record to files, which the others would share
+      game->settings->setBool("display_screen", false);
+      game->settings->setString("record_screen_dir", "");
+      game->settings->setString("record_video_file", "");
+      game->settings->setString("record_trajectory_file", "");
+      game->settings->setString("record_sound_filename", "");
+    }
+    loadSettings(rom_files[i], game->osystem);
+
+    game->rom_settings.reset(buildRomRLWrapper(rom_files[i],
+        game->osystem->console().properties().get(Cartridge_MD5)));
+    if (!game->rom_settings.get())
+      throw std::runtime_error("Unsupported ROM " + rom_files[i]);
+    game->environment.reset(new StellaEnvironment(game->osystem.get(),
+                                                  game->rom_settings.get()));
+    game->max_num_frames = game->osystem->settings().getInt("max_num_frames_per_episode");
+    game->environment->reset();
+    game->start = game->environment->cloneState();
+    game->start_screen = game->environment->getScreen();
+    games.push_back(std::move(game));
+  }
+
+  // The first game takes the place of the current console and settings, which go
+  m_games.swap(games);
+  m_selected_game = 0;
+  swapGame(*m_games[0]);
+  m_games[0]->settings.reset();
+  m_games[0]->osystem.reset();
+}
+
+void ALEInterface::selectROM(int index, bool restart) {
+  if (index < 0 || index >= (int)m_games.size())
+    throw std::runtime_error("No preloaded ROM at this index");
+
+  if (index != m_selected_game) {
+    swapGame(*m_games[m_selected_game]);
+    swapGame(*m_games[index]);
+    m_selected_game = index;
+  }
+  if (restart) {
+    const Game& game = *m_games[index];
+    environment->restart(game.start, game.start_screen);
+  }
+}
+
+void ALEInterface::swapGame(Game& game) {
+  std::swap(theOSystem, game.osystem);
+  std::swap(theSettings, game.settings);
+  std::swap(romSettings, game.rom_settings);
+  std::swap(environment, game.environment);
+  std::swap(m_replicas, game.replicas);
+  std::swap(max_num_frames, game.max_num_frames);
+}
+
 // Get the value of a setting.
 std::string ALEInterface::getString(const std::string& key) {
   assert(theSettings.get());
@@ -362,11 +485,40 @@ void ALEInterface::getScreenRGB(std::vector<unsigned char>& output_rgb_buffer) {
   theOSystem->colourPalette().applyPaletteRGB(output_rgb_buffer, ale_screen_data, screen_size);
 }
 
+// Returns the sound of the frames emulated by the last act()
+void ALEInterface::getAudio(std::vector<unsigned char>& output_audio_buffer) {
+  const SoundHeadless *audio = environment->getAudio();
+  if (audio == NULL) {
+    output_audio_buffer.clear();
+    return;
+  }
+
+  output_audio_buffer.resize(audio->size());
+  audio->getSamples(&output_audio_buffer[0]);
+}
+
+// Returns the number of samples getAudio() provides
+size_t ALEInterface::getAudioSize() {
+  const SoundHeadless *audio = environment->getAudio();
+  return audio == NULL ? 0 : audio->size();
+}
+
 // Returns the current RAM content
 const ALERAM& ALEInterface::getRAM() {
   return environment->getRAM();
 }
 
+// Returns the fingerprint of the current screen, rehashing only the rows which changed
+fingerprint_t ALEInterface::getScreenFingerprint() {
+  const ALEScreen& screen = environment->getScreen();
+  return m_screen_fingerprinter.update(screen.getArray(), screen.height(), screen.width());
+}
+
+// Returns the fingerprint of the current RAM content
+fingerprint_t ALEInterface::getRAMFingerprint() {
+  return environment->getRAM().fingerprint();
+}
+
 // Saves the state of the system
 void ALEInterface::saveState() {
   environment->save();
@@ -393,6 +545,70 @@ void ALEInterface::restoreSystemState(const ALEState& state) {
   return environment->restoreSystemState(state);
 }
 
+Journal::Checkpoint ALEInterface::checkpoint() {
+  return environment->checkpoint();
+}
+
+bool ALEInterface::rollback(const Journal::Checkpoint& checkpoint) {
+  return environment->rollback(checkpoint);
+}
+
+void ALEInterface::rollout(const ALEState& root, const Action* actions, size_t n,
+                           RolloutResult* result, bool save_final_state) {
+  environment->rollout(root, actions, n, *result, save_final_state);
+}
+
+void ALEInterface::rolloutBatch(const ALEState& root, const std::vector<ActionVect>& sequences,
+                                std::vector<RolloutResult>& results, bool save_final_states) {
+  results.resize(sequences.size());
+  getReplicas().run(sequences.size(), [&](size_t i, StellaEnvironment& replica) {
+    const ActionVect& actions = sequences[i];
+    replica.rollout(root, actions.empty() ? NULL : &actions[0], actions.size(), results[i],
+                    save_final_states);
+  });
+}
+
+void ALEInterface::expand(const ALEState& parent, const ActionVect& actions,
+                          std::vector<ChildNode>& children) {
+  children.resize(actions.size());
+  getReplicas().run(actions.size(), [&](size_t i, StellaEnvironment& replica) {
+    // A one-step rollout restores the parent and clones the child
+    RolloutResult result;
+    replica.rollout(parent, &actions[i], 1, result, true);
+
+    ChildNode& child = children[i];
+    child.action = actions[i];
+    child.state = result.final_state;
+    child.reward = result.total_reward;
+    child.lives = result.lives.empty() ? replica.lives() : result.lives[0];
+    child.terminal = result.terminal;
+  });
+}
+
+ReplicaPool& ALEInterface::getReplicas() {
+  if (!m_replicas) {
+    m_replicas.reset(new ReplicaPool(theOSystem.get(),
+                                     theOSystem->settings().getInt("planning_threads")));
+  }
+  return *m_replicas;
+}
+
+std::shared_ptr<TransitionCache> ALEInterface::getTransitionCache() const {
+  return environment->getTransitionCache();
+}
+
+bool ALEInterface::setTransitionCache(std::shared_ptr<TransitionCache> cache) {
+  return environment->setTransitionCache(cache);
+}
+
+void ALEInterface::setReplayBuffer(std::shared_ptr<ReplayBuffer> buffer) {
+  environment->setReplayBuffer(buffer);
+}
+
+std::shared_ptr<ReplayBuffer> ALEInterface::getReplayBuffer() const {
+  return environment->getReplayBuffer();
+}
+
 void ALEInterface::saveScreenPNG(const std::string& filename) {
   ScreenExporter exporter(theOSystem->colourPalette());
   exporter.save(environment->getScreen(), filename);
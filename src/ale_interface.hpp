@@ -39,6 +39,7 @@
 #include "games/Roms.hpp"
 #include "common/display_screen.h"
 #include "environment/stella_environment.hpp"
+#include "environment/replica_pool.hpp"
 #include "common/ScreenExporter.hpp"
 #include "common/Log.hpp"
 
@@ -47,6 +48,39 @@
 
 static const std::string Version = "0.6.0";
 
+/**
+   Wall-clock time, in milliseconds, spent in each phase of environment construction.
+   'config' is measured by the constructor, the others by the last loadROM() call; the
+   phases from 'settings' to 'reset' add up to 'total'.
+ */
+struct StartupTimings {
+  double config;        // Creating the OSystem and its default settings
+  double settings;      // Reading the -config file, validating settings and creating OSystem
+                        //  children (properties, sound)
+  double console;       // Reading and hashing the ROM, building the cartridge and console
+  double rom_check;     // Looking the ROM up in the list of supported MD5s
+  double palette;       // Seeding the RNG and setting the console's colour palette
+  double rom_settings;  // Building the game-specific RomSettings
+  double environment;   // Constructing the StellaEnvironment
+  double reset;         // Emulating the reset sequence
+  double total;         // Time spent in loadROM(), once the previous game is discarded
+
+  StartupTimings():
+    config(0), settings(0), console(0), rom_check(0), palette(0), rom_settings(0),
+    environment(0), reset(0), total(0) {}
+};
+
+/**
+   A child of a search node, as computed by ALEInterface::expand().
+ */
+struct ChildNode {
+  Action action;                   // The action leading to this child
+  std::shared_ptr<ALEState> state; // The state reached
+  reward_t reward;
+  int lives;
+  bool terminal;
+};
+
 /**
    This class interfaces ALE with external code for controlling agents.
  */
@@ -75,6 +109,23 @@ public:
   // setting for the setting to take effect.
   void loadROM(std::string rom_file);
 
+  // Loads each ROM into a game of its own, with its own console, RomSettings and environment
+  // configured with the current settings, and keeps the state and screen each started
+  // from, so that selectROM() switches games without reloading. The current game is
+  // discarded and the first one becomes active; setters then configure the active game
+  // only. The next loadROM() discards the other games. Throws std::runtime_error if a ROM
+  // can't be loaded, leaving no game loaded.
+  void preloadROMs(const std::vector<std::string>& rom_files);
+
+  // Makes the index-th preloaded game active in a few microseconds, leaving the previous one
+  // as it is. With restart, the game restarts from the state it was loaded in rather than
+  // where it was left, which is also much cheaper than reset_game().
+  void selectROM(int index, bool restart = false);
+
+  // Number of preloaded games, and index of the active one (-1 if none was preloaded).
+  int getNumPreloadedROMs() const { return m_games.size(); }
+  int getSelectedROM() const { return m_selected_game; }
+
   // Applies an action to the game and returns the reward. It is the
   // user's responsibility to check if the game has ended and reset
   // when necessary - this method will keep pressing buttons on the
@@ -143,9 +194,23 @@ public:
   //followed by the green colours and then the blue colours
   void getScreenRGB(std::vector<unsigned char>& output_rgb_buffer);
 
+  // Fills the vector with the 8-bit mono sound of the frames emulated by the last act(),
+  // getAudioSize() samples in all (512 per frame). Requires sound_obs to be set before
+  // loadROM(); otherwise the vector is left empty and no sound is ever synthesized.
+  void getAudio(std::vector<unsigned char>& output_audio_buffer);
+
+  // Returns the number of samples getAudio() provides, 0 unless sound_obs is set
+  size_t getAudioSize();
+
   // Returns the current RAM content
   const ALERAM &getRAM();
 
+  // Returns getScreen().fingerprint(), rehashing only the rows which changed since the last call
+  fingerprint_t getScreenFingerprint();
+
+  // Returns getRAM().fingerprint()
+  fingerprint_t getRAMFingerprint();
+
   // Saves the state of the system
   void saveState();
 
@@ -168,6 +233,53 @@ public:
   // Reverse operation of cloneSystemState.
   void restoreSystemState(const ALEState& state);
 
+  // Takes a checkpoint for depth-first search. Rather than copying the state, the emulator
+  // journals the RAM it writes from then on, so that backtracking a few steps with rollback()
+  // is cheaper than restoreState(). Checkpoints nest and, like cloneState(), exclude
+  // pseudorandomness. act() bypasses the transition cache while any checkpoint is live.
+  Journal::Checkpoint checkpoint();
+
+  // Returns to the state of the checkpoint, discarding the checkpoints taken after it but
+  // keeping this one. Returns false, changing nothing, if the checkpoint was discarded: by
+  // rolling back past it, or by reset_game(), restoreState() or rollout().
+  bool rollback(const Journal::Checkpoint& checkpoint);
+
+  // Restores root, then applies the n actions in turn without processing screens, stopping
+  // early at a terminal state. Fills result with the total and per-step rewards and lives
+  // and, if save_final_state is true, the state reached. The environment is left there.
+  void rollout(const ALEState& root, const Action* actions, size_t n, RolloutResult* result,
+               bool save_final_state = false);
+
+  // Plays each action sequence from root like rollout(), in parallel on copies of this
+  // environment ('planning_threads' of them, created on first use), leaving this environment
+  // untouched but for one draw from its RNG per sequence, which seeds the copy playing it.
+  // results[i] is the outcome of sequences[i].
+  void rolloutBatch(const ALEState& root, const std::vector<ActionVect>& sequences,
+                    std::vector<RolloutResult>& results, bool save_final_states = false);
+
+  // Expands a search node: for each action, acts once from parent, in parallel on the
+  // environment copies used by rolloutBatch(). children[i] is the outcome of actions[i]; a
+  // terminal parent has children equal to itself, with no reward. This environment is left
+  // untouched.
+  void expand(const ALEState& parent, const ActionVect& actions,
+              std::vector<ChildNode>& children);
+
+  // Returns the cache memoizing act(), created by the 'transition_cache_mb' setting, or NULL.
+  // Its statistics report the hit rate.
+  std::shared_ptr<TransitionCache> getTransitionCache() const;
+
+  // Memoizes act() in the given cache, e.g. one shared by interfaces planning in parallel
+  // with the same ROM and settings, until the next loadROM(). Returns false if this
+  // environment is stochastic or records its frames, which rules memoization out.
+  bool setTransitionCache(std::shared_ptr<TransitionCache> cache);
+
+  // Adds every step taken by act() to the given replay buffer, which must hold screens of
+  // getScreen()'s size, until the next loadROM(); NULL stops. A buffer follows a single
+  // environment: episodes restart after reset_game() and restoreState(), and rollouts are
+  // left out.
+  void setReplayBuffer(std::shared_ptr<ReplayBuffer> buffer);
+  std::shared_ptr<ReplayBuffer> getReplayBuffer() const;
+
   // Save the current screen as a png file
   void saveScreenPNG(const std::string& filename);
 
@@ -176,6 +288,11 @@ public:
   // to exists. 
   ScreenExporter *createScreenExporter(const std::string &path) const;
 
+  // Returns the time spent in each phase of the constructor and the last loadROM() call.
+  // If the 'startup_budget_ms' setting is positive, loadROM() also warns when it exceeds
+  // that many milliseconds.
+  const StartupTimings &getStartupTimings() const { return m_startup_timings; }
+
  public:
   std::unique_ptr<OSystem> theOSystem;
   std::unique_ptr<Settings> theSettings;
@@ -190,10 +307,38 @@ public:
   static void createOSystem(std::unique_ptr<OSystem> &theOSystem,
                             std::unique_ptr<Settings> &theSettings);
   static void loadSettings(const std::string& romfile,
-                           std::unique_ptr<OSystem> &theOSystem);
+                           std::unique_ptr<OSystem> &theOSystem,
+                           StartupTimings *timings = NULL);
 
  private:
   static void checkForUnsupportedRom(std::unique_ptr<OSystem>& theOSystem);
+
+  // Returns the copies of the environment which run batched planning calls
+  ReplicaPool& getReplicas();
+
+  // A preloaded game, whose objects are moved into the members above while it is active,
+  // and back when another game is selected
+  struct Game {
+    std::unique_ptr<OSystem> osystem;
+    std::unique_ptr<Settings> settings;
+    std::unique_ptr<RomSettings> rom_settings;
+    std::unique_ptr<StellaEnvironment> environment;
+    std::unique_ptr<ReplicaPool> replicas;
+    int max_num_frames;
+    ALEState start;      // The state and screen after loading
+    ALEScreen start_screen;
+
+    Game(): max_num_frames(0), start_screen(0, 0) {}
+  };
+
+  // Exchanges the active game's objects with game's
+  void swapGame(Game& game);
+
+  StartupTimings m_startup_timings;
+  ScreenFingerprinter m_screen_fingerprinter;
+  std::unique_ptr<ReplicaPool> m_replicas;
+  std::vector<std::unique_ptr<Game> > m_games;
+  int m_selected_game;
 };
 
 #endif
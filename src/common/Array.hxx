@@ -45,7 +45,7 @@ class Array
     Array<T>(const Array<T>& array) : _capacity(0), _size(0), _data(0)
     {
       _size = array._size;
-      _capacity = _size + 128;
+      _capacity = _size;
       _data = new T[_capacity];
       for(int i = 0; i < _size; i++)
         _data[i] = array._data[i];
@@ -115,7 +115,7 @@ class Array
       if (_data)
         delete [] _data;
       _size = array._size;
-      _capacity = _size + 128;
+      _capacity = _size;
       _data = new T[_capacity];
       for(int i = 0; i < _size; i++)
         _data[i] = array._data[i];
@@ -176,8 +176,12 @@ class Array
       if (new_len <= _capacity)
         return;
 
+      // Grow geometrically rather than by a fixed amount, so that small
+      // arrays (such as the ones in every Settings object) stay small
       T *old_data = _data;
-      _capacity = new_len + 128;
+      _capacity = _capacity * 2;
+      if (_capacity < new_len)
+        _capacity = new_len < 8 ? 8 : new_len;
       _data = new T[_capacity];
 
       if (old_data)
@@ -0,0 +1,422 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  Dataset.cpp
+ *
+ *  Offline RL datasets written straight from the environment into shards.
+ *
+ **************************************************************************** */
+
+#include "Dataset.hpp"
+#include "Log.hpp"
+#include <zlib.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const char Magic[] = "ALESHD01";
+static const char Trailer[] = "ALESHEND";
+static const size_t MagicSize = 8;
+static const size_t HeaderSize = 44;
+static const size_t FooterSize = 24;
+static const size_t TableEntrySize = 12;
+
+// Chunks waiting for the encoder before observe() blocks
+static const size_t MaxQueuedChunks = 2;
+
+// Distinguishes the writers of this process
+static std::atomic<int> s_writer_count(0);
+
+static void putLE(uInt8 *p, unsigned long long v, int bytes) {
+    for (int i = 0; i < bytes; i++)
+        p[i] = (v >> (8 * i)) & 0xFF;
+}
+
+static unsigned long long getLE(const char *p, int bytes) {
+    unsigned long long v = 0;
+    for (int i = 0; i < bytes; i++)
+        v |= (unsigned long long)(unsigned char)p[i] << (8 * i);
+    return v;
+}
+
+// Compresses data into out, after a uInt32 size; returns the bytes used
+static size_t deflateColumn(const uInt8 *data, size_t size, int level, int strategy,
+                            std::vector<uInt8> &out) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit2(&stream, level, Z_DEFLATED, 15, 8, strategy) != Z_OK) {
+        ale::Logger::Error << "Error compressing dataset chunk" << std::endl;
+        out.assign(4, 0);
+        return 4;
+    }
+    out.resize(4 + deflateBound(&stream, size));
+    stream.next_in = const_cast<Bytef *>(data);
+    stream.avail_in = size;
+    stream.next_out = &out[4];
+    stream.avail_out = out.size() - 4;
+    if (deflate(&stream, Z_FINISH) != Z_STREAM_END) {
+        ale::Logger::Error << "Error compressing dataset chunk" << std::endl;
+        stream.total_out = 0;
+    }
+    deflateEnd(&stream);
+    putLE(&out[0], stream.total_out, 4);
+    return 4 + stream.total_out;
+}
+
+void DatasetChunk::clear() {
+    steps = 0;
+    observations.clear();
+    actions.clear();
+    rewards.clear();
+    terminals.clear();
+    lives.clear();
+}
+
+DatasetWriter::DatasetWriter(const std::string &directory, const std::string &romMD5,
+                             size_t chunkSize, size_t shardSize, int compressionLevel):
+    m_directory(directory),
+    m_md5(romMD5),
+    m_chunk_size(chunkSize < 1 ? 1 : chunkSize),
+    m_shard_size(shardSize),
+    m_compression_level(compressionLevel),
+    m_observed(false),
+    m_skip_next(false),
+    m_height(0),
+    m_width(0),
+    m_steps(0),
+    m_shard_steps(0),
+    m_out(NULL),
+    m_offset(0),
+    m_shard_number(0),
+    m_failed(false),
+    m_shutdown(false) {
+
+    std::ostringstream name;
+    name << m_md5.substr(0, 8) << "-" << getpid() << "-" << s_writer_count++;
+    m_name = name.str();
+
+    m_encoder = std::thread(&DatasetWriter::encoderLoop, this);
+}
+
+DatasetWriter::~DatasetWriter() {
+
+    // Hand over the last steps; the encoder drains the queue before it stops
+    if (m_shard_steps > 0)
+        submit(true);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+    }
+    m_job_queued.notify_all();
+    m_encoder.join();
+}
+
+void DatasetWriter::observe(const ALEScreen &screen) {
+
+    if (m_skip_next)
+        return;
+
+    // A full chunk is handed over only now, so that truncate() can still mark its last step
+    bool endShard = m_shard_size > 0 && m_shard_steps >= m_shard_size;
+    if (endShard || m_chunk.steps >= m_chunk_size)
+        submit(endShard);
+    if (endShard)
+        m_shard_steps = 0;
+
+    if (m_height == 0) {
+        m_height = screen.height();
+        m_width = screen.width();
+    }
+
+    size_t frameSize = m_height * m_width;
+    if (m_chunk.observations.capacity() == 0)
+        m_chunk.observations.reserve(m_chunk_size * frameSize);
+    m_chunk.observations.resize((m_chunk.steps + 1) * frameSize);
+    memcpy(&m_chunk.observations[m_chunk.steps * frameSize], screen.getArray(), frameSize);
+    m_observed = true;
+}
+
+void DatasetWriter::addStep(Action action, reward_t reward, bool terminal, int lives) {
+
+    m_skip_next = false;
+    if (!m_observed)
+        return;
+    m_observed = false;
+
+    m_chunk.actions.push_back(action);
+    m_chunk.rewards.push_back(reward);
+    m_chunk.terminals.push_back(terminal ? DatasetChunk::Terminal : 0);
+    m_chunk.lives.push_back(lives);
+    m_chunk.steps++;
+    m_steps++;
+    m_shard_steps++;
+}
+
+void DatasetWriter::truncate(bool skipNext) {
+
+    if (m_chunk.steps > 0 && m_chunk.terminals[m_chunk.steps - 1] == 0)
+        m_chunk.terminals[m_chunk.steps - 1] = DatasetChunk::Truncated;
+    m_observed = false;
+    m_skip_next = skipNext;
+}
+
+void DatasetWriter::submit(bool endShard) {
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_queue.size() >= MaxQueuedChunks)
+        m_job_done.wait(lock);
+
+    m_queue.push_back(Job());
+    Job &job = m_queue.back();
+    std::swap(job.chunk, m_chunk);
+    job.endShard = endShard;
+
+    // Reuse the buffers of an encoded chunk rather than allocating new ones
+    if (!m_free_chunks.empty()) {
+        std::swap(m_chunk, m_free_chunks.back());
+        m_free_chunks.pop_back();
+    }
+    m_job_queued.notify_one();
+}
+
+void DatasetWriter::encoderLoop() {
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        while (m_queue.empty() && !m_shutdown)
+            m_job_queued.wait(lock);
+        if (m_queue.empty())
+            return;
+
+        Job job;
+        std::swap(job, m_queue.front());
+        m_queue.pop_front();
+        lock.unlock();
+
+        if (job.chunk.steps > 0)
+            writeChunk(job.chunk);
+        if (job.endShard)
+            finishShard();
+        job.chunk.clear();
+
+        lock.lock();
+        m_free_chunks.push_back(std::move(job.chunk));
+        m_job_done.notify_all();
+    }
+}
+
+void DatasetWriter::append(const void *data, size_t size) {
+
+    if (m_out == NULL)
+        return;
+    if (fwrite(data, 1, size, m_out) != size) {
+        ale::Logger::Error << "Error writing dataset shard " << m_shard_file
+                           << "; recording stopped" << std::endl;
+        fclose(m_out);
+        m_out = NULL;
+        m_failed = true;
+        return;
+    }
+    m_offset += size;
+}
+
+void DatasetWriter::writeChunk(const DatasetChunk &chunk) {
+
+    if (m_failed)
+        return;
+
+    if (m_out == NULL) {
+        std::ostringstream name;
+        name << m_name << "-" << m_shard_number++ << ".shard";
+        m_shard_file = name.str();
+
+        std::string path = m_directory + "/" + m_shard_file;
+        m_out = fopen(path.c_str(), "wb");
+        if (m_out == NULL) {
+            ale::Logger::Error << "Could not open " << path << " for writing" << std::endl;
+            m_failed = true;
+            return;
+        }
+        m_offset = 0;
+        m_chunk_offsets.clear();
+        m_chunk_steps.clear();
+
+        uInt8 header[HeaderSize];
+        memcpy(header, Magic, MagicSize);
+        putLE(header + 8, m_height, 2);
+        putLE(header + 10, m_width, 2);
+        memset(header + 12, '0', 32);
+        memcpy(header + 12, m_md5.data(), std::min<size_t>(m_md5.size(), 32));
+        append(header, HeaderSize);
+    }
+
+    m_chunk_offsets.push_back(m_offset);
+    m_chunk_steps.push_back(chunk.steps);
+
+    // Integer columns are stored little-endian whatever the host
+    std::vector<uInt8> rewards(4 * chunk.steps), lives(4 * chunk.steps);
+    for (size_t i = 0; i < chunk.steps; i++) {
+        putLE(&rewards[4 * i], (uInt32)chunk.rewards[i], 4);
+        putLE(&lives[4 * i], (uInt32)chunk.lives[i], 4);
+    }
+
+    const uInt8 *columns[5] = { &chunk.observations[0], &chunk.actions[0], &rewards[0],
+                                &chunk.terminals[0], &lives[0] };
+    // The chunk may end with the observation of a step which was never taken
+    size_t sizes[5] = { chunk.steps * m_height * m_width, chunk.steps, rewards.size(),
+                        chunk.steps, lives.size() };
+    for (int c = 0; c < 5; c++) {
+        // Screens are long runs of a few colours, which run-length matching finds at a
+        //  fraction of the cost of a full search
+        size_t compressedSize = deflateColumn(columns[c], sizes[c], m_compression_level,
+                                              c == 0 ? Z_RLE : Z_DEFAULT_STRATEGY, m_buffer);
+        append(&m_buffer[0], compressedSize);
+    }
+}
+
+void DatasetWriter::finishShard() {
+
+    if (m_out == NULL)
+        return;
+
+    unsigned long long tableOffset = m_offset;
+    size_t steps = 0;
+    std::vector<uInt8> table(m_chunk_offsets.size() * TableEntrySize + FooterSize);
+    for (size_t i = 0; i < m_chunk_offsets.size(); i++) {
+        putLE(&table[i * TableEntrySize], m_chunk_offsets[i], 8);
+        putLE(&table[i * TableEntrySize + 8], m_chunk_steps[i], 4);
+        steps += m_chunk_steps[i];
+    }
+    uInt8 *footer = &table[m_chunk_offsets.size() * TableEntrySize];
+    putLE(footer, tableOffset, 8);
+    putLE(footer + 8, m_chunk_offsets.size(), 4);
+    putLE(footer + 12, steps, 4);
+    memcpy(footer + 16, Trailer, MagicSize);
+    append(&table[0], table.size());
+    if (m_out == NULL)
+        return;
+    fclose(m_out);
+    m_out = NULL;
+
+    // One write per line, so that lines of concurrent writers don't interleave
+    std::ostringstream line;
+    line << m_shard_file << " " << steps << "\n";
+    std::string manifest = m_directory + "/manifest.txt";
+    int fd = open(manifest.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0 || write(fd, line.str().data(), line.str().size()) < 0)
+        ale::Logger::Error << "Could not add " << m_shard_file << " to " << manifest << std::endl;
+    if (fd >= 0)
+        close(fd);
+}
+
+DatasetShard::DatasetShard(const std::string &filename):
+    m_data(NULL),
+    m_size(0) {
+
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Couldn't open dataset shard " + filename);
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= HeaderSize + FooterSize) {
+        m_size = st.st_size;
+        void *region = mmap(NULL, m_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (region != MAP_FAILED)
+            m_data = (const char *)region;
+    }
+    close(fd);
+
+    if (m_data == NULL)
+        throw std::runtime_error("Couldn't map dataset shard " + filename);
+
+    const char *footer = m_data + m_size - FooterSize;
+    unsigned long long tableOffset = getLE(footer, 8);
+    m_num_chunks = getLE(footer + 8, 4);
+    m_steps = getLE(footer + 12, 4);
+    if (memcmp(m_data, Magic, MagicSize) != 0 || memcmp(footer + 16, Trailer, MagicSize) != 0 ||
+        tableOffset < HeaderSize ||
+        tableOffset + m_num_chunks * TableEntrySize != m_size - FooterSize) {
+        munmap((void *)m_data, m_size);
+        throw std::runtime_error("Not a finished dataset shard: " + filename);
+    }
+
+    m_table = m_data + tableOffset;
+    m_height = getLE(m_data + 8, 2);
+    m_width = getLE(m_data + 10, 2);
+    m_md5.assign(m_data + 12, 32);
+}
+
+DatasetShard::~DatasetShard() {
+    munmap((void *)m_data, m_size);
+}
+
+void DatasetShard::readChunk(size_t i, DatasetChunk &chunk) const {
+
+    if (i >= m_num_chunks)
+        throw std::out_of_range("No such chunk in the dataset shard");
+
+    const char *p = m_data + getLE(m_table + i * TableEntrySize, 8);
+    const char *end = i + 1 < m_num_chunks ?
+        m_data + getLE(m_table + (i + 1) * TableEntrySize, 8) : m_table;
+    size_t steps = getLE(m_table + i * TableEntrySize + 8, 4);
+
+    chunk.steps = steps;
+    chunk.observations.resize(steps * m_height * m_width);
+    chunk.actions.resize(steps);
+    chunk.terminals.resize(steps);
+    std::vector<uInt8> rewards(4 * steps), lives(4 * steps);
+
+    uInt8 *columns[5] = { &chunk.observations[0], &chunk.actions[0], &rewards[0],
+                          &chunk.terminals[0], &lives[0] };
+    size_t sizes[5] = { chunk.observations.size(), steps, rewards.size(), steps, lives.size() };
+    for (int c = 0; c < 5; c++) {
+        if (end < p || end - p < 4)
+            throw std::runtime_error("Corrupt dataset chunk");
+        size_t compressedSize = getLE(p, 4);
+        if ((size_t)(end - p - 4) < compressedSize)
+            throw std::runtime_error("Corrupt dataset chunk");
+
+        uLongf size = sizes[c];
+        if (uncompress(columns[c], &size, (const Bytef *)p + 4, compressedSize) != Z_OK ||
+            size != sizes[c])
+            throw std::runtime_error("Corrupt dataset chunk");
+        p += 4 + compressedSize;
+    }
+
+    chunk.rewards.resize(steps);
+    chunk.lives.resize(steps);
+    for (size_t j = 0; j < steps; j++) {
+        chunk.rewards[j] = (Int32)getLE((const char *)&rewards[4 * j], 4);
+        chunk.lives[j] = (Int32)getLE((const char *)&lives[4 * j], 4);
+    }
+}
+
+bool readDatasetManifest(const std::string &directory,
+                         std::vector<DatasetManifestEntry> &shards) {
+
+    shards.clear();
+    std::ifstream in((directory + "/manifest.txt").c_str());
+    if (!in)
+        return false;
+
+    DatasetManifestEntry entry;
+    while (in >> entry.filename >> entry.steps) {
+        entry.filename = directory + "/" + entry.filename;
+        shards.push_back(entry);
+    }
+    return true;
+}
@@ -0,0 +1,206 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  Dataset.hpp
+ *
+ *  Offline RL datasets: the observation, action, reward, terminal flag and
+ *  lives of every step, written straight from the environment into shards.
+ *  Observations are palette indices, a third of the size of RGB before
+ *  compression.
+ *
+ *  A dataset is a directory of shards, listed in manifest.txt, one line per
+ *  finished shard: its file name and number of steps. Writers name their
+ *  shards uniquely and append to the manifest with single writes, so that many
+ *  of them (threads or processes) may fill one directory.
+ *
+ *  Each shard stores steps in chunks, column by column, each column zlib-
+ *  compressed on its own. All integers are little-endian:
+ *
+ *    "ALESHD01"                  magic and version
+ *    uInt16 height, width        of the observations
+ *    char   md5[32]              MD5 of the ROM, in hexadecimal
+ *    per chunk of n steps, five columns, each an uInt32 size then the zlib
+ *    compression of:
+ *      uInt8  observations[n][height][width]   the screen before the step
+ *      uInt8  actions[n]                       player A's action
+ *      Int32  rewards[n]
+ *      uInt8  terminals[n]                     1 if the step ended the episode, 2 if
+ *                                              it was truncated (the next step starts
+ *                                              from another state), else 0
+ *      Int32  lives[n]                         lives left after the step
+ *    per chunk: uInt64 offset, uInt32 n
+ *    uInt64 offset of the chunk table
+ *    uInt32 number of chunks
+ *    uInt32 number of steps
+ *    "ALESHEND"
+ *
+ **************************************************************************** */
+
+#ifndef __DATASET_HPP__
+#define __DATASET_HPP__
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "Constants.h"
+#include "../environment/ale_screen.hpp"
+
+/** The columns of a chunk of steps. */
+struct DatasetChunk {
+    size_t steps;
+    std::vector<pixel_t> observations;
+    std::vector<uInt8> actions;
+    std::vector<Int32> rewards;
+    std::vector<uInt8> terminals;
+    std::vector<Int32> lives;
+
+    /** Flags of the terminals column. */
+    enum { Terminal = 1, Truncated = 2 };
+
+    DatasetChunk(): steps(0) {}
+
+    /** Empties the chunk, keeping its memory. */
+    void clear();
+};
+
+class DatasetWriter {
+
+    public:
+
+        /** Creates a writer adding shards of shardSize steps (0: a single shard) to the
+            dataset in the given directory, which must exist. Chunks of chunkSize steps are
+            compressed at the given zlib level by a background thread. */
+        DatasetWriter(const std::string &directory, const std::string &romMD5,
+                      size_t chunkSize, size_t shardSize, int compressionLevel);
+
+        /** Writes the remaining steps and finishes the last shard. */
+        ~DatasetWriter();
+
+        /** Sets the observation of the next step, i.e. the screen it starts from. */
+        void observe(const ALEScreen &screen);
+
+        /** Adds a step, from the last observation. */
+        void addStep(Action action, reward_t reward, bool terminal, int lives);
+
+        /** Marks the last step, unless terminal, as truncated, when the environment jumps to
+            another state. With skipNext, the next step is left out: the screen it would be
+            observed from is the one shown before the jump. */
+        void truncate(bool skipNext);
+
+        /** Number of steps added so far. */
+        size_t size() const { return m_steps; }
+
+    private:
+
+        /** A chunk handed to the encoder, which finishes the shard after it if asked. */
+        struct Job {
+            DatasetChunk chunk;
+            bool endShard;
+        };
+
+        /** Queues the current chunk for encoding, waiting for room if needed. */
+        void submit(bool endShard);
+
+        /** Background encoder loop. */
+        void encoderLoop();
+
+        /** Compresses and writes a chunk, opening a shard if none is open. */
+        void writeChunk(const DatasetChunk &chunk);
+
+        /** Writes the chunk table and lists the shard in the manifest. */
+        void finishShard();
+
+        void append(const void *data, size_t size);
+
+        std::string m_directory;
+        std::string m_md5;
+        std::string m_name;                  // Unique prefix of our shard files
+        size_t m_chunk_size;
+        size_t m_shard_size;
+        int m_compression_level;
+
+        DatasetChunk m_chunk;                // The chunk being filled
+        bool m_observed;                     // Whether m_chunk holds the next observation
+        bool m_skip_next;                    // Whether to leave out the next step
+        size_t m_height, m_width;
+        size_t m_steps;
+        size_t m_shard_steps;                // Steps added to the current shard
+
+        /** The shard being written; only the encoder touches it. */
+        FILE *m_out;
+        std::string m_shard_file;
+        unsigned long long m_offset;
+        std::vector<unsigned long long> m_chunk_offsets;
+        std::vector<uInt32> m_chunk_steps;
+        int m_shard_number;
+        bool m_failed;                       // Whether writing failed, dropping further steps
+        std::vector<uInt8> m_buffer;
+
+        /** Background encoding; the queue and flags are guarded by m_mutex. */
+        std::thread m_encoder;
+        std::mutex m_mutex;
+        std::condition_variable m_job_queued;
+        std::condition_variable m_job_done;
+        std::deque<Job> m_queue;
+        std::vector<DatasetChunk> m_free_chunks;   // Recycled column buffers
+        bool m_shutdown;
+};
+
+/** A memory-mapped shard, whose chunks are decompressed on demand. */
+class DatasetShard {
+
+    public:
+
+        /** Maps the given shard. Throws std::runtime_error if it can't be read or is not a
+            finished shard. */
+        explicit DatasetShard(const std::string &filename);
+        ~DatasetShard();
+
+        size_t height() const { return m_height; }
+        size_t width() const { return m_width; }
+        const std::string &romMD5() const { return m_md5; }
+
+        /** Number of steps and of chunks. */
+        size_t size() const { return m_steps; }
+        size_t numChunks() const { return m_num_chunks; }
+
+        /** Decompresses the i-th chunk. Throws std::out_of_range if there is none, or
+            std::runtime_error if it is corrupt. */
+        void readChunk(size_t i, DatasetChunk &chunk) const;
+
+    private:
+
+        DatasetShard(const DatasetShard &);
+        DatasetShard &operator=(const DatasetShard &);
+
+        const char *m_data;
+        size_t m_size;
+        const char *m_table;
+        size_t m_num_chunks, m_steps;
+        size_t m_height, m_width;
+        std::string m_md5;
+};
+
+/** The shards listed in a dataset's manifest. */
+struct DatasetManifestEntry {
+    std::string filename;   // Path of the shard
+    size_t steps;
+};
+
+/** Reads the manifest of the dataset in the given directory; returns false if there is
+    none. */
+bool readDatasetManifest(const std::string &directory,
+                         std::vector<DatasetManifestEntry> &shards);
+
+#endif // __DATASET_HPP__
@@ -0,0 +1,184 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  Fingerprint.cpp
+ *
+ *  64-bit fingerprints of screens, RAM and states.
+ *
+ **************************************************************************** */
+
+#include "Fingerprint.hpp"
+#include <cstring>
+
+// XXH64 constants
+static const fingerprint_t Prime1 = 0x9E3779B185EBCA87ULL;
+static const fingerprint_t Prime2 = 0xC2B2AE3D27D4EB4FULL;
+static const fingerprint_t Prime3 = 0x165667B19E3779F9ULL;
+static const fingerprint_t Prime4 = 0x85EBCA77C2B2AE63ULL;
+static const fingerprint_t Prime5 = 0x27D4EB2F165667C5ULL;
+
+static inline fingerprint_t rotl(fingerprint_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline fingerprint_t read64(const unsigned char *p) {
+    fingerprint_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline fingerprint_t read32(const unsigned char *p) {
+    unsigned int v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline fingerprint_t round64(fingerprint_t acc, fingerprint_t input) {
+    acc += input * Prime2;
+    acc = rotl(acc, 31);
+    return acc * Prime1;
+}
+
+static inline fingerprint_t mergeRound(fingerprint_t acc, fingerprint_t val) {
+    acc ^= round64(0, val);
+    return acc * Prime1 + Prime4;
+}
+
+fingerprint_t fingerprintBytes(const void *data, size_t size, fingerprint_t seed) {
+
+    const unsigned char *p = (const unsigned char *)data;
+    const unsigned char *end = p + size;
+    fingerprint_t h;
+
+    if (size >= 32) {
+        // Four independent lanes, which the CPU keeps in flight together
+        fingerprint_t v1 = seed + Prime1 + Prime2;
+        fingerprint_t v2 = seed + Prime2;
+        fingerprint_t v3 = seed;
+        fingerprint_t v4 = seed - Prime1;
+        const unsigned char *limit = end - 32;
+        do {
+            v1 = round64(v1, read64(p));
+            v2 = round64(v2, read64(p + 8));
+            v3 = round64(v3, read64(p + 16));
+            v4 = round64(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = mergeRound(h, v1);
+        h = mergeRound(h, v2);
+        h = mergeRound(h, v3);
+        h = mergeRound(h, v4);
+    }
+    else
+        h = seed + Prime5;
+
+    h += size;
+
+    for (; p + 8 <= end; p += 8) {
+        h ^= round64(0, read64(p));
+        h = rotl(h, 27) * Prime1 + Prime4;
+    }
+    if (p + 4 <= end) {
+        h ^= read32(p) * Prime1;
+        h = rotl(h, 23) * Prime2 + Prime3;
+        p += 4;
+    }
+    for (; p < end; p++) {
+        h ^= (*p) * Prime5;
+        h = rotl(h, 11) * Prime1;
+    }
+
+    // Final avalanche
+    h ^= h >> 33;
+    h *= Prime2;
+    h ^= h >> 29;
+    h *= Prime3;
+    h ^= h >> 32;
+    return h;
+}
+
+// A screen's fingerprint is that of its row fingerprints, so that it can be updated
+//  incrementally
+static fingerprint_t combineRows(const std::vector<fingerprint_t> &rows, int width) {
+    return fingerprintBytes(&rows[0], rows.size() * sizeof(fingerprint_t), width);
+}
+
+fingerprint_t fingerprintPixels(const unsigned char *pixels, int height, int width) {
+
+    std::vector<fingerprint_t> rows(height);
+    for (int y = 0; y < height; y++)
+        rows[y] = fingerprintBytes(pixels + y * width, width, y);
+    return combineRows(rows, width);
+}
+
+fingerprint_t fingerprintCells(const unsigned char *pixels, int height, int width,
+                               int rows, int columns, int levels) {
+
+    if (rows <= 0 || columns <= 0 || rows > height || columns > width || levels <= 0)
+        return 0;
+
+    // Sum the luminance of each block; NTSC palette indices keep it in bits 1-3
+    std::vector<unsigned int> sums(rows * columns, 0);
+    std::vector<int> columnCell(width);
+    for (int x = 0; x < width; x++)
+        columnCell[x] = x * columns / width;
+
+    for (int y = 0; y < height; y++) {
+        unsigned int *rowSums = &sums[(y * rows / height) * columns];
+        const unsigned char *row = pixels + y * width;
+        for (int x = 0; x < width; x++)
+            rowSums[columnCell[x]] += (row[x] >> 1) & 0x7;
+    }
+
+    // Quantize each block's average luminance (0 to 7) into levels values
+    std::vector<unsigned char> cells(rows * columns);
+    for (int r = 0; r < rows; r++) {
+        int blockHeight = (r + 1) * height / rows - r * height / rows;
+        for (int c = 0; c < columns; c++) {
+            int blockWidth = (c + 1) * width / columns - c * width / columns;
+            unsigned long long scaled = (unsigned long long)sums[r * columns + c] * levels;
+            cells[r * columns + c] = (unsigned char)(scaled / (8ULL * blockHeight * blockWidth));
+        }
+    }
+
+    fingerprint_t shape = ((fingerprint_t)rows << 40) | ((fingerprint_t)columns << 20) | levels;
+    return fingerprintBytes(&cells[0], cells.size(), shape);
+}
+
+ScreenFingerprinter::ScreenFingerprinter():
+    m_height(0),
+    m_width(0) {
+}
+
+fingerprint_t ScreenFingerprinter::update(const unsigned char *pixels, int height, int width) {
+
+    if (height != m_height || width != m_width) {
+        m_height = height;
+        m_width = width;
+        m_pixels.assign(pixels, pixels + height * width);
+        m_rows.resize(height);
+        for (int y = 0; y < height; y++)
+            m_rows[y] = fingerprintBytes(pixels + y * width, width, y);
+    }
+    else {
+        for (int y = 0; y < height; y++) {
+            const unsigned char *row = pixels + y * width;
+            unsigned char *previous = &m_pixels[y * width];
+            if (memcmp(row, previous, width) != 0) {
+                memcpy(previous, row, width);
+                m_rows[y] = fingerprintBytes(row, width, y);
+            }
+        }
+    }
+
+    return combineRows(m_rows, width);
+}
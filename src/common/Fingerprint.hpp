@@ -0,0 +1,59 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  Fingerprint.hpp
+ *
+ *  64-bit fingerprints of screens, RAM and states, for deduplication and
+ *  novelty search. Fingerprints are XXH64 hashes; they are stable across runs
+ *  and across little-endian hosts, but are not cryptographic.
+ *
+ **************************************************************************** */
+
+#ifndef __FINGERPRINT_HPP__
+#define __FINGERPRINT_HPP__
+
+#include <cstddef>
+#include <vector>
+
+typedef unsigned long long fingerprint_t;
+
+/** Hashes size bytes. */
+fingerprint_t fingerprintBytes(const void *data, size_t size, fingerprint_t seed = 0);
+
+/** Fingerprints a screen of palette indices, row by row. This is ALEScreen::fingerprint(). */
+fingerprint_t fingerprintPixels(const unsigned char *pixels, int height, int width);
+
+/** Fingerprints a coarse "cell" view of a screen: the screen is divided into rows x columns
+    blocks, and the average luminance of each block is quantized to levels values. Screens
+    which differ only in small details share a cell. This is ALEScreen::cellFingerprint(). */
+fingerprint_t fingerprintCells(const unsigned char *pixels, int height, int width,
+                               int rows, int columns, int levels);
+
+/** Fingerprints successive screens, rehashing only the rows which changed since the previous
+    screen. Returns the same values as fingerprintPixels(). */
+class ScreenFingerprinter {
+
+    public:
+
+        ScreenFingerprinter();
+
+        /** Fingerprints the given screen, which usually follows the previous one. */
+        fingerprint_t update(const unsigned char *pixels, int height, int width);
+
+    private:
+
+        int m_height, m_width;
+
+        /** The previous screen and the fingerprint of each of its rows. */
+        std::vector<unsigned char> m_pixels;
+        std::vector<fingerprint_t> m_rows;
+};
+
+#endif // __FINGERPRINT_HPP__
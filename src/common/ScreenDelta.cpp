@@ -0,0 +1,218 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  ScreenDelta.cpp
+ *
+ *  Encodes successive screens as the spans of pixels that changed since the
+ *  previous one, with periodic keyframes.
+ **************************************************************************** */
+
+#include "ScreenDelta.hpp"
+#include <algorithm>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Unchanged gaps shorter than this are sent rather than starting a new span, which
+//  would cost a 4-byte span header
+static const int MinSpanGap = 4;
+
+static inline uInt8* putLE16(uInt8 *p, unsigned v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    return p + 2;
+}
+
+static inline unsigned getLE16(const uInt8 *p) {
+    return p[0] | (p[1] << 8);
+}
+
+// Index of the lowest set bit; v must be non-zero
+static inline int lowestBit(uInt32 v) {
+#if defined(__GNUC__)
+    return __builtin_ctz(v);
+#else
+    int n = 0;
+    while (!(v & 1)) { v >>= 1; n++; }
+    return n;
+#endif
+}
+
+ScreenDeltaEncoder::ScreenDeltaEncoder(int height, int width, int keyframeInterval):
+    m_height(height),
+    m_width(width),
+    m_keyframe_interval(keyframeInterval),
+    m_frames_since_keyframe(-1),
+    m_reference(height * width, 0),
+    m_changed((width + 31) / 32, 0) {
+}
+
+bool ScreenDeltaEncoder::diffRow(const pixel_t *row, const pixel_t *reference) {
+
+    int words = m_changed.size();
+    int fullWords = m_width / 32;
+    uInt32 any = 0;
+
+    int w = 0;
+#ifdef __SSE2__
+    // 32 pixels at a time: two 16-byte compares, each yielding one bit per pixel
+    for (; w < fullWords; w++) {
+        const __m128i *a = (const __m128i *)(row + 32 * w);
+        const __m128i *b = (const __m128i *)(reference + 32 * w);
+        uInt32 lo = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(a), _mm_loadu_si128(b)));
+        uInt32 hi = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(a + 1),
+                                                     _mm_loadu_si128(b + 1)));
+        uInt32 changed = ~(lo | (hi << 16));
+        m_changed[w] = changed;
+        any |= changed;
+    }
+#endif
+    for (; w < words; w++) {
+        uInt32 changed = 0;
+        int end = std::min(32, m_width - 32 * w);
+        for (int i = 0; i < end; i++)
+            changed |= (uInt32)(row[32 * w + i] != reference[32 * w + i]) << i;
+        m_changed[w] = changed;
+        any |= changed;
+    }
+
+    return any != 0;
+}
+
+int ScreenDeltaEncoder::findPixel(int x, bool changed) const {
+
+    while (x < m_width) {
+        uInt32 bits = changed ? m_changed[x / 32] : ~m_changed[x / 32];
+        bits >>= x % 32;
+        if (bits != 0)
+            return std::min(m_width, x + lowestBit(bits));
+        x = (x / 32 + 1) * 32;
+    }
+
+    return m_width;
+}
+
+bool ScreenDeltaEncoder::encode(const pixel_t *pixels, std::vector<uInt8> &out) {
+
+    size_t numPixels = m_height * m_width;
+    size_t start = out.size();
+
+    bool keyframe = m_frames_since_keyframe < 0 ||
+        (m_keyframe_interval > 0 && m_frames_since_keyframe + 1 >= m_keyframe_interval);
+
+    if (!keyframe) {
+        size_t maskBytes = (m_height + 7) / 8;
+        out.resize(start + 1 + maskBytes, 0);
+        out[start] = DELTA;
+
+        for (int y = 0; y < m_height; y++) {
+            const pixel_t *row = pixels + y * m_width;
+            pixel_t *reference = &m_reference[y * m_width];
+            if (!diffRow(row, reference))
+                continue;
+            out[start + 1 + y / 8] |= 1 << (y % 8);
+
+            // Reserve the span count, then append spans as the change bits are scanned
+            size_t countPos = out.size();
+            out.resize(countPos + 2);
+            unsigned spans = 0;
+
+            int x = findPixel(0, true);
+            while (x < m_width) {
+                // Extend the span over changed pixels and short unchanged gaps
+                int spanStart = x, spanEnd;
+                while (true) {
+                    spanEnd = findPixel(x, false);
+                    x = findPixel(spanEnd, true);
+                    if (x >= m_width || x - spanEnd >= MinSpanGap)
+                        break;
+                }
+
+                size_t pos = out.size();
+                out.resize(pos + 4 + (spanEnd - spanStart));
+                uInt8 *p = putLE16(&out[pos], spanStart);
+                p = putLE16(p, spanEnd - spanStart);
+                memcpy(p, row + spanStart, spanEnd - spanStart);
+                spans++;
+            }
+            putLE16(&out[countPos], spans);
+            memcpy(reference, row, m_width);
+
+            // A delta of a thoroughly changed screen can outgrow the keyframe
+            if (out.size() - start >= 1 + numPixels)
+                break;
+        }
+
+        if (out.size() - start < 1 + numPixels) {
+            m_frames_since_keyframe++;
+            return false;
+        }
+        out.resize(start);
+    }
+
+    out.resize(start + 1 + numPixels);
+    out[start] = KEYFRAME;
+    memcpy(&out[start + 1], pixels, numPixels);
+    memcpy(&m_reference[0], pixels, numPixels);
+    m_frames_since_keyframe = 0;
+    return true;
+}
+
+ScreenDeltaDecoder::ScreenDeltaDecoder(int height, int width):
+    m_height(height),
+    m_width(width),
+    m_valid(false),
+    m_screen(height * width, 0) {
+}
+
+bool ScreenDeltaDecoder::decode(const uInt8 *data, size_t size) {
+
+    size_t numPixels = m_height * m_width;
+    if (size < 1)
+        return m_valid = false;
+
+    if (data[0] == ScreenDeltaEncoder::KEYFRAME) {
+        if (size != 1 + numPixels)
+            return m_valid = false;
+        memcpy(&m_screen[0], data + 1, numPixels);
+        return m_valid = true;
+    }
+
+    size_t maskBytes = (m_height + 7) / 8;
+    if (data[0] != ScreenDeltaEncoder::DELTA || !m_valid || size < 1 + maskBytes)
+        return m_valid = false;
+
+    const uInt8 *mask = data + 1;
+    const uInt8 *p = mask + maskBytes;
+    const uInt8 *end = data + size;
+    for (int y = 0; y < m_height; y++) {
+        if (!(mask[y / 8] & (1 << (y % 8))))
+            continue;
+        if (end - p < 2)
+            return m_valid = false;
+        unsigned spans = getLE16(p);
+        p += 2;
+
+        for (unsigned s = 0; s < spans; s++) {
+            if (end - p < 4)
+                return m_valid = false;
+            unsigned x = getLE16(p), length = getLE16(p + 2);
+            p += 4;
+            if (x + length > (unsigned)m_width || (size_t)(end - p) < length)
+                return m_valid = false;
+            memcpy(&m_screen[y * m_width + x], p, length);
+            p += length;
+        }
+    }
+
+    return m_valid = (p == end);
+}
@@ -0,0 +1,98 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  ScreenDelta.hpp
+ *
+ *  Encodes successive screens as the spans of pixels that changed since the
+ *  previous one, with periodic keyframes. Consecutive Atari frames usually
+ *  differ in a handful of rows, so this is typically an order of magnitude
+ *  smaller than sending every pixel.
+ *
+ *  Each encoded screen starts with a kind byte. All integers are little-endian:
+ *
+ *    0 (keyframe): height * width bytes of row-major pixel values
+ *    1 (delta):    ceil(height / 8) bytes of row bitmask (bit r % 8 of byte
+ *                  r / 8 is set if row r changed), then for every changed row:
+ *                  uInt16 number of spans, and for each span uInt16 start
+ *                  column, uInt16 length, then length pixel values
+ *
+ **************************************************************************** */
+
+#ifndef __SCREEN_DELTA_HPP__
+#define __SCREEN_DELTA_HPP__
+
+#include <cstddef>
+#include <vector>
+#include "../emucore/m6502/src/bspf/src/bspf.hxx"
+#include "../environment/ale_screen.hpp"
+
+class ScreenDeltaEncoder {
+
+    public:
+
+        enum Kind { KEYFRAME = 0, DELTA = 1 };
+
+        /** Creates an encoder for screens of the given size, emitting a keyframe every
+            keyframeInterval screens (0: only the first one). */
+        ScreenDeltaEncoder(int height, int width, int keyframeInterval);
+
+        /** Appends the encoding of the given screen, relative to the previously encoded one,
+            to out. Returns true if a keyframe was written. */
+        bool encode(const pixel_t *pixels, std::vector<uInt8> &out);
+
+        /** Makes the next screen a keyframe, e.g. when the receiver lost track. */
+        void forceKeyframe() { m_frames_since_keyframe = -1; }
+
+    private:
+
+        /** Marks the pixels of the given row which differ from the reference, one bit per
+            pixel, in m_changed. Returns false if the row is unchanged. */
+        bool diffRow(const pixel_t *row, const pixel_t *reference);
+
+        /** The first column from x on whose pixel changed (or did not), or the width. */
+        int findPixel(int x, bool changed) const;
+
+        int m_height, m_width;
+        int m_keyframe_interval;
+
+        /** Screens encoded since the last keyframe, or -1 if the next one must be a
+            keyframe. */
+        int m_frames_since_keyframe;
+
+        /** The last encoded screen. */
+        std::vector<pixel_t> m_reference;
+
+        /** Per-pixel change bits of the current row, 32 pixels per word. */
+        std::vector<uInt32> m_changed;
+};
+
+class ScreenDeltaDecoder {
+
+    public:
+
+        /** Creates a decoder for screens of the given size. */
+        ScreenDeltaDecoder(int height, int width);
+
+        /** Applies one encoded screen. Returns false if it is malformed, or a delta which
+            does not follow a keyframe; the screen is then unreliable until the next
+            keyframe. */
+        bool decode(const uInt8 *data, size_t size);
+
+        /** The current screen, row by row. */
+        const pixel_t *pixels() const { return &m_screen[0]; }
+
+    private:
+
+        int m_height, m_width;
+        bool m_valid;
+        std::vector<pixel_t> m_screen;
+};
+
+#endif // __SCREEN_DELTA_HPP__
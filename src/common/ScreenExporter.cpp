@@ -23,7 +23,9 @@
 // MGB: These methods originally belonged to ExportScreen. Possibly these should be returned to 
 // their own class, rather than be static methods. They are here to avoid exposing the gritty 
 // details of PNG generation. 
-static void writePNGChunk(std::ofstream& out, const char* type, uInt8* data, int size) {
+// The PNG is assembled in memory and written with a single call, so that encoder threads
+// spend their time compressing rather than in stream overhead.
+static void writePNGChunk(std::string& out, const char* type, const uInt8* data, int size) {
 
     // Stuff the length/type into the buffer
     uInt8 temp[8];
@@ -37,13 +39,13 @@ static void writePNGChunk(std::ofstream& out, const char* type, uInt8* data, int
     temp[7] = type[3];
 
     // Write the header
-    out.write((const char*)temp, 8);
+    out.append((const char*)temp, 8);
 
     // Append the actual data
     uInt32 crc = crc32(0, temp + 4, 4);
     if(size > 0)
     {
-        out.write((const char*)data, size);
+        out.append((const char*)data, size);
         crc = crc32(crc, data, size);
     }
 
@@ -52,17 +54,15 @@ static void writePNGChunk(std::ofstream& out, const char* type, uInt8* data, int
     temp[1] = crc >> 16;
     temp[2] = crc >> 8;
     temp[3] = crc;
-    out.write((const char*)temp, 4);
+    out.append((const char*)temp, 4);
 }
 
 
-static void writePNGHeader(std::ofstream& out, const ALEScreen &screen, bool doubleWidth = true) {
+static void writePNGHeader(std::string& out, int height, int width, bool indexed) {
 
-        int width = doubleWidth ? screen.width() * 2: screen.width();
-        int height = screen.height();
         // PNG file header
         uInt8 header[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
-        out.write((const char*)header, sizeof(header));
+        out.append((const char*)header, sizeof(header));
 
         // PNG IHDR
         uInt8 ihdr[13];
@@ -74,8 +74,8 @@ static void writePNGHeader(std::ofstream& out, const ALEScreen &screen, bool dou
         ihdr[5]  = (height >> 16) & 0xFF;
         ihdr[6]  = (height >>  8) & 0xFF;
         ihdr[7]  = (height >>  0) & 0xFF;
-        ihdr[8]  = 8;  // 8 bits per sample (24 bits per pixel)
-        ihdr[9]  = 2;  // PNG_COLOR_TYPE_RGB
+        ihdr[8]  = 8;  // 8 bits per sample (24 bits per RGB pixel, 8 per indexed pixel)
+        ihdr[9]  = indexed ? 3 : 2;  // PNG_COLOR_TYPE_PALETTE : PNG_COLOR_TYPE_RGB
         ihdr[10] = 0;  // PNG_COMPRESSION_TYPE_DEFAULT
         ihdr[11] = 0;  // PNG_FILTER_TYPE_DEFAULT
         ihdr[12] = 0;  // PNG_INTERLACE_NONE
@@ -83,50 +83,76 @@ static void writePNGHeader(std::ofstream& out, const ALEScreen &screen, bool dou
 }
 
 
-static void writePNGData(std::ofstream &out, const ALEScreen &screen, const ColourPalette &palette, bool doubleWidth = true) {
+static void writePNGPalette(std::string& out, const uInt32 *palette) {
+
+    // PLTE: all 256 entries, so that pixel values can be stored as-is
+    uInt8 plte[256 * 3];
+    for (int i = 0; i < 256; i++) {
+        uInt32 rgb = palette[i];
+        plte[i * 3 + 0] = (rgb >> 16) & 0xFF;
+        plte[i * 3 + 1] = (rgb >>  8) & 0xFF;
+        plte[i * 3 + 2] = (rgb >>  0) & 0xFF;
+    }
+    writePNGChunk(out, "PLTE", plte, sizeof(plte));
+}
+
+
+static void writePNGData(std::string &out, const pixel_t *pixels, int height, int dataWidth,
+                         const uInt32 *palette, bool indexed, int level,
+                         bool doubleWidth = true) {
 
-    int dataWidth = screen.width(); 
     int width = doubleWidth ? dataWidth * 2 : dataWidth; 
-    int height = screen.height();
    
     // If so desired, double the width
 
     // Fill the buffer with scanline data
-    int rowbytes = width * 3;
+    int bytesPerPixel = indexed ? 1 : 3;
+    int rowbytes = width * bytesPerPixel;
 
     std::vector<uInt8> buffer((rowbytes + 1) * height, 0);
     uInt8* buf_ptr = &buffer[0];
 
     for(int i = 0; i < height; i++) {
         *buf_ptr++ = 0;                  // first byte of row is filter type
-        for(int j = 0; j < dataWidth; j++) {
-            int r, g, b;
-
-            palette.getRGB(screen.getArray()[i * dataWidth + j], r, g, b);
-            // Double the pixel width, if so desired
-            int jj = doubleWidth ? 2 * j : j;
-
-            buf_ptr[jj * 3 + 0] = r;
-            buf_ptr[jj * 3 + 1] = g;
-            buf_ptr[jj * 3 + 2] = b;
-            
-            if (doubleWidth) {
-                
-                jj = jj + 1;
+        const pixel_t *row = pixels + i * dataWidth;
+        if (indexed) {
+            for(int j = 0; j < dataWidth; j++) {
+                if (doubleWidth) {
+                    buf_ptr[2 * j] = buf_ptr[2 * j + 1] = row[j];
+                }
+                else
+                    buf_ptr[j] = row[j];
+            }
+        }
+        else {
+            for(int j = 0; j < dataWidth; j++) {
+                uInt32 rgb = palette[row[j]];
+                int r = (rgb >> 16) & 0xFF, g = (rgb >> 8) & 0xFF, b = rgb & 0xFF;
+                // Double the pixel width, if so desired
+                int jj = doubleWidth ? 2 * j : j;
 
                 buf_ptr[jj * 3 + 0] = r;
                 buf_ptr[jj * 3 + 1] = g;
                 buf_ptr[jj * 3 + 2] = b;
+            
+                if (doubleWidth) {
+                
+                    jj = jj + 1;
+
+                    buf_ptr[jj * 3 + 0] = r;
+                    buf_ptr[jj * 3 + 1] = g;
+                    buf_ptr[jj * 3 + 2] = b;
+                }
             }
         }
         buf_ptr += rowbytes;                 // add pitch
     }
 
     // Compress the data with zlib
-    uLongf compmemsize = (uLongf)((height * (width + 1) * 3 + 1) + 12);
+    uLongf compmemsize = compressBound(buffer.size());
     std::vector<uInt8> compmem(compmemsize, 0);
     
-    if((compress(&compmem[0], &compmemsize, &buffer[0], height * (width * 3 + 1)) != Z_OK)) {
+    if((compress2(&compmem[0], &compmemsize, &buffer[0], buffer.size(), level) != Z_OK)) {
 
         // @todo -- throw a proper exception
         ale::Logger::Error << "Error: Couldn't compress PNG" << std::endl;
@@ -138,46 +164,112 @@ static void writePNGData(std::ofstream &out, const ALEScreen &screen, const Colo
 }
 
 
-static void writePNGEnd(std::ofstream &out) {
+static void writePNGEnd(std::string &out) {
 
     // Finish up
     writePNGChunk(out, "IEND", 0, 0);
 }
 
 ScreenExporter::ScreenExporter(ColourPalette &palette):
-    m_palette(palette),
     m_frame_number(0),
-    m_frame_field_width(6) {
+    m_frame_field_width(6),
+    m_indexed(false),
+    m_compression_level(Z_DEFAULT_COMPRESSION),
+    m_max_queued(0),
+    m_num_encoding(0),
+    m_shutdown(false) {
+
+    copyPalette(palette);
 }
 
 
 ScreenExporter::ScreenExporter(ColourPalette &palette, const std::string &path):
-    m_palette(palette),
     m_frame_number(0),
     m_frame_field_width(6),
-    m_path(path) {
+    m_path(path),
+    m_indexed(false),
+    m_compression_level(Z_DEFAULT_COMPRESSION),
+    m_max_queued(0),
+    m_num_encoding(0),
+    m_shutdown(false) {
+
+    copyPalette(palette);
 }
 
 
-void ScreenExporter::save(const ALEScreen &screen, const std::string &filename) const {
+ScreenExporter::ScreenExporter(ColourPalette &palette, const std::string &path,
+                               int num_threads, size_t max_queued):
+    m_frame_number(0),
+    m_frame_field_width(6),
+    m_path(path),
+    m_indexed(false),
+    m_compression_level(Z_DEFAULT_COMPRESSION),
+    m_max_queued(max_queued < 1 ? 1 : max_queued),
+    m_num_encoding(0),
+    m_shutdown(false) {
+
+    copyPalette(palette);
+    for (int i = 0; i < num_threads; i++)
+        m_encoders.push_back(std::thread(&ScreenExporter::encoderLoop, this));
+}
+
+
+ScreenExporter::~ScreenExporter() {
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+    }
+    m_frame_queued.notify_all();
+
+    // Encoders drain the queue before they stop
+    for (size_t i = 0; i < m_encoders.size(); i++)
+        m_encoders[i].join();
+}
+
+
+void ScreenExporter::copyPalette(const ColourPalette &palette) {
+
+    for (int i = 0; i < 256; i++)
+        m_palette[i] = palette.getRGB(i);
+}
+
+
+void ScreenExporter::write(const Frame &frame) const {
+
+    std::string png;
+    writePNGHeader(png, frame.height, frame.width * 2, m_indexed);
+    if (m_indexed)
+        writePNGPalette(png, m_palette);
+    writePNGData(png, &frame.pixels[0], frame.height, frame.width, m_palette, m_indexed,
+                 m_compression_level, true);
+    writePNGEnd(png);
 
     // Open file for writing 
-    std::ofstream out(filename.c_str(), std::ios_base::binary);
+    std::ofstream out(frame.filename.c_str(), std::ios_base::binary);
     if (!out.good()) {
         
         // @todo exception
-        ale::Logger::Error << "Could not open " << filename << " for writing" << std::endl;
+        ale::Logger::Error << "Could not open " << frame.filename << " for writing" << std::endl;
         return;
     }
 
-    // Now write the PNG proper
-    writePNGHeader(out, screen, true);
-    writePNGData(out, screen, m_palette, true);
-    writePNGEnd(out);
-
+    out.write(png.data(), png.size());
     out.close();
 }
 
+
+void ScreenExporter::save(const ALEScreen &screen, const std::string &filename) const {
+
+    Frame frame;
+    frame.pixels.assign(screen.getArray(), screen.getArray() + screen.height() * screen.width());
+    frame.height = screen.height();
+    frame.width = screen.width();
+    frame.filename = filename;
+
+    write(frame);
+}
+
 void ScreenExporter::saveNext(const ALEScreen &screen) {
 
     // Must have specified a directory. 
@@ -191,10 +283,64 @@ void ScreenExporter::saveNext(const ALEScreen &screen) {
     oss << m_path << "/" << 
         std::setw(m_frame_field_width) << std::setfill('0') << m_frame_number << ".png";
 
+    m_frame_number++;
+
     // Save the png
-    save(screen, oss.str());
+    if (m_encoders.empty()) {
+        save(screen, oss.str());
+        return;
+    }
 
-    m_frame_number++;
+    // Otherwise hand a copy of the raw frame to the encoders, waiting for room if needed
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_queue.size() >= m_max_queued)
+        m_frame_done.wait(lock);
+
+    m_queue.push_back(Frame());
+    Frame &frame = m_queue.back();
+    if (!m_free_buffers.empty()) {
+        frame.pixels.swap(m_free_buffers.back());
+        m_free_buffers.pop_back();
+    }
+    frame.pixels.assign(screen.getArray(), screen.getArray() + screen.height() * screen.width());
+    frame.height = screen.height();
+    frame.width = screen.width();
+    frame.filename = oss.str();
+
+    lock.unlock();
+    m_frame_queued.notify_one();
 }
 
+void ScreenExporter::flush() {
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_queue.empty() || m_num_encoding > 0)
+        m_frame_done.wait(lock);
+}
 
+void ScreenExporter::encoderLoop() {
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        while (m_queue.empty() && !m_shutdown)
+            m_frame_queued.wait(lock);
+        if (m_queue.empty())
+            return; // Shutting down, nothing left to write
+
+        Frame frame;
+        std::swap(frame, m_queue.front());
+        m_queue.pop_front();
+        m_num_encoding++;
+        m_frame_done.notify_all();
+
+        lock.unlock();
+        write(frame);
+        lock.lock();
+
+        // Keep the pixel buffer around for a later frame
+        m_free_buffers.push_back(std::vector<pixel_t>());
+        m_free_buffers.back().swap(frame.pixels);
+        m_num_encoding--;
+        m_frame_done.notify_all();
+    }
+}
@@ -18,6 +18,11 @@
 #define __SCREEN_EXPORTER_HPP__ 
 
 #include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "display_screen.h"
 #include "../environment/ale_screen.hpp"
 
@@ -32,15 +37,52 @@ class ScreenExporter {
             Frames are sequentially named with 6 digits, starting at 000000. */
         ScreenExporter(ColourPalette &palette, const std::string &path);
 
+        /** As above, but frames passed to saveNext() are encoded by a pool of num_threads
+            background threads. saveNext() only blocks once max_queued frames are waiting to
+            be encoded. With num_threads == 0, frames are written synchronously. */
+        ScreenExporter(ColourPalette &palette, const std::string &path,
+                       int num_threads, size_t max_queued);
+
+        /** Waits for all queued frames to be written. */
+        ~ScreenExporter();
+
+        /** Whether to write indexed-colour PNGs (one byte per pixel plus a PLTE chunk) rather
+            than RGB ones. Defaults to false. */
+        void setIndexed(bool indexed) { m_indexed = indexed; }
+
+        /** The zlib compression level (0-9, or -1 for zlib's default). Defaults to -1. */
+        void setCompressionLevel(int level) { m_compression_level = level; }
+
         /** Save the given screen to the given filename. No paths are created. */
         void save(const ALEScreen &screen, const std::string &filename) const;
 
         /** Save the given screen according to our own internal numbering. */
         void saveNext(const ALEScreen &screen);
 
+        /** Blocks until every frame passed to saveNext() has been written. */
+        void flush();
+
     private:
 
-        ColourPalette &m_palette;
+        /** A frame waiting to be encoded: raw palette indices plus where it goes. */
+        struct Frame {
+            std::vector<pixel_t> pixels;
+            int height, width;
+            std::string filename;
+        };
+
+        /** Takes a copy of the palette's colours. */
+        void copyPalette(const ColourPalette &palette);
+
+        /** Encodes the given frame and writes it out. */
+        void write(const Frame &frame) const;
+
+        /** Background encoder loop. */
+        void encoderLoop();
+
+        /** The palette's colours when the exporter was created. Encoders may still be
+            writing frames while the OSystem's palette is set for another ROM. */
+        uInt32 m_palette[256];
 
         /** The next frame number. */
         int m_frame_number;
@@ -50,6 +92,21 @@ class ScreenExporter {
 
         /** The directory where we save successive frames. */ 
         std::string m_path;
+
+        /** Output format. */
+        bool m_indexed;
+        int m_compression_level;
+
+        /** Background encoding; all of the below is guarded by m_mutex. */
+        std::vector<std::thread> m_encoders;
+        std::mutex m_mutex;
+        std::condition_variable m_frame_queued;   // Signalled when work is queued or on shutdown
+        std::condition_variable m_frame_done;     // Signalled when a frame leaves the queue or is written
+        std::deque<Frame> m_queue;
+        std::vector<std::vector<pixel_t> > m_free_buffers; // Recycled pixel buffers
+        size_t m_max_queued;
+        int m_num_encoding;                       // Frames currently being encoded
+        bool m_shutdown;
 };
 
 #endif // __SCREEN_EXPORTER_HPP__ 
@@ -1,5 +1,5 @@
 #include "SoundExporter.hpp"
-#include <cassert>
+#include "Log.hpp"
 
 namespace ale {
 namespace sound {
@@ -7,49 +7,91 @@ namespace sound {
 // Sample rate is 60Hz x SamplesPerFrame bytes
 // TODO(mgb): in reality this should be 31,400 Hz, but currently we are just short of this
 static const unsigned int SampleRate = 60 * SoundExporter::SamplesPerFrame; 
-// Save wav file every 30 seconds
+// Update the wav header every 30 seconds
 static const unsigned int WriteInterval = SampleRate * 30;
+// Buffer one second of audio per channel before appending it to the file
+static const unsigned int BufferSamples = SampleRate;
 
 
 SoundExporter::SoundExporter(const std::string &filename, int channels):
-    m_filename(filename),
+    m_stream(filename.c_str(), std::ios::binary),
     m_channels(channels),
+    m_data_bytes(0),
     m_samples_since_write(0) {
+
+    if (!m_stream) {
+        ale::Logger::Error << "Could not open " << filename << " for writing" << std::endl;
+        return;
+    }
+
+    m_buffer.reserve(BufferSamples * m_channels);
+    // Placeholder sizes; patched by flush()
+    writeWAVHeader();
 }
 
 
 SoundExporter::~SoundExporter() {
 
-    writeWAVData();
+    flush();
 }
 
 
 void SoundExporter::addSamples(SampleType *s, int len) {
 
-    // @todo -- currently we only support mono recording 
-    assert(m_channels == 1);
+    if (!m_stream) return;
+
+    size_t remaining = len * m_channels;
+    while (remaining > 0) {
+        size_t room = m_buffer.capacity() - m_buffer.size();
+        size_t n = remaining < room ? remaining : room;
 
-    for (int i = 0; i < len; i++)
-        m_data.push_back(s[i]);
+        m_buffer.insert(m_buffer.end(), s, s + n);
+        s += n;
+        remaining -= n;
 
-    // Periodically flush to disk (to avoid cases where the destructor is not called)
+        // Append full buffers to the file
+        if (m_buffer.size() == m_buffer.capacity()) {
+            m_stream.write((const char*)&m_buffer[0], m_buffer.size() * sizeof(SampleType));
+            m_data_bytes += m_buffer.size() * sizeof(SampleType);
+            m_buffer.clear();
+        }
+    }
+
+    // Periodically update the header (to avoid cases where the destructor is not called)
     m_samples_since_write += len;
     if (m_samples_since_write >= WriteInterval) {
 
-        writeWAVData();
+        flush();
         m_samples_since_write = 0;
     }
 }
 
 
-void SoundExporter::writeWAVData() {
+void SoundExporter::flush() {
+
+    if (!m_stream) return;
+
+    if (!m_buffer.empty()) {
+        m_stream.write((const char*)&m_buffer[0], m_buffer.size() * sizeof(SampleType));
+        m_data_bytes += m_buffer.size() * sizeof(SampleType);
+        m_buffer.clear();
+    }
+
+    // Patch the sizes in place, then carry on appending
+    m_stream.seekp(0, std::ios::beg);
+    writeWAVHeader();
+    m_stream.seekp(0, std::ios::end);
+    m_stream.flush();
+}
+
+
+void SoundExporter::writeWAVHeader() {
    
     // Taken from http://stackoverflow.com/questions/22226872/two-problems-when-writing-to-wav-c
-    // Open file stream 
-    std::ofstream stream(m_filename.c_str(), std::ios::binary);                
+    std::ofstream &stream = m_stream;
 
     // Cast size into a 32-bit integer
-    int bufSize = m_data.size();
+    int bufSize = m_data_bytes;
 
     // Header 
     stream.write("RIFF", 4);                                        // sGroupID (RIFF = Resource Interchange File Format)
@@ -68,10 +110,8 @@ void SoundExporter::writeWAVData() {
 
     // Data chunk
     stream.write("data", 4);                                        // sGroupID (data)
-    stream.write((const char*)&bufSize, 4);                         // Chunk size (of Data, and thus of bufferSize)
-    stream.write((const char*)&m_data[0], bufSize);                 // The samples DATA!!!
+    write<int>(stream, bufSize);                                    // Chunk size (of Data, and thus of bufferSize)
 }
 
 } // namespace ale::sound 
 } // namespace ale
-
@@ -11,7 +11,9 @@
  * *****************************************************************************
  *  SoundExporter.hpp 
  *
- *  A class for writing Atari 2600 sound to a WAV file.
+ *  A class for writing Atari 2600 sound to a WAV file. Samples are streamed to
+ *  disk through a fixed-size buffer; the RIFF and data chunk sizes are patched
+ *  in place whenever the buffer is flushed, so memory use stays constant.
  *
  *  Parts of this code were taken from 
  *
@@ -42,28 +44,34 @@ class SoundExporter {
 
         typedef uInt8 SampleType;
   
-        /** Create a new sound exporter which, on program termination, will write out a wav file. */
+        /** Create a new sound exporter which streams samples to the given wav file. */
         SoundExporter(const std::string &filename, int channels);
         ~SoundExporter();
 
-        /** Adds a buffer of samples. */ 
+        /** Adds a buffer of len sample frames, i.e. len * channels interleaved samples. */ 
         void addSamples(SampleType *s, int len);
 
+        /** Writes out any buffered samples and updates the WAV header sizes. */
+        void flush();
+
     private:
    
-        /** Writes the data to disk. */
-        void writeWAVData();
+        /** Writes the WAV header, with the sizes as they currently stand. */
+        void writeWAVHeader();
 
-        /** The file to save our audio to. */
-        std::string m_filename;
+        /** The file we save our audio to. */
+        std::ofstream m_stream;
 
         /** Number of channels. */
         int m_channels;
 
-        /** The sound data. */
-        std::vector<SampleType> m_data;
+        /** Samples waiting to be written; never grows beyond its initial capacity. */
+        std::vector<SampleType> m_buffer;
+
+        /** Bytes of sample data written to the file so far. */
+        size_t m_data_bytes;
 
-        /** Keep track of how many samples have been written since the last write to disk */
+        /** Keep track of how many samples have been written since the last header update */
         size_t m_samples_since_write;
 };
 
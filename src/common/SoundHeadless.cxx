@@ -0,0 +1,182 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare,
+ *   Matthew Hausknecht and the Reinforcement Learning and Artificial Intelligence
+ *   Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  SoundHeadless.cxx
+ *
+ *  A sound object which synthesizes TIA audio into memory rather than playing
+ *  it, so that agents can observe sound without SDL or an audio device.
+ *
+ **************************************************************************** */
+
+#include <algorithm>
+#include <cstring>
+
+#include "Serializer.hxx"
+#include "Deserializer.hxx"
+
+#include "bspf.hxx"
+
+#include "SoundHeadless.hxx"
+
+// Machine cycles in one NTSC frame (262 scanlines of 76 cycles); used to place
+//  register writes when the start of the current frame is unknown
+static const Int32 NominalFrameCycles = 262 * 76;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+SoundHeadless::SoundHeadless(OSystem* osystem, uInt32 numFrames)
+    : Sound(osystem),
+      myTIASound(60 * SamplesPerFrame, 31400, 1),
+      myFrameStartCycle(-1),
+      myLastRegisterSetCycle(0),
+      myBuffer((numFrames > 0 ? numFrames : 1) * SamplesPerFrame, 0),
+      myNextFrame(0)
+{
+  // Frames seldom write more sound registers than this; the vector grows if need be
+  myRegWrites.reserve(256);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+SoundHeadless::~SoundHeadless()
+{
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void SoundHeadless::adjustCycleCounter(Int32 amount)
+{
+  for(size_t i = 0; i < myRegWrites.size(); ++i)
+    myRegWrites[i].cycle += amount;
+
+  if(myFrameStartCycle >= 0)
+    myFrameStartCycle += amount;
+  myLastRegisterSetCycle += amount;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void SoundHeadless::setFrameRate(uInt32 framerate)
+{
+  // One frame of sound is always SamplesPerFrame samples long
+  myTIASound.outputFrequency(framerate * SamplesPerFrame);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void SoundHeadless::reset()
+{
+  myTIASound.reset();
+  myRegWrites.clear();
+  myFrameStartCycle = -1;
+  myLastRegisterSetCycle = 0;
+  std::fill(myBuffer.begin(), myBuffer.end(), 0);
+  myNextFrame = 0;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void SoundHeadless::set(uInt16 addr, uInt8 value, Int32 cycle)
+{
+  RegWrite info;
+  info.addr = addr;
+  info.value = value;
+  info.cycle = cycle;
+  myRegWrites.push_back(info);
+
+  myLastRegisterSetCycle = cycle;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void SoundHeadless::processFrame(Int32 cycle)
+{
+  Int32 start = myFrameStartCycle >= 0 ? myFrameStartCycle : cycle - NominalFrameCycles;
+  Int32 span = cycle - start;
+  if(span <= 0)
+    span = 1;
+
+  uInt8* out = &myBuffer[myNextFrame * SamplesPerFrame];
+  uInt32 done = 0;
+
+  // Each register write takes effect at the sample matching its position
+  //  within the frame
+  for(size_t i = 0; i < myRegWrites.size(); ++i)
+  {
+    const RegWrite& info = myRegWrites[i];
+    Int32 offset = info.cycle - start;
+    uInt32 position = offset <= 0 ? 0 :
+        (uInt32)(((unsigned long long)offset * SamplesPerFrame) / span);
+    if(position > SamplesPerFrame)
+      position = SamplesPerFrame;
+
+    if(position > done)
+    {
+      myTIASound.process(out + done, position - done);
+      done = position;
+    }
+    myTIASound.set(info.addr, info.value);
+  }
+  if(done < SamplesPerFrame)
+    myTIASound.process(out + done, SamplesPerFrame - done);
+
+  myRegWrites.clear();
+  myFrameStartCycle = cycle;
+  myNextFrame = (myNextFrame + 1) % (myBuffer.size() / SamplesPerFrame);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void SoundHeadless::getSamples(uInt8* buffer) const
+{
+  // The ring buffer is unrolled starting from the oldest frame
+  uInt32 split = myNextFrame * SamplesPerFrame;
+  uInt32 tail = myBuffer.size() - split;
+
+  memcpy(buffer, &myBuffer[split], tail);
+  if(split > 0)
+    memcpy(buffer + tail, &myBuffer[0], split);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool SoundHeadless::load(Deserializer& in)
+{
+  std::string soundDevice = "TIASound";
+  if(in.getString() != soundDevice)
+    return false;
+
+  // Pending writes belong to the frame we are leaving
+  myRegWrites.clear();
+  myFrameStartCycle = -1;
+
+  static const uInt16 registers[6] = { 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a };
+  for(int i = 0; i < 6; ++i)
+    myTIASound.set(registers[i], (uInt8) in.getInt());
+
+  myLastRegisterSetCycle = (Int32) in.getInt();
+
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool SoundHeadless::save(Serializer& out)
+{
+  out.putString("TIASound");
+
+  // Registers as they stand after any writes still queued for this frame
+  uInt8 regs[6];
+  for(int i = 0; i < 6; ++i)
+    regs[i] = myTIASound.get(0x15 + i);
+  for(size_t i = 0; i < myRegWrites.size(); ++i)
+  {
+    uInt16 addr = myRegWrites[i].addr;
+    if(addr >= 0x15 && addr <= 0x1a)
+      regs[addr - 0x15] = myRegWrites[i].value;
+  }
+  for(int i = 0; i < 6; ++i)
+    out.putInt(regs[i]);
+
+  out.putInt(myLastRegisterSetCycle);
+
+  return true;
+}
@@ -0,0 +1,144 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare,
+ *   Matthew Hausknecht and the Reinforcement Learning and Artificial Intelligence
+ *   Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  SoundHeadless.hxx
+ *
+ *  A sound object which synthesizes TIA audio into memory rather than playing
+ *  it, so that agents can observe sound without SDL or an audio device.
+ *
+ **************************************************************************** */
+
+#ifndef SOUND_HEADLESS_HXX
+#define SOUND_HEADLESS_HXX
+
+class OSystem;
+class Serializer;
+class Deserializer;
+
+#include <vector>
+#include "../emucore/m6502/src/bspf/src/bspf.hxx"
+#include "../emucore/Sound.hxx"
+#include "../emucore/TIASnd.hxx"
+
+/**
+  This class queues the TIA sound register writes made during a frame and,
+  once the frame is complete, runs them through TIASound to produce exactly
+  SamplesPerFrame mono samples. The samples of the last few frames are kept
+  in a fixed-size ring buffer.
+
+  It is only created when the sound_obs setting is true; otherwise SoundNull
+  is used and no synthesis takes place.
+*/
+class SoundHeadless : public Sound
+{
+  public:
+    /** Number of samples produced for each emulated frame. */
+    static const uInt32 SamplesPerFrame = 512;
+
+    /**
+      Create a new sound object which keeps the samples of the last
+      numFrames frames.
+    */
+    SoundHeadless(OSystem* osystem, uInt32 numFrames);
+
+    /**
+      Destructor
+    */
+    virtual ~SoundHeadless();
+
+  public:
+    void setEnabled(bool) { }
+    void setChannels(uInt32) { }
+    void initialize() { }
+    void close() { }
+    bool isSuccessfullyInitialized() const { return true; }
+    void mute(bool) { }
+    void setVolume(Int32) { }
+    void adjustVolume(Int8) { }
+    void recordNextFrame() { }
+
+    /**
+      The system cycle counter is being adjusting by the specified amount.
+
+      @param amount The amount the cycle counter is being adjusted by
+    */
+    void adjustCycleCounter(Int32 amount);
+
+    /**
+      Sets the display framerate; samples are generated so that one frame
+      of sound always spans SamplesPerFrame samples.
+
+      @param framerate The base framerate depending on NTSC or PAL ROM
+    */
+    void setFrameRate(uInt32 framerate);
+
+    /**
+      Reset the sound device.
+    */
+    void reset();
+
+    /**
+      Queues a write to the given sound register.
+
+      @param addr  The register address
+      @param value The value to save into the register
+      @param cycle The system cycle at which the register is being updated
+    */
+    void set(uInt16 addr, uInt8 value, Int32 cycle);
+
+    /**
+      Synthesizes the samples for the frame which ends at the given cycle.
+
+      @param cycle The current system cycle
+    */
+    void processFrame(Int32 cycle);
+
+    /**
+      Copies the samples of the last numFrames frames, oldest first, into
+      the given buffer, which must hold size() bytes.
+    */
+    void getSamples(uInt8* buffer) const;
+
+    /**
+      The number of samples returned by getSamples().
+    */
+    uInt32 size() const { return myBuffer.size(); }
+
+  public:
+    bool load(Deserializer& in);
+    bool save(Serializer& out);
+
+  private:
+    struct RegWrite
+    {
+      uInt16 addr;
+      uInt8 value;
+      Int32 cycle;
+    };
+
+    // TIA sound emulation
+    TIASound myTIASound;
+
+    // Register writes made since the start of the current frame
+    std::vector<RegWrite> myRegWrites;
+
+    // The system cycle at which the current frame started
+    Int32 myFrameStartCycle;
+
+    // The cycle of the last register write, kept for state compatibility
+    Int32 myLastRegisterSetCycle;
+
+    // Samples of the last frames; myNextFrame is the slot written next
+    std::vector<uInt8> myBuffer;
+    uInt32 myNextFrame;
+};
+
+#endif
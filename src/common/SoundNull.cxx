@@ -78,3 +78,8 @@ bool SoundNull::save(Serializer& out)
 
   return true;
 }
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void SoundNull::checkpoint(Journal&)
+{
+}
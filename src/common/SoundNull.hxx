@@ -157,6 +157,13 @@ public:
       @return The result of the save.  True on success, false on failure.
     */
     bool save(Serializer& out);
+
+    /**
+      Records nothing, as there is no state to save.
+
+      @param journal The journal to record to
+    */
+    void checkpoint(Journal& journal);
 };
 
 #endif
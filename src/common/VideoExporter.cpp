@@ -0,0 +1,219 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and 
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details. 
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  VideoExporter.cpp 
+ *
+ *  A class for streaming Atari 2600 frames into a single video file (or FIFO).
+ *
+ **************************************************************************** */
+
+#include "VideoExporter.hpp"
+#include <zlib.h>
+#include <cstring>
+#include "Log.hpp"
+
+// Large stdio buffers keep the number of write calls per frame low
+static const size_t StreamBufferSize = 1 << 20;
+
+static const unsigned FramesPerSecond = 60;
+
+static void putLE16(uInt8 *p, unsigned v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+}
+
+static void putLE32(uInt8 *p, unsigned long v) {
+    for (int i = 0; i < 4; i++)
+        p[i] = (v >> (8 * i)) & 0xFF;
+}
+
+static void putLE64(uInt8 *p, unsigned long long v) {
+    for (int i = 0; i < 8; i++)
+        p[i] = (v >> (8 * i)) & 0xFF;
+}
+
+static uInt8 clampByte(int v) {
+    return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+VideoExporter::VideoExporter(ColourPalette &palette, const std::string &filename, Format format,
+                             bool compress, bool writeIndex, int keyframeInterval):
+    m_palette(palette),
+    m_format(format),
+    m_compress(compress && format != Y4M),
+    m_keyframe_interval(keyframeInterval),
+    m_out(NULL),
+    m_index(NULL),
+    m_offset(0),
+    m_frame_count(0),
+    m_height(0),
+    m_width(0) {
+
+    m_out = fopen(filename.c_str(), "wb");
+    if (m_out == NULL) {
+        ale::Logger::Error << "Could not open " << filename << " for writing" << std::endl;
+        return;
+    }
+    setvbuf(m_out, NULL, _IOFBF, StreamBufferSize);
+
+    if (writeIndex) {
+        std::string indexName = filename + ".idx";
+        m_index = fopen(indexName.c_str(), "wb");
+        if (m_index == NULL)
+            ale::Logger::Warning << "Could not open " << indexName << "; no index will be written"
+                                 << std::endl;
+        else
+            fwrite("ALEIDX01", 1, 8, m_index);
+    }
+
+    // Precompute the BT.601 (studio range) colours of every palette entry
+    for (int i = 0; i < 256; i++) {
+        uInt32 rgb = m_palette.getRGB(i);
+        int r = (rgb >> 16) & 0xFF, g = (rgb >> 8) & 0xFF, b = rgb & 0xFF;
+        m_yuv[i][0] = clampByte(16 + ((66 * r + 129 * g + 25 * b + 128) >> 8));
+        m_yuv[i][1] = clampByte(128 + ((-38 * r - 74 * g + 112 * b + 128) >> 8));
+        m_yuv[i][2] = clampByte(128 + ((112 * r - 94 * g - 18 * b + 128) >> 8));
+    }
+}
+
+VideoExporter::~VideoExporter() {
+
+    if (m_out != NULL)
+        fclose(m_out);
+    if (m_index != NULL)
+        fclose(m_index);
+}
+
+bool VideoExporter::parseFormat(const std::string &name, Format &format) {
+
+    if (name == "y4m")
+        format = Y4M;
+    else if (name == "indexed")
+        format = INDEXED;
+    else if (name == "delta")
+        format = DELTA;
+    else
+        return false;
+
+    return true;
+}
+
+void VideoExporter::append(const void *data, size_t size) {
+
+    if (fwrite(data, 1, size, m_out) != size) {
+        ale::Logger::Error << "Error writing video; recording stopped" << std::endl;
+        fclose(m_out);
+        m_out = NULL;
+        return;
+    }
+    m_offset += size;
+}
+
+void VideoExporter::writeHeader(int height, int width) {
+
+    m_height = height;
+    m_width = width;
+
+    if (m_format == Y4M) {
+        // Atari pixels are twice as wide as they are tall
+        char header[128];
+        int n = snprintf(header, sizeof(header), "YUV4MPEG2 W%d H%d F%u:1 Ip A2:1 C444\n",
+                         width, height, FramesPerSecond);
+        append(header, n);
+    }
+    else {
+        uInt8 header[16 + 256 * 3];
+        memcpy(header, "ALEVID01", 8);
+        putLE16(header + 8, width);
+        putLE16(header + 10, height);
+        putLE16(header + 12, FramesPerSecond);
+        putLE16(header + 14, (m_compress ? 1 : 0) | (m_format == DELTA ? 2 : 0));
+        for (int i = 0; i < 256; i++) {
+            uInt32 rgb = m_palette.getRGB(i);
+            header[16 + i * 3 + 0] = (rgb >> 16) & 0xFF;
+            header[16 + i * 3 + 1] = (rgb >>  8) & 0xFF;
+            header[16 + i * 3 + 2] = (rgb >>  0) & 0xFF;
+        }
+        append(header, sizeof(header));
+
+        if (m_format == DELTA)
+            m_delta_encoder.reset(new ScreenDeltaEncoder(height, width, m_keyframe_interval));
+    }
+}
+
+void VideoExporter::addFrame(const ALEScreen &screen) {
+
+    if (m_out == NULL)
+        return;
+
+    if (m_frame_count == 0)
+        writeHeader(screen.height(), screen.width());
+    else if ((int)screen.height() != m_height || (int)screen.width() != m_width) {
+        ale::Logger::Error << "Screen size changed while recording video; frame dropped"
+                           << std::endl;
+        return;
+    }
+
+    size_t numPixels = m_height * m_width;
+    const pixel_t *pixels = screen.getArray();
+
+    // Build the whole frame record, so it can be written with a single call
+    if (m_format == Y4M) {
+        // Planar Y, then U, then V
+        m_buffer.resize(6 + 3 * numPixels);
+        memcpy(&m_buffer[0], "FRAME\n", 6);
+        uInt8 *planes = &m_buffer[6];
+        for (size_t i = 0; i < numPixels; i++) {
+            const uInt8 *yuv = m_yuv[pixels[i]];
+            planes[i] = yuv[0];
+            planes[numPixels + i] = yuv[1];
+            planes[2 * numPixels + i] = yuv[2];
+        }
+    }
+    else {
+        // The payload is either the pixels or their delta encoding
+        const uInt8 *payload = pixels;
+        size_t payloadSize = numPixels;
+        if (m_format == DELTA) {
+            m_delta.clear();
+            m_delta_encoder->encode(pixels, m_delta);
+            payload = &m_delta[0];
+            payloadSize = m_delta.size();
+        }
+
+        if (m_compress) {
+            uLongf compressedSize = compressBound(payloadSize);
+            m_buffer.resize(4 + compressedSize);
+            if (compress(&m_buffer[4], &compressedSize, payload, payloadSize) != Z_OK) {
+                ale::Logger::Error << "Error: Couldn't compress video frame" << std::endl;
+                // The next frame must not depend on this one
+                if (m_delta_encoder.get() != NULL)
+                    m_delta_encoder->forceKeyframe();
+                return;
+            }
+            putLE32(&m_buffer[0], compressedSize);
+            m_buffer.resize(4 + compressedSize);
+        }
+        else {
+            m_buffer.resize(4 + payloadSize);
+            putLE32(&m_buffer[0], payloadSize);
+            memcpy(&m_buffer[4], payload, payloadSize);
+        }
+    }
+
+    if (m_index != NULL) {
+        uInt8 offset[8];
+        putLE64(offset, m_offset);
+        fwrite(offset, 1, sizeof(offset), m_index);
+    }
+
+    append(&m_buffer[0], m_buffer.size());
+    m_frame_count++;
+}
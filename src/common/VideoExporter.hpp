@@ -0,0 +1,111 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and 
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details. 
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  VideoExporter.hpp 
+ *
+ *  A class for streaming Atari 2600 frames into a single video file (or FIFO).
+ *
+ *  Three formats are supported:
+ *
+ *   - Y4M (YUV4MPEG2, 4:4:4, 60 fps, 2:1 pixel aspect), which ffmpeg and most
+ *     other video tools read directly.
+ *
+ *   - An indexed frame stream, which stores the palette once and then one
+ *     byte per pixel. All integers are little-endian:
+ *
+ *       "ALEVID01"                      magic and version
+ *       uInt16 width, height, fps, flags  (flags bit 0: frames are zlib streams)
+ *       uInt8  palette[256][3]           RGB of every pixel value
+ *       per frame: uInt32 size, then size bytes of row-major pixel values
+ *                  (or their zlib compression)
+ *
+ *   - A delta frame stream: as the indexed stream, with flags bit 1 set, but
+ *     each frame holds a screen encoded by ScreenDeltaEncoder, i.e. either a
+ *     keyframe or the spans which changed since the previous frame.
+ *
+ *  Optionally a sidecar index (<filename>.idx) is written alongside: "ALEIDX01"
+ *  followed by one uInt64 per frame, the offset of that frame's record (the
+ *  FRAME line, for Y4M) in the video stream.
+ *
+ **************************************************************************** */
+
+#ifndef __VIDEO_EXPORTER_HPP__
+#define __VIDEO_EXPORTER_HPP__ 
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <memory>
+#include "ColourPalette.hpp"
+#include "ScreenDelta.hpp"
+#include "../environment/ale_screen.hpp"
+
+class VideoExporter {
+
+    public:
+
+        enum Format { Y4M, INDEXED, DELTA };
+
+        /** Creates a new VideoExporter appending frames to the given file. Compression does
+            not apply to Y4M; keyframeInterval only applies to delta streams. */
+        VideoExporter(ColourPalette &palette, const std::string &filename, Format format,
+                      bool compress = false, bool writeIndex = true, int keyframeInterval = 60);
+
+        /** Flushes and closes the video (and index) file. */
+        ~VideoExporter();
+
+        /** Whether the output could be opened. */
+        bool isOpen() const { return m_out != NULL; }
+
+        /** Appends the given screen to the video. */
+        void addFrame(const ALEScreen &screen);
+
+        /** Number of frames written so far. */
+        size_t frameCount() const { return m_frame_count; }
+
+        /** Maps "y4m", "indexed" or "delta" to a format; returns false for anything else. */
+        static bool parseFormat(const std::string &name, Format &format);
+
+    private:
+
+        /** Writes the stream header, once the frame dimensions are known. */
+        void writeHeader(int height, int width);
+
+        /** Appends raw bytes to the video, keeping track of the stream offset. */
+        void append(const void *data, size_t size);
+
+        ColourPalette &m_palette;
+
+        Format m_format;
+        bool m_compress;
+        int m_keyframe_interval;
+
+        /** Output streams; the index is NULL when not requested. */
+        FILE *m_out;
+        FILE *m_index;
+
+        /** Bytes written to m_out so far (ftell does not work on FIFOs). */
+        unsigned long long m_offset;
+
+        size_t m_frame_count;
+        int m_height, m_width;
+
+        /** Scratch space for one encoded frame record, and for a delta-encoded screen. */
+        std::vector<uInt8> m_buffer;
+        std::vector<uInt8> m_delta;
+
+        /** Encodes delta streams; created with the header. */
+        std::unique_ptr<ScreenDeltaEncoder> m_delta_encoder;
+
+        /** Palette value to Y, U and V, for Y4M output. */
+        uInt8 m_yuv[256][3];
+};
+
+#endif // __VIDEO_EXPORTER_HPP__ 
@@ -3,10 +3,15 @@ MODULE := src/common
 MODULE_OBJS := \
 	src/common/SoundNull.o \
 	src/common/SoundSDL.o \
+	src/common/SoundHeadless.o \
     src/common/SoundExporter.o \
 	src/common/display_screen.o \
 	src/common/ColourPalette.o \
 	src/common/ScreenExporter.o \
+	src/common/VideoExporter.o \
+	src/common/Dataset.o \
+	src/common/ScreenDelta.o \
+	src/common/Fingerprint.o \
 	src/common/Constants.o \
     src/common/Log.o
 
@@ -24,7 +24,8 @@
 
 ALEController::ALEController(OSystem* osystem):
   m_osystem(osystem),
-  m_settings(buildRomRLWrapper(m_osystem->settings().getString("rom_file"))),
+  m_settings(buildRomRLWrapper(m_osystem->settings().getString("rom_file"),
+                               m_osystem->console().properties().get(Cartridge_MD5))),
   m_environment(m_osystem, m_settings.get()) {
 
   if (m_settings.get() == NULL) {
@@ -50,23 +51,28 @@ void ALEController::display() {
 }
 
 reward_t ALEController::applyActions(Action player_a, Action player_b) {
+  return applyActions(m_environment, player_a, player_b);
+}
+
+reward_t ALEController::applyActions(StellaEnvironment& environment,
+                                     Action player_a, Action player_b) {
   reward_t sum_rewards = 0;
   // Perform different operations based on the first player's action 
   switch (player_a) {
     case LOAD_STATE: // Load system state
       // Note - this does not reset the game screen; so that the subsequent screen
       //  is incorrect (in fact, two screens, due to colour averaging)
-      m_environment.load();
+      environment.load();
       break;
     case SAVE_STATE: // Save system state
-      m_environment.save();
+      environment.save();
       break;
     case SYSTEM_RESET:
-      m_environment.reset();
+      environment.reset();
       break;
     default:
       // Pass action to emulator!
-      sum_rewards = m_environment.act(player_a, player_b);
+      sum_rewards = environment.act(player_a, player_b);
       break;
   }
   return sum_rewards;
@@ -37,6 +37,8 @@ class ALEController {
 
     /** Applies the given action to the environment (e.g. by emulating or resetting) */
     reward_t applyActions(Action a, Action b); 
+    /** As above, for any environment; used by controllers hosting several of them */
+    static reward_t applyActions(StellaEnvironment& environment, Action a, Action b);
     /** Support for SDL display... available to all controllers. Simply call it from run(). */
     void display();
 
@@ -0,0 +1,139 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  binary_protocol.hpp
+ *
+ *  Constants and encoders of the binary agent protocol, shared by the FIFO
+ *  controller and the environment server.
+ **************************************************************************** */
+
+#ifndef __BINARY_PROTOCOL_HPP__
+#define __BINARY_PROTOCOL_HPP__
+
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "../emucore/m6502/src/bspf/src/bspf.hxx"
+#include "../environment/ale_screen.hpp"
+#include "../common/ScreenDelta.hpp"
+
+#define BINARY_MAX_RUN_LENGTH (0xFF)
+
+// Values of the optional fifth handshake field. Any binary value also selects how
+//  screens are encoded.
+enum {
+  PROTOCOL_TEXT = 0,
+  PROTOCOL_BINARY_RAW = 1,    // One byte per pixel
+  PROTOCOL_BINARY_RLE = 2,    // (colour, length) byte pairs
+  PROTOCOL_BINARY_DELTA = 3,  // As RLE, of the XOR with the previously sent screen
+  PROTOCOL_BINARY_SPANS = 4   // Changed row spans with periodic keyframes; see ScreenDelta.hpp
+};
+
+// Section flags of a binary frame
+#define BINARY_RAM    (0x01)
+#define BINARY_SCREEN (0x02)
+#define BINARY_RL     (0x04)
+
+/* Binary fields are little-endian, whatever the host */
+inline uInt8* putUInt16(uInt8 *buf, uInt16 v) {
+    buf[0] = v & 0xFF;
+    buf[1] = v >> 8;
+    return buf + 2;
+}
+
+inline uInt8* putUInt32(uInt8 *buf, uInt32 v) {
+    buf[0] = v & 0xFF;
+    buf[1] = (v >> 8) & 0xFF;
+    buf[2] = (v >> 16) & 0xFF;
+    buf[3] = v >> 24;
+    return buf + 4;
+}
+
+inline Int32 getInt32(const uInt8 *buf) {
+    return (Int32)(buf[0] | (buf[1] << 8) | (buf[2] << 16) | ((uInt32)buf[3] << 24));
+}
+
+/* Run-length encodes n bytes as (value, length) pairs; dst must hold 2 * n bytes */
+inline size_t binaryRLE(const uInt8 *src, size_t n, uInt8 *dst) {
+    size_t dn = 0;
+    size_t i = 0;
+    while (i < n) {
+        uInt8 v = src[i];
+        size_t run = 1;
+        while (i + run < n && src[i + run] == v && run < BINARY_MAX_RUN_LENGTH)
+            run++;
+
+        dst[dn++] = v;
+        dst[dn++] = (uInt8)run;
+        i += run;
+    }
+
+    return dn;
+}
+
+/* Encodes the screens sent to one agent, as its binary protocol requires */
+class BinaryScreenEncoder {
+  public:
+    BinaryScreenEncoder() : m_protocol(PROTOCOL_TEXT), m_keyframe_interval(0) {}
+
+    /* Selects the encoding; span keyframes are sent every keyframe_interval screens */
+    void setProtocol(int protocol, int keyframe_interval) {
+        m_protocol = protocol;
+        m_keyframe_interval = keyframe_interval;
+        m_spans.reset();
+        m_previous.clear();
+    }
+
+    /* Returns the encoding of the given screen and stores its size. Raw screens are
+       returned in place; other encodings are only valid until the next call. */
+    const uInt8* encode(const ALEScreen& screen, size_t& size) {
+        const pixel_t *pixels = screen.getArray();
+        size_t n = screen.arraySize();
+
+        if (m_protocol == PROTOCOL_BINARY_RAW) {
+            size = n;
+            return pixels;
+        }
+
+        if (m_protocol == PROTOCOL_BINARY_SPANS) {
+            if (m_spans.get() == NULL)
+                m_spans.reset(new ScreenDeltaEncoder(screen.height(), screen.width(),
+                                                     m_keyframe_interval));
+            m_encoded.clear();
+            m_spans->encode(pixels, m_encoded);
+            size = m_encoded.size();
+            return &m_encoded[0];
+        }
+
+        m_encoded.resize(2 * n);
+        if (m_protocol == PROTOCOL_BINARY_RLE) {
+            size = binaryRLE(pixels, n, &m_encoded[0]);
+        }
+        else {
+            // Unchanged pixels become long runs of zeros
+            if (m_previous.size() != n)
+                m_previous.assign(n, 0);
+            for (size_t i = 0; i < n; i++)
+                m_previous[i] ^= pixels[i];
+            size = binaryRLE(&m_previous[0], n, &m_encoded[0]);
+            memcpy(&m_previous[0], pixels, n);
+        }
+        return &m_encoded[0];
+    }
+
+  private:
+    int m_protocol;
+    int m_keyframe_interval;
+    std::vector<uInt8> m_encoded; // Scratch space for the encoded screen
+    std::vector<pixel_t> m_previous; // Last screen sent, for delta encoding
+    std::unique_ptr<ScreenDeltaEncoder> m_spans; // Created with the first screen
+};
+
+#endif // __BINARY_PROTOCOL_HPP__
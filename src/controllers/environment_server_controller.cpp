@@ -0,0 +1,543 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  environment_server_controller.cpp
+ *
+ *  The EnvironmentServerController class hosts one environment per agent
+ *  connecting to its UNIX domain socket, all within a single process. One
+ *  thread multiplexes the connections with epoll; the environments are
+ *  stepped by a pool of worker threads. Agents talk the binary FIFO protocol.
+ **************************************************************************** */
+
+#include "environment_server_controller.hpp"
+#include "../common/Log.hpp"
+
+#ifdef __linux__
+
+#include "binary_protocol.hpp"
+#include "../ale_interface.hpp"
+#include "../games/Roms.hpp"
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// Handshakes longer than this are not from a well-behaved agent
+static const size_t MaxHandshakeLength = 1024;
+
+// Events handled per call to epoll_wait
+static const int MaxEvents = 64;
+
+// Whether agents may send these actions. Anything else would make the emulator exit and take
+//  every other agent down with it; saved states are refused, as nothing bounds the stack
+static bool isServedAction(int player_a, int player_b) {
+  bool valid_a = (player_a >= PLAYER_A_NOOP && player_a < PLAYER_A_MAX) ||
+                 player_a == RESET || player_a == SYSTEM_RESET;
+  bool valid_b = (player_b >= PLAYER_B_NOOP && player_b < PLAYER_B_MAX) || player_b == RESET;
+  return valid_a && valid_b;
+}
+
+struct EnvironmentServerController::Client {
+  int fd;
+  uInt32 seed; // Drawn from the server's RNG when the agent connects
+
+  bool handshaken; // Whether the handshake line has been received
+  bool busy; // Owned by the worker pool
+  bool hung_up; // The connection failed or the agent closed it
+  bool finished; // The environment is done; close once the output is written
+  bool watched; // Whether epoll watches the connection, which it doesn't while busy
+  uInt32 events; // What epoll currently watches for
+
+  std::string input; // Received but not yet parsed
+  std::vector<uInt8> output; // Not yet written, from output_pos on
+  size_t output_pos;
+
+  // Negotiated during the handshake
+  bool send_screen, send_ram, send_rl;
+  int protocol;
+
+  // The next actions to apply
+  Action action_a, action_b;
+
+  // Declared in the order ALEInterface uses, so that they are destroyed in reverse
+  std::unique_ptr<OSystem> osystem;
+  std::unique_ptr<Settings> settings;
+  std::unique_ptr<RomSettings> rom_settings;
+  std::unique_ptr<StellaEnvironment> environment;
+
+  BinaryScreenEncoder screen_encoder;
+
+  Client(int _fd, uInt32 _seed) :
+    fd(_fd), seed(_seed), handshaken(false), busy(false), hung_up(false), finished(false),
+    watched(false), events(0), output_pos(0), send_screen(false), send_ram(false), send_rl(false),
+    protocol(PROTOCOL_TEXT), action_a(PLAYER_A_NOOP), action_b(PLAYER_B_NOOP) {}
+};
+
+EnvironmentServerController::EnvironmentServerController(OSystem* osystem) :
+  ALEController(osystem),
+  m_socket(-1),
+  m_epoll(-1),
+  m_wakeup(-1),
+  m_shutdown(false) {
+  m_socket_path = m_osystem->settings().getString("env_server_socket");
+  m_max_num_frames = m_osystem->settings().getInt("max_num_frames");
+}
+
+EnvironmentServerController::~EnvironmentServerController() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_shutdown = true;
+  }
+  m_job_queued.notify_all();
+  for (size_t i = 0; i < m_workers.size(); i++)
+    m_workers[i].join();
+
+  while (!m_clients.empty())
+    closeClient(m_clients.begin()->second);
+
+  if (m_wakeup >= 0) close(m_wakeup);
+  if (m_epoll >= 0) close(m_epoll);
+  if (m_socket >= 0) {
+    close(m_socket);
+    unlink(m_socket_path.c_str());
+  }
+}
+
+bool EnvironmentServerController::openSocket() {
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (m_socket_path.empty() || m_socket_path.size() >= sizeof(address.sun_path)) {
+    ale::Logger::Error << "Invalid environment server socket path: " << m_socket_path
+                       << std::endl;
+    return false;
+  }
+  strncpy(address.sun_path, m_socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+  m_socket = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (m_socket < 0) {
+    ale::Logger::Error << "Could not create environment server socket: " << strerror(errno)
+                       << std::endl;
+    return false;
+  }
+
+  // Remove any socket left behind by a previous server
+  unlink(m_socket_path.c_str());
+  if (bind(m_socket, (struct sockaddr*)&address, sizeof(address)) < 0 ||
+      listen(m_socket, SOMAXCONN) < 0) {
+    ale::Logger::Error << "Could not listen on " << m_socket_path << ": "
+                       << strerror(errno) << std::endl;
+    close(m_socket);
+    m_socket = -1;
+    return false;
+  }
+
+  return true;
+}
+
+void EnvironmentServerController::run() {
+  if (!openSocket())
+    return;
+
+  m_epoll = epoll_create1(EPOLL_CLOEXEC);
+  m_wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (m_epoll < 0 || m_wakeup < 0) {
+    ale::Logger::Error << "Could not set up the environment server: " << strerror(errno)
+                       << std::endl;
+    return;
+  }
+
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN;
+  event.data.fd = m_socket;
+  epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_socket, &event);
+  event.data.fd = m_wakeup;
+  epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeup, &event);
+
+  int num_threads = m_osystem->settings().getInt("env_server_threads");
+  if (num_threads <= 0)
+    num_threads = std::max(1, (int)std::thread::hardware_concurrency());
+  for (int i = 0; i < num_threads; i++)
+    m_workers.push_back(std::thread(&EnvironmentServerController::workerLoop, this));
+
+  ale::Logger::Info << "Environment server listening on " << m_socket_path << " with "
+                    << num_threads << " worker threads" << std::endl;
+
+  struct epoll_event events[MaxEvents];
+  while (true) {
+    int n = epoll_wait(m_epoll, events, MaxEvents, -1);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      ale::Logger::Error << "Environment server stopped: " << strerror(errno) << std::endl;
+      break;
+    }
+
+    for (int i = 0; i < n; i++) {
+      int fd = events[i].data.fd;
+      if (fd == m_socket) {
+        acceptClients();
+      }
+      else if (fd == m_wakeup) {
+        finishJobs();
+      }
+      else {
+        // The client may have been closed while handling an earlier event
+        std::map<int, Client*>::iterator it = m_clients.find(fd);
+        if (it == m_clients.end())
+          continue;
+        Client* client = it->second;
+
+        if (events[i].events & EPOLLOUT)
+          flushClient(client);
+        if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+          readClient(client);
+        else
+          updateClient(client);
+      }
+    }
+  }
+}
+
+void EnvironmentServerController::acceptClients() {
+  while (true) {
+    int fd = accept4(m_socket, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK)
+        ale::Logger::Error << "Could not accept agent: " << strerror(errno) << std::endl;
+      return;
+    }
+
+    // Draw the environment's seed from the template, as the fork server does, so that a
+    //  fixed random_seed yields a reproducible sequence of environments
+    Client* client = new Client(fd, m_osystem->rng().next());
+    m_clients[fd] = client;
+
+    // Greet the agent with the screen size, as the FIFO controller does
+    char greeting[64];
+    int length = snprintf(greeting, sizeof(greeting), "%d-%d\n",
+      (int)m_environment.getScreen().width(), (int)m_environment.getScreen().height());
+    client->output.insert(client->output.end(), greeting, greeting + length);
+    flushClient(client);
+    updateClient(client);
+  }
+}
+
+void EnvironmentServerController::readClient(Client* client) {
+  char buffer[4096];
+  while (true) {
+    ssize_t n = recv(client->fd, buffer, sizeof(buffer), 0);
+    if (n > 0) {
+      client->input.append(buffer, n);
+      continue;
+    }
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+      client->hung_up = true;
+    break;
+  }
+
+  processInput(client);
+}
+
+void EnvironmentServerController::processInput(Client* client) {
+  if (!client->busy && !client->hung_up && !client->finished) {
+    if (!client->handshaken) {
+      size_t end = client->input.find('\n');
+      if (end == std::string::npos) {
+        if (client->input.size() > MaxHandshakeLength)
+          client->hung_up = true;
+      }
+      else {
+        // Parse response: send_screen, send_ram, <obsolete>, send_RL, protocol
+        std::string line = client->input.substr(0, end);
+        client->input.erase(0, end + 1);
+        int fields[5] = { 0, 0, 0, 0, PROTOCOL_TEXT };
+        sscanf(line.c_str(), "%d,%d,%d,%d,%d", &fields[0], &fields[1], &fields[2],
+               &fields[3], &fields[4]);
+        client->send_screen = fields[0] != 0;
+        client->send_ram = fields[1] != 0;
+        client->send_rl = fields[3] != 0;
+        client->protocol = fields[4];
+
+        if (client->protocol < PROTOCOL_BINARY_RAW || client->protocol > PROTOCOL_BINARY_SPANS) {
+          ale::Logger::Warning << "Environment server agents must request a binary protocol; "
+                               << "closing connection" << std::endl;
+          client->hung_up = true;
+        }
+        else {
+          const char ack[] = "binary-1\n";
+          client->output.insert(client->output.end(), ack, ack + sizeof(ack) - 1);
+          client->screen_encoder.setProtocol(client->protocol,
+            m_osystem->settings().getInt("screen_keyframe_interval"));
+          client->handshaken = true;
+          client->busy = true;
+        }
+      }
+    }
+    else if (client->input.size() >= 8) {
+      // Two little-endian 32-bit integers
+      const uInt8* actions = (const uInt8*)client->input.data();
+      int player_a = (int)getInt32(actions);
+      int player_b = (int)getInt32(actions + 4);
+      client->input.erase(0, 8);
+      if (isServedAction(player_a, player_b)) {
+        client->action_a = (Action)player_a;
+        client->action_b = (Action)player_b;
+        client->busy = true;
+      }
+      else {
+        ale::Logger::Warning << "Environment server agent sent invalid actions " << player_a
+                             << ", " << player_b << "; closing connection" << std::endl;
+        client->hung_up = true;
+      }
+    }
+
+    if (client->busy) {
+      // Whatever is already due goes out before the pool takes over the output buffer
+      flushClient(client);
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(client);
+      }
+      m_job_queued.notify_one();
+    }
+  }
+
+  updateClient(client);
+}
+
+void EnvironmentServerController::flushClient(Client* client) {
+  while (client->output_pos < client->output.size()) {
+    ssize_t n = send(client->fd, &client->output[client->output_pos],
+                     client->output.size() - client->output_pos, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK)
+        client->hung_up = true;
+      return;
+    }
+    client->output_pos += n;
+  }
+
+  client->output.clear();
+  client->output_pos = 0;
+}
+
+bool EnvironmentServerController::updateClient(Client* client) {
+  bool pending = client->output_pos < client->output.size();
+  if (!client->busy && (client->hung_up || (client->finished && !pending))) {
+    closeClient(client);
+    return false;
+  }
+
+  // The connection leaves epoll while the pool owns the client: epoll always reports hang-ups,
+  //  which would wake the loop over and over until the job is done. Requests are read only
+  //  while idle, so each agent has at most one request in flight
+  if (client->busy) {
+    if (client->watched) {
+      epoll_ctl(m_epoll, EPOLL_CTL_DEL, client->fd, NULL);
+      client->watched = false;
+    }
+    return true;
+  }
+
+  uInt32 events = (client->finished ? 0 : EPOLLIN) | (pending ? EPOLLOUT : 0);
+  if (!client->watched || events != client->events) {
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.fd = client->fd;
+    epoll_ctl(m_epoll, client->watched ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, client->fd, &event);
+    client->watched = true;
+    client->events = events;
+  }
+  return true;
+}
+
+void EnvironmentServerController::closeClient(Client* client) {
+  if (client->watched)
+    epoll_ctl(m_epoll, EPOLL_CTL_DEL, client->fd, NULL);
+  close(client->fd);
+  m_clients.erase(client->fd);
+
+  std::lock_guard<std::mutex> lock(m_environment_mutex);
+  delete client;
+}
+
+void EnvironmentServerController::finishJobs() {
+  eventfd_t count;
+  if (eventfd_read(m_wakeup, &count) < 0 && errno != EAGAIN)
+    ale::Logger::Warning << "Could not read worker notification: " << strerror(errno)
+                         << std::endl;
+
+  std::vector<Client*> finished;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    finished.swap(m_finished);
+  }
+
+  for (size_t i = 0; i < finished.size(); i++) {
+    Client* client = finished[i];
+    client->busy = false;
+    if (!client->hung_up)
+      flushClient(client);
+    // The agent may already have sent its next actions
+    processInput(client);
+  }
+}
+
+void EnvironmentServerController::workerLoop() {
+  while (true) {
+    Client* client;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      while (m_jobs.empty() && !m_shutdown)
+        m_job_queued.wait(lock);
+      if (m_shutdown)
+        return;
+      client = m_jobs.front();
+      m_jobs.pop_front();
+    }
+
+    serveClient(client);
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_finished.push_back(client);
+    }
+    if (eventfd_write(m_wakeup, 1) < 0)
+      ale::Logger::Warning << "Could not notify the event loop: " << strerror(errno)
+                           << std::endl;
+  }
+}
+
+void EnvironmentServerController::serveClient(Client* client) {
+  reward_t reward = 0;
+  if (client->environment.get() == NULL)
+    startEnvironment(client);
+  else
+    reward = applyActions(*client->environment, client->action_a, client->action_b);
+
+  // Die once we reach enough samples; binary agents receive an empty frame
+  if (m_max_num_frames > 0 && client->environment->getFrameNumber() >= m_max_num_frames) {
+    uInt8 die[4];
+    putUInt32(die, 0);
+    client->output.insert(client->output.end(), die, die + sizeof(die));
+    client->finished = true;
+  }
+  else {
+    encodeFrame(client, reward);
+  }
+}
+
+void EnvironmentServerController::startEnvironment(Client* client) {
+  std::lock_guard<std::mutex> lock(m_environment_mutex);
+
+  // Each environment is configured like the template, but has no display of its own and
+  //  does not record; they would all write to the same files. Datasets are the exception:
+  //  each writer adds shards of its own
+  ALEInterface::createOSystem(client->osystem, client->settings);
+  m_osystem->settings().copyTo(*client->settings);
+  client->settings->setBool("display_screen", false);
+  client->settings->setString("record_screen_dir", "");
+  client->settings->setString("record_video_file", "");
+  client->settings->setString("record_trajectory_file", "");
+  client->settings->setString("record_sound_filename", "");
+
+  // A zero seed would mean seeding from the time
+  int seed = (int)(client->seed & 0x7FFFFFFF);
+  client->settings->setInt("random_seed", seed != 0 ? seed : 1);
+
+  const std::string& rom_file = m_osystem->romFile();
+  ALEInterface::loadSettings(rom_file, client->osystem);
+
+  client->rom_settings.reset(buildRomRLWrapper(rom_file,
+      client->osystem->console().properties().get(Cartridge_MD5)));
+  client->environment.reset(new StellaEnvironment(client->osystem.get(),
+                                                  client->rom_settings.get()));
+  client->environment->reset();
+}
+
+void EnvironmentServerController::encodeFrame(Client* client, reward_t reward) {
+  // Same layout as FIFOController::sendBinaryData(): u32 length of what follows, u8
+  //  section flags, then the RAM, screen and RL sections that were requested
+  StellaEnvironment& environment = *client->environment;
+  std::vector<uInt8>& out = client->output;
+  size_t start = out.size();
+
+  uInt8 header[4 + 1];
+  header[4] = (client->send_ram ? BINARY_RAM : 0) | (client->send_screen ? BINARY_SCREEN : 0) |
+    (client->send_rl ? BINARY_RL : 0);
+  out.insert(out.end(), header, header + sizeof(header));
+
+  if (client->send_ram) {
+    const ALERAM& ram = environment.getRAM();
+    uInt8 size[2];
+    putUInt16(size, ram.size());
+    out.insert(out.end(), size, size + sizeof(size));
+    out.insert(out.end(), ram.array(), ram.array() + ram.size());
+  }
+
+  if (client->send_screen) {
+    size_t sn;
+    const uInt8* data = client->screen_encoder.encode(environment.getScreen(), sn);
+
+    uInt8 screen_header[1 + 4];
+    screen_header[0] = (uInt8)client->protocol;
+    putUInt32(screen_header + 1, sn);
+    out.insert(out.end(), screen_header, screen_header + sizeof(screen_header));
+    out.insert(out.end(), data, data + sn);
+  }
+
+  if (client->send_rl) {
+    uInt8 rl[1 + 4];
+    rl[0] = environment.isTerminal() ? 1 : 0;
+    putUInt32(rl + 1, (uInt32)(Int32)reward);
+    out.insert(out.end(), rl, rl + sizeof(rl));
+  }
+
+  putUInt32(&out[start], out.size() - start - 4);
+}
+
+#else
+
+struct EnvironmentServerController::Client {
+};
+
+EnvironmentServerController::EnvironmentServerController(OSystem* osystem) :
+  ALEController(osystem),
+  m_socket(-1),
+  m_epoll(-1),
+  m_wakeup(-1),
+  m_shutdown(false) {
+}
+
+EnvironmentServerController::~EnvironmentServerController() {
+}
+
+void EnvironmentServerController::run() {
+  ale::Logger::Error << "The environment server is only available on Linux." << std::endl;
+}
+
+#endif
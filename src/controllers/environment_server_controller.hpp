@@ -0,0 +1,89 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  environment_server_controller.hpp
+ *
+ *  The EnvironmentServerController class hosts one environment per agent
+ *  connecting to its UNIX domain socket, all within a single process. One
+ *  thread multiplexes the connections with epoll; the environments are
+ *  stepped by a pool of worker threads. Agents talk the binary FIFO protocol.
+ **************************************************************************** */
+
+#ifndef __ENVIRONMENT_SERVER_CONTROLLER_HPP__
+#define __ENVIRONMENT_SERVER_CONTROLLER_HPP__
+
+#include "ale_controller.hpp"
+
+#include <map>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class EnvironmentServerController : public ALEController {
+  public:
+    EnvironmentServerController(OSystem* osystem);
+    virtual ~EnvironmentServerController();
+
+    /** Serves agents until the socket fails. */
+    virtual void run();
+
+  private:
+    /** A connected agent and the environment it controls. */
+    struct Client;
+
+    /** Creates the listening socket; returns false on failure. */
+    bool openSocket();
+
+    /** Accepts every pending connection. */
+    void acceptClients();
+    /** Reads whatever the agent sent, then acts on it. */
+    void readClient(Client* client);
+    /** Parses the handshake or the next pair of actions, queueing work for the pool. */
+    void processInput(Client* client);
+    /** Writes as much pending output as the socket accepts. */
+    void flushClient(Client* client);
+    /** Closes the client if it is done with, else updates what epoll watches for. Returns
+        false if the client was closed. */
+    bool updateClient(Client* client);
+    void closeClient(Client* client);
+    /** Hands clients whose work is complete back to the event loop. */
+    void finishJobs();
+
+    /** Worker side: creates or steps the client's environment and encodes its reply. */
+    void workerLoop();
+    void serveClient(Client* client);
+    void startEnvironment(Client* client);
+    void encodeFrame(Client* client, reward_t reward);
+
+  private:
+    std::string m_socket_path; // Where agents connect
+    int m_socket; // Listening socket, or -1
+    int m_epoll; // Event multiplexer, or -1
+    int m_wakeup; // Signalled by workers when a job is complete, or -1
+    int m_max_num_frames; // Frames after which each environment stops
+
+    std::map<int, Client*> m_clients; // Connected agents, by socket; event loop only
+
+    // Worker pool; the queues are guarded by m_mutex. A client is in at most one queue,
+    //  and belongs to the worker pool from when it is queued until it is finished.
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_job_queued;
+    std::deque<Client*> m_jobs;
+    std::vector<Client*> m_finished;
+    bool m_shutdown;
+
+    // Serializes creating and destroying environments
+    std::mutex m_environment_mutex;
+};
+
+#endif // __ENVIRONMENT_SERVER_CONTROLLER_HPP__
@@ -18,8 +18,20 @@
 
 #include <stdio.h>
 #include <cassert>
+#include <cstring>
 #include "../common/Log.hpp"
 
+#if defined(WIN32) || defined(__MINGW32__)
+struct iovec {
+  void* iov_base;
+  size_t iov_len;
+};
+#else
+#include <sys/uio.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
 #define MAX_RUN_LENGTH (0xFF)
 
 static const char hexval[] = { 
@@ -35,7 +47,12 @@ inline void appendByte(char *buf, uInt8 v) {
 
 FIFOController::FIFOController(OSystem* _osystem, bool named_pipes) :
   ALEController(_osystem),
-  m_named_pipes(named_pipes) {
+  m_named_pipes(named_pipes),
+  m_fout(NULL),
+  m_fin(NULL),
+  latest_reward(0),
+  m_protocol(PROTOCOL_TEXT),
+  m_write_error(false) {
   m_max_num_frames = m_osystem->settings().getInt("max_num_frames");
   m_run_length_encoding = m_osystem->settings().getBool("run_length_encoding");
 }
@@ -56,7 +73,10 @@ void FIFOController::run() {
     // Send data over to agent
     sendData();
     // Read agent's response & process it
-    readAction(action_a, action_b);
+    if (m_protocol == PROTOCOL_TEXT)
+      readAction(action_a, action_b);
+    else
+      readBinaryAction(action_a, action_b);
 
     // Emulate Atari forward
     latest_reward = applyActions(action_a, action_b);
@@ -65,20 +85,32 @@ void FIFOController::run() {
     display();
   }
 
-  // Send a termination signal to the agent, if they're still around
-  if (!feof(m_fout))
+  // Send a termination signal to the agent, if they're still around; binary agents
+  //  receive an empty frame
+  if (m_protocol != PROTOCOL_TEXT) {
+    if (!m_write_error) {
+      uInt8 die[4];
+      struct iovec iov;
+      iov.iov_base = die;
+      iov.iov_len = putUInt32(die, 0) - die;
+      writeBinary(&iov, 1);
+    }
+  }
+  else if (!feof(m_fout))
     fprintf (m_fout, "DIE\n");
 }
 
 bool FIFOController::isDone() {
   // Die once we reach enough samples
   return ((m_max_num_frames > 0 && m_environment.getFrameNumber() >= m_max_num_frames) ||
-    feof(m_fin) || feof(m_fout) || ferror(m_fout));
+    feof(m_fin) || feof(m_fout) || ferror(m_fout) || m_write_error);
 }
 
 void FIFOController::handshake() {
-  // If using named pipes, open said files
-  if (m_named_pipes) {
+  // Streams may already have been provided, e.g. by the fork server
+  if (m_fin != NULL && m_fout != NULL) {
+    // Nothing to open
+  } else if (m_named_pipes) { // If using named pipes, open said files
     openNamedPipes();
   } else { // Otherwise read from stdin and output to stdout
       m_fout = stdout;
@@ -112,6 +144,24 @@ void FIFOController::handshake() {
   // Used to be frame skip; now obsolete
   token = strtok(NULL, ",\n");
   m_send_rl = atoi(token);
+
+  // Optional: a binary protocol; older agents send only the four fields above. We
+  //  acknowledge it so that agents can tell us apart from ALEs that only speak text.
+  token = strtok(NULL, ",\n");
+  if (token != NULL) {
+    int protocol = atoi(token);
+    if (protocol >= PROTOCOL_BINARY_RAW && protocol <= PROTOCOL_BINARY_SPANS) {
+      m_protocol = protocol;
+      m_screen_encoder.setProtocol(protocol,
+        m_osystem->settings().getInt("screen_keyframe_interval"));
+      fputs("binary-1\n", m_fout);
+      fflush(m_fout);
+    }
+    else if (protocol != PROTOCOL_TEXT) {
+      ale::Logger::Warning << "Unknown FIFO protocol " << protocol
+                           << "; using the text protocol" << std::endl;
+    }
+  }
 }
 
 void FIFOController::openNamedPipes() {
@@ -130,6 +180,11 @@ void FIFOController::openNamedPipes() {
 }
 
 void FIFOController::sendData() {
+  if (m_protocol != PROTOCOL_TEXT) {
+    sendBinaryData();
+    return;
+  }
+
   if (m_send_ram) sendRAM();
   if (m_send_screen) sendScreen();
   if (m_send_rl) sendRL();
@@ -250,3 +305,109 @@ void FIFOController::readAction(Action& action_a, Action& action_b) {
   action_b = (Action)atoi(token);
 }
 
+void FIFOController::sendBinaryData() {
+  // Frame: u32 length of what follows, u8 section flags, then each requested section:
+  //  RAM:    u16 size, raw bytes
+  //  screen: u8 encoding, u32 size, encoded pixels
+  //  RL:     u8 terminal, i32 reward
+  uInt8 header[4 + 1 + 2];
+  uInt8 screen_header[1 + 4];
+  uInt8 rl[1 + 4];
+  struct iovec iov[5];
+  int count = 0;
+  uInt32 length = 1;
+
+  uInt8 flags = (m_send_ram ? BINARY_RAM : 0) | (m_send_screen ? BINARY_SCREEN : 0) |
+    (m_send_rl ? BINARY_RL : 0);
+  uInt8 *hp = header + 4;
+  *hp++ = flags;
+
+  iov[count].iov_base = header;
+  count++;
+
+  if (m_send_ram) {
+    const ALERAM& ram = m_environment.getRAM();
+    hp = putUInt16(hp, ram.size());
+
+    iov[count].iov_base = ram.array();
+    iov[count].iov_len = ram.size();
+    length += 2 + ram.size();
+    count++;
+  }
+  iov[0].iov_len = hp - header;
+
+  if (m_send_screen) {
+    size_t sn;
+    const uInt8 *data = m_screen_encoder.encode(m_environment.getScreen(), sn);
+
+    screen_header[0] = (uInt8)m_protocol;
+    putUInt32(screen_header + 1, sn);
+    iov[count].iov_base = screen_header;
+    iov[count].iov_len = sizeof(screen_header);
+    count++;
+    iov[count].iov_base = const_cast<uInt8*>(data);
+    iov[count].iov_len = sn;
+    count++;
+    length += sizeof(screen_header) + sn;
+  }
+
+  if (m_send_rl) {
+    rl[0] = m_environment.isTerminal() ? 1 : 0;
+    putUInt32(rl + 1, (uInt32)(Int32)latest_reward);
+    iov[count].iov_base = rl;
+    iov[count].iov_len = sizeof(rl);
+    count++;
+    length += sizeof(rl);
+  }
+
+  putUInt32(header, length);
+
+  // The whole frame goes out in one system call
+  if (!writeBinary(iov, count))
+    m_write_error = true;
+}
+
+bool FIFOController::writeBinary(struct iovec* iov, int count) {
+#if defined(WIN32) || defined(__MINGW32__)
+  for (int i = 0; i < count; i++) {
+    if (fwrite(iov[i].iov_base, 1, iov[i].iov_len, m_fout) != iov[i].iov_len)
+      return false;
+  }
+  return fflush(m_fout) == 0;
+#else
+  int fd = fileno(m_fout);
+  while (count > 0) {
+    ssize_t n = writev(fd, iov, count);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+
+    // Skip over what was written; pipes may accept part of a large frame
+    while (count > 0 && (size_t)n >= iov->iov_len) {
+      n -= iov->iov_len;
+      iov++;
+      count--;
+    }
+    if (count > 0) {
+      iov->iov_base = (char*)iov->iov_base + n;
+      iov->iov_len -= n;
+    }
+  }
+  return true;
+#endif
+}
+
+void FIFOController::readBinaryAction(Action& action_a, Action& action_b) {
+  // Two little-endian 32-bit integers
+  uInt8 buffer[8];
+  if (fread(buffer, 1, sizeof(buffer), m_fin) != sizeof(buffer)) {
+    // The agent has probably hung up; see readAction()
+    action_a = PLAYER_A_NOOP;
+    action_b = PLAYER_B_NOOP;
+    return;
+  }
+
+  action_a = (Action)getInt32(buffer);
+  action_b = (Action)getInt32(buffer + 4);
+}
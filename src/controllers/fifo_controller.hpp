@@ -18,6 +18,10 @@
 #define __FIFO_CONTROLLER_HPP__
 
 #include "ale_controller.hpp"
+#include "binary_protocol.hpp"
+#include <vector>
+
+struct iovec;
 
 class FIFOController : public ALEController {
   public:
@@ -40,7 +44,12 @@ class FIFOController : public ALEController {
     void sendRAM();
     void sendRL();
 
-  private:
+    // Binary protocol, negotiated during the handshake
+    void sendBinaryData();
+    void readBinaryAction(Action& action_a, Action& action_b);
+    bool writeBinary(struct iovec* iov, int count);
+
+  protected:
     bool m_named_pipes; // Whether to use named pipes
 
     int m_max_num_frames; // Maximum number of total frames before we stop
@@ -50,10 +59,14 @@ class FIFOController : public ALEController {
     bool m_send_ram; // Agent requested RAM data
     bool m_send_rl; // Agent requested RL data
     
-    FILE* m_fout; 
+    FILE* m_fout; // Agent streams; subclasses may open these before run()
     FILE* m_fin; 
 
     reward_t latest_reward; // Most recent reward
+
+    int m_protocol; // Text (the default) or one of the binary screen encodings
+    bool m_write_error; // Whether a binary write to the agent failed
+    BinaryScreenEncoder m_screen_encoder; // Encodes screens for the binary protocols
 };
 
 #endif // __FIFO_CONTROLLER_HPP__
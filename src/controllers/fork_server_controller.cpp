@@ -0,0 +1,164 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and 
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details. 
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  fork_server_controller.cpp
+ *
+ *  The ForkServerController class keeps a template environment, loaded and
+ *  reset once, and forks a new process from it for every agent connecting to
+ *  its UNIX domain socket. Each child then talks the FIFO protocol over its
+ *  connection, starting from copy-on-write pages that are already warmed up.
+ **************************************************************************** */
+
+#include "fork_server_controller.hpp"
+#include "../common/Log.hpp"
+
+#if !(defined(WIN32) || defined(__MINGW32__))
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// Children inherit the template's recorders without their background threads, and would
+//  all write to the same files; so recording is disabled before the template is built
+static OSystem* withoutRecorders(OSystem* osystem) {
+  // The sound file is opened along with the OSystem, too early to be ignored: children
+  //  would append to it and rewrite its header through the one shared file offset
+  if (!osystem->settings().getString("record_sound_filename").empty()) {
+    ale::Logger::Error << "The fork server can't record sound; unset record_sound_filename."
+                       << std::endl;
+    exit(1);
+  }
+
+  static const char* recorders[] = { "record_screen_dir", "record_video_file",
+                                     "record_trajectory_file", "record_dataset_dir" };
+  for (size_t i = 0; i < sizeof(recorders) / sizeof(recorders[0]); i++) {
+    if (!osystem->settings().getString(recorders[i]).empty()) {
+      ale::Logger::Warning << "Warning: the fork server doesn't record; ignoring "
+                           << recorders[i] << "." << std::endl;
+      osystem->settings().setString(recorders[i], "");
+    }
+  }
+  return osystem;
+}
+
+ForkServerController::ForkServerController(OSystem* osystem) :
+  FIFOController(withoutRecorders(osystem), false),
+  m_socket(-1) {
+  m_socket_path = m_osystem->settings().getString("fork_server_socket");
+}
+
+ForkServerController::~ForkServerController() {
+  if (m_socket >= 0) {
+    close(m_socket);
+    unlink(m_socket_path.c_str());
+  }
+}
+
+bool ForkServerController::openSocket() {
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (m_socket_path.empty() || m_socket_path.size() >= sizeof(address.sun_path)) {
+    ale::Logger::Error << "Invalid fork server socket path: " << m_socket_path << std::endl;
+    return false;
+  }
+  strncpy(address.sun_path, m_socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+  m_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (m_socket < 0) {
+    ale::Logger::Error << "Could not create fork server socket: " << strerror(errno) << std::endl;
+    return false;
+  }
+
+  // Remove any socket left behind by a previous server
+  unlink(m_socket_path.c_str());
+  if (bind(m_socket, (struct sockaddr*)&address, sizeof(address)) < 0 ||
+      listen(m_socket, SOMAXCONN) < 0) {
+    ale::Logger::Error << "Could not listen on " << m_socket_path << ": "
+                       << strerror(errno) << std::endl;
+    close(m_socket);
+    m_socket = -1;
+    return false;
+  }
+
+  return true;
+}
+
+void ForkServerController::run() {
+  if (!openSocket())
+    return;
+
+  // Children are never waited for; let the kernel reap them
+  signal(SIGCHLD, SIG_IGN);
+
+  ale::Logger::Info << "Fork server listening on " << m_socket_path << std::endl;
+
+  while (true) {
+    int connection = accept(m_socket, NULL, NULL);
+    if (connection < 0) {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      ale::Logger::Error << "Fork server stopped: " << strerror(errno) << std::endl;
+      break;
+    }
+
+    // Draw the child's seed from the template, so that children differ from one another
+    //  but a fixed random_seed still yields a reproducible sequence of children
+    uInt32 seed = m_osystem->rng().next();
+
+    pid_t pid = fork();
+    if (pid == 0) {
+      close(m_socket);
+      m_socket = -1;
+      serve(connection, seed);
+    }
+    else if (pid < 0) {
+      ale::Logger::Error << "Could not fork environment: " << strerror(errno) << std::endl;
+    }
+
+    close(connection);
+  }
+}
+
+void ForkServerController::serve(int connection, uInt32 seed) {
+  m_osystem->rng().seed(seed);
+
+  m_fin = fdopen(connection, "r");
+  m_fout = fdopen(dup(connection), "w");
+  if (m_fin != NULL && m_fout != NULL)
+    FIFOController::run();
+
+  if (m_fin != NULL) fclose(m_fin);
+  if (m_fout != NULL) fclose(m_fout);
+
+  // Leave without running the template's destructors and exit handlers
+  _exit(0);
+}
+
+#else
+
+ForkServerController::ForkServerController(OSystem* osystem) :
+  FIFOController(osystem, false),
+  m_socket(-1) {
+}
+
+ForkServerController::~ForkServerController() {
+}
+
+void ForkServerController::run() {
+  ale::Logger::Error << "The fork server is only available on POSIX systems." << std::endl;
+}
+
+#endif
@@ -0,0 +1,44 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and 
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details. 
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  fork_server_controller.hpp
+ *
+ *  The ForkServerController class keeps a template environment, loaded and
+ *  reset once, and forks a new process from it for every agent connecting to
+ *  its UNIX domain socket. Each child then talks the FIFO protocol over its
+ *  connection, starting from copy-on-write pages that are already warmed up.
+ **************************************************************************** */
+
+#ifndef __FORK_SERVER_CONTROLLER_HPP__
+#define __FORK_SERVER_CONTROLLER_HPP__
+
+#include "fifo_controller.hpp"
+
+class ForkServerController : public FIFOController {
+  public:
+    ForkServerController(OSystem* osystem);
+    virtual ~ForkServerController();
+
+    /** Accepts connections until the socket fails, forking one child per agent. */
+    virtual void run();
+
+  private:
+    /** Creates the listening socket; returns false on failure. */
+    bool openSocket();
+
+    /** Child side: re-seeds the RNG and serves the agent on the given connection. */
+    void serve(int connection, uInt32 seed);
+
+  private:
+    std::string m_socket_path; // Where agents connect to request a new environment
+    int m_socket; // Listening socket, or -1
+};
+
+#endif // __FORK_SERVER_CONTROLLER_HPP__
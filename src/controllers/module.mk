@@ -3,6 +3,9 @@ MODULE := src/controllers
 MODULE_OBJS := \
 	src/controllers/ale_controller.o \
 	src/controllers/fifo_controller.o \
+	src/controllers/fork_server_controller.o \
+	src/controllers/shared_memory_controller.o \
+	src/controllers/environment_server_controller.o \
 	src/controllers/rlglue_controller.o \
 	
 MODULE_DIRS += \
@@ -0,0 +1,197 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and 
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details. 
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  shared_memory_controller.cpp
+ *
+ *  The SharedMemoryController class implements an Agent/ALE interface through
+ *  a POSIX shared-memory region: observations are published into a ring of
+ *  slots which the agent reads in place, and actions come back through a
+ *  mailbox. See shared_memory_layout.h for the layout and handshake.
+ **************************************************************************** */
+
+#include "shared_memory_controller.hpp"
+#include "../common/Log.hpp"
+
+#if !(defined(WIN32) || defined(__MINGW32__))
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// How long to sleep between checks that the agent is still alive
+static const long AgentCheckIntervalNs = 100 * 1000 * 1000;
+
+SharedMemoryController::SharedMemoryController(OSystem* osystem) :
+  ALEController(osystem),
+  m_header(NULL),
+  m_region_size(0),
+  m_seq(0) {
+  m_name = m_osystem->settings().getString("shm_name");
+  m_num_slots = m_osystem->settings().getInt("shm_slots");
+  if (m_num_slots < 2) {
+    ale::Logger::Warning << "Warning: shm_slots set to < 2. Setting to 2." << std::endl;
+    m_num_slots = 2;
+  }
+  m_max_num_frames = m_osystem->settings().getInt("max_num_frames");
+}
+
+SharedMemoryController::~SharedMemoryController() {
+  if (m_header != NULL) {
+    // Tell the agent we are gone; its mapping outlives the name
+    ale_shm_store(&m_header->state, ALE_SHM_CLOSED);
+    ale_shm_store(&m_header->obs_seq, m_seq + 1);
+    ale_shm_wake(&m_header->obs_seq);
+
+    munmap(m_header, m_region_size);
+    shm_unlink(m_name.c_str());
+  }
+}
+
+bool SharedMemoryController::openRegion() {
+  const ALEScreen& screen = m_environment.getScreen();
+
+  // Slots are cache-line aligned so that screens can be read with aligned loads
+  size_t slot_size = sizeof(ale_shm_slot_t) + screen.arraySize();
+  slot_size = (slot_size + 63) & ~(size_t)63;
+  size_t slots_offset = sizeof(ale_shm_header_t);
+  m_region_size = slots_offset + slot_size * m_num_slots;
+
+  // Remove any region left behind by a previous run
+  shm_unlink(m_name.c_str());
+  int fd = shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    ale::Logger::Error << "Could not create shared memory " << m_name << ": "
+                       << strerror(errno) << std::endl;
+    return false;
+  }
+
+  void* region = MAP_FAILED;
+  if (ftruncate(fd, m_region_size) == 0)
+    region = mmap(NULL, m_region_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if (region == MAP_FAILED) {
+    ale::Logger::Error << "Could not map shared memory " << m_name << ": "
+                       << strerror(errno) << std::endl;
+    shm_unlink(m_name.c_str());
+    return false;
+  }
+
+  // The region comes zero-filled, so all sequence numbers start at 0
+  m_header = static_cast<ale_shm_header_t*>(region);
+  m_header->magic = ALE_SHM_MAGIC;
+  m_header->version = ALE_SHM_VERSION;
+  m_header->width = screen.width();
+  m_header->height = screen.height();
+  m_header->num_slots = m_num_slots;
+  m_header->slot_size = slot_size;
+  m_header->slots_offset = slots_offset;
+
+  return true;
+}
+
+void SharedMemoryController::publish(reward_t reward) {
+  uInt32 seq = m_seq + 1;
+  ale_shm_slot_t* slot = ale_shm_slot(m_header, seq);
+
+  slot->seq = seq;
+  slot->reward = (int32_t)reward;
+  slot->terminal = m_environment.isTerminal();
+  slot->lives = m_settings->lives();
+  slot->frame_number = m_environment.getFrameNumber();
+  slot->episode_frame_number = m_environment.getEpisodeFrameNumber();
+
+  const ALERAM& ram = m_environment.getRAM();
+  memcpy(slot->ram, ram.array(), sizeof(slot->ram));
+  const ALEScreen& screen = m_environment.getScreen();
+  memcpy(ale_shm_screen(slot), screen.getArray(), screen.arraySize());
+
+  // Release the slot's contents along with its number
+  m_seq = seq;
+  ale_shm_store(&m_header->obs_seq, seq);
+  ale_shm_wake(&m_header->obs_seq);
+}
+
+bool SharedMemoryController::waitForAction(Action& action_a, Action& action_b) {
+  volatile uint32_t* action_seq = &m_header->action_seq;
+
+  uint32_t seen = ale_shm_load(action_seq);
+  while (seen != m_seq) {
+    seen = ale_shm_wait(action_seq, seen, AgentCheckIntervalNs);
+    if (seen == m_seq)
+      break;
+
+    // Until an agent attaches there is nobody to check on
+    pid_t agent = m_header->agent_pid;
+    if (agent < 0) {
+      ale::Logger::Info << "Agent detached" << std::endl;
+      return false;
+    }
+    if (agent > 0 && kill(agent, 0) < 0 && errno == ESRCH) {
+      ale::Logger::Info << "Agent " << agent << " went away" << std::endl;
+      return false;
+    }
+  }
+
+  action_a = (Action)m_header->action_a;
+  action_b = (Action)m_header->action_b;
+  return true;
+}
+
+bool SharedMemoryController::isDone() {
+  // Die once we reach enough samples
+  return (m_max_num_frames > 0 && m_environment.getFrameNumber() >= m_max_num_frames);
+}
+
+void SharedMemoryController::run() {
+  if (!openRegion())
+    return;
+
+  ale::Logger::Info << "Waiting for an agent on shared memory " << m_name << std::endl;
+  ale_shm_store(&m_header->state, ALE_SHM_RUNNING);
+
+  Action action_a, action_b;
+  reward_t reward = 0;
+
+  while (!isDone()) {
+    publish(reward);
+    if (!waitForAction(action_a, action_b))
+      break;
+
+    // Emulate Atari forward
+    reward = applyActions(action_a, action_b);
+
+    // Update display if needed
+    display();
+  }
+}
+
+#else
+
+SharedMemoryController::SharedMemoryController(OSystem* osystem) :
+  ALEController(osystem),
+  m_header(NULL),
+  m_region_size(0),
+  m_seq(0) {
+}
+
+SharedMemoryController::~SharedMemoryController() {
+}
+
+void SharedMemoryController::run() {
+  ale::Logger::Error << "The shared memory controller is only available on POSIX systems."
+                     << std::endl;
+}
+
+#endif
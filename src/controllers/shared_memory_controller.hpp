@@ -0,0 +1,57 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and 
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details. 
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  shared_memory_controller.hpp
+ *
+ *  The SharedMemoryController class implements an Agent/ALE interface through
+ *  a POSIX shared-memory region: observations are published into a ring of
+ *  slots which the agent reads in place, and actions come back through a
+ *  mailbox. See shared_memory_layout.h for the layout and handshake.
+ **************************************************************************** */
+
+#ifndef __SHARED_MEMORY_CONTROLLER_HPP__
+#define __SHARED_MEMORY_CONTROLLER_HPP__
+
+#include "ale_controller.hpp"
+#include "shared_memory_layout.h"
+
+class SharedMemoryController : public ALEController {
+  public:
+    SharedMemoryController(OSystem* osystem);
+    virtual ~SharedMemoryController();
+
+    /** Publishes observations and applies the agent's actions until ALE terminates
+        or the agent goes away. */
+    virtual void run();
+
+  private:
+    /** Creates and maps the shared-memory region; returns false on failure. */
+    bool openRegion();
+
+    /** Writes the current observation into the next slot and publishes it. */
+    void publish(reward_t reward);
+
+    /** Waits for the agent to answer the last observation; returns false if it
+        went away. */
+    bool waitForAction(Action& action_a, Action& action_b);
+
+    bool isDone();
+
+  private:
+    std::string m_name; // Name of the shared-memory object
+    int m_num_slots; // Number of observation slots in the ring
+    int m_max_num_frames; // Maximum number of total frames before we stop
+
+    ale_shm_header_t* m_header; // The mapped region, or NULL
+    size_t m_region_size;
+    uInt32 m_seq; // Number of the last published observation
+};
+
+#endif // __SHARED_MEMORY_CONTROLLER_HPP__
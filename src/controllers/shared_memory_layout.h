@@ -0,0 +1,148 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  shared_memory_layout.h
+ *
+ *  Layout of the POSIX shared-memory region used by the SharedMemoryController,
+ *  and the signalling helpers both sides use. Plain C, so that agents written
+ *  in other languages can include it (or mirror it) without the rest of ALE.
+ *
+ *  The region starts with an ale_shm_header_t, followed by num_slots
+ *  observation slots of slot_size bytes each, starting at slots_offset. Each
+ *  slot is an ale_shm_slot_t followed by width * height screen bytes.
+ *
+ *  Observation n (counting from 1) is written to slot (n - 1) % num_slots, and
+ *  published by storing n into obs_seq. The agent answers it by writing its
+ *  actions into the mailbox and storing n into action_seq. ALE only writes
+ *  observation n + 1 once action n has been posted, so the agent may keep
+ *  using the last num_slots - 1 observations in place.
+ *
+ *  The agent stores its pid into agent_pid when it attaches, and -1 when it
+ *  detaches; ALE stops if the agent detaches or dies. ALE sets state to
+ *  ALE_SHM_CLOSED and bumps obs_seq when it stops.
+ **************************************************************************** */
+
+#ifndef __SHARED_MEMORY_LAYOUT_H__
+#define __SHARED_MEMORY_LAYOUT_H__
+
+#include <stdint.h>
+#include <time.h>
+
+#define ALE_SHM_MAGIC    (0x4D48534Cu) /* "LSHM" */
+#define ALE_SHM_VERSION  (1)
+#define ALE_SHM_RAM_SIZE (128)
+
+/* Values of ale_shm_header_t::state */
+#define ALE_SHM_STARTING (0)
+#define ALE_SHM_RUNNING  (1)
+#define ALE_SHM_CLOSED   (2)
+
+typedef struct {
+  /* Fixed once the region is created */
+  uint32_t magic;
+  uint32_t version;
+  uint32_t width;
+  uint32_t height;
+  uint32_t num_slots;
+  uint32_t slot_size;
+  uint32_t slots_offset;
+  uint32_t reserved0;
+
+  /* Written by ALE */
+  volatile uint32_t state;
+  volatile uint32_t obs_seq;      /* Last published observation; futex word */
+  uint8_t pad0[64 - 10 * sizeof(uint32_t)];
+
+  /* Written by the agent, on its own cache line */
+  volatile int32_t agent_pid;     /* 0 before attaching, -1 after detaching */
+  volatile uint32_t action_seq;   /* Last answered observation; futex word */
+  volatile int32_t action_a;
+  volatile int32_t action_b;
+  uint8_t pad1[64 - 4 * sizeof(uint32_t)];
+} ale_shm_header_t;
+
+typedef struct {
+  uint32_t seq;                   /* Observation number stored in this slot */
+  int32_t reward;                 /* Reward obtained by the previous action */
+  uint32_t terminal;
+  int32_t lives;
+  uint32_t frame_number;
+  uint32_t episode_frame_number;
+  uint8_t reserved[8];
+  uint8_t ram[ALE_SHM_RAM_SIZE];
+  /* The screen, one palette index per pixel and row by row, follows */
+} ale_shm_slot_t;
+
+static inline ale_shm_slot_t* ale_shm_slot(ale_shm_header_t* header, uint32_t seq) {
+  return (ale_shm_slot_t*)((uint8_t*)header + header->slots_offset +
+      (size_t)((seq - 1) % header->num_slots) * header->slot_size);
+}
+
+static inline uint8_t* ale_shm_screen(ale_shm_slot_t* slot) {
+  return (uint8_t*)(slot + 1);
+}
+
+static inline uint32_t ale_shm_load(volatile uint32_t* word) {
+  return __atomic_load_n(word, __ATOMIC_ACQUIRE);
+}
+
+static inline void ale_shm_store(volatile uint32_t* word, uint32_t value) {
+  __atomic_store_n(word, value, __ATOMIC_RELEASE);
+}
+
+#ifdef __linux__
+#include <limits.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+/* Wakes every process waiting on the given word */
+static inline void ale_shm_wake(volatile uint32_t* word) {
+  syscall(SYS_futex, word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+/* Sleeps while the word still equals seen, for at most timeout_ns nanoseconds */
+static inline void ale_shm_sleep(volatile uint32_t* word, uint32_t seen, long timeout_ns) {
+  struct timespec timeout;
+  timeout.tv_sec = timeout_ns / 1000000000L;
+  timeout.tv_nsec = timeout_ns % 1000000000L;
+  syscall(SYS_futex, word, FUTEX_WAIT, seen, &timeout, NULL, 0);
+}
+#else
+/* Without futexes waiters poll, so there is no one to wake */
+static inline void ale_shm_wake(volatile uint32_t* word) {
+  (void)word;
+}
+
+static inline void ale_shm_sleep(volatile uint32_t* word, uint32_t seen, long timeout_ns) {
+  struct timespec pause;
+  (void)word;
+  (void)seen;
+  pause.tv_sec = 0;
+  pause.tv_nsec = timeout_ns < 50000L ? timeout_ns : 50000L;
+  nanosleep(&pause, NULL);
+}
+#endif
+
+/* Waits until the word differs from seen, spinning briefly before sleeping for at
+   most timeout_ns. Returns the word's value, which is still seen on a timeout. */
+static inline uint32_t ale_shm_wait(volatile uint32_t* word, uint32_t seen, long timeout_ns) {
+  uint32_t value;
+  int spins;
+  for (spins = 0; spins < 2000; spins++) {
+    value = ale_shm_load(word);
+    if (value != seen) return value;
+  }
+
+  ale_shm_sleep(word, seen, timeout_ns);
+  return ale_shm_load(word);
+}
+
+#endif /* __SHARED_MEMORY_LAYOUT_H__ */
@@ -50,10 +50,12 @@
 #include "Settings.hxx"
 using namespace std;
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-Cartridge* Cartridge::create(const uInt8* image, uInt32 size,
+Cartridge* Cartridge::create(const RomImagePtr& rom,
     const Properties& properties, const Settings& settings)
 {
   Cartridge* cartridge = 0;
+  const uInt8* image = rom->image();
+  uInt32 size = rom->size();
 
   // Get the type of the cartridge we're creating
   const string& md5 = properties.get(Cartridge_MD5);
@@ -138,6 +140,9 @@ Cartridge* Cartridge::create(const uInt8* image, uInt32 size,
   else
     ale::Logger::Error << "ERROR: Invalid cartridge type " << type << " ..." << endl;
 
+  if(cartridge)
+    cartridge->myRomImage = rom;
+
   return cartridge;
 }
 
@@ -157,7 +162,7 @@ bool Cartridge::save(ofstream& out)
 {
   int size = -1;
 
-  uInt8* image = getImage(size);
+  const uInt8* image = getImage(size);
   if(image == 0 || size <= 0)
   {
     ale::Logger::Error << "save not supported" << endl;
@@ -28,6 +28,7 @@ class Settings;
 #include "m6502/src/bspf/src/bspf.hxx"
 #include "m6502/src/Device.hxx"
 #include "../common/Log.hpp"
+#include "RomImage.hxx"
 
 /**
   A cartridge is a device which contains the machine code for a 
@@ -43,13 +44,18 @@ class Cartridge : public Device
       Create a new cartridge object allocated on the heap.  The
       type of cartridge created depends on the properties object.
 
-      @param image    A pointer to the ROM image
-      @param size     The size of the ROM image 
+      The cartridge keeps a reference to the (shared) ROM image, so
+      bank data may be read from it directly for the cartridge's lifetime.
+      Cartridges whose banks are pure ROM (2K, 4K, E0, E7, F4, F6, F8 and
+      their SC variants, FASC, FE, MB and UA) point into the image instead
+      of copying it; the others keep private copies they can modify.
+
+      @param rom      The ROM image
       @param props    The properties associated with the game
       @param settings The settings associated with the system
       @return   Pointer to the new cartridge object allocated on the heap
     */
-    static Cartridge* create(const uInt8* image, uInt32 size, 
+    static Cartridge* create(const RomImagePtr& rom,
         const Properties& props, const Settings& settings);
 
     /**
@@ -106,7 +112,9 @@ class Cartridge : public Device
     virtual int bankCount() = 0;
 
     /**
-      Patch the cartridge ROM.
+      Patch the cartridge ROM.  Cartridges that point into the shared
+      ROM image can't be patched, since that would change the game for
+      every console running it, and return false.
 
       @param address  The ROM address to patch
       @param value    The value to place into the address
@@ -120,7 +128,7 @@ class Cartridge : public Device
       @param size  Set to the size of the internal ROM image data
       @return  A pointer to the internal ROM image data
     */
-    virtual uInt8* getImage(int& size) = 0;
+    virtual const uInt8* getImage(int& size) = 0;
 
   protected:
     // If bankLocked is true, ignore attempts at bankswitching. This is used
@@ -196,6 +204,10 @@ class Cartridge : public Device
     // Contains info about this cartridge in string format
     static std::string myAboutString;
 
+    // The ROM image this cartridge was created from; held so that
+    // cartridges can reference its banks instead of copying them
+    RomImagePtr myRomImage;
+
     // Copy constructor isn't supported by cartridges so make it private
     Cartridge(const Cartridge&);
 
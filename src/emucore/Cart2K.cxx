@@ -21,16 +21,13 @@
 #include "System.hxx"
 #include "Serializer.hxx"
 #include "Deserializer.hxx"
+#include "Journal.hxx"
 #include "Cart2K.hxx"
 using namespace std;
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Cartridge2K::Cartridge2K(const uInt8* image)
 {
-  // Copy the ROM image into my buffer
-  for(uInt32 addr = 0; addr < 2048; ++addr)
-  {
-    myImage[addr] = image[addr];
-  }
+  myImage = image;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -130,6 +127,11 @@ bool Cartridge2K::load(Deserializer& in)
   return true;
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Cartridge2K::checkpoint(Journal&)
+{
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Cartridge2K::bank(uInt16 bank)
 {
@@ -152,12 +154,11 @@ int Cartridge2K::bankCount()
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 bool Cartridge2K::patch(uInt16 address, uInt8 value)
 {
-  myImage[address & 0x07FF] = value;
-  return true;
+  return false;
 } 
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-uInt8* Cartridge2K::getImage(int& size)
+const uInt8* Cartridge2K::getImage(int& size)
 {
   size = 2048;
   return &myImage[0];
@@ -86,6 +86,13 @@ class Cartridge2K : public Cartridge
     */
     virtual bool load(Deserializer& in);
 
+    /**
+      Records nothing in the given journal, as the cartridge has no state.
+
+      @param journal The journal to record to
+    */
+    virtual void checkpoint(Journal& journal);
+
     /**
       Install pages for the specified bank in the system.
 
@@ -120,7 +127,7 @@ class Cartridge2K : public Cartridge
       @param size  Set to the size of the internal ROM image data
       @return  A pointer to the internal ROM image data
     */
-    virtual uInt8* getImage(int& size);
+    virtual const uInt8* getImage(int& size);
 
   public:
     /**
@@ -140,7 +147,7 @@ class Cartridge2K : public Cartridge
 
   private:
     // The 2k ROM image for the cartridge
-    uInt8 myImage[2048];
+    const uInt8* myImage;
 };
 
 #endif
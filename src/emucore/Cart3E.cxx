@@ -303,7 +303,7 @@ bool Cartridge3E::patch(uInt16 address, uInt8 value)
 } 
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-uInt8* Cartridge3E::getImage(int& size)
+const uInt8* Cartridge3E::getImage(int& size)
 {
   size = mySize;
   return &myImage[0];
@@ -149,7 +149,7 @@ class Cartridge3E : public Cartridge
       @param size  Set to the size of the internal ROM image data
       @return  A pointer to the internal ROM image data
     */
-    virtual uInt8* getImage(int& size);
+    virtual const uInt8* getImage(int& size);
 
   public:
     /**
@@ -237,7 +237,7 @@ bool Cartridge3F::patch(uInt16 address, uInt8 value)
 } 
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-uInt8* Cartridge3F::getImage(int& size)
+const uInt8* Cartridge3F::getImage(int& size)
 {
   size = mySize;
   return &myImage[0];
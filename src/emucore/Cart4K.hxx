@@ -85,6 +85,13 @@ class Cartridge4K : public Cartridge
     */
     virtual bool load(Deserializer& in);
 
+    /**
+      Records nothing in the given journal, as the cartridge has no state.
+
+      @param journal The journal to record to
+    */
+    virtual void checkpoint(Journal& journal);
+
     /**
       Install pages for the specified bank in the system.
 
@@ -119,7 +126,7 @@ class Cartridge4K : public Cartridge
       @param size  Set to the size of the internal ROM image data
       @return  A pointer to the internal ROM image data
     */
-    virtual uInt8* getImage(int& size);
+    virtual const uInt8* getImage(int& size);
 
   public:
     /**
@@ -139,7 +146,7 @@ class Cartridge4K : public Cartridge
 
   private:
     // The 4K ROM image for the cartridge
-    uInt8 myImage[4096];
+    const uInt8* myImage;
 };
 
 #endif
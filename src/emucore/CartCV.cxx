@@ -217,7 +217,7 @@ bool CartridgeCV::patch(uInt16 address, uInt8 value)
 } 
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-uInt8* CartridgeCV::getImage(int& size)
+const uInt8* CartridgeCV::getImage(int& size)
 {
   size = 2048;
   return &myImage[0];
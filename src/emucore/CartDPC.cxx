@@ -597,7 +597,7 @@ bool CartridgeDPC::patch(uInt16 address, uInt8 value)
 } 
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-uInt8* CartridgeDPC::getImage(int& size)
+const uInt8* CartridgeDPC::getImage(int& size)
 {
   size = 8192 + 2048 + 255;
 
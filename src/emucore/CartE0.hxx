@@ -124,7 +124,7 @@ class CartridgeE0 : public Cartridge
       @param size  Set to the size of the internal ROM image data
       @return  A pointer to the internal ROM image data
     */
-    virtual uInt8* getImage(int& size);
+    virtual const uInt8* getImage(int& size);
 
   public:
     /**
@@ -169,7 +169,7 @@ class CartridgeE0 : public Cartridge
     uInt16 myCurrentSlice[4];
 
     // The 8K ROM image of the cartridge
-    uInt8 myImage[8192];
+    const uInt8* myImage;
 };
 
 #endif
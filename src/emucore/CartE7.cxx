@@ -28,11 +28,7 @@ using namespace std;
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 CartridgeE7::CartridgeE7(const uInt8* image)
 {
-  // Copy the ROM image into my buffer
-  for(uInt32 addr = 0; addr < 16384; ++addr)
-  {
-    myImage[addr] = image[addr];
-  }
+  myImage = image;
 
   // Initialize RAM with random values
   class Random& random = Random::getInstance();
@@ -311,14 +307,11 @@ int CartridgeE7::bankCount()
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 bool CartridgeE7::patch(uInt16 address, uInt8 value)
 {
-  address = address & 0x0FFF;
-  myImage[(myCurrentSlice[address >> 11] << 11) + (address & 0x07FF)] = value;
-  bank(myCurrentSlice[0]);
-  return true;
+  return false;
 } 
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-uInt8* CartridgeE7::getImage(int& size)
+const uInt8* CartridgeE7::getImage(int& size)
 {
   size = 16384;
   return &myImage[0];
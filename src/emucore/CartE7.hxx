@@ -141,7 +141,7 @@ class CartridgeE7 : public Cartridge
       @param size  Set to the size of the internal ROM image data
       @return  A pointer to the internal ROM image data
     */
-    virtual uInt8* getImage(int& size);
+    virtual const uInt8* getImage(int& size);
 
   public:
     /**
@@ -175,7 +175,7 @@ class CartridgeE7 : public Cartridge
     uInt16 myCurrentRAM;
 
     // The 16K ROM image of the cartridge
-    uInt8 myImage[16384];
+    const uInt8* myImage;
 
     // The 2048 bytes of RAM
     uInt8 myRAM[2048];
@@ -85,6 +85,18 @@ class CartridgeF4 : public Cartridge
     */
     virtual bool load(Deserializer& in);
 
+    /**
+      Records the current bank in the given journal when a checkpoint is taken.
+
+      @param journal The journal to record to
+    */
+    virtual void checkpoint(Journal& journal);
+
+    /**
+      Remaps the current bank after a rollback.
+    */
+    virtual void journalRestored();
+
     /**
       Install pages for the specified bank in the system.
 
@@ -119,7 +131,7 @@ class CartridgeF4 : public Cartridge
       @param size  Set to the size of the internal ROM image data
       @return  A pointer to the internal ROM image data
     */
-    virtual uInt8* getImage(int& size);
+    virtual const uInt8* getImage(int& size);
 
   public:
     /**
@@ -142,7 +154,7 @@ class CartridgeF4 : public Cartridge
     uInt16 myCurrentBank;
 
     // The 16K ROM image of the cartridge
-    uInt8 myImage[32768];
+    const uInt8* myImage;
 };
 
 #endif
@@ -22,17 +22,14 @@
 #include "System.hxx"
 #include "Serializer.hxx"
 #include "Deserializer.hxx"
+#include "Journal.hxx"
 #include "CartF4SC.hxx"
 using namespace std;
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 CartridgeF4SC::CartridgeF4SC(const uInt8* image)
 {
-  // Copy the ROM image into my buffer
-  for(uInt32 addr = 0; addr < 32768; ++addr)
-  {
-    myImage[addr] = image[addr];
-  }
+  myImage = image;
 
   // Initialize RAM with random values
   class Random& random = Random::getInstance();
@@ -197,6 +194,20 @@ bool CartridgeF4SC::load(Deserializer& in)
   return true;
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void CartridgeF4SC::checkpoint(Journal& journal)
+{
+  // The RAM is only written through the system, which journals it
+  journal.notify(*this);
+  journal.save(myCurrentBank);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void CartridgeF4SC::journalRestored()
+{
+  bank(myCurrentBank);
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void CartridgeF4SC::bank(uInt16 bank)
 { 
@@ -237,13 +248,11 @@ int CartridgeF4SC::bankCount()
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 bool CartridgeF4SC::patch(uInt16 address, uInt8 value)
 {
-  address = address & 0x0FFF;
-  myImage[myCurrentBank * 4096 + address] = value;
-  return true;
+  return false;
 } 
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-uInt8* CartridgeF4SC::getImage(int& size)
+const uInt8* CartridgeF4SC::getImage(int& size)
 {
   size = 32768;
   return &myImage[0];
@@ -86,6 +86,18 @@ class CartridgeF8 : public Cartridge
     */
     virtual bool load(Deserializer& in);
 
+    /**
+      Records the current bank in the given journal when a checkpoint is taken.
+
+      @param journal The journal to record to
+    */
+    virtual void checkpoint(Journal& journal);
+
+    /**
+      Remaps the current bank after a rollback.
+    */
+    virtual void journalRestored();
+
     /**
       Install pages for the specified bank in the system.
 
@@ -120,7 +132,7 @@ class CartridgeF8 : public Cartridge
       @param size  Set to the size of the internal ROM image data
       @return  A pointer to the internal ROM image data
     */
-    virtual uInt8* getImage(int& size);
+    virtual const uInt8* getImage(int& size);
 
   public:
     /**
@@ -146,7 +158,7 @@ class CartridgeF8 : public Cartridge
     uInt16 myResetBank;
 
     // The 8K ROM image of the cartridge
-    uInt8 myImage[8192];
+    const uInt8* myImage;
 };
 
 #endif
@@ -320,7 +320,7 @@ bool CartridgeMC::patch(uInt16 address, uInt8 value)
 } 
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-uInt8* CartridgeMC::getImage(int& size)
+const uInt8* CartridgeMC::getImage(int& size)
 {
   size = 128 * 1024; // FIXME: keep track of original size
   return &myImage[0];
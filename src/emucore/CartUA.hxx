@@ -120,7 +120,7 @@ class CartridgeUA : public Cartridge
       @param size  Set to the size of the internal ROM image data
       @return  A pointer to the internal ROM image data
     */
-    virtual uInt8* getImage(int& size);
+    virtual const uInt8* getImage(int& size);
 
   public:
     /**
@@ -143,7 +143,7 @@ class CartridgeUA : public Cartridge
     uInt16 myCurrentBank;
 
     // The 8K ROM image of the cartridge
-    uInt8 myImage[8192];
+    const uInt8* myImage;
    
     // Previous Device's page access
     System::PageAccess myHotSpotPageAccess;
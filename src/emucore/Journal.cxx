@@ -0,0 +1,158 @@
+//============================================================================
+//
+//   SSSS    tt          lll  lll
+//  SS  SS   tt           ll   ll
+//  SS     tttttt  eeee   ll   ll   aaaa
+//   SSSS    tt   ee  ee  ll   ll      aa
+//      SS   tt   eeeeee  ll   ll   aaaaa  --  "An Atari 2600 VCS Emulator"
+//  SS  SS   tt   ee      ll   ll  aa  aa
+//   SSSS     ttt  eeeee llll llll  aaaaa
+//
+// Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+//
+// See the file "license" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//
+//============================================================================
+
+#include <algorithm>
+#include <unordered_set>
+
+#include "Device.hxx"
+#include "Journal.hxx"
+using namespace std;
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Journal::Journal()
+  : myNextId(0)
+{
+  scheduleCompaction(0);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Journal::Checkpoint Journal::begin()
+{
+  Entry entry;
+  entry.checkpoint.depth = myCheckpoints.size();
+  entry.checkpoint.id = myNextId++;
+  entry.begin = entry.end = myRecords.size();
+  entry.dataEnd = myData.size();
+  myCheckpoints.push_back(entry);
+  scheduleCompaction(0);
+
+  return entry.checkpoint;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Journal::end()
+{
+  Entry& entry = myCheckpoints.back();
+  entry.end = myRecords.size();
+  entry.dataEnd = myData.size();
+  scheduleCompaction(0);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+bool Journal::rollback(const Checkpoint& checkpoint)
+{
+  if(checkpoint.depth >= myCheckpoints.size() ||
+     myCheckpoints[checkpoint.depth].checkpoint.id != checkpoint.id)
+    return false;
+
+  const Entry entry = myCheckpoints[checkpoint.depth];
+
+  // Undo the writes and snapshots since the checkpoint, then reapply its
+  // own snapshot, which holds the registers as they were when it was taken
+  undo(myRecords.size(), entry.end);
+  undo(entry.end, entry.begin);
+
+  myRecords.resize(entry.end);
+  myData.resize(entry.dataEnd);
+  myCheckpoints.resize(checkpoint.depth + 1);
+  scheduleCompaction(0);
+
+  return true;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Journal::undo(size_t from, size_t to)
+{
+  while(from > to)
+  {
+    const Record& r = myRecords[--from];
+    if(r.restore != 0)
+      r.restore(r.address, r.size > 0 ? &myData[r.offset] : 0, r.size);
+    else if(r.size == 1)
+      *(uInt8*)r.address = myData[r.offset];
+    else
+      memcpy(r.address, &myData[r.offset], r.size);
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Journal::compact()
+{
+  const Entry& entry = myCheckpoints.back();
+
+  // Rolling back leaves each byte with its oldest value; the newer ones go
+  unordered_set<const void*> recorded;
+  size_t kept = entry.end, dataEnd = entry.dataEnd;
+  for(size_t i = entry.end; i < myRecords.size(); ++i)
+  {
+    Record r = myRecords[i];
+    if(r.restore == 0 && r.size == 1 && !recorded.insert(r.address).second)
+      continue;
+
+    if(r.size > 0)
+      memmove(&myData[dataEnd], &myData[r.offset], r.size);
+    r.offset = dataEnd;
+    dataEnd += r.size;
+    myRecords[kept++] = r;
+  }
+  myRecords.resize(kept);
+  myData.resize(dataEnd);
+
+  scheduleCompaction(kept - entry.end);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Journal::scheduleCompaction(size_t compacted)
+{
+  myCompactAt = myRecords.size() + max(compacted, (size_t)CompactionThreshold);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Journal::clear()
+{
+  myRecords.clear();
+  myData.clear();
+  myCheckpoints.clear();
+  scheduleCompaction(0);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+size_t Journal::size() const
+{
+  return myRecords.size() * sizeof(Record) + myData.size();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Journal::saveObject(void* object, const string& data, Restore restore)
+{
+  Record r = { object, (uInt32)data.size(), myData.size(), restore };
+  myRecords.push_back(r);
+  myData.insert(myData.end(), data.begin(), data.end());
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Journal::notify(Device& device)
+{
+  Record r = { &device, 0, myData.size(), &notifyDevice };
+  myRecords.push_back(r);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Journal::notifyDevice(void* device, const uInt8*, uInt32)
+{
+  static_cast<Device*>(device)->journalRestored();
+}
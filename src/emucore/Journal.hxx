@@ -0,0 +1,228 @@
+//============================================================================
+//
+//   SSSS    tt          lll  lll
+//  SS  SS   tt           ll   ll
+//  SS     tttttt  eeee   ll   ll   aaaa
+//   SSSS    tt   ee  ee  ll   ll      aa
+//      SS   tt   eeeeee  ll   ll   aaaaa  --  "An Atari 2600 VCS Emulator"
+//  SS  SS   tt   ee      ll   ll  aa  aa
+//   SSSS     ttt  eeeee llll llll  aaaaa
+//
+// Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+//
+// See the file "license" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//
+//============================================================================
+
+#ifndef JOURNAL_HXX
+#define JOURNAL_HXX
+
+class Device;
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "m6502/src/bspf/src/bspf.hxx"
+#include "Serializer.hxx"
+#include "Deserializer.hxx"
+
+/**
+  An undo log of the emulator state, for searches which mostly step
+  forward and back up a few steps at a time.
+
+  Taking a checkpoint asks every part of the system to record its
+  registers, which are small; from then on, the system records the
+  old value of every byte of RAM it writes.  Rolling back replays the
+  records backwards, so that it costs time proportional to the writes
+  since the checkpoint rather than to the full state.
+
+  Checkpoints nest: rolling back to one discards those taken after
+  it, but keeps it valid for further rollbacks.
+
+  Parts of the system without a journaling implementation record
+  themselves through their serialization instead, which is slower
+  but always correct.
+
+  The writes since the newest checkpoint are compacted as they pile
+  up, keeping only the oldest record of each byte, which is the one
+  a rollback restores.  However long the system runs between
+  checkpoints, the journal thus holds, per checkpoint, no more than
+  twice the larger of the memory written and CompactionThreshold
+  records.
+*/
+class Journal
+{
+  public:
+    /**
+      A handle on a checkpoint, valid until it is discarded.
+    */
+    struct Checkpoint
+    {
+      uInt32 depth;  // Position in the stack of live checkpoints
+      uInt32 id;     // Unique within the journal
+    };
+
+    /**
+      Called on rollback with the object a record was taken of and
+      the data saved with it.
+    */
+    typedef void (*Restore)(void* object, const uInt8* data, uInt32 size);
+
+  public:
+    Journal();
+
+    /**
+      The least number of records taken since the last compaction
+      which triggers the next one.
+    */
+    enum { CompactionThreshold = 4096 };
+
+    /**
+      Answer whether any checkpoint is live, in which case writes
+      must be recorded.
+    */
+    bool active() const { return !myCheckpoints.empty(); }
+
+    /**
+      Start a checkpoint.  Everything the system records until the
+      matching end() makes up its snapshot.
+
+      @return The handle on the new checkpoint
+    */
+    Checkpoint begin();
+
+    /**
+      End the checkpoint started last.
+    */
+    void end();
+
+    /**
+      Restore the state of the given checkpoint, discarding the ones
+      taken after it.
+
+      @param checkpoint The checkpoint to roll back to
+      @return False if the checkpoint was discarded, leaving the
+              state untouched
+    */
+    bool rollback(const Checkpoint& checkpoint);
+
+    /**
+      Discard every checkpoint, e.g. when the state is changed
+      without journaling.
+    */
+    void clear();
+
+    /**
+      Answer the number of bytes held by the journal.
+    */
+    size_t size() const;
+
+  public:
+    /**
+      Record the byte at the given address, which is about to be
+      written.
+    */
+    void record(uInt8* address)
+    {
+      Record r = { address, 1, myData.size(), 0 };
+      myRecords.push_back(r);
+      myData.push_back(*address);
+      if(myRecords.size() >= myCompactAt)
+        compact();
+    }
+
+    /**
+      Record a block of memory.
+    */
+    void saveBlock(void* address, uInt32 size)
+    {
+      Record r = { address, size, myData.size(), 0 };
+      myRecords.push_back(r);
+      myData.resize(r.offset + size);
+      memcpy(&myData[r.offset], address, size);
+    }
+
+    /**
+      Record a variable.
+    */
+    template<typename T>
+    void save(T& variable)
+    {
+      saveBlock(&variable, sizeof(T));
+    }
+
+    /**
+      Record an object through its save() method; it is restored
+      through its load() method.
+    */
+    template<typename T>
+    void saveObject(T& object)
+    {
+      Serializer out;
+      object.save(out);
+      saveObject(&object, out.get_str(), &loadObject<T>);
+    }
+
+    /**
+      Record an object serialized by the caller; restore is called
+      with the serialized data on rollback.
+    */
+    void saveObject(void* object, const std::string& data, Restore restore);
+
+    /**
+      Have the device's journalRestored() method called once the
+      records taken after this one have been rolled back.
+    */
+    void notify(Device& device);
+
+  private:
+    struct Record
+    {
+      void* address;    // The memory or object recorded
+      uInt32 size;      // The number of bytes of saved data
+      size_t offset;    // The position of the saved data in myData
+      Restore restore;  // Null for memory, which is copied back
+    };
+
+    struct Entry
+    {
+      Checkpoint checkpoint;
+      size_t begin, end;  // The records of the snapshot
+      size_t dataEnd;     // The size of myData after the snapshot
+    };
+
+    void undo(size_t from, size_t to);
+
+    /**
+      Drop the records of bytes written since the newest checkpoint
+      which are not their oldest, and schedule the next compaction.
+    */
+    void compact();
+
+    /**
+      Schedule the next compaction once the records grow by as many
+      as the given number already compacted, and by at least
+      CompactionThreshold, so that compacting takes linear time.
+    */
+    void scheduleCompaction(size_t compacted);
+
+    template<typename T>
+    static void loadObject(void* object, const uInt8* data, uInt32 size)
+    {
+      Deserializer in(std::string((const char*)data, size));
+      static_cast<T*>(object)->load(in);
+    }
+
+    static void notifyDevice(void* device, const uInt8*, uInt32);
+
+  private:
+    std::vector<Record> myRecords;
+    std::vector<uInt8> myData;
+    std::vector<Entry> myCheckpoints;
+    uInt32 myNextId;
+    size_t myCompactAt;  // The number of records which triggers compact()
+};
+
+#endif
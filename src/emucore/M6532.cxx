@@ -23,6 +23,7 @@
 #include "System.hxx"
 #include "Serializer.hxx"
 #include "Deserializer.hxx"
+#include "Journal.hxx"
 #include "OSystem.hxx"
 #include <iostream>
 using namespace std;
@@ -393,6 +394,19 @@ bool M6532::load(Deserializer& in)
   return true;
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void M6532::checkpoint(Journal& journal)
+{
+  // The RAM is only written through the system, which journals it
+  journal.save(myTimer);
+  journal.save(myIntervalShift);
+  journal.save(myCyclesWhenTimerSet);
+  journal.save(myCyclesWhenInterruptReset);
+  journal.save(myTimerReadAfterInterrupt);
+  journal.save(myDDRA);
+  journal.save(myDDRB);
+}
+
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 M6532::M6532(const M6532& c)
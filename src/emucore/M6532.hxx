@@ -23,6 +23,7 @@ class Console;
 class System;
 class Serializer;
 class Deserializer;
+class Journal;
 
 #include "m6502/src/bspf/src/bspf.hxx"
 #include "m6502/src/Device.hxx"
@@ -93,6 +94,14 @@ class M6532 : public Device
     */
     virtual bool load(Deserializer& in);
 
+    /**
+      Records the timer and ports of this device in the given journal when a
+      checkpoint is taken.
+
+      @param journal The journal to record to
+    */
+    virtual void checkpoint(Journal& journal);
+
    public:
     /**
       Get the byte at the specified address
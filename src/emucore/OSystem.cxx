@@ -39,6 +39,7 @@ using namespace std;
 #include "Event.hxx"
 #include "OSystem.hxx"
 #include "SoundSDL.hxx"
+#include "SoundHeadless.hxx"
 
 #define MAX_ROM_SIZE  512 * 1024
 
@@ -331,6 +332,12 @@ void OSystem::createSound()
   }
   mySound = NULL;
 
+  // Sound observations are synthesized in memory, whether or not SDL is available
+  if (mySettings->getBool("sound_obs")) {
+      mySound = new SoundHeadless(this, std::max(mySettings->getInt("frame_skip"), 1));
+      return;
+  }
+
 #ifdef SOUND_SUPPORT
   // If requested (& supported), enable sound
   if (mySettings->getBool("sound") == true) {
@@ -368,22 +375,20 @@ bool OSystem::createConsole(const string& romfile)
     myRomFile = romfile;
 
   // Open the cartridge image and read it in
-  uInt8* image;
-  int size = -1;
-  string md5;
-  if(openROM(myRomFile, md5, &image, &size))
+  RomImagePtr image;
+  if(openROM(myRomFile, image))
   {
     // Get all required info for creating a valid console
     Cartridge* cart = (Cartridge*) NULL;
     Properties props;
-    if(queryConsoleInfo(image, size, md5, &cart, props))
+    if(queryConsoleInfo(image, &cart, props))
     {
       // Create an instance of the 2600 game console
       myConsole = new Console(this, cart, props);
       m_colour_palette.loadUserPalette(paletteFile());
 
     #ifdef CHEATCODE_SUPPORT
-      myCheatManager->loadCheats(md5);
+      myCheatManager->loadCheats(image->md5());
     #endif
       //ALE  myEventHandler->reset(EventHandler::S_EMULATE);
       //ALE  createFrameBuffer(false);  // Takes care of initializeVideo()
@@ -420,10 +425,6 @@ bool OSystem::createConsole(const string& romfile)
     retval = false;
   }
 
-  // Free the image since we don't need it any longer
-  if(size != -1) {
-    delete[] image;
-  }
   if (mySettings->getBool("display_screen", true)) {
 #ifndef __USE_SDL
     ale::Logger::Error << "Screen display requires directive __USE_SDL to be defined."
@@ -483,21 +484,33 @@ void OSystem::createLauncher()
 ALE */
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-bool OSystem::openROM(const string& rom, string& md5, uInt8** image, int* size)
+bool OSystem::openROM(const string& rom, RomImagePtr& image)
 {
   // Assume the file is either gzip'ed or not compressed at all
   gzFile f = gzopen(rom.c_str(), "rb");
   if(!f)
     return false;
 
-  *image = new uInt8[MAX_ROM_SIZE];
-  *size = gzread(f, *image, MAX_ROM_SIZE);
+  uInt8* buffer = new uInt8[MAX_ROM_SIZE];
+  int size = gzread(f, buffer, MAX_ROM_SIZE);
   gzclose(f);
+  if(size < 0)
+  {
+    delete[] buffer;
+    return false;
+  }
 
   // If we get to this point, we know we have a valid file to open
-  // Now we make sure that the file has a valid properties entry
-  md5 = MD5(*image, *size);
+  // Reuse the image (and properties) of another console running this ROM
+  string md5 = MD5(buffer, size);
+  image = RomImage::find(md5);
+  if(image)
+  {
+    delete[] buffer;
+    return true;
+  }
 
+  // Now we make sure that the file has a valid properties entry
   // Some games may not have a name, since there may not
   // be an entry in stella.pro.  In that case, we use the rom name
   // and reinsert the properties object
@@ -518,6 +531,9 @@ bool OSystem::openROM(const string& rom, string& md5, uInt8** image, int* size)
     }
   }
 
+  image = RomImage::insert(md5, buffer, size, props);
+  delete[] buffer;
+
   return true;
 }
 
@@ -527,15 +543,13 @@ string OSystem::getROMInfo(const string& romfile)
   ostringstream buf;
 
   // Open the cartridge image and read it in
-  uInt8* image;
-  int size = -1;
-  string md5;
-  if(openROM(romfile, md5, &image, &size))
+  RomImagePtr image;
+  if(openROM(romfile, image))
   {
     // Get all required info for creating a temporary console
     Cartridge* cart = (Cartridge*) NULL;
     Properties props;
-    if(queryConsoleInfo(image, size, md5, &cart, props))
+    if(queryConsoleInfo(image, &cart, props))
     {
       Console* console = new Console(this, cart, props);
       if(console)
@@ -548,21 +562,16 @@ string OSystem::getROMInfo(const string& romfile)
     else
       buf << "ERROR: Couldn't open " << romfile << " ..." << endl;
   }
-  // Free the image and console since we don't need it any longer
-  if(size != -1)
-    delete[] image;
-
   return buf.str();
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-bool OSystem::queryConsoleInfo(const uInt8* image, uInt32 size,
-                               const string& md5,
-                               Cartridge** cart, Properties& props)
+bool OSystem::queryConsoleInfo(const RomImagePtr& image, Cartridge** cart,
+                               Properties& props)
 {
   // Get a valid set of properties, including any entered on the commandline
   string s;
-  myPropSet->getMD5(md5, props);
+  props = image->properties();
   
     s = mySettings->getString("type");
     if(s != "") props.set(Cartridge_Type, s);
@@ -600,7 +609,7 @@ bool OSystem::queryConsoleInfo(const uInt8* image, uInt32 size,
     s = mySettings->getString("hmove");
     if(s != "") props.set(Emulation_HmoveBlanks, s);
 
-  *cart = Cartridge::create(image, size, props, *mySettings);
+  *cart = Cartridge::create(image, props, *mySettings);
   if(!*cart)
     return false;
 
@@ -34,6 +34,7 @@ class VideoDialog;
 #include "../common/SoundNull.hxx"
 #include "Settings.hxx"
 #include "Console.hxx"
+#include "RomImage.hxx"
 #include "Event.hxx"  //ALE 
 //ALE  #include "Font.hxx"
 #include "m6502/src/bspf/src/bspf.hxx"
@@ -325,16 +326,15 @@ class OSystem
     const std::string& features() const { return myFeatures; }
 
     /**
-      Open the given ROM and return an array containing its contents.
+      Open the given ROM and return its (shared) image.  If a console
+      in this process already uses a ROM with the same MD5, its image
+      and properties are reused.
 
       @param rom    The absolute pathname of the ROM file
-      @param md5    The md5 calculated from the ROM file
-      @param image  A pointer to store the ROM data
-                    Note, the calling method is responsible for deleting this
-      @param size   The amount of data read into the image array
+      @param image  Set to the image holding the ROM data and properties
       @return  False on any errors, else true
     */
-    bool openROM(const std::string& rom, std::string& md5, uInt8** image, int* size);
+    bool openROM(const std::string& rom, RomImagePtr& image);
 
     /**
       Issue a quit event to the OSystem.
@@ -560,8 +560,8 @@ class OSystem
 
       @return Success or failure for a valid console
     */
-    bool queryConsoleInfo(const uInt8* image, uInt32 size, const std::string& md5,
-                          Cartridge** cart, Properties& props);
+    bool queryConsoleInfo(const RomImagePtr& image, Cartridge** cart,
+                          Properties& props);
 
     /**
       Initializes the timing so that the mainloop is reset to its
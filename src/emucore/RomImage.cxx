@@ -0,0 +1,102 @@
+//============================================================================
+//
+//   SSSS    tt          lll  lll       
+//  SS  SS   tt           ll   ll        
+//  SS     tttttt  eeee   ll   ll   aaaa 
+//   SSSS    tt   ee  ee  ll   ll      aa
+//      SS   tt   eeeeee  ll   ll   aaaaa  --  "An Atari 2600 VCS Emulator"
+//  SS  SS   tt   ee      ll   ll  aa  aa
+//   SSSS     ttt  eeeee llll llll  aaaaa
+//
+// Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+//
+// See the file "license" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//
+//============================================================================
+
+#include <cstring>
+#include <map>
+#include <mutex>
+
+#include "RomImage.hxx"
+using namespace std;
+
+// Cartridges with a fixed layout read this many bytes regardless of the
+// file size (CartridgeMB being the largest)
+#define MIN_IMAGE_SIZE  64 * 1024
+
+namespace {
+  typedef map<string, weak_ptr<const RomImage> > Registry;
+
+  // Function-local statics so the registry is usable during static
+  // initialization of other translation units
+  mutex& registryMutex()
+  {
+    static mutex m;
+    return m;
+  }
+
+  Registry& registry()
+  {
+    static Registry r;
+    return r;
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+RomImagePtr RomImage::find(const string& md5)
+{
+  lock_guard<mutex> lock(registryMutex());
+
+  Registry::const_iterator it = registry().find(md5);
+  if(it == registry().end())
+    return RomImagePtr();
+
+  return it->second.lock();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+RomImagePtr RomImage::insert(const string& md5, const uInt8* image,
+                             uInt32 size, const Properties& props)
+{
+  lock_guard<mutex> lock(registryMutex());
+
+  weak_ptr<const RomImage>& slot = registry()[md5];
+  RomImagePtr rom = slot.lock();
+  if(!rom)
+  {
+    rom = RomImagePtr(new RomImage(md5, image, size, props));
+    slot = rom;
+  }
+
+  // Drop the entries of ROMs no console is using anymore
+  for(Registry::iterator it = registry().begin(); it != registry().end(); )
+  {
+    if(it->second.expired())
+      registry().erase(it++);
+    else
+      ++it;
+  }
+
+  return rom;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+RomImage::RomImage(const string& md5, const uInt8* image, uInt32 size,
+                   const Properties& props)
+  : myMD5(md5),
+    mySize(size),
+    myProperties(props)
+{
+  uInt32 allocated = BSPF_max(size, (uInt32)(MIN_IMAGE_SIZE));
+  myImage = new uInt8[allocated];
+  memcpy(myImage, image, size);
+  memset(myImage + size, 0, allocated - size);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+RomImage::~RomImage()
+{
+  delete[] myImage;
+}
@@ -0,0 +1,97 @@
+//============================================================================
+//
+//   SSSS    tt          lll  lll       
+//  SS  SS   tt           ll   ll        
+//  SS     tttttt  eeee   ll   ll   aaaa 
+//   SSSS    tt   ee  ee  ll   ll      aa
+//      SS   tt   eeeeee  ll   ll   aaaaa  --  "An Atari 2600 VCS Emulator"
+//  SS  SS   tt   ee      ll   ll  aa  aa
+//   SSSS     ttt  eeeee llll llll  aaaaa
+//
+// Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+//
+// See the file "license" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//
+//============================================================================
+
+#ifndef ROM_IMAGE_HXX
+#define ROM_IMAGE_HXX
+
+class RomImage;
+
+#include <memory>
+#include <string>
+
+#include "m6502/src/bspf/src/bspf.hxx"
+#include "Props.hxx"
+
+typedef std::shared_ptr<const RomImage> RomImagePtr;
+
+/**
+  An immutable ROM image together with the properties it was first
+  loaded with.  Images are kept in a process-wide registry keyed by
+  MD5, so every console running the same game reads its (non-RAM)
+  cartridge banks from one shared buffer.  An image is released when
+  the last cartridge referencing it is destroyed.
+
+  The registry is safe to use from several threads at once; the
+  images themselves are never modified after creation.  Each cartridge
+  holds a reference to its image (see Cartridge::create), so the data
+  may be pointed to rather than copied for as long as the cartridge lives.
+*/
+class RomImage
+{
+  public:
+    /**
+      Get the live image with the given MD5, if any.
+
+      @param md5  The MD5 of the ROM contents
+      @return  The shared image, or an empty pointer if none is loaded
+    */
+    static RomImagePtr find(const std::string& md5);
+
+    /**
+      Register a freshly read ROM.  If another thread registered the
+      same MD5 in the meantime, that image is returned instead and
+      the given data is discarded.
+
+      @param md5    The MD5 of the ROM contents
+      @param image  The ROM data, which is copied
+      @param size   The number of bytes in the ROM data
+      @param props  The properties to associate with the ROM
+      @return  The shared image for this MD5
+    */
+    static RomImagePtr insert(const std::string& md5, const uInt8* image,
+                              uInt32 size, const Properties& props);
+
+  public:
+    ~RomImage();
+
+    const std::string& md5() const { return myMD5; }
+    const uInt8* image() const { return myImage; }
+    uInt32 size() const { return mySize; }
+    const Properties& properties() const { return myProperties; }
+
+  private:
+    RomImage(const std::string& md5, const uInt8* image, uInt32 size,
+             const Properties& props);
+
+    // Copy constructor isn't supported by this class so make it private
+    RomImage(const RomImage&);
+
+    // Assignment operator isn't supported by this class so make it private
+    RomImage& operator = (const RomImage&);
+
+  private:
+    std::string myMD5;
+
+    // The ROM data, zero-padded to at least the largest fixed-size bank
+    // layout so cartridges may always read their full address space
+    uInt8* myImage;
+    uInt32 mySize;
+
+    Properties myProperties;
+};
+
+#endif
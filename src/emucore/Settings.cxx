@@ -27,6 +27,8 @@ using namespace std;
 #include "Version.hxx"
 #include "bspf.hxx"
 #include "Settings.hxx"
+#include "Serializer.hxx"
+#include "Deserializer.hxx"
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Settings::Settings(OSystem* osystem) : myOSystem(osystem) {
@@ -272,7 +274,7 @@ void Settings::usage() {
        "\n"
        " Main arguments:\n"
        "   -help -- prints out help information\n"
-       "   -game_controller [fifo|fifo_named"
+       "   -game_controller [fifo|fifo_named|fork_server|shm|env_server"
 #ifdef __USE_RLGLUE
        "|rlglue"
 #endif
@@ -280,6 +282,11 @@ void Settings::usage() {
        "      Defines how Stella communicates with the player agent:\n"
        "            - 'fifo':       Control occurs through FIFO pipes\n"
        "            - 'fifo_named': Control occurs through named FIFO pipes\n"
+       "            - 'fork_server': Forks a reset environment for each agent connecting\n"
+       "                             to -fork_server_socket, then uses the FIFO protocol\n"
+       "            - 'shm':        Control occurs through the shared memory named by -shm_name\n"
+       "            - 'env_server': Hosts one environment per agent connecting to\n"
+       "                            -env_server_socket, stepping them on a thread pool\n"
 #ifdef __USE_RLGLUE
        "            - 'rlglue':     External control via RL-Glue\n"
 #endif
@@ -301,15 +308,78 @@ void Settings::usage() {
        "     Ends each episode after this number of frames. 0 means never.\n"
        "   -color_averaging [true|false] (default: false)\n"
        "     Phosphor blends screens to reduce flicker\n"
+       "   -compact_environment [true|false] (default: false)\n"
+       "     Minimizes per-environment memory; screens are allocated on first use "
+                "and color_averaging is unavailable\n"
+       "   -sound_obs [true|false] (default: false)\n"
+       "     Synthesizes game sound in memory so that it can be read after each step "
+                "(see ALEInterface::getAudio)\n"
        "   -record_screen_dir [save_directory]\n"
        "     Saves game screen images to save_directory\n"
+       "   -record_screen_threads n (default: 1)\n"
+       "     Number of background threads encoding recorded screens. 0 encodes them "
+                "synchronously.\n"
+       "   -record_screen_queue n (default: 64)\n"
+       "     Number of recorded screens that may wait for encoding before emulation blocks\n"
+       "   -record_screen_indexed [true|false] (default: false)\n"
+       "     Saves recorded screens as indexed-colour rather than RGB PNGs\n"
+       "   -record_screen_compression n (default: -1)\n"
+       "     zlib compression level (0-9) of recorded screens; -1 is zlib's default\n"
+       "   -record_video_file [filename]\n"
+       "     Streams game screens into a single video file (or FIFO)\n"
+       "   -record_video_format [y4m|indexed|delta] (default: y4m)\n"
+       "     Video format: YUV4MPEG2, palette indices with the palette stored once, "
+                "or the spans of palette indices that changed since the previous frame\n"
+       "   -record_video_compress [true|false] (default: false)\n"
+       "     zlib-compresses each frame of an indexed video\n"
+       "   -record_video_index [true|false] (default: true)\n"
+       "     Writes the offset of every frame to filename.idx\n"
+       "   -record_trajectory_file [filename]\n"
+       "     Logs every action, with its reward and a RAM hash, for deterministic replay\n"
+       "   -trajectory_snapshot_interval n (default: 1000)\n"
+       "     Embeds the state every n steps of a recorded trajectory, for seeking. "
+                "0 means only the first.\n"
+       "   -record_dataset_dir [dirname]\n"
+       "     Writes every step (screen as palette indices, action, reward, terminal, lives) "
+                "to an offline RL dataset of compressed shards in this directory\n"
+       "   -dataset_chunk_size n (default: 256)\n"
+       "     Number of steps compressed together in a dataset shard\n"
+       "   -dataset_shard_size n (default: 100000)\n"
+       "     Number of steps per dataset shard. 0 means a single shard.\n"
+       "   -dataset_compression n (default: 1)\n"
+       "     zlib compression level (0-9) of dataset shards\n"
+       "   -screen_keyframe_interval n (default: 60)\n"
+       "     Sends a whole screen every n screens in delta videos and the FIFO spans "
+                "protocol. 0 means only the first.\n"
        "   -repeat_action_probability (default: 0.25)\n"
        "     Stochasticity in the environment. It is the probability the previous "
                 "action will repeated without executing the new one.\n"
+       "   -startup_budget_ms m (default: 0)\n"
+       "     Warns, with a per-phase breakdown, when loading a ROM takes longer than this. "
+                "0 means never.\n"
+       "   -transition_cache_mb m (default: 0)\n"
+       "     Memoizes up to m MB of deterministic transitions, so that acting again from a "
+                "known state restores the outcome instead of emulating it. 0 means off.\n"
+       "   -planning_threads n (default: 0)\n"
+       "     Number of environment copies running batched rollouts; 0 uses one per processor\n"
        "\n"
        " FIFO Controller arguments:\n"
        "   -run_length_encoding [true|false] (default: true)\n"
        "     Encodes data using run-length encoding\n"
+       "   -fork_server_socket [path] (default: ale_fork_server)\n"
+       "     UNIX domain socket on which the fork server accepts agents\n"
+       "\n"
+       " Shared Memory Controller arguments:\n"
+       "   -shm_name [name] (default: /ale_shm)\n"
+       "     Name of the POSIX shared memory object shared with the agent\n"
+       "   -shm_slots n (default: 4)\n"
+       "     Number of observation slots; the agent may hold on to all but one\n"
+       "\n"
+       " Environment Server arguments:\n"
+       "   -env_server_socket [path] (default: ale_env_server)\n"
+       "     UNIX domain socket on which the environment server accepts agents\n"
+       "   -env_server_threads n (default: 0)\n"
+       "     Number of threads stepping environments; 0 uses one per processor\n"
        "\n"
 #ifdef __USE_RLGLUE
        " RL-Glue Controller arguments:\n"
@@ -547,6 +617,47 @@ void Settings::setSize(const string& key, const int value1, const int value2)
   setString(key, buf.str());
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Settings::copyTo(Settings& target) const
+{
+  for(unsigned int i = 0; i < myInternalSettings.size(); ++i)
+    target.setInternal(myInternalSettings[i].key, myInternalSettings[i].value);
+  for(unsigned int i = 0; i < myExternalSettings.size(); ++i)
+    target.setExternal(myExternalSettings[i].key, myExternalSettings[i].value);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Settings::saveState(Serializer& out) const
+{
+  out.putInt(myInternalSettings.size());
+  for(unsigned int i = 0; i < myInternalSettings.size(); ++i)
+  {
+    out.putString(myInternalSettings[i].key);
+    out.putString(myInternalSettings[i].value);
+  }
+  out.putInt(myExternalSettings.size());
+  for(unsigned int i = 0; i < myExternalSettings.size(); ++i)
+  {
+    out.putString(myExternalSettings[i].key);
+    out.putString(myExternalSettings[i].value);
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Settings::loadState(Deserializer& in)
+{
+  for(int i = in.getInt(); i > 0; --i)
+  {
+    string key = in.getString();
+    setInternal(key, in.getString());
+  }
+  for(int i = in.getInt(); i > 0; --i)
+  {
+    string key = in.getString();
+    setExternal(key, in.getString());
+  }
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 int Settings::getInternalPos(const string& key) const
 {
@@ -700,19 +811,44 @@ void Settings::setDefaultSettings() {
 
     // FIFO controller settings
     boolSettings.insert(pair<string, bool>("run_length_encoding", true));
+    stringSettings.insert(pair<string, string>("fork_server_socket", "ale_fork_server"));
+    stringSettings.insert(pair<string, string>("shm_name", "/ale_shm"));
+    intSettings.insert(pair<string, int>("shm_slots", 4));
+    stringSettings.insert(pair<string, string>("env_server_socket", "ale_env_server"));
+    intSettings.insert(pair<string, int>("env_server_threads", 0));
 
     // Environment customization settings
     boolSettings.insert(pair<string, bool>("restricted_action_set", false));
     intSettings.insert(pair<string, int>("random_seed", 0));
     boolSettings.insert(pair<string, bool>("color_averaging", false));
+    boolSettings.insert(pair<string, bool>("compact_environment", false));
+    boolSettings.insert(pair<string, bool>("sound_obs", false));
     boolSettings.insert(pair<string, bool>("send_rgb", false));
     intSettings.insert(pair<string, int>("frame_skip", 1));
     floatSettings.insert(pair<string, float>("repeat_action_probability", 0.25));
     stringSettings.insert(pair<string, string>("rom_file", ""));
+    intSettings.insert(pair<string, int>("startup_budget_ms", 0));
+    intSettings.insert(pair<string, int>("transition_cache_mb", 0));
+    intSettings.insert(pair<string, int>("planning_threads", 0));
 
     // Record settings
     intSettings.insert(pair<string, int>("fragsize", 64)); // fragsize to 64 ensures proper sound sync
     stringSettings.insert(pair<string, string>("record_screen_dir", ""));
+    intSettings.insert(pair<string, int>("record_screen_threads", 1));
+    intSettings.insert(pair<string, int>("record_screen_queue", 64));
+    boolSettings.insert(pair<string, bool>("record_screen_indexed", false));
+    intSettings.insert(pair<string, int>("record_screen_compression", -1));
+    stringSettings.insert(pair<string, string>("record_video_file", ""));
+    stringSettings.insert(pair<string, string>("record_video_format", "y4m"));
+    boolSettings.insert(pair<string, bool>("record_video_compress", false));
+    boolSettings.insert(pair<string, bool>("record_video_index", true));
+    intSettings.insert(pair<string, int>("screen_keyframe_interval", 60));
+    stringSettings.insert(pair<string, string>("record_trajectory_file", ""));
+    intSettings.insert(pair<string, int>("trajectory_snapshot_interval", 1000));
+    stringSettings.insert(pair<string, string>("record_dataset_dir", ""));
+    intSettings.insert(pair<string, int>("dataset_chunk_size", 256));
+    intSettings.insert(pair<string, int>("dataset_shard_size", 100000));
+    intSettings.insert(pair<string, int>("dataset_compression", 1));
     stringSettings.insert(pair<string, string>("record_sound_filename", ""));
 
     // Display Settings
@@ -20,6 +20,8 @@
 #define SETTINGS_HXX
 
 class OSystem;
+class Serializer;
+class Deserializer;
 
 #include <map>
 #include <stdexcept>
@@ -165,6 +167,29 @@ class Settings
     */
     void setSize(const std::string& key, const int value1, const int value2);
 
+    /**
+      Copy the value of every setting into the given settings object, e.g.
+      to configure further environments like this one.
+
+      @param target The settings to overwrite
+    */
+    void copyTo(Settings& target) const;
+
+    /**
+      Write the value of every setting, e.g. to record how an environment
+      was configured.
+
+      @param out The serializer to write to
+    */
+    void saveState(Serializer& out) const;
+
+    /**
+      Set the values written by saveState().
+
+      @param in The deserializer to read from
+    */
+    void loadState(Deserializer& in);
+
 
   private:
     // Copy constructor isn't supported by this class so make it private
@@ -24,6 +24,7 @@ class Serializer;
 class Deserializer;
 
 #include "m6502/src/bspf/src/bspf.hxx"
+#include "Journal.hxx"
 
 /**
   This class is an abstract base class for the various sound objects.
@@ -156,6 +157,17 @@ public:
     */
     virtual bool save(Serializer& out) = 0;
 
+    /**
+      Records the state of this device in the given journal when a
+      checkpoint is taken.  By default it is recorded through save().
+
+      @param journal The journal to record to
+    */
+    virtual void checkpoint(Journal& journal)
+    {
+      journal.saveObject(*this);
+    }
+
   protected:
     // The OSystem for this sound object
     OSystem* myOSystem;
@@ -28,6 +28,7 @@
 #include "TIA.hxx"
 #include "Serializer.hxx"
 #include "Deserializer.hxx"
+#include "Journal.hxx"
 #include "Settings.hxx"
 #include "Sound.hxx"
 using namespace std;
@@ -48,9 +49,13 @@ TIA::TIA(const Console& console, Settings& settings)
 {
   uInt32 i;
 
-  // Allocate buffers for two frame buffers
+  // Allocate buffers for two frame buffers; compact environments have
+  // no use for the previous frame, so they draw into a single buffer
   myCurrentFrameBuffer = new uInt8[160 * 300];
-  myPreviousFrameBuffer = new uInt8[160 * 300];
+  if(settings.getBool("compact_environment", false))
+    myPreviousFrameBuffer = myCurrentFrameBuffer;
+  else
+    myPreviousFrameBuffer = new uInt8[160 * 300];
 
   myFrameGreyed = false;
   myPartialFrameFlag = false; //ALE : This was left uninitialized :(
@@ -95,18 +100,6 @@ TIA::TIA(const Console& console, Settings& settings)
     }
   }
 
-  for(i = 0; i < 640; ++i)
-    ourDisabledMaskTable[i] = 0;
-
-  // Compute all of the mask tables
-  computeBallMaskTable();
-  computeCollisionTable();
-  computeMissleMaskTable();
-  computePlayerMaskTable();
-  computePlayerPositionResetWhenTable();
-  computePlayerReflectTable();
-  computePlayfieldMaskTable();
-
   // Init stats counters
   myFrameCounter = 0;
 
@@ -118,8 +111,9 @@ TIA::TIA(const Console& console, Settings& settings)
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 TIA::~TIA()
 {
+  if(myPreviousFrameBuffer != myCurrentFrameBuffer)
+    delete[] myPreviousFrameBuffer;
   delete[] myCurrentFrameBuffer;
-  delete[] myPreviousFrameBuffer;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -500,6 +494,84 @@ bool TIA::load(Deserializer& in)
   return true;
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIA::checkpoint(Journal& journal)
+{
+  // Restored last, once every register is back
+  journal.notify(*this);
+
+  // The same registers as save()
+  journal.save(myClockWhenFrameStarted);
+  journal.save(myClockStartDisplay);
+  journal.save(myClockStopDisplay);
+  journal.save(myClockAtLastUpdate);
+  journal.save(myClocksToEndOfScanLine);
+  journal.save(myScanlineCountForLastFrame);
+  journal.save(myCurrentScanline);
+  journal.save(myVSYNCFinishClock);
+
+  journal.save(myEnabledObjects);
+
+  journal.save(myVSYNC);
+  journal.save(myVBLANK);
+  journal.save(myNUSIZ0);
+  journal.save(myNUSIZ1);
+
+  journal.save(myCOLUP0);
+  journal.save(myCOLUP1);
+  journal.save(myCOLUPF);
+  journal.save(myCOLUBK);
+
+  journal.save(myCTRLPF);
+  journal.save(myPlayfieldPriorityAndScore);
+  journal.save(myREFP0);
+  journal.save(myREFP1);
+  journal.save(myPF);
+  journal.save(myGRP0);
+  journal.save(myGRP1);
+  journal.save(myDGRP0);
+  journal.save(myDGRP1);
+  journal.save(myENAM0);
+  journal.save(myENAM1);
+  journal.save(myENABL);
+  journal.save(myDENABL);
+  journal.save(myHMP0);
+  journal.save(myHMP1);
+  journal.save(myHMM0);
+  journal.save(myHMM1);
+  journal.save(myHMBL);
+  journal.save(myVDELP0);
+  journal.save(myVDELP1);
+  journal.save(myVDELBL);
+  journal.save(myRESMP0);
+  journal.save(myRESMP1);
+  journal.save(myCollision);
+  journal.save(myPOSP0);
+  journal.save(myPOSP1);
+  journal.save(myPOSM0);
+  journal.save(myPOSM1);
+  journal.save(myPOSBL);
+
+  journal.save(myCurrentGRP0);
+  journal.save(myCurrentGRP1);
+
+  journal.save(myLastHMOVEClock);
+  journal.save(myHMOVEBlankEnabled);
+  journal.save(myM0CosmicArkMotionEnabled);
+  journal.save(myM0CosmicArkCounter);
+
+  journal.save(myDumpEnabled);
+  journal.save(myDumpDisabledCycle);
+
+  mySound->checkpoint(journal);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void TIA::journalRestored()
+{
+  enableBits(true);
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void TIA::update()
 {
@@ -721,490 +793,6 @@ void TIA::setSound(Sound& sound)
   mySound = &sound;
 }
 
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void TIA::computeBallMaskTable()
-{
-  // First, calculate masks for alignment 0
-  for(Int32 size = 0; size < 4; ++size)
-  {
-    Int32 x;
-
-    // Set all of the masks to false to start with
-    for(x = 0; x < 160; ++x)
-    {
-      ourBallMaskTable[0][size][x] = false;
-    }
-
-    // Set the necessary fields true
-    for(x = 0; x < 160 + 8; ++x)
-    {
-      if((x >= 0) && (x < (1 << size)))
-      {
-        ourBallMaskTable[0][size][x % 160] = true;
-      }
-    }
-
-    // Copy fields into the wrap-around area of the mask
-    for(x = 0; x < 160; ++x)
-    {
-      ourBallMaskTable[0][size][x + 160] = ourBallMaskTable[0][size][x];
-    }
-  }
-
-  // Now, copy data for alignments of 1, 2 and 3
-  for(uInt32 align = 1; align < 4; ++align)
-  {
-    for(uInt32 size = 0; size < 4; ++size)
-    {
-      for(uInt32 x = 0; x < 320; ++x)
-      {
-        ourBallMaskTable[align][size][x] = 
-            ourBallMaskTable[0][size][(x + 320 - align) % 320];
-      }
-    }
-  }
-}
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void TIA::computeCollisionTable()
-{
-  for(uInt8 i = 0; i < 64; ++i)
-  { 
-    ourCollisionTable[i] = 0;
-
-    if((i & myM0Bit) && (i & myP1Bit))    // M0-P1
-      ourCollisionTable[i] |= 0x0001;
-
-    if((i & myM0Bit) && (i & myP0Bit))    // M0-P0
-      ourCollisionTable[i] |= 0x0002;
-
-    if((i & myM1Bit) && (i & myP0Bit))    // M1-P0
-      ourCollisionTable[i] |= 0x0004;
-
-    if((i & myM1Bit) && (i & myP1Bit))    // M1-P1
-      ourCollisionTable[i] |= 0x0008;
-
-    if((i & myP0Bit) && (i & myPFBit))    // P0-PF
-      ourCollisionTable[i] |= 0x0010;
-
-    if((i & myP0Bit) && (i & myBLBit))    // P0-BL
-      ourCollisionTable[i] |= 0x0020;
-
-    if((i & myP1Bit) && (i & myPFBit))    // P1-PF
-      ourCollisionTable[i] |= 0x0040;
-
-    if((i & myP1Bit) && (i & myBLBit))    // P1-BL
-      ourCollisionTable[i] |= 0x0080;
-
-    if((i & myM0Bit) && (i & myPFBit))    // M0-PF
-      ourCollisionTable[i] |= 0x0100;
-
-    if((i & myM0Bit) && (i & myBLBit))    // M0-BL
-      ourCollisionTable[i] |= 0x0200;
-
-    if((i & myM1Bit) && (i & myPFBit))    // M1-PF
-      ourCollisionTable[i] |= 0x0400;
-
-    if((i & myM1Bit) && (i & myBLBit))    // M1-BL
-      ourCollisionTable[i] |= 0x0800;
-
-    if((i & myBLBit) && (i & myPFBit))    // BL-PF
-      ourCollisionTable[i] |= 0x1000;
-
-    if((i & myP0Bit) && (i & myP1Bit))    // P0-P1
-      ourCollisionTable[i] |= 0x2000;
-
-    if((i & myM0Bit) && (i & myM1Bit))    // M0-M1
-      ourCollisionTable[i] |= 0x4000;
-  }
-}
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void TIA::computeMissleMaskTable()
-{
-  // First, calculate masks for alignment 0
-  Int32 x, size, number;
-
-  // Clear the missle table to start with
-  for(number = 0; number < 8; ++number)
-    for(size = 0; size < 4; ++size)
-      for(x = 0; x < 160; ++x)
-        ourMissleMaskTable[0][number][size][x] = false;
-
-  for(number = 0; number < 8; ++number)
-  {
-    for(size = 0; size < 4; ++size)
-    {
-      for(x = 0; x < 160 + 72; ++x)
-      {
-        // Only one copy of the missle
-        if((number == 0x00) || (number == 0x05) || (number == 0x07))
-        {
-          if((x >= 0) && (x < (1 << size)))
-            ourMissleMaskTable[0][number][size][x % 160] = true;
-        }
-        // Two copies - close
-        else if(number == 0x01)
-        {
-          if((x >= 0) && (x < (1 << size)))
-            ourMissleMaskTable[0][number][size][x % 160] = true;
-          else if(((x - 16) >= 0) && ((x - 16) < (1 << size)))
-            ourMissleMaskTable[0][number][size][x % 160] = true;
-        }
-        // Two copies - medium
-        else if(number == 0x02)
-        {
-          if((x >= 0) && (x < (1 << size)))
-            ourMissleMaskTable[0][number][size][x % 160] = true;
-          else if(((x - 32) >= 0) && ((x - 32) < (1 << size)))
-            ourMissleMaskTable[0][number][size][x % 160] = true;
-        }
-        // Three copies - close
-        else if(number == 0x03)
-        {
-          if((x >= 0) && (x < (1 << size)))
-            ourMissleMaskTable[0][number][size][x % 160] = true;
-          else if(((x - 16) >= 0) && ((x - 16) < (1 << size)))
-            ourMissleMaskTable[0][number][size][x % 160] = true;
-          else if(((x - 32) >= 0) && ((x - 32) < (1 << size)))
-            ourMissleMaskTable[0][number][size][x % 160] = true;
-        }
-        // Two copies - wide
-        else if(number == 0x04)
-        {
-          if((x >= 0) && (x < (1 << size)))
-            ourMissleMaskTable[0][number][size][x % 160] = true;
-          else if(((x - 64) >= 0) && ((x - 64) < (1 << size)))
-            ourMissleMaskTable[0][number][size][x % 160] = true;
-        }
-        // Three copies - medium
-        else if(number == 0x06)
-        {
-          if((x >= 0) && (x < (1 << size)))
-            ourMissleMaskTable[0][number][size][x % 160] = true;
-          else if(((x - 32) >= 0) && ((x - 32) < (1 << size)))
-            ourMissleMaskTable[0][number][size][x % 160] = true;
-          else if(((x - 64) >= 0) && ((x - 64) < (1 << size)))
-            ourMissleMaskTable[0][number][size][x % 160] = true;
-        }
-      }
-
-      // Copy data into wrap-around area
-      for(x = 0; x < 160; ++x)
-        ourMissleMaskTable[0][number][size][x + 160] = 
-          ourMissleMaskTable[0][number][size][x];
-    }
-  }
-
-  // Now, copy data for alignments of 1, 2 and 3
-  for(uInt32 align = 1; align < 4; ++align)
-  {
-    for(number = 0; number < 8; ++number)
-    {
-      for(size = 0; size < 4; ++size)
-      {
-        for(x = 0; x < 320; ++x)
-        {
-          ourMissleMaskTable[align][number][size][x] = 
-            ourMissleMaskTable[0][number][size][(x + 320 - align) % 320];
-        }
-      }
-    }
-  }
-}
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void TIA::computePlayerMaskTable()
-{
-  // First, calculate masks for alignment 0
-  Int32 x, enable, mode;
-
-  // Set the player mask table to all zeros
-  for(enable = 0; enable < 2; ++enable)
-    for(mode = 0; mode < 8; ++mode)
-      for(x = 0; x < 160; ++x)
-        ourPlayerMaskTable[0][enable][mode][x] = 0x00;
-
-  // Now, compute the player mask table
-  for(enable = 0; enable < 2; ++enable)
-  {
-    for(mode = 0; mode < 8; ++mode)
-    {
-      for(x = 0; x < 160 + 72; ++x)
-      {
-        if(mode == 0x00)
-        {
-          if((enable == 0) && (x >= 0) && (x < 8))
-            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> x;
-        }
-        else if(mode == 0x01)
-        {
-          if((enable == 0) && (x >= 0) && (x < 8))
-            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> x;
-          else if(((x - 16) >= 0) && ((x - 16) < 8))
-            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> (x - 16);
-        }
-        else if(mode == 0x02)
-        {
-          if((enable == 0) && (x >= 0) && (x < 8))
-            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> x;
-          else if(((x - 32) >= 0) && ((x - 32) < 8))
-            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> (x - 32);
-        }
-        else if(mode == 0x03)
-        {
-          if((enable == 0) && (x >= 0) && (x < 8))
-            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> x;
-          else if(((x - 16) >= 0) && ((x - 16) < 8))
-            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> (x - 16);
-          else if(((x - 32) >= 0) && ((x - 32) < 8))
-            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> (x - 32);
-        }
-        else if(mode == 0x04)
-        {
-          if((enable == 0) && (x >= 0) && (x < 8))
-            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> x;
-          else if(((x - 64) >= 0) && ((x - 64) < 8))
-            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> (x - 64);
-        }
-        else if(mode == 0x05)
-        {
-          // For some reason in double size mode the player's output
-          // is delayed by one pixel thus we use > instead of >=
-          if((enable == 0) && (x > 0) && (x <= 16))
-            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> ((x - 1)/2);
-        }
-        else if(mode == 0x06)
-        {
-          if((enable == 0) && (x >= 0) && (x < 8))
-            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> x;
-          else if(((x - 32) >= 0) && ((x - 32) < 8))
-            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> (x - 32);
-          else if(((x - 64) >= 0) && ((x - 64) < 8))
-            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> (x - 64);
-        }
-        else if(mode == 0x07)
-        {
-          // For some reason in quad size mode the player's output
-          // is delayed by one pixel thus we use > instead of >=
-          if((enable == 0) && (x > 0) && (x <= 32))
-            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> ((x - 1)/4);
-        }
-      }
-  
-      // Copy data into wrap-around area
-      for(x = 0; x < 160; ++x)
-      {
-        ourPlayerMaskTable[0][enable][mode][x + 160] = 
-            ourPlayerMaskTable[0][enable][mode][x];
-      }
-    }
-  }
-
-  // Now, copy data for alignments of 1, 2 and 3
-  for(uInt32 align = 1; align < 4; ++align)
-  {
-    for(enable = 0; enable < 2; ++enable)
-    {
-      for(mode = 0; mode < 8; ++mode)
-      {
-        for(x = 0; x < 320; ++x)
-        {
-          ourPlayerMaskTable[align][enable][mode][x] =
-              ourPlayerMaskTable[0][enable][mode][(x + 320 - align) % 320];
-        }
-      }
-    }
-  }
-}
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void TIA::computePlayerPositionResetWhenTable()
-{
-  uInt32 mode, oldx, newx;
-
-  // Loop through all player modes, all old player positions, and all new
-  // player positions and determine where the new position is located:
-  // 1 means the new position is within the display of an old copy of the
-  // player, -1 means the new position is within the delay portion of an
-  // old copy of the player, and 0 means it's neither of these two
-  for(mode = 0; mode < 8; ++mode)
-  {
-    for(oldx = 0; oldx < 160; ++oldx)
-    {
-      // Set everything to 0 for non-delay/non-display section
-      for(newx = 0; newx < 160; ++newx)
-      {
-        ourPlayerPositionResetWhenTable[mode][oldx][newx] = 0;
-      }
-
-      // Now, we'll set the entries for non-delay/non-display section
-      for(newx = 0; newx < 160 + 72 + 5; ++newx)
-      {
-        if(mode == 0x00)
-        {
-          if((newx >= oldx) && (newx < (oldx + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-
-          if((newx >= oldx + 4) && (newx < (oldx + 4 + 8)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-        }
-        else if(mode == 0x01)
-        {
-          if((newx >= oldx) && (newx < (oldx + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-          else if((newx >= (oldx + 16)) && (newx < (oldx + 16 + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-
-          if((newx >= oldx + 4) && (newx < (oldx + 4 + 8)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-          else if((newx >= oldx + 16 + 4) && (newx < (oldx + 16 + 4 + 8)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-        }
-        else if(mode == 0x02)
-        {
-          if((newx >= oldx) && (newx < (oldx + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-          else if((newx >= (oldx + 32)) && (newx < (oldx + 32 + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-
-          if((newx >= oldx + 4) && (newx < (oldx + 4 + 8)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-          else if((newx >= oldx + 32 + 4) && (newx < (oldx + 32 + 4 + 8)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-        }
-        else if(mode == 0x03)
-        {
-          if((newx >= oldx) && (newx < (oldx + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-          else if((newx >= (oldx + 16)) && (newx < (oldx + 16 + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-          else if((newx >= (oldx + 32)) && (newx < (oldx + 32 + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-
-          if((newx >= oldx + 4) && (newx < (oldx + 4 + 8)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-          else if((newx >= oldx + 16 + 4) && (newx < (oldx + 16 + 4 + 8)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-          else if((newx >= oldx + 32 + 4) && (newx < (oldx + 32 + 4 + 8)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-        }
-        else if(mode == 0x04)
-        {
-          if((newx >= oldx) && (newx < (oldx + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-          else if((newx >= (oldx + 64)) && (newx < (oldx + 64 + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-
-          if((newx >= oldx + 4) && (newx < (oldx + 4 + 8)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-          else if((newx >= oldx + 64 + 4) && (newx < (oldx + 64 + 4 + 8)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-        }
-        else if(mode == 0x05)
-        {
-          if((newx >= oldx) && (newx < (oldx + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-
-          if((newx >= oldx + 4) && (newx < (oldx + 4 + 16)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-        }
-        else if(mode == 0x06)
-        {
-          if((newx >= oldx) && (newx < (oldx + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-          else if((newx >= (oldx + 32)) && (newx < (oldx + 32 + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-          else if((newx >= (oldx + 64)) && (newx < (oldx + 64 + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-
-          if((newx >= oldx + 4) && (newx < (oldx + 4 + 8)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-          else if((newx >= oldx + 32 + 4) && (newx < (oldx + 32 + 4 + 8)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-          else if((newx >= oldx + 64 + 4) && (newx < (oldx + 64 + 4 + 8)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-        }
-        else if(mode == 0x07)
-        {
-          if((newx >= oldx) && (newx < (oldx + 4)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
-
-          if((newx >= oldx + 4) && (newx < (oldx + 4 + 32)))
-            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
-        }
-      }
-
-      // Let's do a sanity check on our table entries
-      uInt32 s1 = 0, s2 = 0;
-      for(newx = 0; newx < 160; ++newx)
-      {
-        if(ourPlayerPositionResetWhenTable[mode][oldx][newx] == -1)
-          ++s1;
-        if(ourPlayerPositionResetWhenTable[mode][oldx][newx] == 1)
-          ++s2;
-      }
-      assert((s1 % 4 == 0) && (s2 % 8 == 0));
-    }
-  }
-}
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void TIA::computePlayerReflectTable()
-{
-  for(uInt16 i = 0; i < 256; ++i)
-  {
-    uInt8 r = 0;
-
-    for(uInt16 t = 1; t <= 128; t *= 2)
-    {
-      r = (r << 1) | ((i & t) ? 0x01 : 0x00);
-    }
-
-    ourPlayerReflectTable[i] = r;
-  } 
-}
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void TIA::computePlayfieldMaskTable()
-{
-  Int32 x;
-
-  // Compute playfield mask table for non-reflected mode
-  for(x = 0; x < 160; ++x)
-  {
-    if(x < 16)
-      ourPlayfieldTable[0][x] = 0x00001 << (x / 4);
-    else if(x < 48)
-      ourPlayfieldTable[0][x] = 0x00800 >> ((x - 16) / 4);
-    else if(x < 80) 
-      ourPlayfieldTable[0][x] = 0x01000 << ((x - 48) / 4);
-    else if(x < 96) 
-      ourPlayfieldTable[0][x] = 0x00001 << ((x - 80) / 4);
-    else if(x < 128)
-      ourPlayfieldTable[0][x] = 0x00800 >> ((x - 96) / 4);
-    else if(x < 160) 
-      ourPlayfieldTable[0][x] = 0x01000 << ((x - 128) / 4);
-  }
-
-  // Compute playfield mask table for reflected mode
-  for(x = 0; x < 160; ++x)
-  {
-    if(x < 16)
-      ourPlayfieldTable[1][x] = 0x00001 << (x / 4);
-    else if(x < 48)
-      ourPlayfieldTable[1][x] = 0x00800 >> ((x - 16) / 4);
-    else if(x < 80) 
-      ourPlayfieldTable[1][x] = 0x01000 << ((x - 48) / 4);
-    else if(x < 112) 
-      ourPlayfieldTable[1][x] = 0x80000 >> ((x - 80) / 4);
-    else if(x < 144) 
-      ourPlayfieldTable[1][x] = 0x00010 << ((x - 112) / 4);
-    else if(x < 160) 
-      ourPlayfieldTable[1][x] = 0x00008 >> ((x - 144) / 4);
-  }
-}
-
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
 {
@@ -1235,7 +823,7 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       case myPFBit: 
       case myPFBit | PriorityBit:
       {
-        uInt32* mask = &myCurrentPFMask[hpos];
+        const uInt32* mask = &myCurrentPFMask[hpos];
 
         // Update a uInt8 at a time until reaching a uInt32 boundary
         for(; ((uintptr_t)myFramePointer & 0x03) && (myFramePointer < ending);
@@ -1256,7 +844,7 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       case myPFBit | ScoreBit:
       case myPFBit | ScoreBit | PriorityBit:
       {
-        uInt32* mask = &myCurrentPFMask[hpos];
+        const uInt32* mask = &myCurrentPFMask[hpos];
 
         // Update a uInt8 at a time until reaching a uInt32 boundary
         for(; ((uintptr_t)myFramePointer & 0x03) && (myFramePointer < ending); 
@@ -1282,7 +870,7 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       case myP0Bit | PriorityBit:
       case myP0Bit | ScoreBit | PriorityBit:
       {
-        uInt8* mP0 = &myCurrentP0Mask[hpos];
+        const uInt8* mP0 = &myCurrentP0Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -1306,7 +894,7 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       case myP1Bit | PriorityBit:
       case myP1Bit | ScoreBit | PriorityBit:
       {
-        uInt8* mP1 = &myCurrentP1Mask[hpos];
+        const uInt8* mP1 = &myCurrentP1Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -1330,8 +918,8 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       case myP0Bit | myP1Bit | PriorityBit:
       case myP0Bit | myP1Bit | ScoreBit | PriorityBit:
       {
-        uInt8* mP0 = &myCurrentP0Mask[hpos];
-        uInt8* mP1 = &myCurrentP1Mask[hpos];
+        const uInt8* mP0 = &myCurrentP0Mask[hpos];
+        const uInt8* mP1 = &myCurrentP1Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -1361,7 +949,7 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       case myM0Bit | PriorityBit:
       case myM0Bit | ScoreBit | PriorityBit:
       {
-        uInt8* mM0 = &myCurrentM0Mask[hpos];
+        const uInt8* mM0 = &myCurrentM0Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -1385,7 +973,7 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       case myM1Bit | PriorityBit:
       case myM1Bit | ScoreBit | PriorityBit:
       {
-        uInt8* mM1 = &myCurrentM1Mask[hpos];
+        const uInt8* mM1 = &myCurrentM1Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -1409,7 +997,7 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       case myBLBit | PriorityBit:
       case myBLBit | ScoreBit | PriorityBit:
       {
-        uInt8* mBL = &myCurrentBLMask[hpos];
+        const uInt8* mBL = &myCurrentBLMask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -1433,8 +1021,8 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       case myM0Bit | myM1Bit | PriorityBit:
       case myM0Bit | myM1Bit | ScoreBit | PriorityBit:
       {
-        uInt8* mM0 = &myCurrentM0Mask[hpos];
-        uInt8* mM1 = &myCurrentM1Mask[hpos];
+        const uInt8* mM0 = &myCurrentM0Mask[hpos];
+        const uInt8* mM1 = &myCurrentM1Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -1460,8 +1048,8 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       case myBLBit | myM0Bit:
       case myBLBit | myM0Bit | ScoreBit:
       {
-        uInt8* mBL = &myCurrentBLMask[hpos];
-        uInt8* mM0 = &myCurrentM0Mask[hpos];
+        const uInt8* mBL = &myCurrentBLMask[hpos];
+        const uInt8* mM0 = &myCurrentM0Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -1487,8 +1075,8 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       case myBLBit | myM0Bit | PriorityBit:
       case myBLBit | myM0Bit | ScoreBit | PriorityBit:
       {
-        uInt8* mBL = &myCurrentBLMask[hpos];
-        uInt8* mM0 = &myCurrentM0Mask[hpos];
+        const uInt8* mBL = &myCurrentBLMask[hpos];
+        const uInt8* mM0 = &myCurrentM0Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -1514,8 +1102,8 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       case myBLBit | myM1Bit:
       case myBLBit | myM1Bit | ScoreBit:
       {
-        uInt8* mBL = &myCurrentBLMask[hpos];
-        uInt8* mM1 = &myCurrentM1Mask[hpos];
+        const uInt8* mBL = &myCurrentBLMask[hpos];
+        const uInt8* mM1 = &myCurrentM1Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -1542,8 +1130,8 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       case myBLBit | myM1Bit | PriorityBit:
       case myBLBit | myM1Bit | ScoreBit | PriorityBit:
       {
-        uInt8* mBL = &myCurrentBLMask[hpos];
-        uInt8* mM1 = &myCurrentM1Mask[hpos];
+        const uInt8* mBL = &myCurrentBLMask[hpos];
+        const uInt8* mM1 = &myCurrentM1Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -1570,8 +1158,8 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       case myBLBit | myP1Bit:
       case myBLBit | myP1Bit | ScoreBit:
       {
-        uInt8* mBL = &myCurrentBLMask[hpos];
-        uInt8* mP1 = &myCurrentP1Mask[hpos];
+        const uInt8* mBL = &myCurrentBLMask[hpos];
+        const uInt8* mP1 = &myCurrentP1Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -1598,8 +1186,8 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       case myBLBit | myP1Bit | PriorityBit:
       case myBLBit | myP1Bit | PriorityBit | ScoreBit:
       {
-        uInt8* mBL = &myCurrentBLMask[hpos];
-        uInt8* mP1 = &myCurrentP1Mask[hpos];
+        const uInt8* mBL = &myCurrentBLMask[hpos];
+        const uInt8* mP1 = &myCurrentP1Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -1625,8 +1213,8 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       // Playfield and Player 0 are enabled and playfield priority is not set
       case myPFBit | myP0Bit:
       {
-        uInt32* mPF = &myCurrentPFMask[hpos];
-        uInt8* mP0 = &myCurrentP0Mask[hpos];
+        const uInt32* mPF = &myCurrentPFMask[hpos];
+        const uInt8* mP0 = &myCurrentP0Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -1653,8 +1241,8 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       // Playfield and Player 0 are enabled and playfield priority is set
       case myPFBit | myP0Bit | PriorityBit:
       {
-        uInt32* mPF = &myCurrentPFMask[hpos];
-        uInt8* mP0 = &myCurrentP0Mask[hpos];
+        const uInt32* mPF = &myCurrentPFMask[hpos];
+        const uInt8* mP0 = &myCurrentP0Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -1681,8 +1269,8 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       // Playfield and Player 1 are enabled and playfield priority is not set
       case myPFBit | myP1Bit:
       {
-        uInt32* mPF = &myCurrentPFMask[hpos];
-        uInt8* mP1 = &myCurrentP1Mask[hpos];
+        const uInt32* mPF = &myCurrentPFMask[hpos];
+        const uInt8* mP1 = &myCurrentP1Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -1709,8 +1297,8 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       // Playfield and Player 1 are enabled and playfield priority is set
       case myPFBit | myP1Bit | PriorityBit:
       {
-        uInt32* mPF = &myCurrentPFMask[hpos];
-        uInt8* mP1 = &myCurrentP1Mask[hpos];
+        const uInt32* mPF = &myCurrentPFMask[hpos];
+        const uInt8* mP1 = &myCurrentP1Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -1738,8 +1326,8 @@ inline void TIA::updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos)
       case myPFBit | myBLBit:
       case myPFBit | myBLBit | PriorityBit:
       {
-        uInt32* mPF = &myCurrentPFMask[hpos];
-        uInt8* mBL = &myCurrentBLMask[hpos];
+        const uInt32* mPF = &myCurrentPFMask[hpos];
+        const uInt8* mBL = &myCurrentBLMask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -2910,13 +2498,10 @@ void TIA::poke(uInt16 addr, uInt8 value)
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-uInt8 TIA::ourBallMaskTable[4][4][320];
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-uInt16 TIA::ourCollisionTable[64];
+const uInt8 TIA::ourDisabledMaskTable[640] = { 0 };
 
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-uInt8 TIA::ourDisabledMaskTable[640];
+// The remaining mask tables are generated at compile time (see src/tools)
+#include "TIATables.hxx"
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 const Int16 TIA::ourPokeDelayTable[64] = {
@@ -2926,9 +2511,6 @@ const Int16 TIA::ourPokeDelayTable[64] = {
    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
 };
 
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-uInt8 TIA::ourMissleMaskTable[4][8][4][320];
-
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 const bool TIA::ourHMOVEBlankEnableCycles[76] = {
   true,  true,  true,  true,  true,  true,  true,  true,  true,  true,   // 00
@@ -3021,18 +2603,6 @@ const Int32 TIA::ourCompleteMotionTable[76][16] = {
   { 0, -1, -2, -3, -4, -5, -6, -7,  8,  7,  6,  5,  4,  3,  2,  1}  // HBLANK
 };
 
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-uInt8 TIA::ourPlayerMaskTable[4][2][8][320];
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-Int8 TIA::ourPlayerPositionResetWhenTable[8][160][160];
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-uInt8 TIA::ourPlayerReflectTable[256];
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-uInt32 TIA::ourPlayfieldTable[2][160];
-
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 TIA::TIA(const TIA& c)
     : myConsole(c.myConsole),
@@ -3087,7 +2657,7 @@ inline void TIA::updateFrameScanlineFast(uInt32 clocksToUpdate, uInt32 hpos)
       case myPFBit | PriorityBit:
       /* @strip
       {
-        uInt32* mask = &myCurrentPFMask[hpos];
+        const uInt32* mask = &myCurrentPFMask[hpos];
 
         // Update a uInt8 at a time until reaching a uInt32 boundary
         for(; ((uintptr_t)myFramePointer & 0x03) && (myFramePointer < ending);
@@ -3108,7 +2678,7 @@ inline void TIA::updateFrameScanlineFast(uInt32 clocksToUpdate, uInt32 hpos)
       case myPFBit | ScoreBit:
       case myPFBit | ScoreBit | PriorityBit:
       /* @strip {
-        uInt32* mask = &myCurrentPFMask[hpos];
+        const uInt32* mask = &myCurrentPFMask[hpos];
 
         // Update a uInt8 at a time until reaching a uInt32 boundary
         for(; ((uintptr_t)myFramePointer & 0x03) && (myFramePointer < ending); 
@@ -3135,7 +2705,7 @@ inline void TIA::updateFrameScanlineFast(uInt32 clocksToUpdate, uInt32 hpos)
       case myP0Bit | PriorityBit:
       case myP0Bit | ScoreBit | PriorityBit:
       /* @strip {
-        uInt8* mP0 = &myCurrentP0Mask[hpos];
+        const uInt8* mP0 = &myCurrentP0Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -3159,7 +2729,7 @@ inline void TIA::updateFrameScanlineFast(uInt32 clocksToUpdate, uInt32 hpos)
       case myP1Bit | PriorityBit:
       case myP1Bit | ScoreBit | PriorityBit:
       /* @strip {
-        uInt8* mP1 = &myCurrentP1Mask[hpos];
+        const uInt8* mP1 = &myCurrentP1Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -3183,8 +2753,8 @@ inline void TIA::updateFrameScanlineFast(uInt32 clocksToUpdate, uInt32 hpos)
       case myP0Bit | myP1Bit | PriorityBit:
       case myP0Bit | myP1Bit | ScoreBit | PriorityBit:
       {
-        uInt8* mP0 = &myCurrentP0Mask[hpos];
-        uInt8* mP1 = &myCurrentP1Mask[hpos];
+        const uInt8* mP0 = &myCurrentP0Mask[hpos];
+        const uInt8* mP1 = &myCurrentP1Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -3215,7 +2785,7 @@ inline void TIA::updateFrameScanlineFast(uInt32 clocksToUpdate, uInt32 hpos)
       case myM0Bit | PriorityBit:
       case myM0Bit | ScoreBit | PriorityBit:
       /* @strip {
-        uInt8* mM0 = &myCurrentM0Mask[hpos];
+        const uInt8* mM0 = &myCurrentM0Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -3240,7 +2810,7 @@ inline void TIA::updateFrameScanlineFast(uInt32 clocksToUpdate, uInt32 hpos)
       case myM1Bit | PriorityBit:
       case myM1Bit | ScoreBit | PriorityBit:
       /* @strip {
-        uInt8* mM1 = &myCurrentM1Mask[hpos];
+        const uInt8* mM1 = &myCurrentM1Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -3265,7 +2835,7 @@ inline void TIA::updateFrameScanlineFast(uInt32 clocksToUpdate, uInt32 hpos)
       case myBLBit | PriorityBit:
       case myBLBit | ScoreBit | PriorityBit:
       /* @strip {
-        uInt8* mBL = &myCurrentBLMask[hpos];
+        const uInt8* mBL = &myCurrentBLMask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -3290,8 +2860,8 @@ inline void TIA::updateFrameScanlineFast(uInt32 clocksToUpdate, uInt32 hpos)
       case myM0Bit | myM1Bit | PriorityBit:
       case myM0Bit | myM1Bit | ScoreBit | PriorityBit:
       {
-        uInt8* mM0 = &myCurrentM0Mask[hpos];
-        uInt8* mM1 = &myCurrentM1Mask[hpos];
+        const uInt8* mM0 = &myCurrentM0Mask[hpos];
+        const uInt8* mM1 = &myCurrentM1Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -3317,8 +2887,8 @@ inline void TIA::updateFrameScanlineFast(uInt32 clocksToUpdate, uInt32 hpos)
       case myBLBit | myM0Bit:
       case myBLBit | myM0Bit | ScoreBit:
       {
-        uInt8* mBL = &myCurrentBLMask[hpos];
-        uInt8* mM0 = &myCurrentM0Mask[hpos];
+        const uInt8* mBL = &myCurrentBLMask[hpos];
+        const uInt8* mM0 = &myCurrentM0Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -3344,8 +2914,8 @@ inline void TIA::updateFrameScanlineFast(uInt32 clocksToUpdate, uInt32 hpos)
       case myBLBit | myM0Bit | PriorityBit:
       case myBLBit | myM0Bit | ScoreBit | PriorityBit:
       {
-        uInt8* mBL = &myCurrentBLMask[hpos];
-        uInt8* mM0 = &myCurrentM0Mask[hpos];
+        const uInt8* mBL = &myCurrentBLMask[hpos];
+        const uInt8* mM0 = &myCurrentM0Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -3371,8 +2941,8 @@ inline void TIA::updateFrameScanlineFast(uInt32 clocksToUpdate, uInt32 hpos)
       case myBLBit | myM1Bit:
       case myBLBit | myM1Bit | ScoreBit:
       {
-        uInt8* mBL = &myCurrentBLMask[hpos];
-        uInt8* mM1 = &myCurrentM1Mask[hpos];
+        const uInt8* mBL = &myCurrentBLMask[hpos];
+        const uInt8* mM1 = &myCurrentM1Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -3399,8 +2969,8 @@ inline void TIA::updateFrameScanlineFast(uInt32 clocksToUpdate, uInt32 hpos)
       case myBLBit | myM1Bit | PriorityBit:
       case myBLBit | myM1Bit | ScoreBit | PriorityBit:
       {
-        uInt8* mBL = &myCurrentBLMask[hpos];
-        uInt8* mM1 = &myCurrentM1Mask[hpos];
+        const uInt8* mBL = &myCurrentBLMask[hpos];
+        const uInt8* mM1 = &myCurrentM1Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -3427,8 +2997,8 @@ inline void TIA::updateFrameScanlineFast(uInt32 clocksToUpdate, uInt32 hpos)
       case myBLBit | myP1Bit:
       case myBLBit | myP1Bit | ScoreBit:
       {
-        uInt8* mBL = &myCurrentBLMask[hpos];
-        uInt8* mP1 = &myCurrentP1Mask[hpos];
+        const uInt8* mBL = &myCurrentBLMask[hpos];
+        const uInt8* mP1 = &myCurrentP1Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -3455,8 +3025,8 @@ inline void TIA::updateFrameScanlineFast(uInt32 clocksToUpdate, uInt32 hpos)
       case myBLBit | myP1Bit | PriorityBit:
       case myBLBit | myP1Bit | PriorityBit | ScoreBit:
       {
-        uInt8* mBL = &myCurrentBLMask[hpos];
-        uInt8* mP1 = &myCurrentP1Mask[hpos];
+        const uInt8* mBL = &myCurrentBLMask[hpos];
+        const uInt8* mP1 = &myCurrentP1Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -3482,8 +3052,8 @@ inline void TIA::updateFrameScanlineFast(uInt32 clocksToUpdate, uInt32 hpos)
       // Playfield and Player 0 are enabled and playfield priority is not set
       case myPFBit | myP0Bit:
       {
-        uInt32* mPF = &myCurrentPFMask[hpos];
-        uInt8* mP0 = &myCurrentP0Mask[hpos];
+        const uInt32* mPF = &myCurrentPFMask[hpos];
+        const uInt8* mP0 = &myCurrentP0Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -3510,8 +3080,8 @@ inline void TIA::updateFrameScanlineFast(uInt32 clocksToUpdate, uInt32 hpos)
       // Playfield and Player 0 are enabled and playfield priority is set
       case myPFBit | myP0Bit | PriorityBit:
       {
-        uInt32* mPF = &myCurrentPFMask[hpos];
-        uInt8* mP0 = &myCurrentP0Mask[hpos];
+        const uInt32* mPF = &myCurrentPFMask[hpos];
+        const uInt8* mP0 = &myCurrentP0Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -3538,8 +3108,8 @@ inline void TIA::updateFrameScanlineFast(uInt32 clocksToUpdate, uInt32 hpos)
       // Playfield and Player 1 are enabled and playfield priority is not set
       case myPFBit | myP1Bit:
       {
-        uInt32* mPF = &myCurrentPFMask[hpos];
-        uInt8* mP1 = &myCurrentP1Mask[hpos];
+        const uInt32* mPF = &myCurrentPFMask[hpos];
+        const uInt8* mP1 = &myCurrentP1Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -3566,8 +3136,8 @@ inline void TIA::updateFrameScanlineFast(uInt32 clocksToUpdate, uInt32 hpos)
       // Playfield and Player 1 are enabled and playfield priority is set
       case myPFBit | myP1Bit | PriorityBit:
       {
-        uInt32* mPF = &myCurrentPFMask[hpos];
-        uInt8* mP1 = &myCurrentP1Mask[hpos];
+        const uInt32* mPF = &myCurrentPFMask[hpos];
+        const uInt8* mP1 = &myCurrentP1Mask[hpos];
 
         while(myFramePointer < ending)
         {
@@ -3595,8 +3165,8 @@ inline void TIA::updateFrameScanlineFast(uInt32 clocksToUpdate, uInt32 hpos)
       case myPFBit | myBLBit:
       case myPFBit | myBLBit | PriorityBit:
       {
-        uInt32* mPF = &myCurrentPFMask[hpos];
-        uInt8* mBL = &myCurrentBLMask[hpos];
+        const uInt32* mPF = &myCurrentPFMask[hpos];
+        const uInt8* mBL = &myCurrentBLMask[hpos];
 
         while(myFramePointer < ending)
         {
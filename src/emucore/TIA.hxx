@@ -23,6 +23,7 @@ class Console;
 class System;
 class Serializer;
 class Deserializer;
+class Journal;
 class Settings;
 
 #include "m6502/src/bspf/src/bspf.hxx"
@@ -111,6 +112,19 @@ class TIA : public Device , public MediaSource
     */
     virtual bool load(Deserializer& in);
 
+    /**
+      Records the registers of this device in the given journal when a
+      checkpoint is taken.
+
+      @param journal The journal to record to
+    */
+    virtual void checkpoint(Journal& journal);
+
+    /**
+      Re-enables every object after a rollback, as load() does.
+    */
+    virtual void journalRestored();
+
   public:
     /**
       Get the byte at the specified address
@@ -142,7 +156,8 @@ class TIA : public Device , public MediaSource
     uInt8* currentFrameBuffer() const { return myCurrentFrameBuffer; }
 
     /**
-      Answers the previous frame buffer
+      Answers the previous frame buffer.  With the "compact_environment"
+      setting only one frame buffer is kept, and this is the current one.
 
       @return Pointer to the previous frame buffer
     */
@@ -233,28 +248,6 @@ class TIA : public Device , public MediaSource
     virtual void updateScanlineByTrace(int target);
 #endif
 
-  private:
-    // Compute the ball mask table
-    void computeBallMaskTable();
-
-    // Compute the collision decode table
-    void computeCollisionTable();
-
-    // Compute the missle mask table
-    void computeMissleMaskTable();
-
-    // Compute the player mask table
-    void computePlayerMaskTable();
-
-    // Compute the player position reset when table
-    void computePlayerPositionResetWhenTable();
-
-    // Compute the player reflect table
-    void computePlayerReflectTable();
-
-    // Compute playfield mask table
-    void computePlayfieldMaskTable();
-
   private:
     // Update the current frame buffer up to one scanline
     void updateFrameScanline(uInt32 clocksToUpdate, uInt32 hpos);
@@ -304,7 +297,8 @@ class TIA : public Device , public MediaSource
     // Pointer to the current frame buffer
     uInt8* myCurrentFrameBuffer;
 
-    // Pointer to the previous frame buffer
+    // Pointer to the previous frame buffer; the same as the current one
+    // when running a compact environment
     uInt8* myPreviousFrameBuffer;
 
     // Pointer to the next pixel that will be drawn in the current frame buffer
@@ -455,22 +449,22 @@ class TIA : public Device , public MediaSource
     // the TIA code will fail on a good number of CPUs.
 
     // Pointer to the currently active mask array for the ball
-    uInt8* myCurrentBLMask;
+    const uInt8* myCurrentBLMask;
 
     // Pointer to the currently active mask array for missle 0
-    uInt8* myCurrentM0Mask;
+    const uInt8* myCurrentM0Mask;
 
     // Pointer to the currently active mask array for missle 1
-    uInt8* myCurrentM1Mask;
+    const uInt8* myCurrentM1Mask;
 
     // Pointer to the currently active mask array for player 0
-    uInt8* myCurrentP0Mask;
+    const uInt8* myCurrentP0Mask;
 
     // Pointer to the currently active mask array for player 1
-    uInt8* myCurrentP1Mask;
+    const uInt8* myCurrentP1Mask;
 
     // Pointer to the currently active mask array for the playfield
-    uInt32* myCurrentPFMask;
+    const uInt32* myCurrentPFMask;
 
     // Audio values. Only used by TIADebug.
     uInt8 myAUDV0;
@@ -511,19 +505,19 @@ class TIA : public Device , public MediaSource
 
   private:
     // Ball mask table (entries are true or false)
-    static uInt8 ourBallMaskTable[4][4][320];
+    static const uInt8 ourBallMaskTable[4][4][320];
 
     // Used to set the collision register to the correct value
-    static uInt16 ourCollisionTable[64];
+    static const uInt16 ourCollisionTable[64];
 
     // A mask table which can be used when an object is disabled
-    static uInt8 ourDisabledMaskTable[640];
+    static const uInt8 ourDisabledMaskTable[640];
 
     // Indicates the update delay associated with poking at a TIA address
     static const Int16 ourPokeDelayTable[64];
 
     // Missle mask table (entries are true or false)
-    static uInt8 ourMissleMaskTable[4][8][4][320];
+    static const uInt8 ourMissleMaskTable[4][8][4][320];
 
     // Used to convert value written in a motion register into 
     // its internal representation
@@ -533,16 +527,16 @@ class TIA : public Device , public MediaSource
     static const bool ourHMOVEBlankEnableCycles[76];
 
     // Player mask table
-    static uInt8 ourPlayerMaskTable[4][2][8][320];
+    static const uInt8 ourPlayerMaskTable[4][2][8][320];
 
     // Indicates if player is being reset during delay, display or other times
-    static Int8 ourPlayerPositionResetWhenTable[8][160][160];
+    static const Int8 ourPlayerPositionResetWhenTable[8][160][160];
 
     // Used to reflect a players graphics
-    static uInt8 ourPlayerReflectTable[256];
+    static const uInt8 ourPlayerReflectTable[256];
 
     // Playfield mask table for reflected and non-reflected playfields
-    static uInt32 ourPlayfieldTable[2][160];
+    static const uInt32 ourPlayfieldTable[2][160];
 
   private:
     // Copy constructor isn't supported by this class so make it private
@@ -17,6 +17,7 @@
 //============================================================================
 
 #include "Device.hxx"
+#include "Journal.hxx"
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Device::Device()
@@ -35,3 +36,13 @@ void Device::systemCyclesReset()
   // By default I do nothing when my system resets its cycle counter
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Device::checkpoint(Journal& journal)
+{
+  journal.saveObject(*this);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Device::journalRestored()
+{
+}
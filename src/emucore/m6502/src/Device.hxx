@@ -22,6 +22,7 @@
 class System;
 class Serializer;
 class Deserializer;
+class Journal;
 
 #include "bspf/src/bspf.hxx"
 
@@ -89,6 +90,22 @@ class Device
     */
     virtual bool load(Deserializer& in) = 0;
 
+    /**
+      Records the state of this device, apart from RAM written through
+      the system, in the given journal when a checkpoint is taken.  By
+      default the device is recorded through save().
+
+      @param journal The journal to record to
+    */
+    virtual void checkpoint(Journal& journal);
+
+    /**
+      Notification method invoked on rollback after a journal.notify(*this)
+      record, once the state recorded after it has been restored, e.g. to
+      remap banks.
+    */
+    virtual void journalRestored();
+
   public:
     /**
       Get the byte at the specified address
@@ -17,6 +17,7 @@
 //============================================================================
 
 #include "M6502.hxx"
+#include "Journal.hxx"
 
 #ifdef DEBUGGER_SUPPORT
   #include "Expression.hxx"
@@ -106,6 +107,28 @@ void M6502::stop()
   myExecutionStatus |= StopExecutionBit;
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void M6502::checkpoint(Journal& journal)
+{
+  // The same registers as save()
+  journal.save(A);
+  journal.save(X);
+  journal.save(Y);
+  journal.save(SP);
+  journal.save(IR);
+  journal.save(PC);
+
+  journal.save(N);
+  journal.save(V);
+  journal.save(B);
+  journal.save(D);
+  journal.save(I);
+  journal.save(notZ);
+  journal.save(C);
+
+  journal.save(myExecutionStatus);
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 M6502::AddressingMode M6502::addressingMode(uInt8 opcode) const
 {
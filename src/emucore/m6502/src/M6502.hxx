@@ -23,6 +23,7 @@ class D6502;
 class M6502;
 class Serializer;
 class Deserializer;
+class Journal;
 class Debugger;
 class CpuDebug;
 class Expression;
@@ -121,6 +122,14 @@ class M6502
     */
     virtual bool load(Deserializer& in) = 0;
 
+    /**
+      Records the register file in the given journal when a checkpoint
+      is taken.
+
+      @param journal The journal to record to
+    */
+    virtual void checkpoint(Journal& journal);
+
     /**
       Get a null terminated string which is the processor's name (i.e. "M6532")
 
@@ -19,6 +19,7 @@
 #include "M6502Hi.hxx"
 #include "Serializer.hxx"
 #include "Deserializer.hxx"
+#include "Journal.hxx"
 
 #ifdef DEBUGGER_SUPPORT
   #include "Debugger.hxx"
@@ -280,6 +281,15 @@ bool M6502High::save(Serializer& out)
   return true;
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void M6502High::checkpoint(Journal& journal)
+{
+  M6502::checkpoint(journal);
+
+  journal.save(myNumberOfDistinctAccesses);
+  journal.save(myLastAddress);
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 bool M6502High::load(Deserializer& in)
 {
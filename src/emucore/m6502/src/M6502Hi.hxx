@@ -80,6 +80,13 @@ class M6502High : public M6502
     */
     virtual bool load(Deserializer& in);
 
+    /**
+      Records the register file and access counters in the given journal.
+
+      @param journal The journal to record to
+    */
+    virtual void checkpoint(Journal& journal);
+
     /**
       Get a null terminated string which is the processors's name (i.e. "M6532")
 
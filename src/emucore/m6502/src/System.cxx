@@ -25,6 +25,7 @@
 #include "System.hxx"
 #include "Serializer.hxx"
 #include "Deserializer.hxx"
+#include "Journal.hxx"
 using namespace std;
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -37,6 +38,7 @@ System::System(uInt16 n, uInt16 m)
     myM6502(0),
     myTIA(0),
     myCycles(0),
+    myJournal(0),
     myDataBusState(0)
 {
   // Make sure the arguments are reasonable
@@ -284,6 +286,15 @@ bool System::loadState(const string& md5sum, Deserializer& in)
   return true;  // success
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void System::checkpoint(Journal& journal)
+{
+  journal.save(myCycles);
+  myM6502->checkpoint(journal);
+  for(uInt32 i = 0; i < myNumberOfDevices; ++i)
+    myDevices[i]->checkpoint(journal);
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 System::System(const System& s)
   : myAddressMask(s.myAddressMask),
@@ -335,7 +346,10 @@ void System::poke(uInt16 addr, uInt8 value)
   // See if this page uses direct accessing or not 
   if(access.directPokeBase != 0)
   {
-    *(access.directPokeBase + (addr & myPageMask)) = value;
+    uInt8* location = access.directPokeBase + (addr & myPageMask);
+    if(myJournal != 0)
+      myJournal->record(location);
+    *location = value;
   }
   else
   {
@@ -25,6 +25,7 @@ class TIA;
 class NullDevice;
 class Serializer;
 class Deserializer;
+class Journal;
 
 #include "bspf/src/bspf.hxx"
 #include "Device.hxx"
@@ -136,6 +137,26 @@ class System
     */
     bool loadState(const std::string& md5sum, Deserializer& in);
 
+    /**
+      Records the state of this system, its CPU and every device in the
+      given journal, taking a checkpoint.  RAM is not recorded; the
+      system journals writes to it instead (see setJournal()).
+
+      @param journal  The journal to record to
+    */
+    void checkpoint(Journal& journal);
+
+    /**
+      Records the old value of every byte of RAM written from now on in
+      the given journal, or stops recording if it is the null pointer.
+
+      @param journal  The journal to record to
+    */
+    void setJournal(Journal* journal)
+    {
+      myJournal = journal;
+    }
+
   public:
     /**
       Answer the 6502 microprocessor attached to the system.  If a
@@ -282,7 +303,7 @@ class System
         to this page, while other values are the base address of an array 
         to directly access for reads to this page.
       */
-      uInt8* directPeekBase;
+      const uInt8* directPeekBase;
 
       /**
         Pointer to a block of memory or the null pointer.  The null pointer
@@ -346,6 +367,9 @@ class System
     // Number of system cycles executed since the last reset
     uInt32 myCycles;
 
+    // Journal recording RAM writes, or the null pointer
+    Journal* myJournal;
+
     // Null device to use for page which are not installed
     NullDevice myNullDevice; 
 
@@ -32,6 +32,7 @@ MODULE_OBJS := \
 	src/emucore/Driving.o \
 	src/emucore/Event.o \
 	src/emucore/FSNode.o \
+	src/emucore/Journal.o \
 	src/emucore/Joystick.o \
 	src/emucore/Keyboard.o \
 	src/emucore/M6532.o \
@@ -42,6 +43,7 @@ MODULE_OBJS := \
 	src/emucore/Props.o \
 	src/emucore/PropsSet.o \
 	src/emucore/Random.o \
+	src/emucore/RomImage.o \
 	src/emucore/Serializer.o \
 	src/emucore/Settings.o \
 	src/emucore/SpeakJet.o \
@@ -19,6 +19,7 @@
 #define __ALE_RAM_HPP__
 
 #include <string.h>
+#include "../common/Fingerprint.hpp"
 
 typedef unsigned char byte_t;
 
@@ -43,6 +44,9 @@ class ALERAM {
     /** Returns whether two copies of the RAM are equal */
     bool equals(const ALERAM &rhs) const;
 
+    /** Returns a 64-bit hash of the RAM; equal copies have equal fingerprints */
+    fingerprint_t fingerprint() const { return fingerprintBytes(m_ram, sizeof(m_ram)); }
+
   protected:
     byte_t m_ram[RAM_SIZE];
 };
@@ -22,6 +22,7 @@
 #include <cstring>
 #include <memory>
 #include <vector>
+#include "../common/Fingerprint.hpp"
 
 typedef unsigned char pixel_t;
 
@@ -53,6 +54,15 @@ class ALEScreen {
     /** Returns whether two screens are equal */
     bool equals(const ALEScreen &rhs) const;
 
+    /** Returns a 64-bit hash of the screen; equal screens have equal fingerprints */
+    fingerprint_t fingerprint() const { return fingerprintPixels(getArray(), m_rows, m_columns); }
+
+    /** Returns the fingerprint of a coarse view of the screen: rows x columns blocks of
+        average luminance, quantized to levels values (see fingerprintCells) */
+    fingerprint_t cellFingerprint(int rows, int columns, int levels) const {
+      return fingerprintCells(getArray(), m_rows, m_columns, rows, columns, levels);
+    }
+
   protected:
     int m_rows;
     int m_columns;
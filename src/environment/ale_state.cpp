@@ -97,6 +97,15 @@ ALEState ALEState::save(OSystem* osystem, RomSettings* settings, std::string md5
   return ALEState(*this, ser.get_str());
 }
 
+void ALEState::checkpoint(Journal& journal) {
+  journal.save(m_left_paddle);
+  journal.save(m_right_paddle);
+  journal.save(m_frame_number);
+  journal.save(m_episode_frame_number);
+  journal.save(m_mode);
+  journal.save(m_difficulty);
+}
+
 void ALEState::incrementFrame(int steps /* = 1 */) {
     m_frame_number += steps;
     m_episode_frame_number += steps;
@@ -106,7 +115,7 @@ void ALEState::resetEpisodeFrameNumber() {
     m_episode_frame_number = 0;
 }
 
-std::string ALEState::serialize() {
+std::string ALEState::serialize() const {
   Serializer ser;
 
   ser.putInt(this->m_left_paddle);
@@ -122,6 +131,16 @@ std::string ALEState::serialize() {
 
 
 
+std::string ALEState::getROMMD5() const {
+  if (m_serialized_state.empty())
+    return "";
+
+  // The emulator state starts with the system flag (see save()), then System::saveState()'s MD5
+  Deserializer des(m_serialized_state);
+  des.getBool();
+  return des.getString();
+}
+
 /* ***************************************************************************
  *  Calculates the Paddle resistance, based on the given x val
  * ***************************************************************************/
@@ -433,6 +452,14 @@ void ALEState::resetKeys(Event* event) {
     setDifficultySwitches(event, m_difficulty);
 }
 
+fingerprint_t ALEState::fingerprint() const {
+  // The same fields as equals()
+  int fields[6] = { m_left_paddle, m_right_paddle, m_frame_number, m_episode_frame_number,
+                    (int)m_mode, (int)m_difficulty };
+  fingerprint_t seed = fingerprintBytes(fields, sizeof(fields));
+  return fingerprintBytes(m_serialized_state.data(), m_serialized_state.size(), seed);
+}
+
 bool ALEState::equals(ALEState &rhs) {
   return (rhs.m_serialized_state == this->m_serialized_state &&
     rhs.m_left_paddle == this->m_left_paddle &&
@@ -20,8 +20,10 @@
 
 #include "../emucore/OSystem.hxx"
 #include "../emucore/Event.hxx"
+#include "../emucore/Journal.hxx"
 #include <string>
 #include "../common/Log.hpp"
+#include "../common/Fingerprint.hpp"
 
 class RomSettings;
 
@@ -49,6 +51,11 @@ class ALEState {
     /** Returns true if the two states contain the same saved information */
     bool equals(ALEState &state);
 
+    /** Returns a 64-bit hash of the saved information; states which are equal() have equal
+      *  fingerprints. The emulator state includes cycle counters, so states reached at
+      *  different times seldom match; screen or RAM fingerprints suit novelty search better. */
+    fingerprint_t fingerprint() const;
+
     void resetPaddles(Event*);
 
     //Apply the special select action
@@ -85,7 +92,14 @@ class ALEState {
     //Get the current mode we are in.
     game_mode_t getCurrentMode() const { return m_mode; }
 
-    std::string serialize();
+    std::string serialize() const;
+
+    /** Returns the MD5 of the ROM this state was saved from, or an empty string for a state
+      *  which holds no emulator information. */
+    std::string getROMMD5() const;
+
+    /** Returns the size of the stored emulator state, in bytes */
+    size_t serializedSize() const { return m_serialized_state.size(); }
 
 
   protected:
@@ -102,6 +116,10 @@ class ALEState {
       *  the emulator. If save_system == true, this includes the RNG state. */
     ALEState save(OSystem* osystem, RomSettings* settings, std::string md5, bool save_system);
 
+    /** Records the paddles, frame numbers, mode and difficulty in the journal, so that
+      *  rolling back restores them along with the emulator. */
+    void checkpoint(Journal& journal);
+
     /** Reset key presses */
     void resetKeys(Event* event_obj);
 
@@ -4,6 +4,12 @@ MODULE_OBJS := \
 	src/environment/ale_state.o \
 	src/environment/stella_environment.o \
 	src/environment/phosphor_blend.o \
+	src/environment/transition_cache.o \
+	src/environment/replica_pool.o \
+	src/environment/state_archive.o \
+	src/environment/state_codec.o \
+	src/environment/trajectory.o \
+	src/environment/replay_buffer.o \
 	
 MODULE_DIRS += \
 	src/environment
@@ -17,18 +17,26 @@
 #include "phosphor_blend.hpp"
 #include "../emucore/Console.hxx"
 
+#include <cstdlib>
+#include <map>
+#include <mutex>
+
 PhosphorBlend::PhosphorBlend(OSystem * osystem):
     m_osystem(osystem) {
   
   // Taken from default Stella settings
   m_phosphor_blend_ratio = 77;
-
-  makeAveragePalette();
 }
 
 void PhosphorBlend::process(ALEScreen& screen) {
   Console& console = m_osystem->console();
 
+  // The tables are only needed once we actually average colours
+  if (!m_tables) {
+    m_tables = getTables(m_osystem->colourPalette(), m_phosphor_blend_ratio);
+  }
+  const Tables& tables = *m_tables;
+
   // Fetch current and previous frame buffers from the emulator
   uInt8 * current_buffer  = console.mediaSource().currentFrameBuffer();
   uInt8 * previous_buffer = console.mediaSource().previousFrameBuffer();
@@ -39,28 +47,53 @@ void PhosphorBlend::process(ALEScreen& screen) {
     int pv = previous_buffer[i];
     
     // Find out the corresponding rgb color 
-    uInt32 rgb = m_avg_palette[cv][pv];
+    uInt32 rgb = tables.avg_palette[cv][pv];
 
-    // Set the corresponding pixel in the array
-    screen.getArray()[i] = rgbToNTSC(rgb);
+    // Set the corresponding pixel in the array, converting the RGB value back to 8 bits
+    screen.getArray()[i] =
+      tables.rgb_ntsc[(rgb >> 18) & 0x3F][(rgb >> 10) & 0x3F][(rgb >> 2) & 0x3F];
   }
 }
-void PhosphorBlend::makeAveragePalette() {
-  
-  ColourPalette &palette = m_osystem->colourPalette();
+
+std::shared_ptr<const PhosphorBlend::Tables> PhosphorBlend::getTables(
+    const ColourPalette& palette, uInt8 blend_ratio) {
+  static std::mutex cache_mutex;
+  static std::map<std::string, std::shared_ptr<const Tables> > cache;
+
+  // Key the cache on the palette contents; odd (grayscale) entries are never averaged
+  std::string key(1, (char)blend_ratio);
+  for (int c = 0; c < 256; c += 2) {
+    uInt32 rgb = palette.getRGB(c);
+    key.append(reinterpret_cast<const char*>(&rgb), sizeof(rgb));
+  }
+
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  std::shared_ptr<const Tables>& tables = cache[key];
+  if (!tables) {
+    Tables* new_tables = new Tables();
+    makeAveragePalette(palette, blend_ratio, *new_tables);
+    tables.reset(new_tables);
+  }
+  return tables;
+}
+
+void PhosphorBlend::makeAveragePalette(const ColourPalette& palette, uInt8 blend_ratio,
+                                       Tables& tables) {
+  // Unpack the RGB components of the colour entries once, as they are used in the inner loops
+  int pr[128], pg[128], pb[128];
+  for (int c1 = 0; c1 < 256; c1 += 2) {
+    palette.getRGB(c1, pr[c1 >> 1], pg[c1 >> 1], pb[c1 >> 1]);
+  }
 
   // Precompute the average RGB values for phosphor-averaged colors c1 and c2.
   for (int c1 = 0; c1 < 256; c1 += 2) {
     for (int c2 = 0; c2 < 256; c2 += 2) {
-      int r1, g1, b1;
-      int r2, g2, b2;
-      palette.getRGB(c1, r1, g1, b1);
-      palette.getRGB(c2, r2, g2, b2);
-
-      uInt8 r = getPhosphor(r1, r2);
-      uInt8 g = getPhosphor(g1, g2);
-      uInt8 b = getPhosphor(b1, b2);
-      m_avg_palette[c1][c2] = makeRGB(r, g, b);
+      int i1 = c1 >> 1, i2 = c2 >> 1;
+
+      uInt8 r = getPhosphor(pr[i1], pr[i2], blend_ratio);
+      uInt8 g = getPhosphor(pg[i1], pg[i2], blend_ratio);
+      uInt8 b = getPhosphor(pb[i1], pb[i2], blend_ratio);
+      tables.avg_palette[c1][c2] = makeRGB(r, g, b);
     }
   }
   
@@ -75,32 +108,28 @@ void PhosphorBlend::makeAveragePalette() {
 
         // Look for the closest NTSC value matching (r,g,b). Odd palette
         // entries correspond to grayscale values and are ignored.
-        for (int c1 = 0; c1 < 256; c1 += 2) {
-          // Get the RGB corresponding to c1
-          int r1, g1, b1;
-          palette.getRGB(c1, r1, g1, b1);
-
-          int dist = abs(r1 - r) + abs(g1 - g) + abs(b1 - b);
+        for (int i = 0; i < 128; i++) {
+          int dist = abs(pr[i] - r) + abs(pg[i] - g) + abs(pb[i] - b);
           if (dist < minDist) {
             minDist = dist;
-            minIndex = c1;
+            minIndex = i << 1;
           }
         }
 
-        m_rgb_ntsc[r >> 2][g >> 2][b >> 2] = minIndex;
+        tables.rgb_ntsc[r >> 2][g >> 2][b >> 2] = minIndex;
       }
     }
   }
 }
 
-uInt8 PhosphorBlend::getPhosphor(uInt8 v1, uInt8 v2) {
+uInt8 PhosphorBlend::getPhosphor(uInt8 v1, uInt8 v2, uInt8 blend_ratio) {
   if (v1 < v2) {
     int tmp = v1;
     v1 = v2;
     v2 = tmp;
   }
 
-  uInt32 blendedValue = ((v1 - v2) * m_phosphor_blend_ratio) / 100 + v2;
+  uInt32 blendedValue = ((v1 - v2) * blend_ratio) / 100 + v2;
   if (blendedValue > 255) return 255;
   else return (uInt8) blendedValue;
 }
@@ -108,13 +137,3 @@ uInt8 PhosphorBlend::getPhosphor(uInt8 v1, uInt8 v2) {
 uInt32 PhosphorBlend::makeRGB(uInt8 r, uInt8 g, uInt8 b) {
   return (r << 16) | (g << 8) | b;
 }
-
-/** Converts a RGB value to an 8-bit format */
-uInt8 PhosphorBlend::rgbToNTSC(uInt32 rgb) {
-  int r = (rgb >> 16) & 0xFF;
-  int g = (rgb >> 8) & 0xFF;
-  int b = rgb & 0xFF;
-
-  return m_rgb_ntsc[r >> 2][g >> 2][b >> 2];
-}
-
@@ -20,6 +20,8 @@
 #include "../emucore/OSystem.hxx"
 #include "ale_screen.hpp"
 
+#include <memory>
+
 class PhosphorBlend {
   public:
     PhosphorBlend(OSystem *);
@@ -27,18 +29,24 @@ class PhosphorBlend {
     void process(ALEScreen& screen);
 
   private:
-    void makeAveragePalette();
-    uInt8 getPhosphor(uInt8 v1, uInt8 v2);
-    uInt32 makeRGB(uInt8 r, uInt8 g, uInt8 b);
-    /** Converts a RGB value to an 8-bit format */
-    uInt8 rgbToNTSC(uInt32 rgb);
+    /** The averaging tables only depend on the palette; they are built on first use and
+      *  shared by every PhosphorBlend in the process that uses the same palette. */
+    struct Tables {
+      uInt8 rgb_ntsc[64][64][64];
+      uInt32 avg_palette[256][256];
+    };
+
+    static std::shared_ptr<const Tables> getTables(const ColourPalette& palette,
+                                                   uInt8 blend_ratio);
+    static void makeAveragePalette(const ColourPalette& palette, uInt8 blend_ratio,
+                                   Tables& tables);
+    static uInt8 getPhosphor(uInt8 v1, uInt8 v2, uInt8 blend_ratio);
+    static uInt32 makeRGB(uInt8 r, uInt8 g, uInt8 b);
     
   private:
     OSystem * m_osystem;
 
-    uInt8 m_rgb_ntsc[64][64][64];
-
-    uInt32 m_avg_palette[256][256];
+    std::shared_ptr<const Tables> m_tables;
     uInt8 m_phosphor_blend_ratio;
 };
 
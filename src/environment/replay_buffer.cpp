@@ -0,0 +1,270 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  replay_buffer.cpp
+ *
+ *  A circular replay buffer storing each frame once.
+ *
+ **************************************************************************** */
+
+#include "replay_buffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+ReplayBuffer::ReplayBuffer(size_t capacity, size_t height, size_t width, int stack,
+                           bool deduplicate, unsigned int seed):
+  m_capacity(capacity),
+  m_height(height),
+  m_width(width),
+  m_frame_size(height * width),
+  m_stack(stack),
+  m_deduplicate(deduplicate),
+  m_slots(capacity),
+  m_size(0),
+  m_next(0),
+  m_leaves(1),
+  m_transitions(0),
+  m_max_priority(1.0),
+  m_rng(seed) {
+
+  if (stack < 1 || capacity <= (size_t)stack)
+    throw std::invalid_argument("A replay buffer must hold more steps than a stack of frames");
+
+  while (m_leaves < capacity)
+    m_leaves *= 2;
+  m_tree.assign(2 * m_leaves, 0.0);
+}
+
+uInt32 ReplayBuffer::acquireFrame(const ALEScreen &screen) {
+  if (screen.height() != m_height || screen.width() != m_width)
+    throw std::runtime_error("Screen size doesn't match the replay buffer");
+
+  fingerprint_t fingerprint = 0;
+  if (m_deduplicate) {
+    fingerprint = screen.fingerprint();
+    std::unordered_map<fingerprint_t, uInt32>::iterator it = m_frame_ids.find(fingerprint);
+    if (it != m_frame_ids.end() &&
+        memcmp(frame(it->second), screen.getArray(), m_frame_size) == 0) {
+      m_frame_refs[it->second]++;
+      return it->second;
+    }
+  }
+
+  uInt32 id;
+  if (!m_free_frames.empty()) {
+    id = m_free_frames.back();
+    m_free_frames.pop_back();
+  } else {
+    id = m_frame_refs.size();
+    m_frame_refs.push_back(0);
+    m_frame_fingerprints.push_back(0);
+    if (id % FramesPerBlock == 0) {
+      m_blocks.push_back(
+          std::unique_ptr<pixel_t[]>(new pixel_t[FramesPerBlock * m_frame_size]));
+    }
+  }
+  memcpy(frame(id), screen.getArray(), m_frame_size);
+  m_frame_refs[id] = 1;
+
+  // On a collision the newer frame takes over the fingerprint
+  if (m_deduplicate) {
+    m_frame_fingerprints[id] = fingerprint;
+    m_frame_ids[fingerprint] = id;
+  }
+  return id;
+}
+
+void ReplayBuffer::releaseFrame(uInt32 id) {
+  if (--m_frame_refs[id] > 0)
+    return;
+
+  if (m_deduplicate) {
+    std::unordered_map<fingerprint_t, uInt32>::iterator it =
+        m_frame_ids.find(m_frame_fingerprints[id]);
+    if (it != m_frame_ids.end() && it->second == id)
+      m_frame_ids.erase(it);
+  }
+  m_free_frames.push_back(id);
+}
+
+void ReplayBuffer::push(const Slot &slot, const ALEScreen &screen) {
+  size_t i = m_next;
+  uInt32 id = acquireFrame(screen);
+  if (m_size == m_capacity)
+    releaseFrame(m_slots[i].frame);
+  else
+    m_size++;
+
+  m_slots[i] = slot;
+  m_slots[i].frame = id;
+  m_next = (i + 1) % m_capacity;
+
+  // The oldest transitions' stacks reached back into the evicted step
+  if (m_size == m_capacity) {
+    for (int k = 1; k <= m_stack; k++)
+      setPriority((i + k) % m_capacity, 0.0);
+  }
+  setPriority(i, slot.first ? 0.0 : m_max_priority);
+}
+
+void ReplayBuffer::startEpisode(const ALEScreen &screen) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  size_t last = (m_next + m_capacity - 1) % m_capacity;
+  if (m_size > 0 && m_slots[last].first) {
+    uInt32 id = acquireFrame(screen);
+    releaseFrame(m_slots[last].frame);
+    m_slots[last].frame = id;
+    return;
+  }
+
+  Slot slot = { 0, 0, 0, false, true };
+  push(slot, screen);
+}
+
+void ReplayBuffer::addStep(Action action, reward_t reward, bool terminal,
+                           const ALEScreen &screen) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  // Without a screen to start from, the step only starts an episode
+  Slot slot = { 0, reward, (uInt8)action, terminal, m_size == 0 };
+  push(slot, screen);
+}
+
+void ReplayBuffer::copyStack(size_t slot, pixel_t *out) const {
+  // From the newest frame back, with zeros before the start of the episode
+  bool started = false;
+  for (int k = m_stack - 1; k >= 0; k--) {
+    pixel_t *dst = out + k * m_frame_size;
+    if (started) {
+      memset(dst, 0, m_frame_size);
+      continue;
+    }
+    memcpy(dst, frame(m_slots[slot].frame), m_frame_size);
+    if (m_slots[slot].first)
+      started = true;
+    else
+      slot = (slot + m_capacity - 1) % m_capacity;
+  }
+}
+
+bool ReplayBuffer::sample(size_t n, const Batch &batch, int threads) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_transitions == 0 || n == 0)
+    return m_transitions > 0;
+
+  // One draw in each of n equal slices of the total priority
+  std::vector<size_t> indices(n);
+  double total = m_tree[1], segment = total / n;
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  for (size_t i = 0; i < n; i++) {
+    size_t slot = findPriority(std::min((i + uniform(m_rng)) * segment, total));
+    // Rounding may land on an empty leaf next to the mass drawn; draw again from anywhere
+    while (m_tree[m_leaves + slot] <= 0.0)
+      slot = findPriority(uniform(m_rng) * total);
+    indices[i] = slot;
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    size_t slot = indices[i];
+    batch.actions[i] = m_slots[slot].action;
+    if (batch.rewards != NULL)
+      batch.rewards[i] = m_slots[slot].reward;
+    if (batch.terminals != NULL)
+      batch.terminals[i] = m_slots[slot].terminal;
+    if (batch.indices != NULL)
+      batch.indices[i] = slot;
+    if (batch.probabilities != NULL)
+      batch.probabilities[i] = m_tree[m_leaves + slot] / total;
+  }
+
+  // Copying the frames is the bulk of the work
+  size_t stackSize = m_stack * m_frame_size;
+  auto copyRows = [&](size_t first, size_t step) {
+    for (size_t i = first; i < n; i += step) {
+      copyStack((indices[i] + m_capacity - 1) % m_capacity,
+                batch.observations + i * stackSize);
+      if (batch.next_observations != NULL)
+        copyStack(indices[i], batch.next_observations + i * stackSize);
+    }
+  };
+
+  threads = std::max(1, std::min<int>(threads, n));
+  std::vector<std::thread> workers;
+  for (int t = 1; t < threads; t++)
+    workers.push_back(std::thread(copyRows, t, threads));
+  copyRows(0, threads);
+  for (size_t t = 0; t < workers.size(); t++)
+    workers[t].join();
+  return true;
+}
+
+void ReplayBuffer::updatePriorities(const size_t *indices, const double *priorities,
+                                    size_t n) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (size_t i = 0; i < n; i++) {
+    if (indices[i] >= m_capacity || !(priorities[i] > 0.0))
+      continue;
+    // Slots which can't be sampled any more stay so
+    if (m_tree[m_leaves + indices[i]] <= 0.0)
+      continue;
+    setPriority(indices[i], priorities[i]);
+    m_max_priority = std::max(m_max_priority, priorities[i]);
+  }
+}
+
+void ReplayBuffer::setPriority(size_t slot, double priority) {
+  size_t node = m_leaves + slot;
+  if (m_tree[node] <= 0.0 && priority > 0.0)
+    m_transitions++;
+  else if (m_tree[node] > 0.0 && priority <= 0.0)
+    m_transitions--;
+
+  // Sums are recomputed rather than adjusted, so that rounding errors don't accumulate
+  m_tree[node] = priority;
+  for (node /= 2; node >= 1; node /= 2)
+    m_tree[node] = m_tree[2 * node] + m_tree[2 * node + 1];
+}
+
+size_t ReplayBuffer::findPriority(double mass) const {
+  size_t node = 1;
+  while (node < m_leaves) {
+    if (mass < m_tree[2 * node]) {
+      node = 2 * node;
+    } else {
+      mass -= m_tree[2 * node];
+      node = 2 * node + 1;
+    }
+  }
+  return node - m_leaves;
+}
+
+size_t ReplayBuffer::size() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_size;
+}
+
+size_t ReplayBuffer::transitions() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_transitions;
+}
+
+size_t ReplayBuffer::numFrames() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_frame_refs.size() - m_free_frames.size();
+}
+
+size_t ReplayBuffer::frameBytes() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_blocks.size() * FramesPerBlock * m_frame_size;
+}
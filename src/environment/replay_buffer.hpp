@@ -0,0 +1,137 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  replay_buffer.hpp
+ *
+ *  A circular replay buffer for agents learning from stacks of frames, fed by
+ *  the environment as it plays. Each frame is stored once, as palette indices
+ *  (and, when deduplicating, once per distinct screen); the stacked
+ *  observations of a transition are put together when it is sampled. Sampling
+ *  is proportional to priorities, as in prioritized experience replay.
+ *
+ **************************************************************************** */
+
+#ifndef __REPLAY_BUFFER_HPP__
+#define __REPLAY_BUFFER_HPP__
+
+#include "ale_screen.hpp"
+#include "../common/Constants.h"
+
+#include <memory>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+class ReplayBuffer {
+  public:
+    /** Where sample() writes a minibatch of n transitions. Observations are
+      *  [n][stack][height][width] palette indices, oldest frame first, with zeros for the
+      *  frames before the start of the episode. Any pointer but observations and actions may
+      *  be NULL. */
+    struct Batch {
+      pixel_t *observations;      // The stacks the actions were taken from
+      int *actions;
+      reward_t *rewards;
+      pixel_t *next_observations; // The stacks the actions led to
+      uInt8 *terminals;           // Whether the action ended the episode
+      size_t *indices;            // To update the priorities of the transitions
+      double *probabilities;      // With which they were drawn, for importance weights
+    };
+
+    /** Creates a buffer of the last capacity steps, of screens of the given size observed in
+      *  stacks of stack frames. If deduplicate is true, identical screens (by fingerprint) are
+      *  stored once. Throws std::invalid_argument unless capacity exceeds stack. */
+    ReplayBuffer(size_t capacity, size_t height, size_t width, int stack = 4,
+                 bool deduplicate = false, unsigned int seed = 0);
+
+    /** Starts an episode from the given screen. Starting another before any step replaces
+      *  it. */
+    void startEpisode(const ALEScreen &screen);
+
+    /** Adds the step from the last screen added, which led to the given one; evicts the
+      *  oldest step once full. New transitions get the largest priority given so far. */
+    void addStep(Action action, reward_t reward, bool terminal, const ALEScreen &screen);
+
+    /** Draws n transitions with probability proportional to their priority, stratified, and
+      *  writes them to batch, sharing the copies between the given number of threads.
+      *  Returns false, writing nothing, if there is no transition to draw. */
+    bool sample(size_t n, const Batch &batch, int threads = 1);
+
+    /** Sets the priorities of sampled transitions; these must be positive, and should
+      *  already be raised to the prioritization exponent. Transitions evicted since they were
+      *  sampled are ignored, unless their slot holds a new one. */
+    void updatePriorities(const size_t *indices, const double *priorities, size_t n);
+
+    /** Number of steps stored, and of transitions which can be sampled: starts of episodes
+      *  and the oldest steps, whose stacks would reach past the evicted ones, can't. */
+    size_t size() const;
+    size_t transitions() const;
+    size_t capacity() const { return m_capacity; }
+
+    /** Number of distinct frames stored, and bytes allocated to frames. */
+    size_t numFrames() const;
+    size_t frameBytes() const;
+
+    size_t height() const { return m_height; }
+    size_t width() const { return m_width; }
+    int stack() const { return m_stack; }
+
+  private:
+    /** A step, from the previous slot's frame to this slot's, or the start of an episode. */
+    struct Slot {
+      uInt32 frame;
+      reward_t reward;
+      uInt8 action;
+      bool terminal;
+      bool first;    // Starts an episode, so that it's no transition
+    };
+
+    /** Stores the frame, returning its id, or the id of an identical one. */
+    uInt32 acquireFrame(const ALEScreen &screen);
+    void releaseFrame(uInt32 id);
+    pixel_t *frame(uInt32 id) const {
+      return m_blocks[id / FramesPerBlock].get() + (id % FramesPerBlock) * m_frame_size;
+    }
+
+    /** Appends a slot, evicting the oldest one when full. */
+    void push(const Slot &slot, const ALEScreen &screen);
+
+    /** Copies the stack of frames ending with the given slot's. */
+    void copyStack(size_t slot, pixel_t *out) const;
+
+    /** Sum tree of the priorities, indexed by slot. */
+    void setPriority(size_t slot, double priority);
+    size_t findPriority(double mass) const;
+
+    static const size_t FramesPerBlock = 256;
+
+    size_t m_capacity, m_height, m_width, m_frame_size;
+    int m_stack;
+    bool m_deduplicate;
+
+    std::vector<Slot> m_slots;
+    size_t m_size, m_next;
+
+    std::vector<std::unique_ptr<pixel_t[]> > m_blocks;
+    std::vector<uInt32> m_frame_refs;        // References to each frame
+    std::vector<fingerprint_t> m_frame_fingerprints; // When deduplicating
+    std::vector<uInt32> m_free_frames;
+    std::unordered_map<fingerprint_t, uInt32> m_frame_ids; // When deduplicating
+
+    std::vector<double> m_tree;              // m_leaves leaves, the root at 1
+    size_t m_leaves, m_transitions;
+    double m_max_priority;
+    std::mt19937_64 m_rng;
+
+    mutable std::mutex m_mutex;              // Guards everything above
+};
+
+#endif // __REPLAY_BUFFER_HPP__
@@ -0,0 +1,133 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  replica_pool.cpp
+ *
+ *  Copies of an environment on which planning work runs in parallel.
+ *
+ **************************************************************************** */
+
+#include "replica_pool.hpp"
+#include "../ale_interface.hpp"
+
+#include <algorithm>
+
+ReplicaPool::ReplicaPool(OSystem* osystem, int size):
+  m_osystem(osystem),
+  m_job(NULL),
+  m_num_jobs(0),
+  m_next_job(0),
+  m_busy_workers(0),
+  m_batch(0),
+  m_stop(false) {
+
+  if (size <= 0)
+    size = std::max(1u, std::thread::hardware_concurrency());
+
+  // Replicas are configured like the original, but have no display and do not record; they
+  //  would all write to the same files. Nor do they cache transitions: rollouts skip the
+  //  observations a cached transition would have to restore
+  const std::string& rom_file = osystem->romFile();
+  for (int i = 0; i < size; i++) {
+    std::unique_ptr<Replica> replica(new Replica());
+    ALEInterface::createOSystem(replica->osystem, replica->settings);
+    osystem->settings().copyTo(*replica->settings);
+    replica->settings->setBool("display_screen", false);
+    replica->settings->setString("record_screen_dir", "");
+    replica->settings->setString("record_video_file", "");
+    replica->settings->setString("record_trajectory_file", "");
+    replica->settings->setString("record_dataset_dir", "");
+    replica->settings->setString("record_sound_filename", "");
+    replica->settings->setInt("transition_cache_mb", 0);
+    ALEInterface::loadSettings(rom_file, replica->osystem);
+
+    replica->rom_settings.reset(buildRomRLWrapper(rom_file,
+        replica->osystem->console().properties().get(Cartridge_MD5)));
+    replica->environment.reset(new StellaEnvironment(replica->osystem.get(),
+                                                     replica->rom_settings.get()));
+    m_replicas.push_back(std::move(replica));
+  }
+
+  for (int i = 0; i < size; i++)
+    m_workers.push_back(std::thread(&ReplicaPool::workerLoop, this, i));
+}
+
+ReplicaPool::~ReplicaPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_work_cv.notify_all();
+  for (size_t i = 0; i < m_workers.size(); i++)
+    m_workers[i].join();
+}
+
+void ReplicaPool::run(size_t n, const Job& job) {
+  if (n == 0)
+    return;
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_job = &job;
+  m_seeds.resize(n);
+  for (size_t i = 0; i < n; i++)
+    m_seeds[i] = m_osystem->rng().next();
+  m_num_jobs = n;
+  m_next_job = 0;
+  m_busy_workers = m_workers.size();
+  m_batch++;
+  m_work_cv.notify_all();
+
+  m_done_cv.wait(lock, [this] { return m_busy_workers == 0; });
+  m_job = NULL;
+
+  if (m_error) {
+    std::exception_ptr error;
+    std::swap(error, m_error);
+    std::rethrow_exception(error);
+  }
+}
+
+void ReplicaPool::workerLoop(int index) {
+  StellaEnvironment& environment = *m_replicas[index]->environment;
+  Random& rng = m_replicas[index]->osystem->rng();
+  unsigned batch = 0;
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true) {
+    m_work_cv.wait(lock, [&] { return m_stop || m_batch != batch; });
+    if (m_stop)
+      return;
+    batch = m_batch;
+
+    // Jobs are handed out one at a time, so that long rollouts balance out
+    while (m_next_job < m_num_jobs) {
+      size_t job = m_next_job++;
+      rng.seed(m_seeds[job]);
+      lock.unlock();
+      std::exception_ptr error;
+      try {
+        (*m_job)(job, environment);
+      }
+      catch (...) {
+        error = std::current_exception();
+      }
+      lock.lock();
+
+      // The first failure is rethrown by run(); the jobs not yet started are dropped
+      if (error && !m_error) {
+        m_error = error;
+        m_next_job = m_num_jobs;
+      }
+    }
+
+    if (--m_busy_workers == 0)
+      m_done_cv.notify_all();
+  }
+}
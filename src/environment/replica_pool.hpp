@@ -0,0 +1,79 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  replica_pool.hpp
+ *
+ *  Copies of an environment, each with its own emulator and thread, on which
+ *  planning work from one state (rollouts, node expansions) runs in parallel.
+ *
+ **************************************************************************** */
+
+#ifndef __REPLICA_POOL_HPP__
+#define __REPLICA_POOL_HPP__
+
+#include "stella_environment.hpp"
+#include "../emucore/OSystem.hxx"
+#include "../emucore/Settings.hxx"
+#include "../games/RomSettings.hpp"
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ReplicaPool {
+  public:
+    /** Runs job i on the given environment. */
+    typedef std::function<void(size_t, StellaEnvironment&)> Job;
+
+    /** Creates size environments (0: one per processor) configured like the given one, which
+      *  must have a ROM loaded, but without display, recording or transition cache. */
+    ReplicaPool(OSystem* osystem, int size);
+    ~ReplicaPool();
+
+    int size() const { return m_replicas.size(); }
+
+    /** Runs jobs 0 to n - 1, spread over the environments, and returns once all are done.
+      *  Jobs start from whatever state the previous job on their environment left, but with
+      *  its RNG seeded from the original's, one draw per job, so that randomness such as
+      *  sticky actions doesn't depend on which environment runs which job. If a job throws,
+      *  the remaining jobs are dropped and the exception is rethrown here. */
+    void run(size_t n, const Job& job);
+
+  private:
+    struct Replica {
+      std::unique_ptr<OSystem> osystem;
+      std::unique_ptr<Settings> settings;
+      std::unique_ptr<RomSettings> rom_settings;
+      std::unique_ptr<StellaEnvironment> environment;
+    };
+
+    void workerLoop(int index);
+
+    OSystem* m_osystem;
+    std::vector<std::unique_ptr<Replica> > m_replicas;
+    std::vector<std::thread> m_workers;
+
+    // The current batch, guarded by m_mutex
+    std::mutex m_mutex;
+    std::condition_variable m_work_cv, m_done_cv;
+    const Job* m_job;
+    std::exception_ptr m_error; // The first exception thrown by a job of the batch
+    std::vector<uInt32> m_seeds;
+    size_t m_num_jobs, m_next_job;
+    int m_busy_workers;
+    unsigned m_batch; // Incremented for every batch, so that workers notice new work
+    bool m_stop;
+};
+
+#endif // __REPLICA_POOL_HPP__
@@ -0,0 +1,175 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  state_archive.cpp
+ *
+ *  A single file holding many states of one ROM.
+ *
+ **************************************************************************** */
+
+#include "state_archive.hpp"
+#include "../common/Log.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const char Magic[] = "ALESTARC";
+static const char Trailer[] = "ALESTEND";
+static const size_t MagicSize = 8;
+static const size_t MD5Size = 32;
+static const size_t HeaderSize = 56;
+static const size_t FooterSize = 24;
+
+static void putLE(std::string &out, unsigned long long v, int bytes) {
+  for (int i = 0; i < bytes; i++)
+    out.push_back((char)((v >> (8 * i)) & 0xFF));
+}
+
+static unsigned long long getLE(const char *p, int bytes) {
+  unsigned long long v = 0;
+  for (int i = 0; i < bytes; i++)
+    v |= (unsigned long long)(unsigned char)p[i] << (8 * i);
+  return v;
+}
+
+StateArchiveWriter::StateArchiveWriter(const std::string &filename, const StateCodec &codec):
+  m_codec(codec),
+  m_failed(false),
+  m_offset(0) {
+
+  m_out = fopen(filename.c_str(), "wb");
+  if (m_out == NULL) return;
+
+  const std::string &reference = m_codec.getReference();
+  std::string header(Magic, MagicSize);
+  putLE(header, StateCodec::Version, 2);
+  putLE(header, 0, 2);
+  putLE(header, reference.size(), 4);
+  putLE(header, m_codec.getLayoutHash(), 8);
+  header.append(m_codec.getROMMD5());
+  write(header);
+  write(reference);
+}
+
+StateArchiveWriter::~StateArchiveWriter() {
+  if (m_out != NULL && !close())
+    ale::Logger::Error << "Error writing state archive" << std::endl;
+}
+
+void StateArchiveWriter::write(const std::string &data) {
+  if (m_failed)
+    return;
+  if (fwrite(data.data(), 1, data.size(), m_out) != data.size())
+    m_failed = true;
+  m_offset += data.size();
+}
+
+size_t StateArchiveWriter::add(const ALEState &state) {
+  if (m_out == NULL)
+    throw std::runtime_error("State archive is not open");
+
+  std::string serialized = state.serialize();
+  if (StateCodec::layoutHash(serialized.size()) != m_codec.getLayoutHash())
+    throw std::runtime_error("State has another layout than the archive");
+
+  m_buffer.clear();
+  m_codec.encodeBody(serialized, m_buffer);
+  m_offsets.push_back(m_offset);
+  write(m_buffer);
+  if (m_failed)
+    throw std::runtime_error("Error writing state archive");
+
+  return m_offsets.size() - 1;
+}
+
+bool StateArchiveWriter::close() {
+  if (m_out == NULL) return !m_failed;
+
+  unsigned long long index_offset = m_offset;
+  std::string index;
+  for (size_t i = 0; i < m_offsets.size(); i++)
+    putLE(index, m_offsets[i], 8);
+  putLE(index, m_offset, 8);
+  putLE(index, index_offset, 8);
+  putLE(index, m_offsets.size(), 8);
+  index.append(Trailer, MagicSize);
+  write(index);
+
+  if (fclose(m_out) != 0)
+    m_failed = true;
+  m_out = NULL;
+  return !m_failed;
+}
+
+StateArchive::StateArchive(const std::string &filename):
+  m_data(NULL),
+  m_size(0) {
+
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("Couldn't open state archive " + filename);
+
+  struct stat st;
+  if (fstat(fd, &st) == 0 && (size_t)st.st_size >= HeaderSize + FooterSize) {
+    m_size = st.st_size;
+    void *region = mmap(NULL, m_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (region != MAP_FAILED) m_data = (const char *)region;
+  }
+  ::close(fd);
+
+  if (m_data == NULL)
+    throw std::runtime_error("Couldn't map state archive " + filename);
+
+  try {
+    const char *footer = m_data + m_size - FooterSize;
+    if (memcmp(m_data, Magic, MagicSize) != 0)
+      throw std::runtime_error("Not a state archive: " + filename);
+    if (getLE(m_data + 8, 2) > (unsigned)StateCodec::Version)
+      throw std::runtime_error("State archive from a newer version: " + filename);
+    if (memcmp(footer + 16, Trailer, MagicSize) != 0)
+      throw std::runtime_error("Unfinished state archive: " + filename);
+
+    size_t reference_size = getLE(m_data + 12, 4);
+    unsigned long long index_offset = getLE(footer, 8);
+    m_count = getLE(footer + 8, 8);
+    if (HeaderSize + reference_size > index_offset ||
+        index_offset + (m_count + 1) * 8 != m_size - FooterSize)
+      throw std::runtime_error("Corrupt state archive: " + filename);
+    m_index = m_data + index_offset;
+
+    m_codec.reset(new StateCodec(std::string(m_data + HeaderSize, reference_size)));
+    if (m_codec->getLayoutHash() != getLE(m_data + 16, 8) ||
+        m_codec->getROMMD5().compare(0, MD5Size, m_data + 24, MD5Size) != 0)
+      throw std::runtime_error("State archive from another emulator version: " + filename);
+  } catch (...) {
+    munmap((void *)m_data, m_size);
+    throw;
+  }
+}
+
+StateArchive::~StateArchive() {
+  munmap((void *)m_data, m_size);
+}
+
+ALEState StateArchive::get(size_t i) const {
+  if (i >= m_count)
+    throw std::out_of_range("No such state in the archive");
+
+  unsigned long long begin = getLE(m_index + 8 * i, 8);
+  unsigned long long end = getLE(m_index + 8 * (i + 1), 8);
+  if (begin > end || end > (unsigned long long)(m_index - m_data))
+    throw std::runtime_error("Corrupt state archive");
+
+  return ALEState(m_codec->decodeBody(m_data + begin, end - begin));
+}
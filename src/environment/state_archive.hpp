@@ -0,0 +1,105 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  state_archive.hpp
+ *
+ *  A single file holding many states of one ROM, e.g. a library of start
+ *  states, encoded by a StateCodec. The file is memory-mapped when read: the
+ *  index gives any state's body in constant time, and only the states asked
+ *  for are decompressed. All integers are little-endian:
+ *
+ *    "ALESTARC"              magic
+ *    uInt16 version          StateCodec::Version
+ *    uInt16 flags            reserved, 0
+ *    uInt32 reference size
+ *    uInt64 layout           as StateCodec::getLayoutHash()
+ *    char   md5[32]          MD5 of the ROM, in hexadecimal
+ *    reference               the serialized reference state
+ *    bodies                  one StateCodec body per state
+ *    uInt64 offsets[n + 1]   start of every body, then the end of the last
+ *    uInt64 index offset     start of the offsets
+ *    uInt64 n                number of states
+ *    "ALESTEND"              trailer, absent if the writer did not finish
+ *
+ **************************************************************************** */
+
+#ifndef __STATE_ARCHIVE_HPP__
+#define __STATE_ARCHIVE_HPP__
+
+#include "state_codec.hpp"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+class StateArchiveWriter {
+  public:
+    /** Creates the archive, overwriting any existing file, with the codec's reference.
+      *  Check isOpen() for failure. */
+    StateArchiveWriter(const std::string &filename, const StateCodec &codec);
+
+    /** Finishes the archive, logging an error if it couldn't be written. */
+    ~StateArchiveWriter();
+
+    /** Whether the output could be opened. */
+    bool isOpen() const { return m_out != NULL; }
+
+    /** Appends a state, which must be of the codec's ROM, and returns its index. Throws
+      *  std::runtime_error if the state doesn't match or the archive can't be written. */
+    size_t add(const ALEState &state);
+
+    /** Writes the index, after which no state may be added. Returns false if any write
+      *  failed, leaving the archive incomplete. */
+    bool close();
+
+    /** Number of states added so far. */
+    size_t size() const { return m_offsets.size(); }
+
+  private:
+    void write(const std::string &data);
+
+    StateCodec m_codec;
+    FILE *m_out;
+    bool m_failed;                               // Whether a write failed
+    unsigned long long m_offset;                 // Bytes written so far
+    std::vector<unsigned long long> m_offsets;   // Start of every body
+    std::string m_buffer;
+};
+
+class StateArchive {
+  public:
+    /** Maps the given archive. Throws std::runtime_error if it can't be read, or was
+      *  written by another version of the emulator or not finished. */
+    explicit StateArchive(const std::string &filename);
+
+    ~StateArchive();
+
+    /** Number of states in the archive. */
+    size_t size() const { return m_count; }
+
+    /** Decodes the i-th state. Throws std::out_of_range if there is none. */
+    ALEState get(size_t i) const;
+
+    /** The codec the archive was written with. */
+    const StateCodec &codec() const { return *m_codec; }
+
+  private:
+    StateArchive(const StateArchive &);
+    StateArchive &operator=(const StateArchive &);
+
+    const char *m_data;
+    size_t m_size;
+    const char *m_index;
+    size_t m_count;
+    std::unique_ptr<StateCodec> m_codec;
+};
+
+#endif // __STATE_ARCHIVE_HPP__
@@ -0,0 +1,133 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  state_codec.cpp
+ *
+ *  A compact, versioned encoding of saved states.
+ *
+ **************************************************************************** */
+
+#include "state_codec.hpp"
+#include "../common/Version.hxx"
+
+#include <cstring>
+#include <stdexcept>
+#include <zlib.h>
+
+static const char Magic[] = "ALESTATE";
+static const size_t MagicSize = 8;
+static const size_t MD5Size = 32;
+static const unsigned DeltaFlag = 1;
+
+static void putLE(std::string &out, unsigned long long v, int bytes) {
+  for (int i = 0; i < bytes; i++)
+    out.push_back((char)((v >> (8 * i)) & 0xFF));
+}
+
+static unsigned long long getLE(const char *p, int bytes) {
+  unsigned long long v = 0;
+  for (int i = 0; i < bytes; i++)
+    v |= (unsigned long long)(unsigned char)p[i] << (8 * i);
+  return v;
+}
+
+StateCodec::StateCodec(const ALEState &reference, int level):
+  StateCodec(reference.serialize(), level) {
+}
+
+StateCodec::StateCodec(const std::string &serialized_reference, int level):
+  m_reference(serialized_reference),
+  m_level(level) {
+
+  ALEState reference(serialized_reference);
+  m_md5 = reference.getROMMD5();
+  if (m_md5.size() != MD5Size)
+    throw std::runtime_error("The reference state holds no emulator information");
+
+  m_layout = layoutHash(m_reference.size());
+  m_reference_fingerprint = fingerprintBytes(m_reference.data(), m_reference.size());
+}
+
+fingerprint_t StateCodec::layoutHash(size_t serialized_size) {
+  std::string layout = std::string("ALE " STELLA_VERSION " ") + std::to_string(serialized_size);
+  return fingerprintBytes(layout.data(), layout.size());
+}
+
+void StateCodec::encodeBody(const std::string &serialized, std::string &out) const {
+  // XOR with the reference leaves zeros wherever the two states agree
+  std::string delta(serialized);
+  size_t common = std::min(delta.size(), m_reference.size());
+  for (size_t i = 0; i < common; i++)
+    delta[i] ^= m_reference[i];
+
+  uLongf compressed_size = compressBound(delta.size());
+  size_t start = out.size();
+  out.resize(start + 4 + compressed_size);
+  if (compress2((Bytef *)&out[start + 4], &compressed_size, (const Bytef *)delta.data(),
+                delta.size(), m_level) != Z_OK)
+    throw std::runtime_error("Couldn't compress state");
+
+  out.resize(start + 4 + compressed_size);
+  for (int i = 0; i < 4; i++)
+    out[start + i] = (char)((delta.size() >> (8 * i)) & 0xFF);
+}
+
+std::string StateCodec::decodeBody(const char *data, size_t size) const {
+  if (size < 4)
+    throw std::runtime_error("Corrupt encoded state");
+
+  std::string serialized(getLE(data, 4), '\0');
+  uLongf serialized_size = serialized.size();
+  if (uncompress((Bytef *)&serialized[0], &serialized_size, (const Bytef *)data + 4,
+                 size - 4) != Z_OK || serialized_size != serialized.size())
+    throw std::runtime_error("Corrupt encoded state");
+
+  size_t common = std::min(serialized.size(), m_reference.size());
+  for (size_t i = 0; i < common; i++)
+    serialized[i] ^= m_reference[i];
+  return serialized;
+}
+
+std::string StateCodec::encode(const ALEState &state) const {
+  std::string serialized = state.serialize();
+
+  std::string out(Magic, MagicSize);
+  putLE(out, Version, 2);
+  putLE(out, DeltaFlag, 2);
+  out.append(m_md5);
+  putLE(out, m_layout, 8);
+  putLE(out, m_reference_fingerprint, 8);
+  encodeBody(serialized, out);
+  return out;
+}
+
+ALEState StateCodec::decode(const std::string &data) const {
+  const char *p = data.data();
+  if (data.size() < HeaderSize || memcmp(p, Magic, MagicSize) != 0)
+    throw std::runtime_error("Not an encoded state");
+  if (getLE(p + 8, 2) > (unsigned)Version)
+    throw std::runtime_error("Encoded state from a newer version");
+  if (data.compare(12, MD5Size, m_md5) != 0)
+    throw std::runtime_error("Encoded state of another ROM");
+  if (getLE(p + 44, 8) != m_layout)
+    throw std::runtime_error("Encoded state with another layout");
+
+  bool delta = (getLE(p + 10, 2) & DeltaFlag) != 0;
+  if (delta && getLE(p + 52, 8) != m_reference_fingerprint)
+    throw std::runtime_error("Encoded state against another reference");
+
+  if (delta)
+    return ALEState(decodeBody(p + HeaderSize, data.size() - HeaderSize));
+
+  // Without the delta flag, the body holds the state itself
+  StateCodec identity(*this);
+  identity.m_reference.clear();
+  return ALEState(identity.decodeBody(p + HeaderSize, data.size() - HeaderSize));
+}
@@ -0,0 +1,88 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  state_codec.hpp
+ *
+ *  A compact, versioned encoding of saved states. States of one ROM share
+ *  most of their serialization (device names, the ROM MD5, untouched RAM), so
+ *  each state is XORed with a reference state of the same ROM and the result,
+ *  mostly zeros, is zlib-compressed.
+ *
+ *  A standalone encoded state is, with all integers little-endian:
+ *
+ *    "ALESTATE"            magic
+ *    uInt16 version        StateCodec::Version
+ *    uInt16 flags          bit 0: the body is a delta against the reference
+ *    char   md5[32]        MD5 of the ROM, in hexadecimal
+ *    uInt64 layout         fingerprint of the serialization layout (see layoutHash())
+ *    uInt64 reference      fingerprint of the reference state, or 0
+ *    body                  uInt32 size of the serialized state, then its zlib
+ *                          compression (after XOR with the reference)
+ *
+ *  StateArchive stores bodies only, with the header fields once per file.
+ *
+ **************************************************************************** */
+
+#ifndef __STATE_CODEC_HPP__
+#define __STATE_CODEC_HPP__
+
+#include "ale_state.hpp"
+#include "../common/Fingerprint.hpp"
+
+#include <string>
+
+class StateCodec {
+  public:
+    /** The version of the encoding written; older versions are read. */
+    static const int Version = 1;
+
+    /** Size in bytes of the standalone header. */
+    static const size_t HeaderSize = 60;
+
+    /** Encodes states of the reference's ROM as deltas against it. The reference must hold
+      *  emulator information, e.g. come from cloneState(); the start state of an episode is
+      *  a good choice. level is the zlib compression level, -1 being zlib's default. */
+    explicit StateCodec(const ALEState &reference, int level = -1);
+
+    /** Likewise, from the serialization of the reference (ALEState::serialize()). */
+    explicit StateCodec(const std::string &serialized_reference, int level = -1);
+
+    /** Returns the header and body encoding the state, which must be of the same ROM. */
+    std::string encode(const ALEState &state) const;
+
+    /** Decodes a state produced by encode(). Throws std::runtime_error if the data is not an
+      *  encoded state or was encoded for another ROM, layout or reference. */
+    ALEState decode(const std::string &data) const;
+
+    /** Appends the body encoding a serialized state to out. */
+    void encodeBody(const std::string &serialized, std::string &out) const;
+
+    /** Returns the serialized state encoded by a body. Throws std::runtime_error if the body
+      *  is corrupt. */
+    std::string decodeBody(const char *data, size_t size) const;
+
+    const std::string &getROMMD5() const { return m_md5; }
+    fingerprint_t getLayoutHash() const { return m_layout; }
+    const std::string &getReference() const { return m_reference; }
+
+    /** Identifies how states are serialized: by this version of the emulator, for a ROM whose
+      *  states serialize to the given number of bytes. States are only exchanged between
+      *  codecs with the same layout. */
+    static fingerprint_t layoutHash(size_t serialized_size);
+
+  private:
+    std::string m_reference;         // Serialized reference state
+    std::string m_md5;               // Its ROM
+    fingerprint_t m_layout;
+    fingerprint_t m_reference_fingerprint;
+    int m_level;
+};
+
+#endif // __STATE_CODEC_HPP__
@@ -17,14 +17,25 @@
 
 #include "stella_environment.hpp"
 #include "../emucore/m6502/src/System.hxx"
+#include "../emucore/Serializer.hxx"
+#include "../emucore/Deserializer.hxx"
 #include <sstream>
 
+// Restores the game settings recorded in a checkpoint
+static void restoreRomSettings(void* settings, const uInt8* data, uInt32 size) {
+  Deserializer des(std::string((const char*)data, size));
+  static_cast<RomSettings*>(settings)->loadState(des);
+}
+
 StellaEnvironment::StellaEnvironment(OSystem* osystem, RomSettings* settings):
   m_osystem(osystem),
   m_settings(settings),
   m_phosphor_blend(osystem),  
-  m_screen(m_osystem->console().mediaSource().height(),
-        m_osystem->console().mediaSource().width()),
+  m_screen(0, 0),
+  m_screen_pending(false),
+  m_skip_observations(false),
+  m_replay_restart(false),
+  m_audio(dynamic_cast<SoundHeadless*>(&osystem->sound())),
   m_player_a_action(PLAYER_A_NOOP),
   m_player_b_action(PLAYER_B_NOOP) {
 
@@ -42,6 +53,19 @@ StellaEnvironment::StellaEnvironment(OSystem* osystem, RomSettings* settings):
   m_max_num_frames_per_episode = m_osystem->settings().getInt("max_num_frames_per_episode");
   m_colour_averaging = m_osystem->settings().getBool("color_averaging");
 
+  // Compact environments keep a single TIA frame buffer and only allocate the ALE screen
+  //  once it is asked for
+  m_compact = m_osystem->settings().getBool("compact_environment");
+  if (m_compact && m_colour_averaging) {
+    ale::Logger::Warning << "Warning: color_averaging is not supported by compact environments. "
+                         << "Disabling it." << std::endl;
+    m_colour_averaging = false;
+  }
+  if (!m_compact) {
+    m_screen = ALEScreen(m_osystem->console().mediaSource().height(),
+        m_osystem->console().mediaSource().width());
+  }
+
   m_repeat_action_probability = m_osystem->settings().getFloat("repeat_action_probability");
   
   m_frame_skip = m_osystem->settings().getInt("frame_skip");
@@ -53,15 +77,96 @@ StellaEnvironment::StellaEnvironment(OSystem* osystem, RomSettings* settings):
   // If so desired, we record all emulated frames to a given directory 
   std::string recordDir = m_osystem->settings().getString("record_screen_dir");
   if (!recordDir.empty()) {
+    int queue = m_osystem->settings().getInt("record_screen_queue");
+    if (queue < 1) {
+      ale::Logger::Error << "Invalid record_screen_queue: " << queue << std::endl;
+      exit(1);
+    }
     ale::Logger::Info << "Recording screens to directory: " << recordDir << std::endl;
     
-    // Create the screen exporter
-    m_screen_exporter.reset(new ScreenExporter(m_osystem->colourPalette(), recordDir)); 
+    // Create the screen exporter; frames are encoded in the background unless
+    //  record_screen_threads is 0
+    m_screen_exporter.reset(new ScreenExporter(m_osystem->colourPalette(), recordDir,
+        m_osystem->settings().getInt("record_screen_threads"), queue));
+    m_screen_exporter->setIndexed(m_osystem->settings().getBool("record_screen_indexed"));
+    m_screen_exporter->setCompressionLevel(
+        m_osystem->settings().getInt("record_screen_compression"));
+  }
+
+  // Likewise, we may stream all emulated frames into a single video file
+  std::string videoFile = m_osystem->settings().getString("record_video_file");
+  if (!videoFile.empty()) {
+    VideoExporter::Format format;
+    std::string formatName = m_osystem->settings().getString("record_video_format");
+    if (!VideoExporter::parseFormat(formatName, format)) {
+      ale::Logger::Error << "Invalid record_video_format: " << formatName << std::endl;
+      exit(1);
+    }
+    ale::Logger::Info << "Recording video to: " << videoFile << std::endl;
+
+    m_video_exporter.reset(new VideoExporter(m_osystem->colourPalette(), videoFile, format,
+        m_osystem->settings().getBool("record_video_compress"),
+        m_osystem->settings().getBool("record_video_index"),
+        m_osystem->settings().getInt("screen_keyframe_interval")));
+  }
+
+  // Or log the actions taken, from which the run can be replayed
+  std::string trajectoryFile = m_osystem->settings().getString("record_trajectory_file");
+  if (!trajectoryFile.empty()) {
+    ale::Logger::Info << "Recording trajectory to: " << trajectoryFile << std::endl;
+    m_trajectory_recorder.reset(new TrajectoryRecorder(trajectoryFile, m_osystem,
+        cloneSystemState(), m_osystem->settings().getInt("trajectory_snapshot_interval")));
+    if (m_trajectory_recorder->isOpen()) {
+      recordJump();
+    } else {
+      ale::Logger::Error << "Couldn't create trajectory file: " << trajectoryFile << std::endl;
+      m_trajectory_recorder.reset();
+    }
+  }
+
+  // And write an offline RL dataset of the steps taken
+  std::string datasetDir = m_osystem->settings().getString("record_dataset_dir");
+  if (!datasetDir.empty()) {
+    ale::Logger::Info << "Recording dataset to directory: " << datasetDir << std::endl;
+    m_dataset_writer.reset(new DatasetWriter(datasetDir, m_cartridge_md5,
+        m_osystem->settings().getInt("dataset_chunk_size"),
+        m_osystem->settings().getInt("dataset_shard_size"),
+        m_osystem->settings().getInt("dataset_compression")));
+  }
+
+  int cacheSize = m_osystem->settings().getInt("transition_cache_mb");
+  if (cacheSize > 0 &&
+      !setTransitionCache(std::make_shared<TransitionCache>((size_t)cacheSize << 20))) {
+    ale::Logger::Warning << "Warning: transition_cache_mb requires repeat_action_probability 0, "
+                         << "no color averaging, sound observations or recording. "
+                         << "Disabling it." << std::endl;
+  }
+}
+
+StellaEnvironment::~StellaEnvironment() {
+  // The system outlives us; stop it recording into our journal
+  releaseCheckpoints();
+}
+
+bool StellaEnvironment::setTransitionCache(std::shared_ptr<TransitionCache> cache) {
+  // A cached step skips emulation, so it must not depend on the RNG, on the previous frame
+  //  or have side effects
+  if (cache && (m_repeat_action_probability != 0 || m_colour_averaging || m_audio != NULL ||
+      m_screen_exporter.get() != NULL || m_video_exporter.get() != NULL ||
+      m_trajectory_recorder.get() != NULL ||
+      !m_osystem->settings().getString("record_sound_filename").empty())) {
+    return false;
   }
+
+  m_transition_cache = cache;
+  return true;
 }
 
 /** Resets the system to its start state. */
 void StellaEnvironment::reset() {
+  releaseCheckpoints();
+  if (m_trajectory_recorder.get() != NULL)
+    m_trajectory_recorder->addReset();
   m_state.resetEpisodeFrameNumber();
   // Reset the paddles
   m_state.resetPaddles(m_osystem->event());
@@ -89,6 +194,29 @@ void StellaEnvironment::reset() {
   for (size_t i = 0; i < startingActions.size(); i++){
     emulate(startingActions[i], PLAYER_B_NOOP);
   }
+
+  if (m_dataset_writer.get() != NULL)
+    m_dataset_writer->truncate(false);
+  if (m_replay_buffer) {
+    m_replay_buffer->startEpisode(getScreen());
+    m_replay_restart = false;
+  }
+}
+
+void StellaEnvironment::restart(const ALEState& start, const ALEScreen& screen) {
+  // Logged as a jump by restoreState()
+  restoreState(start);
+  m_screen = screen;
+  m_screen_pending = false;
+  processRAM();
+
+  // Unlike after other jumps, the screen shown is the state's
+  if (m_dataset_writer.get() != NULL)
+    m_dataset_writer->truncate(false);
+  if (m_replay_buffer) {
+    m_replay_buffer->startEpisode(getScreen());
+    m_replay_restart = false;
+  }
 }
 
 /** Save/restore the environment state. */
@@ -112,7 +240,9 @@ ALEState StellaEnvironment::cloneState() {
 }
 
 void StellaEnvironment::restoreState(const ALEState& target_state) {
+  releaseCheckpoints();
   m_state.load(m_osystem, m_settings, m_cartridge_md5, target_state, false);
+  restored();
 }
 
 ALEState StellaEnvironment::cloneSystemState() {
@@ -120,7 +250,38 @@ ALEState StellaEnvironment::cloneSystemState() {
 }
 
 void StellaEnvironment::restoreSystemState(const ALEState& target_state) {
+  releaseCheckpoints();
   m_state.load(m_osystem, m_settings, m_cartridge_md5, target_state, true);
+  restored();
+}
+
+Journal::Checkpoint StellaEnvironment::checkpoint() {
+  System& system = m_osystem->console().system();
+
+  Journal::Checkpoint checkpoint = m_journal.begin();
+  system.checkpoint(m_journal);
+  m_state.checkpoint(m_journal);
+  Serializer ser;
+  m_settings->saveState(ser);
+  m_journal.saveObject(m_settings, ser.get_str(), &restoreRomSettings);
+  m_journal.end();
+
+  system.setJournal(&m_journal);
+  return checkpoint;
+}
+
+bool StellaEnvironment::rollback(const Journal::Checkpoint& checkpoint) {
+  if (!m_journal.rollback(checkpoint))
+    return false;
+  restored();
+  return true;
+}
+
+void StellaEnvironment::releaseCheckpoints() {
+  if (!m_journal.active())
+    return;
+  m_journal.clear();
+  m_osystem->console().system().setJournal(NULL);
 }
 
 void StellaEnvironment::noopIllegalActions(Action & player_a_action, Action & player_b_action) {
@@ -141,6 +302,61 @@ void StellaEnvironment::noopIllegalActions(Action & player_a_action, Action & pl
 }
 
 reward_t StellaEnvironment::act(Action player_a_action, Action player_b_action) {
+  if (m_dataset_writer.get() != NULL)
+    m_dataset_writer->observe(getScreen());
+  reward_t reward = cachedAct(player_a_action, player_b_action);
+  if (m_trajectory_recorder.get() != NULL)
+    recordStep(player_a_action, player_b_action, reward);
+  if (m_dataset_writer.get() != NULL)
+    m_dataset_writer->addStep(player_a_action, reward, isTerminal(), lives());
+  if (m_replay_buffer) {
+    // The screen shown before a restored state's first step isn't that state's
+    if (m_replay_restart)
+      m_replay_buffer->startEpisode(getScreen());
+    else
+      m_replay_buffer->addStep(player_a_action, reward, isTerminal(), getScreen());
+    m_replay_restart = false;
+  }
+  return reward;
+}
+
+reward_t StellaEnvironment::cachedAct(Action player_a_action, Action player_b_action) {
+  // Cached transitions store the screen, which rollouts do not process, and are restored
+  //  without journaling
+  if (!m_transition_cache || m_skip_observations || m_journal.active())
+    return emulateAct(player_a_action, player_b_action);
+
+  ALEState source = cloneState();
+  fingerprint_t fingerprint = source.fingerprint();
+
+  TransitionCache::Transition transition;
+  if (m_transition_cache->lookup(fingerprint, player_a_action, player_b_action,
+                                 m_frame_skip, transition)) {
+    // This is the step act() was asked for, not a jump to report to the recorders
+    m_state.load(m_osystem, m_settings, m_cartridge_md5, *transition.state, false);
+    m_screen = *transition.screen;
+    m_screen_pending = false;
+    processRAM();
+    m_player_a_action = player_a_action;
+    m_player_b_action = player_b_action;
+    // Draw what emulateAct() would have, so that later users of the RNG (e.g. the RIOT
+    //  timer at reset) don't depend on cache hits
+    Random& rng = m_osystem->rng();
+    for (size_t i = 0; i < 2 * m_frame_skip; i++)
+      rng.nextDouble();
+    return transition.reward;
+  }
+
+  transition.reward = emulateAct(player_a_action, player_b_action);
+  transition.terminal = isTerminal();
+  transition.state = std::make_shared<ALEState>(cloneState());
+  transition.screen = std::make_shared<ALEScreen>(getScreen());
+  m_transition_cache->insert(fingerprint, player_a_action, player_b_action, m_frame_skip,
+                             transition);
+  return transition.reward;
+}
+
+reward_t StellaEnvironment::emulateAct(Action player_a_action, Action player_b_action) {
   
   // Total reward received as we repeat the action
   reward_t sum_rewards = 0;
@@ -164,7 +380,9 @@ reward_t StellaEnvironment::act(Action player_a_action, Action player_b_action)
 
     // Similarly record screen as needed
     if (m_screen_exporter.get() != NULL)
-        m_screen_exporter->saveNext(m_screen);
+        m_screen_exporter->saveNext(getScreen());
+    if (m_video_exporter.get() != NULL)
+        m_video_exporter->addFrame(getScreen());
 
     // Use the stored actions, which may or may not have changed this frame
     sum_rewards += oneStepAct(m_player_a_action, m_player_b_action);
@@ -173,6 +391,91 @@ reward_t StellaEnvironment::act(Action player_a_action, Action player_b_action)
   return sum_rewards;
 }
 
+void StellaEnvironment::recordStep(Action player_a_action, Action player_b_action,
+                                   reward_t reward) {
+  // Rollouts leave the RAM unprocessed
+  if (m_skip_observations)
+    processRAM();
+  m_trajectory_recorder->addStep(player_a_action, player_b_action, reward, m_ram);
+
+  if (m_trajectory_recorder->snapshotDue()) {
+    m_trajectory_recorder->addSnapshot(cloneSystemState(), m_player_a_action,
+                                       m_player_b_action, false);
+  }
+}
+
+void StellaEnvironment::recordJump() {
+  if (m_trajectory_recorder.get() != NULL) {
+    m_trajectory_recorder->addSnapshot(cloneSystemState(), m_player_a_action,
+                                       m_player_b_action, true);
+  }
+}
+
+void StellaEnvironment::restored() {
+  recordJump();
+  if (m_dataset_writer.get() != NULL)
+    m_dataset_writer->truncate(true);
+  m_replay_restart = true;
+}
+
+void StellaEnvironment::setReplayBuffer(std::shared_ptr<ReplayBuffer> buffer) {
+  m_replay_buffer = buffer;
+  if (m_replay_buffer) {
+    m_replay_buffer->startEpisode(getScreen());
+    m_replay_restart = false;
+  }
+}
+
+void StellaEnvironment::setLastActions(Action player_a_action, Action player_b_action) {
+  m_player_a_action = player_a_action;
+  m_player_b_action = player_b_action;
+}
+
+void StellaEnvironment::rollout(const ALEState& root, const Action* actions, size_t n,
+                                RolloutResult& result, bool save_final_state) {
+  result.total_reward = 0;
+  result.rewards.clear();
+  result.lives.clear();
+  result.final_state.reset();
+
+  // States don't hold the last actions; sticky actions must not repeat those of whatever
+  //  ran here before, or results would depend on scheduling. Reset them first, so that the
+  //  jump recorded by restoreState() holds them
+  m_player_a_action = PLAYER_A_NOOP;
+  m_player_b_action = PLAYER_B_NOOP;
+  restoreState(root);
+
+  // Planning isn't experience; the buffer and dataset start over from wherever the
+  //  rollout ends
+  std::shared_ptr<ReplayBuffer> buffer;
+  buffer.swap(m_replay_buffer);
+  std::unique_ptr<DatasetWriter> dataset;
+  dataset.swap(m_dataset_writer);
+
+  // Recorders need every screen; otherwise only the last one is processed
+  m_skip_observations = m_screen_exporter.get() == NULL && m_video_exporter.get() == NULL;
+  for (size_t i = 0; i < n && !isTerminal(); i++) {
+    reward_t reward = act(actions[i], PLAYER_B_NOOP);
+    result.total_reward += reward;
+    result.rewards.push_back(reward);
+    result.lives.push_back(lives());
+  }
+  if (m_skip_observations) {
+    m_skip_observations = false;
+    processScreen();
+    processRAM();
+  }
+
+  m_replay_buffer.swap(buffer);
+  m_dataset_writer.swap(dataset);
+  if (m_dataset_writer.get() != NULL)
+    m_dataset_writer->truncate(false);
+
+  result.terminal = isTerminal();
+  if (save_final_state)
+    result.final_state = std::make_shared<ALEState>(cloneState());
+}
+
 /** This functions emulates a push on the reset button of the console */
 void StellaEnvironment::softReset() {
   emulate(RESET, PLAYER_B_NOOP, m_num_reset_steps);
@@ -208,6 +511,7 @@ void StellaEnvironment::pressSelect(size_t num_steps) {
   m_state.pressSelect(m_osystem->event());
   for (size_t t = 0; t < num_steps; t++) {
     m_osystem->console().mediaSource().update();
+    processAudio();
   }
   processScreen();
   processRAM();
@@ -217,10 +521,12 @@ void StellaEnvironment::pressSelect(size_t num_steps) {
 
 void StellaEnvironment::setDifficulty(difficulty_t value) {
   m_state.setDifficulty(value);
+  recordJump();
 }
 
 void StellaEnvironment::setMode(game_mode_t value) {
   m_state.setCurrentMode(value);
+  recordJump();
 }
 
 void StellaEnvironment::emulate(Action player_a_action, Action player_b_action, size_t num_steps) {
@@ -234,6 +540,7 @@ void StellaEnvironment::emulate(Action player_a_action, Action player_b_action,
       m_state.applyActionPaddles(event, player_a_action, player_b_action);
 
       m_osystem->console().mediaSource().update();
+      processAudio();
       m_settings->step(m_osystem->console().system());
     }
   }
@@ -243,13 +550,16 @@ void StellaEnvironment::emulate(Action player_a_action, Action player_b_action,
 
     for (size_t t = 0; t < num_steps; t++) {
       m_osystem->console().mediaSource().update();
+      processAudio();
       m_settings->step(m_osystem->console().system());
     }
   }
 
   // Parse screen and RAM into their respective data structures
-  processScreen();
-  processRAM();
+  if (!m_skip_observations) {
+    processScreen();
+    processRAM();
+  }
 }
 
 /** Accessor methods for the environment state. */
@@ -265,11 +575,28 @@ std::unique_ptr<StellaEnvironmentWrapper> StellaEnvironment::getWrapper() {
     return std::unique_ptr<StellaEnvironmentWrapper>(new StellaEnvironmentWrapper(*this));
 }
 
+const ALEScreen &StellaEnvironment::getScreen() const {
+  if (m_screen_pending) {
+    MediaSource &media = m_osystem->console().mediaSource();
+    if (m_screen.height() == 0)
+      m_screen = ALEScreen(media.height(), media.width());
+
+    memcpy(m_screen.getArray(), media.currentFrameBuffer(), m_screen.arraySize());
+    m_screen_pending = false;
+  }
+
+  return m_screen;
+}
+
 void StellaEnvironment::processScreen() {
   if (m_colour_averaging) {
     // Perform phosphor averaging; the blender stores its result in the given screen
     m_phosphor_blend.process(m_screen);
   }
+  else if (m_compact) {
+    // The frame buffer stays untouched until we emulate again, so copy it on demand
+    m_screen_pending = true;
+  }
   else {
     // Copy screen over and we're done! 
     memcpy(m_screen.getArray(), 
@@ -283,3 +610,8 @@ void StellaEnvironment::processRAM() {
     *m_ram.byte(i) = m_osystem->console().system().peek(i + 0x80); 
 }
 
+void StellaEnvironment::processAudio() {
+  if (m_audio != NULL)
+    m_audio->processFrame(m_osystem->console().system().cycles());
+}
+
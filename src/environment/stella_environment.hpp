@@ -22,6 +22,8 @@
 #include "ale_screen.hpp"
 #include "ale_state.hpp"
 #include "phosphor_blend.hpp"
+#include "transition_cache.hpp"
+#include "replay_buffer.hpp"
 #include "stella_environment_wrapper.hpp"
 #include "../emucore/Event.hxx"
 #include "../emucore/OSystem.hxx"
@@ -29,17 +31,37 @@
 #include "../common/Constants.h"
 #include "../common/Log.hpp"
 #include "../common/ScreenExporter.hpp"
+#include "../common/VideoExporter.hpp"
+#include "../common/Dataset.hpp"
+#include "trajectory.hpp"
+#include "../common/SoundHeadless.hxx"
 
 #include <stack>
 #include <memory>
 
+/** The outcome of StellaEnvironment::rollout(). */
+struct RolloutResult {
+  reward_t total_reward;                 // Sum of the rewards
+  std::vector<reward_t> rewards;         // Reward of each step taken
+  std::vector<int> lives;                // Lives left after each step
+  bool terminal;                         // Whether the rollout ended in a terminal state
+  std::shared_ptr<ALEState> final_state; // The state reached, if it was asked for
+
+  RolloutResult(): total_reward(0), terminal(false) {}
+};
+
 class StellaEnvironment {
   public:
     StellaEnvironment(OSystem * system, RomSettings * settings);
+    ~StellaEnvironment();
 
     /** Resets the system to its start state. */
     void reset();
 
+    /** Restores a state saved right after reset(), showing the screen it showed, as a
+      *  cheaper reset(). Like restoreState(), it leaves pseudorandomness alone. */
+    void restart(const ALEState& start, const ALEScreen& screen);
+
     /** Save/restore the environment state onto the stack. */
     void save();
     void load();
@@ -56,6 +78,18 @@ class StellaEnvironment {
     /** Restores a previously saved copy of the state, including RNG state information. */
     void restoreSystemState(const ALEState&);
 
+    /** Takes a checkpoint of the state, which rollback() returns to. From then on, the emulator
+      *  journals the RAM it writes, so that rolling back costs time proportional to the writes
+      *  since the checkpoint. Checkpoints nest; like cloneState(), they exclude
+      *  pseudorandomness. */
+    Journal::Checkpoint checkpoint();
+    /** Restores the state of the checkpoint, as restoreState() would, and discards the
+      *  checkpoints taken after it. Returns false, leaving the state untouched, if the checkpoint
+      *  was discarded: by rolling back past it, or by reset() or restoreState(). */
+    bool rollback(const Journal::Checkpoint& checkpoint);
+    /** Discards every checkpoint, ending journaling. */
+    void releaseCheckpoints();
+
     /** Applies the given actions (e.g. updating paddle positions when the paddle is used)
       *  and performs one simulation step in Stella. Returns the resultant reward. When 
       *  frame skip is set to > 1, up the corresponding number of simulation steps are performed.
@@ -64,6 +98,18 @@ class StellaEnvironment {
       */
     reward_t act(Action player_a_action, Action player_b_action);
 
+    /** Sets the actions which sticky actions (repeat_action_probability) repeat, i.e. those of
+      *  the last act(); used to resume a replay from a recorded state. */
+    void setLastActions(Action player_a_action, Action player_b_action);
+
+    /** Restores root, then applies each of the n actions in turn for player A, stopping early
+      *  at a terminal state; result.rewards is then shorter than the action sequence. Sticky
+      *  actions start from no-ops. Screen
+      *  and RAM are only processed after the last step. If save_final_state is true,
+      *  result.final_state is a clone of the state reached. */
+    void rollout(const ALEState& root, const Action* actions, size_t n, RolloutResult& result,
+                 bool save_final_state = false);
+
     /** This functions emulates a push on the reset button of the console */
     void softReset();
 
@@ -85,21 +131,47 @@ class StellaEnvironment {
     /** Returns true once we reach a terminal state */
     bool isTerminal() const;
 
+    /** Returns the number of lives left, as reported by the game's settings */
+    int lives() { return m_settings->lives(); }
+
     /** Accessor methods for the environment state. */
     void setState(const ALEState & state);
     const ALEState &getState() const;
 
     /** Returns the current screen after processing (e.g. colour averaging) */
-    const ALEScreen &getScreen() const { return m_screen; }
+    const ALEScreen &getScreen() const;
     const ALERAM &getRAM() const { return m_ram; }
 
+    /** Returns the synthesized sound of the last frame_skip frames, or NULL unless
+      *  sound_obs is set. */
+    const SoundHeadless *getAudio() const { return m_audio; }
+
     int getFrameNumber() const { return m_state.getFrameNumber(); }
     int getEpisodeFrameNumber() const { return m_state.getEpisodeFrameNumber(); }
 
     /** Returns a wrapper providing #include-free access to our methods. */ 
     std::unique_ptr<StellaEnvironmentWrapper> getWrapper();
 
+    /** Memoizes act() in the given cache, which other environments running the same ROM
+      *  with the same settings may share; NULL disables memoization. This is only possible
+      *  when the environment is deterministic and nothing records its frames; returns false
+      *  otherwise. */
+    bool setTransitionCache(std::shared_ptr<TransitionCache> cache);
+    std::shared_ptr<TransitionCache> getTransitionCache() const { return m_transition_cache; }
+
+    /** Adds every step taken by act() to the given replay buffer, which must hold screens of
+      *  our size, starting an episode from the current screen; NULL stops. Episodes restart
+      *  after reset() and after the state is restored, and rollouts are left out. */
+    void setReplayBuffer(std::shared_ptr<ReplayBuffer> buffer);
+    std::shared_ptr<ReplayBuffer> getReplayBuffer() const { return m_replay_buffer; }
+
   private:
+    /** act() through the transition cache, if any. */
+    reward_t cachedAct(Action player_a_action, Action player_b_action);
+
+    /** act() without the transition cache. */
+    reward_t emulateAct(Action player_a_action, Action player_b_action);
+
     /** This applies an action exactly one time step. Helper function to act(). */
     reward_t oneStepAct(Action player_a_action, Action player_b_action);
 
@@ -110,10 +182,23 @@ class StellaEnvironment {
       *   from the minimal set of actions. */
     void noopIllegalActions(Action& player_a_action, Action& player_b_action);
 
+    /** Logs a step, and a snapshot when one is due, to the trajectory recorder. */
+    void recordStep(Action player_a_action, Action player_b_action, reward_t reward);
+
+    /** Embeds the current state in the recorded trajectory, if any, after it was changed
+      *  by other means than act() and reset(). */
+    void recordJump();
+
+    /** Tells the recorders that the state was restored, so that the screen shown is no
+      *  longer the state's. */
+    void restored();
+
     /** Processes the current emulator screen and saves it in m_screen */
     void processScreen();
     /** Processes the emulator RAM and saves it in m_ram */
     void processRAM();
+    /** Synthesizes the sound of the frame just emulated, if sound_obs is set */
+    void processAudio();
 
   private:
     OSystem *m_osystem;
@@ -124,18 +209,29 @@ class StellaEnvironment {
     std::stack<ALEState> m_saved_states; // States are saved on a stack
     
     ALEState m_state; // Current environment state    
-    ALEScreen m_screen; // The current ALE screen (possibly colour-averaged)
+    mutable ALEScreen m_screen; // The current ALE screen (possibly colour-averaged)
+    mutable bool m_screen_pending; // Whether m_screen lags behind the emulator (compact only)
     ALERAM m_ram; // The current ALE RAM
 
     bool m_use_paddles;  // Whether this game uses paddles
+    bool m_skip_observations; // Whether emulate() leaves screen and RAM unprocessed (rollouts)
+    bool m_replay_restart; // Whether the screen no longer follows the buffer's last step
     
     /** Parameters loaded from Settings. */
     int m_num_reset_steps; // Number of RESET frames per reset
     bool m_colour_averaging; // Whether to average frames
+    bool m_compact; // Whether to allocate screen buffers only when requested
     int m_max_num_frames_per_episode; // Maxmimum number of frames per episode 
     size_t m_frame_skip; // How many frames to emulate per act()
     float m_repeat_action_probability; // Stochasticity of the environment
     std::unique_ptr<ScreenExporter> m_screen_exporter; // Automatic screen recorder
+    std::unique_ptr<VideoExporter> m_video_exporter; // Automatic video recorder
+    std::unique_ptr<TrajectoryRecorder> m_trajectory_recorder; // Automatic action log
+    std::unique_ptr<DatasetWriter> m_dataset_writer; // Automatic offline RL dataset
+    SoundHeadless *m_audio; // The OSystem's sound, if it is synthesized for observations
+    std::shared_ptr<TransitionCache> m_transition_cache; // Memoized act() results, if any
+    std::shared_ptr<ReplayBuffer> m_replay_buffer; // Where act() adds steps, if anywhere
+    Journal m_journal; // Undo log of the live checkpoints
 
     // The last actions taken by our players
     Action m_player_a_action, m_player_b_action;
@@ -0,0 +1,391 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  trajectory.cpp
+ *
+ *  Action logs from which a run of the emulator can be replayed exactly.
+ *
+ **************************************************************************** */
+
+#include "trajectory.hpp"
+#include "stella_environment.hpp"
+#include "../ale_interface.hpp"
+#include "../emucore/FSNode.hxx"
+#include "../emucore/Serializer.hxx"
+#include "../emucore/Deserializer.hxx"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+static const char Magic[] = "ALETRJ01";
+static const size_t MagicSize = 8;
+
+static void putLE(std::string &out, unsigned long long v, int bytes) {
+  for (int i = 0; i < bytes; i++)
+    out.push_back((char)((v >> (8 * i)) & 0xFF));
+}
+
+static void putBytes(std::string &out, const std::string &data) {
+  putLE(out, data.size(), 4);
+  out.append(data);
+}
+
+// The emulator exits on other actions, so that a corrupt log mustn't reach it
+static bool validActions(Action player_a_action, Action player_b_action) {
+  return (player_a_action < PLAYER_A_MAX || player_a_action == RESET) &&
+         ((player_b_action >= PLAYER_B_NOOP && player_b_action < PLAYER_B_NOOP + PLAYER_A_MAX) ||
+          player_b_action == RESET);
+}
+
+namespace {
+
+// Reads the fields of a trajectory, noticing when the data runs out
+class FieldReader {
+  public:
+    explicit FieldReader(const std::string &data): m_data(data), m_pos(0) {}
+
+    bool has(size_t n) const { return m_data.size() - m_pos >= n; }
+
+    unsigned long long get(int bytes) {
+      unsigned long long v = 0;
+      for (int i = 0; i < bytes; i++)
+        v |= (unsigned long long)(unsigned char)m_data[m_pos + i] << (8 * i);
+      m_pos += bytes;
+      return v;
+    }
+
+    bool getBytes(std::string &out) {
+      if (!has(4)) return false;
+      size_t size = get(4);
+      if (!has(size)) return false;
+      out.assign(m_data, m_pos, size);
+      m_pos += size;
+      return true;
+    }
+
+  private:
+    const std::string &m_data;
+    size_t m_pos;
+};
+
+}
+
+TrajectoryRecorder::TrajectoryRecorder(const std::string &filename, OSystem *osystem,
+                                       const ALEState &initial, int snapshot_interval):
+  m_filename(filename),
+  m_codec(initial),
+  m_snapshot_interval(snapshot_interval),
+  m_steps(0),
+  m_steps_since_snapshot(0) {
+
+  m_out = fopen(filename.c_str(), "wb");
+  if (m_out == NULL) return;
+
+  Serializer settings;
+  osystem->settings().saveState(settings);
+
+  std::string header(Magic, MagicSize);
+  putLE(header, snapshot_interval, 4);
+  putLE(header, osystem->settings().getInt("random_seed"), 4);
+  putBytes(header, osystem->romFile());
+  header.append(m_codec.getROMMD5());
+  putBytes(header, settings.get_str());
+  putBytes(header, m_codec.getReference());
+  write(header);
+}
+
+TrajectoryRecorder::~TrajectoryRecorder() {
+  if (m_out != NULL && fclose(m_out) != 0)
+    ale::Logger::Error << "Error writing trajectory " << m_filename << std::endl;
+}
+
+void TrajectoryRecorder::write(const std::string &data) {
+  if (m_out == NULL)
+    return;
+  if (fwrite(data.data(), 1, data.size(), m_out) != data.size()) {
+    ale::Logger::Error << "Error writing trajectory " << m_filename << "; recording stopped"
+                       << std::endl;
+    fclose(m_out);
+    m_out = NULL;
+  }
+}
+
+void TrajectoryRecorder::addStep(Action player_a_action, Action player_b_action,
+                                 reward_t reward, const ALERAM &ram) {
+  m_buffer.assign(1, 'S');
+  putLE(m_buffer, player_a_action, 1);
+  putLE(m_buffer, player_b_action, 1);
+  putLE(m_buffer, (uInt32)reward, 4);
+  putLE(m_buffer, (uInt32)ram.fingerprint(), 4);
+  write(m_buffer);
+
+  m_steps++;
+  m_steps_since_snapshot++;
+}
+
+void TrajectoryRecorder::addReset() {
+  write(std::string(1, 'R'));
+}
+
+void TrajectoryRecorder::addSnapshot(const ALEState &state, Action player_a_action,
+                                     Action player_b_action, bool jump) {
+  std::string body;
+  m_codec.encodeBody(state.serialize(), body);
+
+  m_buffer.assign(1, jump ? 'J' : 'K');
+  putLE(m_buffer, player_a_action, 1);
+  putLE(m_buffer, player_b_action, 1);
+  putBytes(m_buffer, body);
+  write(m_buffer);
+
+  m_steps_since_snapshot = 0;
+}
+
+Trajectory::Trajectory(const std::string &filename) {
+  std::ifstream in(filename.c_str(), std::ios::binary);
+  if (!in)
+    throw std::runtime_error("Couldn't open trajectory " + filename);
+  std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+  FieldReader reader(data);
+  if (!reader.has(MagicSize) || data.compare(0, MagicSize, Magic) != 0)
+    throw std::runtime_error("Not a trajectory: " + filename);
+  reader.get(MagicSize);
+
+  if (!reader.has(8))
+    throw std::runtime_error("Truncated trajectory: " + filename);
+  reader.get(4); // The snapshot interval only matters to the recorder
+  m_seed = reader.get(4);
+
+  std::string reference;
+  if (!reader.getBytes(m_rom_file) || !reader.has(32))
+    throw std::runtime_error("Truncated trajectory: " + filename);
+  for (int i = 0; i < 32; i++)
+    m_md5.push_back((char)reader.get(1));
+  if (!reader.getBytes(m_settings) || !reader.getBytes(reference))
+    throw std::runtime_error("Truncated trajectory: " + filename);
+
+  m_codec.reset(new StateCodec(reference));
+  if (m_codec->getROMMD5() != m_md5)
+    throw std::runtime_error("Corrupt trajectory: " + filename);
+
+  // A record cut short ends the trajectory
+  while (reader.has(1)) {
+    char type = (char)reader.get(1);
+    Event event;
+    if (type == 'S') {
+      if (!reader.has(10)) break;
+      TrajectoryStep step;
+      step.player_a_action = (Action)reader.get(1);
+      step.player_b_action = (Action)reader.get(1);
+      step.reward = (int)(uInt32)reader.get(4);
+      step.ram_hash = reader.get(4);
+      if (!validActions(step.player_a_action, step.player_b_action))
+        throw std::runtime_error("Corrupt trajectory: " + filename);
+      event.type = Event::STEP;
+      event.index = m_steps.size();
+      m_step_events.push_back(m_events.size());
+      m_steps.push_back(step);
+    } else if (type == 'R') {
+      event.type = Event::RESET;
+      event.index = 0;
+    } else if (type == 'K' || type == 'J') {
+      if (!reader.has(2)) break;
+      Snapshot snapshot;
+      snapshot.player_a_action = (Action)reader.get(1);
+      snapshot.player_b_action = (Action)reader.get(1);
+      snapshot.jump = type == 'J';
+      if (!validActions(snapshot.player_a_action, snapshot.player_b_action))
+        throw std::runtime_error("Corrupt trajectory: " + filename);
+      if (!reader.getBytes(snapshot.body)) break;
+      event.type = Event::SNAPSHOT;
+      event.index = m_snapshots.size();
+      m_snapshots.push_back(snapshot);
+    } else {
+      throw std::runtime_error("Corrupt trajectory: " + filename);
+    }
+    m_events.push_back(event);
+  }
+
+  // Replays start from the first record
+  if (m_snapshots.empty() || m_events[0].type != Event::SNAPSHOT || !m_snapshots[0].jump)
+    throw std::runtime_error("Trajectory without a start state: " + filename);
+}
+
+void Trajectory::applySettings(Settings &settings) const {
+  Deserializer des(m_settings);
+  settings.loadState(des);
+
+  settings.setBool("display_screen", false);
+  settings.setString("record_screen_dir", "");
+  settings.setString("record_video_file", "");
+  settings.setString("record_sound_filename", "");
+  settings.setString("record_trajectory_file", "");
+  settings.setString("record_dataset_dir", "");
+}
+
+ALEState Trajectory::decodeSnapshot(const Snapshot &snapshot) const {
+  return ALEState(m_codec->decodeBody(snapshot.body.data(), snapshot.body.size()));
+}
+
+TrajectoryPlayer::TrajectoryPlayer(StellaEnvironment &environment,
+                                   const Trajectory &trajectory):
+  m_environment(environment),
+  m_trajectory(trajectory),
+  m_event(0),
+  m_position(0) {
+}
+
+void TrajectoryPlayer::seek(size_t step) {
+  if (step > m_trajectory.size())
+    throw std::out_of_range("No such step in the trajectory");
+
+  const std::vector<Trajectory::Event> &events = m_trajectory.events();
+  size_t target = step < m_trajectory.size() ? m_trajectory.eventOfStep(step) : events.size();
+
+  // Restored states lack the screen, so start before the last step to replay; the first
+  //  record is always a snapshot
+  size_t limit = step > 0 ? m_trajectory.eventOfStep(step - 1) : target;
+  size_t start = limit - 1;
+  while (events[start].type != Trajectory::Event::SNAPSHOT)
+    start--;
+
+  const Trajectory::Snapshot &snapshot = m_trajectory.snapshots()[events[start].index];
+  m_environment.restoreSystemState(m_trajectory.decodeSnapshot(snapshot));
+  m_environment.setLastActions(snapshot.player_a_action, snapshot.player_b_action);
+
+  for (m_event = start + 1; m_event < target; m_event++) {
+    const Trajectory::Event &event = events[m_event];
+    if (event.type == Trajectory::Event::STEP) {
+      const TrajectoryStep &s = m_trajectory.steps()[event.index];
+      m_environment.act(s.player_a_action, s.player_b_action);
+    } else {
+      apply(event, false);
+    }
+  }
+  m_position = step;
+}
+
+bool TrajectoryPlayer::step() {
+  if (done())
+    throw std::out_of_range("The trajectory is over");
+
+  const std::vector<Trajectory::Event> &events = m_trajectory.events();
+  bool matched = true;
+  for (size_t target = m_trajectory.eventOfStep(m_position); m_event < target; m_event++)
+    matched = apply(events[m_event], true) && matched;
+
+  const TrajectoryStep &s = m_trajectory.steps()[m_position];
+  reward_t reward = m_environment.act(s.player_a_action, s.player_b_action);
+  matched = matched && reward == s.reward &&
+            (uInt32)m_environment.getRAM().fingerprint() == s.ram_hash;
+  m_event++;
+  m_position++;
+
+  // Periodic snapshots follow the step they were taken after
+  while (m_event < events.size() && events[m_event].type == Trajectory::Event::SNAPSHOT &&
+         !m_trajectory.snapshots()[events[m_event].index].jump)
+    matched = apply(events[m_event++], true) && matched;
+
+  return matched;
+}
+
+bool TrajectoryPlayer::apply(const Trajectory::Event &event, bool verify) {
+  if (event.type == Trajectory::Event::RESET) {
+    m_environment.reset();
+    return true;
+  }
+
+  const Trajectory::Snapshot &snapshot = m_trajectory.snapshots()[event.index];
+  if (snapshot.jump) {
+    m_environment.restoreSystemState(m_trajectory.decodeSnapshot(snapshot));
+    m_environment.setLastActions(snapshot.player_a_action, snapshot.player_b_action);
+    return true;
+  }
+  return !verify ||
+         m_environment.cloneSystemState().serialize() ==
+         m_trajectory.decodeSnapshot(snapshot).serialize();
+}
+
+// Replays one trajectory on a fresh environment
+static void verifyTrajectory(const std::string &filename, const std::string &rom_file,
+                             TrajectoryCheck &result) {
+  // Building consoles touches shared state (e.g. the cartridges' random generator)
+  static std::mutex construction_mutex;
+
+  try {
+    Trajectory trajectory(filename);
+    std::string rom = rom_file.empty() ? trajectory.getROMFile() : rom_file;
+    if (!FilesystemNode::fileExists(rom)) {
+      result.error = "ROM file " + rom + " not found";
+      return;
+    }
+
+    std::unique_ptr<OSystem> osystem;
+    std::unique_ptr<Settings> settings;
+    std::unique_ptr<RomSettings> rom_settings;
+    std::unique_ptr<StellaEnvironment> environment;
+    {
+      std::lock_guard<std::mutex> lock(construction_mutex);
+      ALEInterface::createOSystem(osystem, settings);
+      trajectory.applySettings(*settings);
+      ALEInterface::loadSettings(rom, osystem);
+      if (osystem->console().properties().get(Cartridge_MD5) != trajectory.getROMMD5()) {
+        result.error = "ROM file " + rom + " differs from the one recorded";
+        return;
+      }
+      rom_settings.reset(buildRomRLWrapper(rom, trajectory.getROMMD5()));
+      environment.reset(new StellaEnvironment(osystem.get(), rom_settings.get()));
+    }
+
+    TrajectoryPlayer player(*environment, trajectory);
+    result.deterministic = true;
+    while (!player.done()) {
+      if (!player.step()) {
+        result.deterministic = false;
+        result.divergence = player.position() - 1;
+        break;
+      }
+    }
+    result.steps = player.position();
+  } catch (std::exception &e) {
+    result.deterministic = false;
+    result.error = e.what();
+  } catch (const char *e) {
+    result.deterministic = false;
+    result.error = e;
+  }
+}
+
+void verifyTrajectories(const std::vector<std::string> &filenames,
+                        std::vector<TrajectoryCheck> &results, int threads,
+                        const std::string &rom_file) {
+  results.assign(filenames.size(), TrajectoryCheck());
+  if (threads <= 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  threads = std::min<size_t>(threads, filenames.size());
+
+  // Trajectories are handed out one at a time, so that long ones balance out
+  std::atomic<size_t> next(0);
+  std::vector<std::thread> workers;
+  for (int i = 0; i < threads; i++) {
+    workers.push_back(std::thread([&] {
+      for (size_t j = next++; j < filenames.size(); j = next++)
+        verifyTrajectory(filenames[j], rom_file, results[j]);
+    }));
+  }
+  for (size_t i = 0; i < workers.size(); i++)
+    workers[i].join();
+}
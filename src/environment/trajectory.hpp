@@ -0,0 +1,211 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  trajectory.hpp
+ *
+ *  Action logs from which a run of the emulator can be replayed exactly. The
+ *  emulator is deterministic given its state and the actions taken, so a few
+ *  bytes per step replace the frames, and any frame is reconstructed on demand
+ *  from the nearest embedded snapshot. All integers are little-endian:
+ *
+ *    "ALETRJ01"               magic and version
+ *    uInt32 snapshot interval
+ *    uInt32 random_seed       as set; the RNG state is in the first snapshot
+ *    uInt32 size, char[size]  ROM file, as recorded
+ *    char   md5[32]           MD5 of the ROM, in hexadecimal
+ *    uInt32 size, settings    every setting, as written by Settings::saveState()
+ *    uInt32 size, reference   the serialized state the environment started in
+ *    records, until the end of the file:
+ *      'S' uInt8 action A, uInt8 action B, Int32 reward, uInt32 RAM hash
+ *                             one act(); the hash is the low half of the RAM fingerprint
+ *      'R'                    a reset()
+ *      'K' or 'J' uInt8 action A, uInt8 action B, uInt32 size, body
+ *                             a state, encoded by StateCodec against the reference, and
+ *                             the last actions taken. 'K' snapshots are taken every
+ *                             snapshot interval steps; 'J' ones after the state was
+ *                             changed otherwise (e.g. by restoreState()), and must be
+ *                             restored on replay. The first record is a 'J' snapshot.
+ *
+ *  A recording cut short (e.g. by a crash) remains readable up to its last
+ *  complete record.
+ *
+ **************************************************************************** */
+
+#ifndef __TRAJECTORY_HPP__
+#define __TRAJECTORY_HPP__
+
+#include "state_codec.hpp"
+#include "ale_ram.hpp"
+#include "../common/Constants.h"
+#include "../emucore/OSystem.hxx"
+#include "../emucore/Settings.hxx"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+class StellaEnvironment;
+
+/** One act() of a recorded trajectory. */
+struct TrajectoryStep {
+  Action player_a_action, player_b_action;
+  reward_t reward;
+  uInt32 ram_hash;  // Low 32 bits of the RAM fingerprint after the step
+};
+
+class TrajectoryRecorder {
+  public:
+    /** Creates the log, overwriting any existing file, for an environment of the given
+      *  system which is in the given state (as returned by cloneSystemState()). Check
+      *  isOpen() for failure. */
+    TrajectoryRecorder(const std::string &filename, OSystem *osystem, const ALEState &initial,
+                       int snapshot_interval);
+    ~TrajectoryRecorder();
+
+    /** Whether the output could be opened and written to. After a failed write, which is
+      *  logged, nothing more is recorded. */
+    bool isOpen() const { return m_out != NULL; }
+
+    /** Logs one act() and the RAM it left. */
+    void addStep(Action player_a_action, Action player_b_action, reward_t reward,
+                 const ALERAM &ram);
+
+    /** Logs a reset(). */
+    void addReset();
+
+    /** Embeds a state (from cloneSystemState()) and the last actions taken. A jump marks a
+      *  state which wasn't reached by the logged steps. */
+    void addSnapshot(const ALEState &state, Action player_a_action, Action player_b_action,
+                     bool jump);
+
+    /** Whether a periodic snapshot is due. */
+    bool snapshotDue() const {
+      return m_snapshot_interval > 0 && m_steps_since_snapshot >= (size_t)m_snapshot_interval;
+    }
+
+    /** Number of steps logged so far. */
+    size_t size() const { return m_steps; }
+
+  private:
+    void write(const std::string &data);
+
+    std::string m_filename;
+    FILE *m_out;
+    StateCodec m_codec;
+    int m_snapshot_interval;
+    size_t m_steps;
+    size_t m_steps_since_snapshot;
+    std::string m_buffer;
+};
+
+class Trajectory {
+  public:
+    /** A recorded state. */
+    struct Snapshot {
+      std::string body;      // StateCodec body
+      Action player_a_action, player_b_action;
+      bool jump;
+    };
+
+    /** A record: a step, a reset or a snapshot, with its position in steps() or
+      *  snapshots(). */
+    struct Event {
+      enum Type { STEP, RESET, SNAPSHOT } type;
+      size_t index;
+    };
+
+    /** Reads a log written by TrajectoryRecorder. Throws std::runtime_error if the file
+      *  can't be read or isn't a trajectory. */
+    explicit Trajectory(const std::string &filename);
+
+    const std::string &getROMFile() const { return m_rom_file; }
+    const std::string &getROMMD5() const { return m_md5; }
+    int getSeed() const { return m_seed; }
+
+    /** Configures settings as the recording environment was, but without display or
+      *  recording. */
+    void applySettings(Settings &settings) const;
+
+    /** Number of steps, snapshots and records. */
+    size_t size() const { return m_steps.size(); }
+    const std::vector<TrajectoryStep> &steps() const { return m_steps; }
+    const std::vector<Snapshot> &snapshots() const { return m_snapshots; }
+    const std::vector<Event> &events() const { return m_events; }
+
+    /** The record of the given step. */
+    size_t eventOfStep(size_t step) const { return m_step_events[step]; }
+
+    /** Decodes a snapshot. */
+    ALEState decodeSnapshot(const Snapshot &snapshot) const;
+
+  private:
+    std::string m_rom_file;
+    std::string m_md5;
+    int m_seed;
+    std::string m_settings;
+    std::unique_ptr<StateCodec> m_codec;
+
+    std::vector<TrajectoryStep> m_steps;
+    std::vector<Snapshot> m_snapshots;
+    std::vector<Event> m_events;
+    std::vector<size_t> m_step_events;
+};
+
+class TrajectoryPlayer {
+  public:
+    /** Replays the trajectory on the environment, which must run the same ROM with the
+      *  trajectory's settings (see Trajectory::applySettings()) and not record it. */
+    TrajectoryPlayer(StellaEnvironment &environment, const Trajectory &trajectory);
+
+    /** Brings the environment to its state after the given number of steps (e.g. size()
+      *  for the end), screen included, replaying from the latest snapshot before it. */
+    void seek(size_t step);
+
+    /** Plays the next step. Returns false if the replay diverged from the recording: the
+      *  reward or RAM after the step, or a state embedded around it, differ. */
+    bool step();
+
+    /** Number of steps played. */
+    size_t position() const { return m_position; }
+
+    /** Whether every step has been played. */
+    bool done() const { return m_position == m_trajectory.size(); }
+
+  private:
+    /** Applies a reset or snapshot; returns false if a periodic snapshot differs from the
+      *  replayed state. */
+    bool apply(const Trajectory::Event &event, bool verify);
+
+    StellaEnvironment &m_environment;
+    const Trajectory &m_trajectory;
+    size_t m_event;     // The next record to apply
+    size_t m_position;
+};
+
+/** The outcome of replaying a recorded trajectory, as computed by verifyTrajectories(). */
+struct TrajectoryCheck {
+  bool deterministic;   // Whether the replay matched the recording throughout
+  size_t steps;         // Number of steps replayed
+  size_t divergence;    // The first step which didn't match, if any
+  std::string error;    // Why the trajectory couldn't be replayed, if it couldn't
+
+  TrajectoryCheck(): deterministic(false), steps(0), divergence(0) {}
+};
+
+/** Replays the trajectory files in parallel, each from its start on a fresh environment
+  *  configured as recorded, on the given number of threads (0: one per processor).
+  *  results[i] tells whether the emulator reproduced filenames[i]. If rom_file is not empty,
+  *  it replaces the ROM files recorded. */
+void verifyTrajectories(const std::vector<std::string> &filenames,
+                        std::vector<TrajectoryCheck> &results, int threads = 0,
+                        const std::string &rom_file = "");
+
+#endif // __TRAJECTORY_HPP__
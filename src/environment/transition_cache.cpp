@@ -0,0 +1,163 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  transition_cache.cpp
+ *
+ *  A bounded cache of deterministic transitions.
+ *
+ **************************************************************************** */
+
+#include "transition_cache.hpp"
+
+// Rough bookkeeping cost of an entry beyond its state and screen
+static const size_t EntryOverhead = 128;
+
+TransitionCache::TransitionCache(size_t capacity, int shards):
+  m_capacity(capacity),
+  m_hits(0),
+  m_misses(0),
+  m_insertions(0),
+  m_evictions(0) {
+
+  if (shards < 1)
+    shards = 1;
+  m_shard_capacity = capacity / shards;
+  for (int i = 0; i < shards; i++) {
+    m_shards.push_back(std::unique_ptr<Shard>(new Shard()));
+    m_shards.back()->hand = 0;
+    m_shards.back()->bytes = 0;
+  }
+}
+
+size_t TransitionCache::KeyHash::operator()(const Key &key) const {
+  // The state fingerprint is already well mixed
+  return (size_t)(key.state ^ ((fingerprint_t)key.player_a_action << 8) ^
+      ((fingerprint_t)key.player_b_action << 16) ^ ((fingerprint_t)key.frame_skip << 24));
+}
+
+TransitionCache::Shard &TransitionCache::shardOf(const Key &key) {
+  // Use the high bits, leaving the low ones to the shard's hash table
+  return *m_shards[(key.state >> 48) % m_shards.size()];
+}
+
+size_t TransitionCache::transitionBytes(const Transition &transition) {
+  return transition.state->serializedSize() + transition.screen->arraySize() + EntryOverhead;
+}
+
+bool TransitionCache::lookup(fingerprint_t state, Action player_a_action,
+                             Action player_b_action, int frame_skip, Transition &transition) {
+  Key key = { state, player_a_action, player_b_action, frame_skip };
+  Shard &shard = shardOf(key);
+
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    std::unordered_map<Key, size_t, KeyHash>::iterator it = shard.index.find(key);
+    if (it != shard.index.end()) {
+      Slot &slot = shard.slots[it->second];
+      slot.referenced = true;
+      transition = slot.transition;
+      m_hits++;
+      return true;
+    }
+  }
+
+  m_misses++;
+  return false;
+}
+
+void TransitionCache::insert(fingerprint_t state, Action player_a_action,
+                             Action player_b_action, int frame_skip,
+                             const Transition &transition) {
+  Key key = { state, player_a_action, player_b_action, frame_skip };
+  size_t bytes = transitionBytes(transition);
+  if (bytes > m_shard_capacity)
+    return;
+
+  Shard &shard = shardOf(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+
+  // Another environment sharing the cache may have stored it in the meantime
+  if (shard.index.find(key) != shard.index.end())
+    return;
+
+  makeRoom(shard, bytes);
+
+  size_t index;
+  if (!shard.free_slots.empty()) {
+    index = shard.free_slots.back();
+    shard.free_slots.pop_back();
+  }
+  else {
+    index = shard.slots.size();
+    shard.slots.push_back(Slot());
+  }
+
+  Slot &slot = shard.slots[index];
+  slot.key = key;
+  slot.transition = transition;
+  slot.bytes = bytes;
+  slot.used = true;
+  slot.referenced = false;
+  shard.index[key] = index;
+  shard.bytes += bytes;
+  m_insertions++;
+}
+
+void TransitionCache::makeRoom(Shard &shard, size_t extra) {
+  // CLOCK: sweep the slots, sparing those looked up since the last sweep once
+  while (shard.bytes + extra > m_shard_capacity && !shard.index.empty()) {
+    if (shard.hand >= shard.slots.size())
+      shard.hand = 0;
+    Slot &slot = shard.slots[shard.hand];
+
+    if (slot.used && slot.referenced)
+      slot.referenced = false;
+    else if (slot.used) {
+      shard.index.erase(slot.key);
+      shard.bytes -= slot.bytes;
+      slot.transition = Transition();
+      slot.used = false;
+      shard.free_slots.push_back(shard.hand);
+      m_evictions++;
+    }
+    shard.hand++;
+  }
+}
+
+void TransitionCache::clear() {
+  for (size_t i = 0; i < m_shards.size(); i++) {
+    Shard &shard = *m_shards[i];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.index.clear();
+    shard.slots.clear();
+    shard.free_slots.clear();
+    shard.hand = 0;
+    shard.bytes = 0;
+  }
+}
+
+TransitionCache::Statistics TransitionCache::getStatistics() const {
+  Statistics statistics;
+  statistics.hits = m_hits;
+  statistics.misses = m_misses;
+  statistics.insertions = m_insertions;
+  statistics.evictions = m_evictions;
+  statistics.entries = 0;
+  statistics.bytes = 0;
+
+  for (size_t i = 0; i < m_shards.size(); i++) {
+    Shard &shard = *m_shards[i];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    statistics.entries += shard.index.size();
+    statistics.bytes += shard.bytes;
+  }
+
+  return statistics;
+}
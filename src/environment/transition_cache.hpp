@@ -0,0 +1,120 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  transition_cache.hpp
+ *
+ *  A bounded cache of deterministic transitions, mapping (state, actions,
+ *  frame skip) to the resulting state, screen, reward and terminal flag. With
+ *  it, planners which expand the same nodes repeatedly replace emulation by a
+ *  lookup and a state restore.
+ *
+ **************************************************************************** */
+
+#ifndef __TRANSITION_CACHE_HPP__
+#define __TRANSITION_CACHE_HPP__
+
+#include "ale_screen.hpp"
+#include "ale_state.hpp"
+#include "../common/Constants.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class TransitionCache {
+  public:
+    /** The outcome of acting from a given state. */
+    struct Transition {
+      std::shared_ptr<const ALEState> state;   // The state after acting
+      std::shared_ptr<const ALEScreen> screen; // The screen after acting
+      reward_t reward;
+      bool terminal;
+    };
+
+    struct Statistics {
+      unsigned long long hits, misses, insertions, evictions;
+      size_t entries, bytes;
+
+      double hitRate() const {
+        return hits + misses > 0 ? (double)hits / (hits + misses) : 0.0;
+      }
+    };
+
+    /** Creates a cache holding up to capacity bytes of states and screens. It is split into
+      *  independently locked shards, so that environments on different threads may share it. */
+    TransitionCache(size_t capacity, int shards = 16);
+
+    /** Looks up the transition from the state with the given fingerprint. Returns false on
+      *  a miss. Two distinct states collide with probability about 2^-64. */
+    bool lookup(fingerprint_t state, Action player_a_action, Action player_b_action,
+                int frame_skip, Transition &transition);
+
+    /** Stores a transition, evicting entries which were not looked up recently if the
+      *  cache is full. */
+    void insert(fingerprint_t state, Action player_a_action, Action player_b_action,
+                int frame_skip, const Transition &transition);
+
+    /** Removes every entry; the counters are kept. */
+    void clear();
+
+    Statistics getStatistics() const;
+
+    size_t capacity() const { return m_capacity; }
+
+  private:
+    struct Key {
+      fingerprint_t state;
+      int player_a_action, player_b_action, frame_skip;
+
+      bool operator==(const Key &rhs) const {
+        return state == rhs.state && player_a_action == rhs.player_a_action &&
+          player_b_action == rhs.player_b_action && frame_skip == rhs.frame_skip;
+      }
+    };
+
+    struct KeyHash {
+      size_t operator()(const Key &key) const;
+    };
+
+    struct Slot {
+      Key key;
+      Transition transition;
+      size_t bytes;
+      bool used;
+      bool referenced; // Looked up since the clock hand last passed
+    };
+
+    /** A part of the cache with its own lock and clock hand. */
+    struct Shard {
+      std::mutex mutex;
+      std::unordered_map<Key, size_t, KeyHash> index; // Slot of each key
+      std::vector<Slot> slots;
+      std::vector<size_t> free_slots;
+      size_t hand;
+      size_t bytes;
+    };
+
+    Shard &shardOf(const Key &key);
+
+    /** Evicts entries from the shard until extra more bytes fit. */
+    void makeRoom(Shard &shard, size_t extra);
+
+    static size_t transitionBytes(const Transition &transition);
+
+    size_t m_capacity;
+    size_t m_shard_capacity;
+    std::vector<std::unique_ptr<Shard> > m_shards;
+
+    std::atomic<unsigned long long> m_hits, m_misses, m_insertions, m_evictions;
+};
+
+#endif // __TRANSITION_CACHE_HPP__
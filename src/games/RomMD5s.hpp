@@ -0,0 +1,93 @@
+#ifndef __ROM_MD5S_HPP__
+#define __ROM_MD5S_HPP__
+
+/**
+  This code is generated from md5.txt using the 'create_rom_md5s.cxx'
+  program, located in the src/tools directory.  It must only be included
+  by Roms.cpp.  Don't edit it; change md5.txt and regenerate it instead.
+*/
+
+/* the supported cartridges, as listed in md5.txt, and the games they hold */
+static const struct {
+    const char *md5;
+    const char *rom;
+} romMD5s[] = {
+    { "35be55426c1fec32dfb503b4f0651572", "air_raid" },
+    { "f1a0a23e6464d954e3a9579c4ccd01c8", "alien" },
+    { "acb7750b4d0c4bd34969802a7deb2990", "amidar" },
+    { "de78b3a064d374390ac0710f95edde92", "assault" },
+    { "89a68746eff7f266bbf08de2483abe55", "asterix" },
+    { "ccbd36746ed4525821a8083b0d6d2c2c", "asteroids" },
+    { "9ad36e699ef6f45d9eb6c4cf90475c9f", "atlantis" },
+    { "00ce0bdd43aed84a983bef38fe7f5ee3", "bank_heist" },
+    { "41f252a66c6301f1e8ab3612c19bc5d4", "battle_zone" },
+    { "79ab4123a83dc11d468fb2108ea09e2e", "beam_rider" },
+    { "136f75c4dd02c29283752b7e5799f978", "berzerk" },
+    { "c9b7afad3bfd922e006a6bfc1d4f3fe7", "bowling" },
+    { "c3ef5c4653212088eda54dc91d787870", "boxing" },
+    { "f34f08e5eb96e500e851a80be3277a56", "breakout" },
+    { "028024fb8e5e5f18ea586652f9799c96", "carnival" },
+    { "91c2098e88a6b13f977af8c003e0bca5", "centipede" },
+    { "c1cb228470a87beb5f36e90ac745da26", "chopper_command" },
+    { "55ef7b65066428367844342ed59f956c", "crazy_climber" },
+    { "0f643c34e40e3f1daafd9c524d3ffe64", "defender" },
+    { "f0e0addc07971561ab80d9abe1b8d333", "demon_attack" },
+    { "36b20c427975760cb9cf4a47e41369e4", "donkey_kong" },
+    { "368d88a6c071caba60b4f778615aae94", "double_dunk" },
+    { "71f8bacfbdca019113f3f0801849057e", "elevator_action" },
+    { "94b92a882f6dbaa6993a46e2dcc58402", "enduro" },
+    { "b8865f05676e64f3bec72b9defdacfa7", "fishing_derby" },
+    { "8e0ab801b1705a740b476b7f588c6d16", "freeway" },
+    { "081e2c114c9c20b61acf25fc95c71bf4", "frogger" },
+    { "4ca73eb959299471788f0b685c3ba0b5", "frostbite" },
+    { "211774f4c5739042618be8ff67351177", "galaxian" },
+    { "c16c79aad6272baffb8aae9a7fff0864", "gopher" },
+    { "8ac18076d01a6b63acf6e2cab4968940", "gravitar" },
+    { "fca4a5be1251927027f2c24774a02160", "hero" },
+    { "a4c08c4994eb9d24fb78be1793e82e26", "ice_hockey" },
+    { "e51030251e440cffaab1ac63438b44ae", "jamesbond" },
+    { "718ae62c70af4e5fd8e932fee216948a", "journey_escape" },
+    { "5428cdfada281c569c74c7308c7f2c26", "kaboom" },
+    { "4326edb70ff20d0ee5ba58fa5cb09d60", "kangaroo" },
+    { "6c1f3f2e359dbf55df462ccbcdd2f6bf", "keystone_kapers" },
+    { "0dd4c69b5f9a7ae96a7a08329496779a", "king_kong" },
+    { "534e23210dd1993c828d944c6ac4d9fb", "koolaid" },
+    { "4baada22435320d185c95b7dd2bcdb24", "krull" },
+    { "5b92a93b23523ff16e2789b820e2a4c5", "kung_fu_master" },
+    { "8e4cd60d93fcde8065c1a2b972a26377", "laser_gates" },
+    { "2d76c5d1aad506442b9e9fb67765e051", "lost_luggage" },
+    { "3347a6dd59049b15a38394aa2dafa585", "montezuma_revenge" },
+    { "aa7bb54d2c189a31bb1fa20099e42859", "mr_do" },
+    { "87e79cd41ce136fd4f72cc6e2c161bee", "ms_pacman" },
+    { "36306070f0c90a72461551a7a4f3a209", "name_this_game" },
+    { "fc2233fc116faef0d3c31541717ca2db", "pacman" },
+    { "7e52a95074a66640fcfde124fffd491a", "phoenix" },
+    { "3e90cf23106f2e08b2781e41299de556", "pitfall" },
+    { "60e0ea3cbe0913d39803477945e9e5ec", "pong" },
+    { "4799a40b6e889370b7ee55c17ba65141", "pooyan" },
+    { "ef3a4f64b6494ba770862768caf04b86", "private_eye" },
+    { "484b0076816a104875e00467d431c2d2", "qbert" },
+    { "393948436d1f4cc3192410bb918f9724", "riverraid" },
+    { "2bd00beefdb424fa39931a75e890695d", "road_runner" },
+    { "4f618c2429138e0280969193ed6c107e", "robotank" },
+    { "240bfbac5163af4df5ae713985386f92", "seaquest" },
+    { "dd0cbe5351551a538414fb9e37fc56e8", "sir_lancelot" },
+    { "b76fbadc8ffb1f83e2ca08b6fb4d6c9f", "skiing" },
+    { "e72eb8d4410152bdcb69e7fba327b420", "solaris" },
+    { "72ffbef6504b75e69ee1045af9075f66", "space_invaders" },
+    { "a3c1c70024d7aabb41381adbfb6d3b25", "star_gunner" },
+    { "4d7517ae69f95cfbc053be01312b7dba", "surround" },
+    { "42cdd6a9e42a3639e190722b8ea3fc51", "tennis" },
+    { "b0e1ee07fbc73493eac5651a52f90f00", "tetris" },
+    { "fc2104dd2dadf9a6176c1c1c8f87ced9", "time_pilot" },
+    { "fb27afe896e7c928089307b32e5642ee", "trondead" },
+    { "085322bae40d904f53bdcc56df0593fc", "tutankham" },
+    { "a499d720e7ee35c62424de882a3351b6", "up_n_down" },
+    { "3e899eba0ca8cd2972da1ae5479b4f0d", "venture" },
+    { "107cc025334211e6d29da0b6be46aec7", "video_pinball" },
+    { "7e8aa18bc9502eb57daaf5e7c1e94da7", "wizard_of_wor" },
+    { "c5930d0e8cdae3e037349bfa08e871be", "yars_revenge" },
+    { "eea0da9b987d661264cce69a7c13c3bd", "zaxxon" },
+};
+
+#endif // __ROM_MD5S_HPP__
@@ -12,6 +12,9 @@
 #include "Roms.hpp"
 #include "RomUtils.hpp"
 
+#include <algorithm>
+#include <unordered_map>
+
 // include the game implementations
 #include "supported/Adventure.hpp"
 #include "supported/AirRaid.hpp"
@@ -172,9 +175,38 @@ static const RomSettings *roms[]  = {
 };
 
 
+#include "RomMD5s.hpp"
+
+
+/* maps each cartridge MD5 to its game's settings, or NULL if there are none yet */
+static const std::unordered_map<std::string, const RomSettings *> &romsByMD5() {
+    static const std::unordered_map<std::string, const RomSettings *> registry = [] {
+        std::unordered_map<std::string, const RomSettings *> byName, byMD5;
+        for (size_t i = 0; i < sizeof(roms)/sizeof(roms[0]); i++) {
+            byName[roms[i]->rom()] = roms[i];
+        }
+        for (size_t i = 0; i < sizeof(romMD5s)/sizeof(romMD5s[0]); i++) {
+            auto it = byName.find(romMD5s[i].rom);
+            byMD5[romMD5s[i].md5] = it != byName.end() ? it->second : NULL;
+        }
+        return byMD5;
+    }();
+    return registry;
+}
+
+
+bool isSupportedRomMD5(const std::string &md5) {
+    return romsByMD5().count(md5) > 0;
+}
+
+
 /* looks for the RL wrapper corresponding to a particular rom title */
-RomSettings *buildRomRLWrapper(const std::string &rom) {
+RomSettings *buildRomRLWrapper(const std::string &rom, const std::string &md5) {
+
+    auto it = romsByMD5().find(md5);
+    if (it != romsByMD5().end() && it->second != NULL) return it->second->clone();
 
+    // Other dumps of the supported games are recognized by their file name
     size_t slash_ind = rom.find_last_of("/\\");
     std::string rom_str = rom.substr(slash_ind + 1);
     size_t dot_idx = rom_str.find_first_of(".");
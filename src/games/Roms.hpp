@@ -16,8 +16,13 @@
 
 #include <string>
 
-// looks for the RL wrapper corresponding to a particular rom title 
-extern RomSettings *buildRomRLWrapper(const std::string &rom);
+// looks for the RL wrapper corresponding to a particular cartridge MD5 or, failing that, rom
+// title; returns NULL if there is none
+extern RomSettings *buildRomRLWrapper(const std::string &rom,
+                                      const std::string &md5 = std::string());
+
+// whether the cartridge MD5 is one of those listed in md5.txt
+extern bool isSupportedRomMD5(const std::string &md5);
 
 
 #endif // __ROMS_HPP__
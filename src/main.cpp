@@ -32,6 +32,9 @@
 
 #include "controllers/ale_controller.hpp"
 #include "controllers/fifo_controller.hpp"
+#include "controllers/fork_server_controller.hpp"
+#include "controllers/shared_memory_controller.hpp"
+#include "controllers/environment_server_controller.hpp"
 #include "controllers/rlglue_controller.hpp"
 #include "common/Constants.h"
 #include "ale_interface.hpp"
@@ -53,6 +56,18 @@ static ALEController* createController(OSystem* osystem, std::string type) {
     std::cerr << "Game will be controlled through named FIFO pipes." << std::endl;
     return new FIFOController(osystem, true);
   }
+  else if (type == "fork_server") {
+    std::cerr << "Environments will be forked for agents connecting to the fork server." << std::endl;
+    return new ForkServerController(osystem);
+  }
+  else if (type == "shm") {
+    std::cerr << "Game will be controlled through shared memory." << std::endl;
+    return new SharedMemoryController(osystem);
+  }
+  else if (type == "env_server") {
+    std::cerr << "Environments will be hosted for agents connecting to the environment server." << std::endl;
+    return new EnvironmentServerController(osystem);
+  }
   else if (type == "rlglue") {
     std::cerr << "Game will be controlled through RL-Glue." << std::endl;
     return new RLGlueController(osystem); 
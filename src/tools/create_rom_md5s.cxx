@@ -0,0 +1,89 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2013 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * *****************************************************************************
+ */
+
+/**
+  Generates src/games/RomMD5s.hpp, the registry of supported cartridges that
+  Roms.cpp uses to identify games by MD5, from the checksums listed in md5.txt.
+  Regenerate it whenever md5.txt changes.
+
+  Build and regenerate with (from the top-level directory):
+
+    g++ -o create_rom_md5s src/tools/create_rom_md5s.cxx
+    ./create_rom_md5s md5.txt > src/games/RomMD5s.hpp
+*/
+
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Whether the line is "<md5> <rom>.bin"; the other lines of md5.txt are prose
+static bool parseLine(const std::string &line, std::string &md5, std::string &rom) {
+    std::istringstream in(line);
+    std::string file, rest;
+    if (!(in >> md5 >> file) || (in >> rest)) return false;
+
+    if (md5.size() != 32) return false;
+    for (size_t i = 0; i < md5.size(); i++)
+        if (!isxdigit((unsigned char)md5[i])) return false;
+
+    const std::string extension = ".bin";
+    if (file.size() <= extension.size() ||
+        file.compare(file.size() - extension.size(), extension.size(), extension) != 0)
+        return false;
+    rom = file.substr(0, file.size() - extension.size());
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " md5.txt" << std::endl;
+        return 1;
+    }
+    std::ifstream in(argv[1]);
+    if (!in) {
+        std::cerr << "Can't open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    printf("#ifndef __ROM_MD5S_HPP__\n"
+           "#define __ROM_MD5S_HPP__\n"
+           "\n"
+           "/**\n"
+           "  This code is generated from md5.txt using the 'create_rom_md5s.cxx'\n"
+           "  program, located in the src/tools directory.  It must only be included\n"
+           "  by Roms.cpp.  Don't edit it; change md5.txt and regenerate it instead.\n"
+           "*/\n"
+           "\n"
+           "/* the supported cartridges, as listed in md5.txt, and the games they hold */\n"
+           "static const struct {\n"
+           "    const char *md5;\n"
+           "    const char *rom;\n"
+           "} romMD5s[] = {\n");
+
+    int count = 0;
+    std::string line, md5, rom;
+    while (std::getline(in, line)) {
+        if (!parseLine(line, md5, rom)) continue;
+        printf("    { \"%s\", \"%s\" },\n", md5.c_str(), rom.c_str());
+        count++;
+    }
+
+    printf("};\n"
+           "\n"
+           "#endif // __ROM_MD5S_HPP__\n");
+
+    if (count == 0) {
+        std::cerr << "No checksums found in " << argv[1] << std::endl;
+        return 1;
+    }
+    return 0;
+}
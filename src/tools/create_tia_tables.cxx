@@ -0,0 +1,633 @@
+//============================================================================
+//
+//   SSSS    tt          lll  lll       
+//  SS  SS   tt           ll   ll        
+//  SS     tttttt  eeee   ll   ll   aaaa 
+//   SSSS    tt   ee  ee  ll   ll      aa
+//      SS   tt   eeeeee  ll   ll   aaaaa  --  "An Atari 2600 VCS Emulator"
+//  SS  SS   tt   ee      ll   ll  aa  aa
+//   SSSS     ttt  eeeee llll llll  aaaaa
+//
+// Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+//
+// See the file "license" for information on usage and redistribution of
+// this file, and for a DISCLAIMER OF ALL WARRANTIES.
+//============================================================================
+
+/**
+  Generates src/emucore/TIATables.hxx, which holds the TIA mask, collision,
+  reflect and position reset tables as constant data.  These tables used to
+  be computed by every TIA constructor; emitting them at compile time lets
+  them live in read-only memory shared by all processes and removes the
+  race between concurrently constructed TIAs.
+
+  Build and regenerate with (from the top-level directory):
+
+    g++ -Isrc/emucore/m6502/src/bspf/src -o create_tia_tables \
+        src/tools/create_tia_tables.cxx
+    ./create_tia_tables > src/emucore/TIATables.hxx
+
+  The computations below are the ones formerly found in TIA.cxx.
+*/
+
+#include <cassert>
+#include <cstdio>
+
+#include "bspf.hxx"
+
+enum
+{
+  myP0Bit = 0x01,         // Bit for Player 0
+  myM0Bit = 0x02,         // Bit for Missle 0
+  myP1Bit = 0x04,         // Bit for Player 1
+  myM1Bit = 0x08,         // Bit for Missle 1
+  myBLBit = 0x10,         // Bit for Ball
+  myPFBit = 0x20          // Bit for Playfield
+};
+
+static uInt8 ourBallMaskTable[4][4][320];
+static uInt16 ourCollisionTable[64];
+static uInt8 ourMissleMaskTable[4][8][4][320];
+static uInt8 ourPlayerMaskTable[4][2][8][320];
+static Int8 ourPlayerPositionResetWhenTable[8][160][160];
+static uInt8 ourPlayerReflectTable[256];
+static uInt32 ourPlayfieldTable[2][160];
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void computeBallMaskTable()
+{
+  // First, calculate masks for alignment 0
+  for(Int32 size = 0; size < 4; ++size)
+  {
+    Int32 x;
+
+    // Set all of the masks to false to start with
+    for(x = 0; x < 160; ++x)
+    {
+      ourBallMaskTable[0][size][x] = false;
+    }
+
+    // Set the necessary fields true
+    for(x = 0; x < 160 + 8; ++x)
+    {
+      if((x >= 0) && (x < (1 << size)))
+      {
+        ourBallMaskTable[0][size][x % 160] = true;
+      }
+    }
+
+    // Copy fields into the wrap-around area of the mask
+    for(x = 0; x < 160; ++x)
+    {
+      ourBallMaskTable[0][size][x + 160] = ourBallMaskTable[0][size][x];
+    }
+  }
+
+  // Now, copy data for alignments of 1, 2 and 3
+  for(uInt32 align = 1; align < 4; ++align)
+  {
+    for(uInt32 size = 0; size < 4; ++size)
+    {
+      for(uInt32 x = 0; x < 320; ++x)
+      {
+        ourBallMaskTable[align][size][x] = 
+            ourBallMaskTable[0][size][(x + 320 - align) % 320];
+      }
+    }
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void computeCollisionTable()
+{
+  for(uInt8 i = 0; i < 64; ++i)
+  { 
+    ourCollisionTable[i] = 0;
+
+    if((i & myM0Bit) && (i & myP1Bit))    // M0-P1
+      ourCollisionTable[i] |= 0x0001;
+
+    if((i & myM0Bit) && (i & myP0Bit))    // M0-P0
+      ourCollisionTable[i] |= 0x0002;
+
+    if((i & myM1Bit) && (i & myP0Bit))    // M1-P0
+      ourCollisionTable[i] |= 0x0004;
+
+    if((i & myM1Bit) && (i & myP1Bit))    // M1-P1
+      ourCollisionTable[i] |= 0x0008;
+
+    if((i & myP0Bit) && (i & myPFBit))    // P0-PF
+      ourCollisionTable[i] |= 0x0010;
+
+    if((i & myP0Bit) && (i & myBLBit))    // P0-BL
+      ourCollisionTable[i] |= 0x0020;
+
+    if((i & myP1Bit) && (i & myPFBit))    // P1-PF
+      ourCollisionTable[i] |= 0x0040;
+
+    if((i & myP1Bit) && (i & myBLBit))    // P1-BL
+      ourCollisionTable[i] |= 0x0080;
+
+    if((i & myM0Bit) && (i & myPFBit))    // M0-PF
+      ourCollisionTable[i] |= 0x0100;
+
+    if((i & myM0Bit) && (i & myBLBit))    // M0-BL
+      ourCollisionTable[i] |= 0x0200;
+
+    if((i & myM1Bit) && (i & myPFBit))    // M1-PF
+      ourCollisionTable[i] |= 0x0400;
+
+    if((i & myM1Bit) && (i & myBLBit))    // M1-BL
+      ourCollisionTable[i] |= 0x0800;
+
+    if((i & myBLBit) && (i & myPFBit))    // BL-PF
+      ourCollisionTable[i] |= 0x1000;
+
+    if((i & myP0Bit) && (i & myP1Bit))    // P0-P1
+      ourCollisionTable[i] |= 0x2000;
+
+    if((i & myM0Bit) && (i & myM1Bit))    // M0-M1
+      ourCollisionTable[i] |= 0x4000;
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void computeMissleMaskTable()
+{
+  // First, calculate masks for alignment 0
+  Int32 x, size, number;
+
+  // Clear the missle table to start with
+  for(number = 0; number < 8; ++number)
+    for(size = 0; size < 4; ++size)
+      for(x = 0; x < 160; ++x)
+        ourMissleMaskTable[0][number][size][x] = false;
+
+  for(number = 0; number < 8; ++number)
+  {
+    for(size = 0; size < 4; ++size)
+    {
+      for(x = 0; x < 160 + 72; ++x)
+      {
+        // Only one copy of the missle
+        if((number == 0x00) || (number == 0x05) || (number == 0x07))
+        {
+          if((x >= 0) && (x < (1 << size)))
+            ourMissleMaskTable[0][number][size][x % 160] = true;
+        }
+        // Two copies - close
+        else if(number == 0x01)
+        {
+          if((x >= 0) && (x < (1 << size)))
+            ourMissleMaskTable[0][number][size][x % 160] = true;
+          else if(((x - 16) >= 0) && ((x - 16) < (1 << size)))
+            ourMissleMaskTable[0][number][size][x % 160] = true;
+        }
+        // Two copies - medium
+        else if(number == 0x02)
+        {
+          if((x >= 0) && (x < (1 << size)))
+            ourMissleMaskTable[0][number][size][x % 160] = true;
+          else if(((x - 32) >= 0) && ((x - 32) < (1 << size)))
+            ourMissleMaskTable[0][number][size][x % 160] = true;
+        }
+        // Three copies - close
+        else if(number == 0x03)
+        {
+          if((x >= 0) && (x < (1 << size)))
+            ourMissleMaskTable[0][number][size][x % 160] = true;
+          else if(((x - 16) >= 0) && ((x - 16) < (1 << size)))
+            ourMissleMaskTable[0][number][size][x % 160] = true;
+          else if(((x - 32) >= 0) && ((x - 32) < (1 << size)))
+            ourMissleMaskTable[0][number][size][x % 160] = true;
+        }
+        // Two copies - wide
+        else if(number == 0x04)
+        {
+          if((x >= 0) && (x < (1 << size)))
+            ourMissleMaskTable[0][number][size][x % 160] = true;
+          else if(((x - 64) >= 0) && ((x - 64) < (1 << size)))
+            ourMissleMaskTable[0][number][size][x % 160] = true;
+        }
+        // Three copies - medium
+        else if(number == 0x06)
+        {
+          if((x >= 0) && (x < (1 << size)))
+            ourMissleMaskTable[0][number][size][x % 160] = true;
+          else if(((x - 32) >= 0) && ((x - 32) < (1 << size)))
+            ourMissleMaskTable[0][number][size][x % 160] = true;
+          else if(((x - 64) >= 0) && ((x - 64) < (1 << size)))
+            ourMissleMaskTable[0][number][size][x % 160] = true;
+        }
+      }
+
+      // Copy data into wrap-around area
+      for(x = 0; x < 160; ++x)
+        ourMissleMaskTable[0][number][size][x + 160] = 
+          ourMissleMaskTable[0][number][size][x];
+    }
+  }
+
+  // Now, copy data for alignments of 1, 2 and 3
+  for(uInt32 align = 1; align < 4; ++align)
+  {
+    for(number = 0; number < 8; ++number)
+    {
+      for(size = 0; size < 4; ++size)
+      {
+        for(x = 0; x < 320; ++x)
+        {
+          ourMissleMaskTable[align][number][size][x] = 
+            ourMissleMaskTable[0][number][size][(x + 320 - align) % 320];
+        }
+      }
+    }
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void computePlayerMaskTable()
+{
+  // First, calculate masks for alignment 0
+  Int32 x, enable, mode;
+
+  // Set the player mask table to all zeros
+  for(enable = 0; enable < 2; ++enable)
+    for(mode = 0; mode < 8; ++mode)
+      for(x = 0; x < 160; ++x)
+        ourPlayerMaskTable[0][enable][mode][x] = 0x00;
+
+  // Now, compute the player mask table
+  for(enable = 0; enable < 2; ++enable)
+  {
+    for(mode = 0; mode < 8; ++mode)
+    {
+      for(x = 0; x < 160 + 72; ++x)
+      {
+        if(mode == 0x00)
+        {
+          if((enable == 0) && (x >= 0) && (x < 8))
+            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> x;
+        }
+        else if(mode == 0x01)
+        {
+          if((enable == 0) && (x >= 0) && (x < 8))
+            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> x;
+          else if(((x - 16) >= 0) && ((x - 16) < 8))
+            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> (x - 16);
+        }
+        else if(mode == 0x02)
+        {
+          if((enable == 0) && (x >= 0) && (x < 8))
+            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> x;
+          else if(((x - 32) >= 0) && ((x - 32) < 8))
+            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> (x - 32);
+        }
+        else if(mode == 0x03)
+        {
+          if((enable == 0) && (x >= 0) && (x < 8))
+            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> x;
+          else if(((x - 16) >= 0) && ((x - 16) < 8))
+            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> (x - 16);
+          else if(((x - 32) >= 0) && ((x - 32) < 8))
+            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> (x - 32);
+        }
+        else if(mode == 0x04)
+        {
+          if((enable == 0) && (x >= 0) && (x < 8))
+            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> x;
+          else if(((x - 64) >= 0) && ((x - 64) < 8))
+            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> (x - 64);
+        }
+        else if(mode == 0x05)
+        {
+          // For some reason in double size mode the player's output
+          // is delayed by one pixel thus we use > instead of >=
+          if((enable == 0) && (x > 0) && (x <= 16))
+            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> ((x - 1)/2);
+        }
+        else if(mode == 0x06)
+        {
+          if((enable == 0) && (x >= 0) && (x < 8))
+            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> x;
+          else if(((x - 32) >= 0) && ((x - 32) < 8))
+            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> (x - 32);
+          else if(((x - 64) >= 0) && ((x - 64) < 8))
+            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> (x - 64);
+        }
+        else if(mode == 0x07)
+        {
+          // For some reason in quad size mode the player's output
+          // is delayed by one pixel thus we use > instead of >=
+          if((enable == 0) && (x > 0) && (x <= 32))
+            ourPlayerMaskTable[0][enable][mode][x % 160] = 0x80 >> ((x - 1)/4);
+        }
+      }
+  
+      // Copy data into wrap-around area
+      for(x = 0; x < 160; ++x)
+      {
+        ourPlayerMaskTable[0][enable][mode][x + 160] = 
+            ourPlayerMaskTable[0][enable][mode][x];
+      }
+    }
+  }
+
+  // Now, copy data for alignments of 1, 2 and 3
+  for(uInt32 align = 1; align < 4; ++align)
+  {
+    for(enable = 0; enable < 2; ++enable)
+    {
+      for(mode = 0; mode < 8; ++mode)
+      {
+        for(x = 0; x < 320; ++x)
+        {
+          ourPlayerMaskTable[align][enable][mode][x] =
+              ourPlayerMaskTable[0][enable][mode][(x + 320 - align) % 320];
+        }
+      }
+    }
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void computePlayerPositionResetWhenTable()
+{
+  uInt32 mode, oldx, newx;
+
+  // Loop through all player modes, all old player positions, and all new
+  // player positions and determine where the new position is located:
+  // 1 means the new position is within the display of an old copy of the
+  // player, -1 means the new position is within the delay portion of an
+  // old copy of the player, and 0 means it's neither of these two
+  for(mode = 0; mode < 8; ++mode)
+  {
+    for(oldx = 0; oldx < 160; ++oldx)
+    {
+      // Set everything to 0 for non-delay/non-display section
+      for(newx = 0; newx < 160; ++newx)
+      {
+        ourPlayerPositionResetWhenTable[mode][oldx][newx] = 0;
+      }
+
+      // Now, we'll set the entries for non-delay/non-display section
+      for(newx = 0; newx < 160 + 72 + 5; ++newx)
+      {
+        if(mode == 0x00)
+        {
+          if((newx >= oldx) && (newx < (oldx + 4)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
+
+          if((newx >= oldx + 4) && (newx < (oldx + 4 + 8)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
+        }
+        else if(mode == 0x01)
+        {
+          if((newx >= oldx) && (newx < (oldx + 4)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
+          else if((newx >= (oldx + 16)) && (newx < (oldx + 16 + 4)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
+
+          if((newx >= oldx + 4) && (newx < (oldx + 4 + 8)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
+          else if((newx >= oldx + 16 + 4) && (newx < (oldx + 16 + 4 + 8)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
+        }
+        else if(mode == 0x02)
+        {
+          if((newx >= oldx) && (newx < (oldx + 4)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
+          else if((newx >= (oldx + 32)) && (newx < (oldx + 32 + 4)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
+
+          if((newx >= oldx + 4) && (newx < (oldx + 4 + 8)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
+          else if((newx >= oldx + 32 + 4) && (newx < (oldx + 32 + 4 + 8)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
+        }
+        else if(mode == 0x03)
+        {
+          if((newx >= oldx) && (newx < (oldx + 4)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
+          else if((newx >= (oldx + 16)) && (newx < (oldx + 16 + 4)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
+          else if((newx >= (oldx + 32)) && (newx < (oldx + 32 + 4)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
+
+          if((newx >= oldx + 4) && (newx < (oldx + 4 + 8)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
+          else if((newx >= oldx + 16 + 4) && (newx < (oldx + 16 + 4 + 8)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
+          else if((newx >= oldx + 32 + 4) && (newx < (oldx + 32 + 4 + 8)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
+        }
+        else if(mode == 0x04)
+        {
+          if((newx >= oldx) && (newx < (oldx + 4)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
+          else if((newx >= (oldx + 64)) && (newx < (oldx + 64 + 4)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
+
+          if((newx >= oldx + 4) && (newx < (oldx + 4 + 8)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
+          else if((newx >= oldx + 64 + 4) && (newx < (oldx + 64 + 4 + 8)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
+        }
+        else if(mode == 0x05)
+        {
+          if((newx >= oldx) && (newx < (oldx + 4)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
+
+          if((newx >= oldx + 4) && (newx < (oldx + 4 + 16)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
+        }
+        else if(mode == 0x06)
+        {
+          if((newx >= oldx) && (newx < (oldx + 4)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
+          else if((newx >= (oldx + 32)) && (newx < (oldx + 32 + 4)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
+          else if((newx >= (oldx + 64)) && (newx < (oldx + 64 + 4)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
+
+          if((newx >= oldx + 4) && (newx < (oldx + 4 + 8)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
+          else if((newx >= oldx + 32 + 4) && (newx < (oldx + 32 + 4 + 8)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
+          else if((newx >= oldx + 64 + 4) && (newx < (oldx + 64 + 4 + 8)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
+        }
+        else if(mode == 0x07)
+        {
+          if((newx >= oldx) && (newx < (oldx + 4)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = -1;
+
+          if((newx >= oldx + 4) && (newx < (oldx + 4 + 32)))
+            ourPlayerPositionResetWhenTable[mode][oldx][newx % 160] = 1;
+        }
+      }
+
+      // Let's do a sanity check on our table entries
+      uInt32 s1 = 0, s2 = 0;
+      for(newx = 0; newx < 160; ++newx)
+      {
+        if(ourPlayerPositionResetWhenTable[mode][oldx][newx] == -1)
+          ++s1;
+        if(ourPlayerPositionResetWhenTable[mode][oldx][newx] == 1)
+          ++s2;
+      }
+      assert((s1 % 4 == 0) && (s2 % 8 == 0));
+    }
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void computePlayerReflectTable()
+{
+  for(uInt16 i = 0; i < 256; ++i)
+  {
+    uInt8 r = 0;
+
+    for(uInt16 t = 1; t <= 128; t *= 2)
+    {
+      r = (r << 1) | ((i & t) ? 0x01 : 0x00);
+    }
+
+    ourPlayerReflectTable[i] = r;
+  } 
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+static void computePlayfieldMaskTable()
+{
+  Int32 x;
+
+  // Compute playfield mask table for non-reflected mode
+  for(x = 0; x < 160; ++x)
+  {
+    if(x < 16)
+      ourPlayfieldTable[0][x] = 0x00001 << (x / 4);
+    else if(x < 48)
+      ourPlayfieldTable[0][x] = 0x00800 >> ((x - 16) / 4);
+    else if(x < 80) 
+      ourPlayfieldTable[0][x] = 0x01000 << ((x - 48) / 4);
+    else if(x < 96) 
+      ourPlayfieldTable[0][x] = 0x00001 << ((x - 80) / 4);
+    else if(x < 128)
+      ourPlayfieldTable[0][x] = 0x00800 >> ((x - 96) / 4);
+    else if(x < 160) 
+      ourPlayfieldTable[0][x] = 0x01000 << ((x - 128) / 4);
+  }
+
+  // Compute playfield mask table for reflected mode
+  for(x = 0; x < 160; ++x)
+  {
+    if(x < 16)
+      ourPlayfieldTable[1][x] = 0x00001 << (x / 4);
+    else if(x < 48)
+      ourPlayfieldTable[1][x] = 0x00800 >> ((x - 16) / 4);
+    else if(x < 80) 
+      ourPlayfieldTable[1][x] = 0x01000 << ((x - 48) / 4);
+    else if(x < 112) 
+      ourPlayfieldTable[1][x] = 0x80000 >> ((x - 80) / 4);
+    else if(x < 144) 
+      ourPlayfieldTable[1][x] = 0x00010 << ((x - 112) / 4);
+    else if(x < 160) 
+      ourPlayfieldTable[1][x] = 0x00008 >> ((x - 144) / 4);
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+// Prints 'count' values from 'data' as a brace-enclosed initializer whose
+// nesting follows the array dimensions in 'dims'
+template<typename T>
+static void emit(const T* data, const int* dims, int rank, int width)
+{
+  if(rank == 1)
+  {
+    printf("{");
+    for(int i = 0; i < dims[0]; ++i)
+    {
+      if(i > 0 && i % 32 == 0)
+        printf("\n");
+      printf(i + 1 < dims[0] ? "%*d," : "%*d", width, (int)data[i]);
+    }
+    printf("}");
+    return;
+  }
+
+  int stride = 1;
+  for(int r = 1; r < rank; ++r)
+    stride *= dims[r];
+
+  printf("{\n");
+  for(int i = 0; i < dims[0]; ++i)
+  {
+    emit(data + i * stride, dims + 1, rank - 1, width);
+    printf(i + 1 < dims[0] ? ",\n" : "\n");
+  }
+  printf("}");
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+template<typename T>
+static void emitTable(const char* decl, const T* data, const int* dims,
+    int rank, int width)
+{
+  printf("// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -\n");
+  printf("%s = ", decl);
+  emit(data, dims, rank, width);
+  printf(";\n\n");
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+int main()
+{
+  computeBallMaskTable();
+  computeCollisionTable();
+  computeMissleMaskTable();
+  computePlayerMaskTable();
+  computePlayerPositionResetWhenTable();
+  computePlayerReflectTable();
+  computePlayfieldMaskTable();
+
+  printf("#ifndef TIA_TABLES_HXX\n#define TIA_TABLES_HXX\n\n");
+  printf("/**\n"
+         "  This code is generated using the 'create_tia_tables.cxx' program,\n"
+         "  located in the src/tools directory.  It must only be included by\n"
+         "  TIA.cxx.  Changes to the tables should be made in the generator,\n"
+         "  and then this file should be regenerated and the application\n"
+         "  recompiled.\n"
+         "*/\n\n");
+
+  static const int ballDims[] = { 4, 4, 320 };
+  emitTable("const uInt8 TIA::ourBallMaskTable[4][4][320]",
+      &ourBallMaskTable[0][0][0], ballDims, 3, 1);
+
+  static const int collisionDims[] = { 64 };
+  emitTable("const uInt16 TIA::ourCollisionTable[64]",
+      &ourCollisionTable[0], collisionDims, 1, 5);
+
+  static const int missleDims[] = { 4, 8, 4, 320 };
+  emitTable("const uInt8 TIA::ourMissleMaskTable[4][8][4][320]",
+      &ourMissleMaskTable[0][0][0][0], missleDims, 4, 1);
+
+  static const int playerDims[] = { 4, 2, 8, 320 };
+  emitTable("const uInt8 TIA::ourPlayerMaskTable[4][2][8][320]",
+      &ourPlayerMaskTable[0][0][0][0], playerDims, 4, 3);
+
+  static const int resetWhenDims[] = { 8, 160, 160 };
+  emitTable("const Int8 TIA::ourPlayerPositionResetWhenTable[8][160][160]",
+      &ourPlayerPositionResetWhenTable[0][0][0], resetWhenDims, 3, 2);
+
+  static const int reflectDims[] = { 256 };
+  emitTable("const uInt8 TIA::ourPlayerReflectTable[256]",
+      &ourPlayerReflectTable[0], reflectDims, 1, 3);
+
+  static const int playfieldDims[] = { 2, 160 };
+  emitTable("const uInt32 TIA::ourPlayfieldTable[2][160]",
+      &ourPlayfieldTable[0][0], playfieldDims, 2, 6);
+
+  printf("#endif\n");
+  return 0;
+}